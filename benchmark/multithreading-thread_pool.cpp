@@ -0,0 +1,339 @@
+// Throughput of ThreadPool against the mutex-based pool it
+// replaced, at 1 to 64 threads, for many short tasks queued
+// either from outside the pool or from within its tasks.
+#include <rain.hpp>
+
+namespace Baseline {
+	// The mutex-based ThreadPool preceding the work-stealing
+	// one, kept verbatim for comparison.
+	//
+	// LockingThreadPool manages an upper-bounded number of
+	// threads to work on a queue of tasks.
+	//
+	// If any Task may block, the LockingThreadPool may block during
+	// destruction. Otherwise, the LockingThreadPool is guaranteed
+	// not to block during destruction.
+	//
+	// LockingThreadPool consumes any exceptions thrown by its tasks.
+	class LockingThreadPool {
+		public:
+		// A task is simply a callable which is executed.
+		// Parameters should be captured in the lambda used as
+		// function. Should not throw.
+		using Task = std::function<void()>;
+
+		private:
+		// Maximum number of threads the LockingThreadPool will spawn.
+		// Zero is unbounded.
+		std::atomic_size_t maxThreads,
+			// A thread is idle if it is not waiting on newTaskEv.
+			cIdleThreads;
+
+		// Locks cIdleThreads. Used when threads are idle.
+		mutable std::mutex cIdleThreadsMtx;
+
+		// Tracks all threads.
+		std::list<std::thread> threads;
+
+		// Locks this->threads.
+		mutable std::mutex threadsMtx;
+
+		// Task queue.
+		std::queue<Task> tasks;
+
+		// Locks this->tasks.
+		mutable std::mutex tasksMtx;
+
+		// Lock acquisition order is: tasksMtx, threadsMtx,
+		// cIdleThreadsMtx to avoid deadlock.
+
+		// Breaks when a new task comes, or when destructing.
+		std::condition_variable newTaskEv,
+			// Breaks when no tasks in progress and no tasks in
+			// queue.
+			noTasksEv;
+
+		// In destructor. No new tasks will be taken.
+		std::atomic_bool destructing;
+
+		public:
+		LockingThreadPool(std::size_t maxThreads = 0) noexcept :
+			maxThreads(maxThreads),
+			cIdleThreads(0),
+			destructing(false) {}
+
+		// Forbid copy/move.
+		LockingThreadPool(LockingThreadPool const &) = delete;
+		LockingThreadPool &operator=(LockingThreadPool const &) = delete;
+		LockingThreadPool(LockingThreadPool &&) = delete;
+		LockingThreadPool &operator=(LockingThreadPool &&) = delete;
+
+		// Getters.
+		std::size_t getCQueuedTasks() const noexcept {
+			std::lock_guard<std::mutex> tasksLckGuard(
+				this->tasksMtx);
+			return this->tasks.size();
+		}
+		std::size_t getCBusyThreads() const noexcept {
+			std::lock_guard<std::mutex> tasksLckGuard(
+				this->tasksMtx);
+			std::lock_guard<std::mutex> threadsLckGuard(
+				this->threadsMtx);
+			std::lock_guard<std::mutex> cIdleThreadsLckGuard(
+				this->cIdleThreadsMtx);
+			return this->threads.size() - this->cIdleThreads;
+		}
+		std::size_t getCTasks() const noexcept {
+			std::lock_guard<std::mutex> tasksLckGuard(
+				this->tasksMtx);
+			std::lock_guard<std::mutex> threadsLckGuard(
+				this->threadsMtx);
+			std::lock_guard<std::mutex> cIdleThreadsLckGuard(
+				this->cIdleThreadsMtx);
+			return this->tasks.size() + this->threads.size() -
+				this->cIdleThreads;
+		}
+		std::size_t getCIdleThreads() const noexcept {
+			// No need to lock here, since this atomic will always
+			// be consistent by itself.
+			return this->cIdleThreads;
+		}
+		std::size_t getCThreads() const noexcept {
+			std::lock_guard<std::mutex> threadsLckGuard(
+				this->threadsMtx);
+			return this->threads.size();
+		}
+		std::size_t getMaxThreads() const noexcept {
+			return this->maxThreads;
+		}
+
+		// Setters.
+		void setMaxThreads(std::size_t newMaxThreads) noexcept {
+			this->maxThreads = newMaxThreads;
+		}
+
+		void queueTask(Task const &task) {
+			// Any time a new task is added, notify one waiting
+			// thread.
+			std::lock_guard<std::mutex> tasksLckGuard(
+				this->tasksMtx);
+			this->tasks.push(task);
+			this->newTaskEv.notify_one();
+
+			// If no threads free, make a new thread if possible.
+			std::lock_guard<std::mutex> threadsLckGuard(
+				this->threadsMtx);
+			std::lock_guard<std::mutex> cIdleThreadsLckGuard(
+				this->cIdleThreadsMtx);
+			if (
+				this->cIdleThreads == 0 &&
+				(this->maxThreads == 0 ||
+					this->threads.size() < this->maxThreads)) {
+				// May cause exception to try again if system
+				// resources are not available. In that case, it is
+				// good to set the max thread limit.
+				this->threads.push_back(
+					std::thread(LockingThreadPool::threadFnc, this));
+			}
+		}
+
+		// Thread function.
+		// If Task throws, the error is ignored to stderr.
+		static void threadFnc(LockingThreadPool *threadPool) {
+			while (!threadPool->destructing) {
+				// Wait until task or destruction.
+				std::unique_ptr<Task> task;
+
+				// RAII incrementation in case of exception, with
+				// unique_ptr allowing for delayed initialization.
+				std::unique_ptr<
+					Rain::Error::Incrementer<std::atomic_size_t>>
+					incrementer;
+
+				{
+					// Before a thread idles, check to trigger a tasks
+					// done event.
+					std::unique_lock<std::mutex> tasksLck(
+						threadPool->tasksMtx);
+					{
+						std::lock_guard<std::mutex> threadsLckGuard(
+							threadPool->threadsMtx);
+						std::lock_guard<std::mutex>
+							cIdleThreadsLckGuard(
+								threadPool->cIdleThreadsMtx);
+
+						// Increment via constructor.
+						// If failure before destructor, the
+						// decrementing destructor will be called
+						// automatically.
+						incrementer.reset(new Rain::Error::Incrementer(
+							threadPool->cIdleThreads));
+
+						if (
+							threadPool->tasks.empty() &&
+							threadPool->cIdleThreads ==
+								threadPool->threads.size()) {
+							threadPool->noTasksEv.notify_all();
+						}
+					}
+
+					// Idle with just the tasksLck lock.
+					threadPool->newTaskEv.wait(
+						tasksLck, [threadPool]() {
+							return !threadPool->tasks.empty() ||
+								threadPool->destructing;
+						});
+
+					{
+						std::lock_guard<std::mutex> threadsLckGuard(
+							threadPool->threadsMtx);
+						std::lock_guard<std::mutex>
+							cIdleThreadsLckGuard(
+								threadPool->cIdleThreadsMtx);
+
+						// Decrement via destructor.
+						incrementer.reset();
+					}
+
+					// Exit if necessary.
+					if (threadPool->destructing) {
+						return;
+					}
+
+					// Otherwise, take a task.
+					task.reset(new Task(threadPool->tasks.front()));
+					threadPool->tasks.pop();
+
+					// Release tasksMtx.
+				}
+
+				// Execute the task. Task pointer is automatically
+				// freed afterwards.
+				Rain::Error::consumeThrowable(
+					*task, std::source_location::current())();
+			}
+		}
+
+		// Block until all tasks completed and none are in
+		// queue, or up to a timeout. Return false if all tasks
+		// completed, or true on timeout.
+		bool blockForTasks(Rain::Time::Timeout timeout = {}) {
+			// If no tasks, return immediately.
+			{
+				std::lock_guard<std::mutex> tasksLckGuard(
+					this->tasksMtx);
+				std::lock_guard<std::mutex> threadsLckGuard(
+					this->threadsMtx);
+				std::lock_guard<std::mutex> cIdleThreadsLckGuard(
+					this->cIdleThreadsMtx);
+				if (
+					this->tasks.size() == 0 &&
+					this->cIdleThreads == this->threads.size()) {
+					return false;
+				}
+			}
+
+			// Otherwise, wait for event.
+			std::unique_lock<std::mutex> tasksLck(this->tasksMtx);
+			auto predicate = [this]() {
+				// tasksMtx is locked in predicate.
+
+				std::lock_guard<std::mutex> threadsLckGuard(
+					this->threadsMtx);
+				std::lock_guard<std::mutex> cIdleThreadsLckGuard(
+					this->cIdleThreadsMtx);
+				return this->tasks.empty() &&
+					this->cIdleThreads == this->threads.size();
+			};
+
+			if (timeout.isInfinite()) {
+				this->noTasksEv.wait(tasksLck, predicate);
+				return false;
+			} else {
+				return !this->noTasksEv.wait_until(
+					tasksLck, timeout.asTimepoint(), predicate);
+			}
+		}
+
+		~LockingThreadPool() {
+			// Break any idle threads.
+			this->destructing = true;
+			this->newTaskEv.notify_all();
+
+			// Wait on remaining busy threads to shutdown.
+			// Any tasks not completed at this point won't be
+			// completed. Do not need to lock mutexes, since only
+			// ThreadFnc may be executing here, and that does not
+			// modify this->threads.
+			for (
+				auto it{this->threads.begin()};
+				it != this->threads.end();
+				it++) {
+				it->join();
+			}
+		}
+	};
+}
+
+// Runs cTasks trivial tasks on a pool of cThreads, queued
+// from cQueuers tasks in the pool, or from main if cQueuers
+// is zero. Returns tasks per second.
+template<typename ThreadPool>
+double benchmark(
+	std::size_t cThreads,
+	std::size_t cTasks,
+	std::size_t cQueuers) {
+	ThreadPool threadPool(cThreads);
+	std::atomic_size_t counter{0};
+	auto const task = [&counter]() { counter++; };
+
+	auto const timeBegin{std::chrono::steady_clock::now()};
+	if (cQueuers == 0) {
+		for (std::size_t i{0}; i < cTasks; i++) {
+			threadPool.queueTask(task);
+		}
+	} else {
+		for (std::size_t i{0}; i < cQueuers; i++) {
+			threadPool.queueTask(
+				[&threadPool, &task, cTasks, cQueuers]() {
+					for (std::size_t j{0}; j < cTasks / cQueuers; j++) {
+						threadPool.queueTask(task);
+					}
+				});
+		}
+	}
+	threadPool.blockForTasks();
+	std::chrono::duration<double> const timeElapsed{
+		std::chrono::steady_clock::now() - timeBegin};
+	return counter / timeElapsed.count();
+}
+
+int main() {
+	using namespace Rain::Literal;
+
+	std::size_t const C_TASKS{1_zu << 18}, C_QUEUERS{16};
+	std::cout << "Tasks: " << C_TASKS << "." << std::endl;
+	for (std::size_t cThreads{1}; cThreads <= 64;
+			 cThreads *= 2) {
+		std::cout
+			<< "Threads: " << cThreads << ", tasks/s (external): "
+			<< static_cast<std::size_t>(
+					 benchmark<Baseline::LockingThreadPool>(
+						 cThreads, C_TASKS, 0))
+			<< " locking, "
+			<< static_cast<std::size_t>(
+					 benchmark<Rain::Multithreading::ThreadPool>(
+						 cThreads, C_TASKS, 0))
+			<< " stealing; tasks/s (nested): "
+			<< static_cast<std::size_t>(
+					 benchmark<Baseline::LockingThreadPool>(
+						 cThreads, C_TASKS, C_QUEUERS))
+			<< " locking, "
+			<< static_cast<std::size_t>(
+					 benchmark<Rain::Multithreading::ThreadPool>(
+						 cThreads, C_TASKS, C_QUEUERS))
+			<< " stealing." << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,124 @@
+// Loopback benchmark of sending a large file body, through
+// std::filebuf and the 1KB send buffer, against
+// FileStreamBuf, which is sent with sendfile(2) where
+// available. Reports throughput and process CPU time, which
+// includes the (identical) cost of the receiving client.
+#include <rain.hpp>
+
+using namespace Rain::Literal;
+using namespace Rain::Networking;
+
+std::filesystem::path const FILE_PATH{
+	std::filesystem::temp_directory_path() /
+	"rain-networking-http-file.bin"};
+std::size_t const FILE_SIZE{1_zu << 26};
+
+class FileWorker : public Http::Worker<> {
+	using Worker::Worker;
+
+	ResponseAction reqFilebuf(Request &, std::smatch const &) {
+		std::filebuf filebuf;
+		filebuf.open(FILE_PATH, std::ios::in | std::ios::binary);
+		Response res{StatusCode::OK, {}, std::move(filebuf)};
+		res.headers.contentLength(FILE_SIZE);
+		return {std::move(res)};
+	}
+	ResponseAction reqFileStreamBuf(
+		Request &req,
+		std::smatch const &) {
+		return {
+			{req.headers.range(), Http::FileStreamBuf(FILE_PATH)}};
+	}
+
+	virtual Filters const &filters() override {
+		static Filters const filters{
+			{".*",
+				"/filebuf",
+				{Method::GET},
+				&FileWorker::reqFilebuf},
+			{".*",
+				"/file_stream_buf",
+				{Method::GET},
+				&FileWorker::reqFileStreamBuf}};
+		return filters;
+	}
+};
+
+class FileServer : public Http::Server<FileWorker> {
+	using Server::Server;
+
+	virtual FileWorker makeWorker(
+		NativeSocket nativeSocket,
+		SocketInterface *interrupter) override {
+		return {nativeSocket, interrupter};
+	}
+
+	public:
+	~FileServer() { this->destruct(); }
+};
+
+int main() {
+	{
+		std::ofstream file(FILE_PATH, std::ios::binary);
+		std::string chunk(1_zu << 20, 'a');
+		for (std::size_t i{0}; i < FILE_SIZE / chunk.size();
+				 i++) {
+			file << chunk;
+		}
+	}
+
+	FileServer server(":0");
+	std::size_t const C_DOWNLOADS{16};
+	std::cout << "File size: " << FILE_SIZE
+						<< ", downloads: " << C_DOWNLOADS << std::endl;
+
+	for (std::string const target :
+			 {"/filebuf", "/file_stream_buf"}) {
+		Client<
+			Ipv4FamilyInterface,
+			StreamTypeInterface,
+			TcpProtocolInterface>
+			client(Host{"localhost", server.host().service});
+		std::string const request{
+			"GET " + target + " HTTP/1.1\r\n\r\n"};
+		std::vector<char> buffer(1_zu << 20);
+
+		auto const timeBegin{std::chrono::steady_clock::now()};
+		std::clock_t const clockBegin{std::clock()};
+		for (std::size_t i{0}; i < C_DOWNLOADS; i++) {
+			client.send(request);
+
+			// The head arrives in the first recv.
+			std::size_t cRemaining{0};
+			do {
+				std::size_t result{
+					client.recv(&buffer[0], buffer.size())};
+				if (result == 0) {
+					std::cout << "Download failed." << std::endl;
+					return 1;
+				}
+				if (cRemaining == 0) {
+					cRemaining = FILE_SIZE + 4 +
+						std::string_view(&buffer[0], result)
+							.find("\r\n\r\n");
+				}
+				cRemaining -= result;
+			} while (cRemaining > 0);
+		}
+		double const elapsed{std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - timeBegin)
+													 .count()},
+			cpu{static_cast<double>(std::clock() - clockBegin) /
+				CLOCKS_PER_SEC};
+
+		std::cout << target << ": "
+							<< static_cast<std::size_t>(
+									 C_DOWNLOADS * FILE_SIZE / elapsed /
+									 (1_zu << 20))
+							<< " MB/s, " << cpu / C_DOWNLOADS
+							<< " CPU s/download." << std::endl;
+	}
+
+	std::filesystem::remove(FILE_PATH);
+	return 0;
+}
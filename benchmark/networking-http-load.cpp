@@ -0,0 +1,387 @@
+// Loopback HTTP load generator over Http::Client, against
+// canned scenarios served in-process. Reports requests per
+// second and latency quantiles for each scenario.
+//
+// Also reports how often Worker buffers were reused from
+// the BufferPool of the server.
+//
+// Scenarios:
+// hello: GET of a short body.
+// cached: GET of a short body, from a ResponseCache.
+// frozen: GET of a short body, from a FrozenResponse.
+// large: GET of a 1MB body.
+// stream: GET of a 1MB body, produced in 16KB parts and
+// 	sent chunked.
+// upload: chunked POST of a 64KB body, which the server
+// 	drains.
+//
+// Closed-loop by default: each connection sends the next
+// request as soon as one completes. With a rate, open-loop
+// instead: requests are sent on a fixed schedule, and
+// latency is measured from when each was due, so that a
+// stalled server is not hidden by the generator waiting on
+// it (coordinated omission).
+//
+// Options:
+// --scenario: hello, cached, frozen, large, stream,
+// 	upload, or all (default).
+// --connections: concurrent connections (default 8).
+// --pipeline: requests in flight per connection (default
+// 	1).
+// --keep-alive: 0 to connect anew after each --pipeline
+// 	requests (default 1).
+// --rate: requests per second across all connections, for
+// 	open-loop; 0 (default) for closed-loop.
+// --duration: seconds per scenario (default 2).
+// --reactors: event loops for the server; 0 (default) for
+// 	thread mode.
+//
+// Run all benchmarks with `make benchmarks BUILD=1`, or
+// just this one with `make run PROJ=benchmark
+// BIN=networking-http-load SRC=networking-http-load.cpp
+// BUILD=1 ARGS="--connections 64"`.
+#include <rain.hpp>
+
+using namespace Rain::Literal;
+using namespace Rain::Networking;
+
+std::string const LARGE_BODY(1_zu << 20, 'a');
+
+class LoadWorker : public Http::Worker<> {
+	using Worker::Worker;
+
+	ResponseAction reqHello(Request &, std::smatch const &) {
+		return {{StatusCode::OK, {}, "Hello world!"}};
+	}
+	ResponseAction reqCached(Request &, std::smatch const &) {
+		return {
+			{StatusCode::OK,
+				{{{"Cache-Control", "max-age=60"}}},
+				"Hello world!"}};
+	}
+	ResponseAction reqFrozen(Request &, std::smatch const &) {
+		static Http::FrozenResponse const frozen{
+			Response{StatusCode::OK, {}, "Hello world!"}};
+		return {frozen};
+	}
+	ResponseAction reqLarge(Request &, std::smatch const &) {
+		return {{StatusCode::OK, {}, LARGE_BODY}};
+	}
+	ResponseAction reqStream(Request &, std::smatch const &) {
+		return {
+			{StatusCode::OK,
+				{},
+				Http::ProducerStreamBuf(
+					[idx = 0_zu](std::ostream &stream) mutable {
+						stream << std::string_view(LARGE_BODY).substr(
+							idx, 1_zu << 14);
+						idx += 1_zu << 14;
+						return idx < LARGE_BODY.length();
+					})}};
+	}
+	ResponseAction reqUpload(
+		Request &req,
+		std::smatch const &) {
+		req.body.ignore(
+			std::numeric_limits<std::streamsize>::max());
+		return {
+			{StatusCode::OK,
+				{},
+				std::to_string(req.body.gcount())}};
+	}
+
+	virtual Filters const &filters() override {
+		static Filters const filters{
+			{".*", "/hello", {Method::GET}, &LoadWorker::reqHello},
+			{".*",
+				"/cached",
+				{Method::GET},
+				&LoadWorker::reqCached},
+			{".*",
+				"/frozen",
+				{Method::GET},
+				&LoadWorker::reqFrozen},
+			{".*", "/large", {Method::GET}, &LoadWorker::reqLarge},
+			{".*",
+				"/stream",
+				{Method::GET},
+				&LoadWorker::reqStream},
+			{".*",
+				"/upload",
+				{Method::POST},
+				&LoadWorker::reqUpload}};
+		return filters;
+	}
+
+	virtual Http::ResponseCache *responseCache() override {
+		static Http::ResponseCache cache;
+		return &cache;
+	}
+};
+
+class LoadServer : public Http::Server<LoadWorker> {
+	using Server::Server;
+
+	virtual LoadWorker makeWorker(
+		NativeSocket nativeSocket,
+		SocketInterface *interrupter) override {
+		return {nativeSocket, interrupter};
+	}
+
+	// Every connection comes from loopback, and would
+	// otherwise be rate limited.
+	virtual bool shouldRejectPeer(
+		AddressInfo const &) override {
+		return false;
+	}
+
+	public:
+	~LoadServer() { this->destruct(); }
+};
+
+using LoadClient = Http::Client<>;
+
+struct Options {
+	std::size_t connections{8}, pipeline{1};
+	bool keepAlive{true};
+	double rate{0}, duration{2};
+};
+
+// Request of a scenario, and the body length expected in
+// its response.
+struct Scenario {
+	std::string name;
+	std::function<Http::Request()> makeRequest;
+	std::size_t bodyLen;
+};
+
+// Results across all connections of a run.
+struct Results {
+	Rain::Metrics::Registry registry;
+	Rain::Metrics::Histogram latency{
+		"rain_benchmark_latency_seconds",
+		"Latency of requests, from when they were due.",
+		registry};
+	std::atomic_size_t cResponses{0}, cErrors{0};
+};
+
+// Runs one connection until timeEnd. Requests are due
+// immediately (closed-loop) or on a schedule (open-loop),
+// and at most options.pipeline are in flight at once.
+void runConnection(
+	Host const &host,
+	Scenario const &scenario,
+	Options const &options,
+	std::chrono::steady_clock::time_point timeBegin,
+	std::chrono::steady_clock::time_point timeEnd,
+	Results &results) {
+	std::chrono::steady_clock::duration const interval{
+		options.rate == 0
+			? std::chrono::steady_clock::duration::zero()
+			: std::chrono::duration_cast<
+					std::chrono::steady_clock::duration>(
+					std::chrono::duration<double>(
+						static_cast<double>(options.connections) /
+						options.rate))};
+	auto timeDue{timeBegin};
+	std::unique_ptr<LoadClient> client;
+	std::queue<std::chrono::steady_clock::time_point> inFlight;
+
+	// Requests sent on the current connection.
+	std::size_t cSent{0};
+	while (std::chrono::steady_clock::now() < timeEnd) {
+		try {
+			if (client == nullptr) {
+				client.reset(new LoadClient(host));
+				cSent = 0;
+			}
+
+			auto timeNow{std::chrono::steady_clock::now()};
+			if (interval == interval.zero()) {
+				timeDue = timeNow;
+			}
+			// Requests due together are sent together.
+			client->cork();
+			while (
+				inFlight.size() < options.pipeline &&
+				(options.keepAlive || cSent < options.pipeline) &&
+				timeDue <= timeNow) {
+				client->send(scenario.makeRequest());
+				cSent++;
+				inFlight.push(timeDue);
+				timeDue += interval;
+			}
+			client->cork(false);
+			client->flush();
+			if (inFlight.empty()) {
+				std::this_thread::sleep_until(timeDue);
+				continue;
+			}
+
+			Http::Response res{client->recv()};
+			res.body.ignore(
+				std::numeric_limits<std::streamsize>::max());
+			if (
+				res.statusCode != Http::StatusCode::OK ||
+				static_cast<std::size_t>(res.body.gcount()) !=
+					scenario.bodyLen) {
+				throw std::runtime_error("Unexpected response.");
+			}
+			results.latency.record(
+				std::chrono::steady_clock::now() - inFlight.front());
+			results.cResponses++;
+			inFlight.pop();
+			if (!options.keepAlive && inFlight.empty()) {
+				client.reset();
+			}
+		} catch (...) {
+			results.cErrors++;
+			client.reset();
+			inFlight = {};
+		}
+	}
+}
+
+// Runs a scenario against server, and prints its results.
+void runScenario(
+	LoadServer &server,
+	Scenario const &scenario,
+	Options const &options) {
+	Host const host{"localhost", server.host().service};
+	Results results;
+	auto const cHits{server.bufferPool().hits()},
+		cMisses{server.bufferPool().misses()};
+	auto const timeBegin{std::chrono::steady_clock::now()},
+		timeEnd{
+			timeBegin +
+			std::chrono::duration_cast<
+				std::chrono::steady_clock::duration>(
+				std::chrono::duration<double>(options.duration))};
+	std::vector<std::thread> connections;
+	for (std::size_t idx{0}; idx < options.connections;
+			 idx++) {
+		connections.emplace_back([&, idx]() {
+			// Open-loop schedules are staggered across
+			// connections.
+			auto const timeOffset{
+				options.rate == 0
+					? std::chrono::steady_clock::duration::zero()
+					: std::chrono::duration_cast<
+							std::chrono::steady_clock::duration>(
+							std::chrono::duration<double>(
+								static_cast<double>(idx) / options.rate))};
+			runConnection(
+				host,
+				scenario,
+				options,
+				timeBegin + timeOffset,
+				timeEnd,
+				results);
+		});
+	}
+	for (auto &connection : connections) {
+		connection.join();
+	}
+	double const elapsed{std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - timeBegin)
+												 .count()};
+
+	auto const latency{results.latency.snapshot()};
+	std::cout << scenario.name << ": "
+						<< static_cast<std::size_t>(
+								 results.cResponses / elapsed)
+						<< " requests/s, latency p50: "
+						<< latency.quantile(0.5) / 1000
+						<< "us, p99: " << latency.quantile(0.99) / 1000
+						<< "us, p999: "
+						<< latency.quantile(0.999) / 1000 << "us, "
+						<< results.cErrors << " errors, "
+						<< server.bufferPool().hits() - cHits
+						<< " buffer pool hits, "
+						<< server.bufferPool().misses() - cMisses
+						<< " misses." << std::endl;
+}
+
+int main(int argc, char const *argv[]) {
+	Options options;
+	std::string scenarioName{"all"};
+	std::size_t reactors{0};
+	Rain::String::CommandLineParser parser;
+	parser.addParser("scenario", scenarioName);
+	parser.addParser("connections", options.connections);
+	parser.addParser("pipeline", options.pipeline);
+	parser.addParser("keep-alive", options.keepAlive);
+	parser.addParser("rate", options.rate);
+	parser.addParser("duration", options.duration);
+	parser.addParser("reactors", reactors);
+	if (parser.parse(argc - 1, argv + 1)) {
+		std::cout << "Failed to parse options." << std::endl;
+		return 1;
+	}
+	options.pipeline = std::max(1_zu, options.pipeline);
+
+	// The upload body is sent pre-encoded in 16KB chunks.
+	std::string uploadBody;
+	for (std::size_t idx{0}; idx < 4; idx++) {
+		uploadBody += "4000\r\n" + std::string(1_zu << 14, 'a') +
+			"\r\n";
+	}
+	uploadBody += "0\r\n\r\n";
+	std::vector<Scenario> const scenarios{
+		{"hello",
+			[]() {
+				return Http::Request{Http::Method::GET, "/hello"};
+			},
+			12},
+		{"cached",
+			[]() {
+				return Http::Request{Http::Method::GET, "/cached"};
+			},
+			12},
+		{"frozen",
+			[]() {
+				return Http::Request{Http::Method::GET, "/frozen"};
+			},
+			12},
+		{"large",
+			[]() {
+				return Http::Request{Http::Method::GET, "/large"};
+			},
+			LARGE_BODY.length()},
+		{"stream",
+			[]() {
+				return Http::Request{Http::Method::GET, "/stream"};
+			},
+			LARGE_BODY.length()},
+		{"upload",
+			[&uploadBody]() {
+				return Http::Request{
+					Http::Method::POST,
+					"/upload",
+					{{{"Transfer-Encoding", "chunked"}}},
+					uploadBody};
+			},
+			std::to_string(1_zu << 16).length()}};
+
+	LoadServer server(
+		ServeOptions{.reactors = reactors}, ":0");
+	std::cout << "Serving on " << server.host() << " with "
+						<< options.connections << " connections, "
+						<< options.pipeline << " in flight each, "
+						<< (options.keepAlive ? "with" : "without")
+						<< " keep-alive, ";
+	if (options.rate == 0) {
+		std::cout << "closed-loop." << std::endl;
+	} else {
+		std::cout << "open-loop at " << options.rate << "/s."
+							<< std::endl;
+	}
+	for (Scenario const &scenario : scenarios) {
+		if (
+			scenarioName == "all" ||
+			scenarioName == scenario.name) {
+			runScenario(server, scenario, options);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,203 @@
+// Benchmark of HTTP request head parsing: the previous
+// std::istream path, Request::recvWith over an in-memory
+// receive buffer, and RequestParser alone. Reports requests
+// per second and heap allocations per request.
+#include <rain.hpp>
+
+// Counts heap allocations.
+std::atomic_size_t cAllocations{0};
+void *operator new(std::size_t size) {
+	cAllocations++;
+	void *result{std::malloc(size == 0 ? 1 : size)};
+	if (result == nullptr) {
+		throw std::bad_alloc();
+	}
+	return result;
+}
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+namespace Baseline {
+	using namespace Rain::Literal;
+	using namespace Rain::Networking::Http;
+
+	// Headers::operator>> before RequestParser.
+	void recvHeaders(std::istream &stream, Headers &headers) {
+		std::size_t totalHeadersBytes{0};
+		std::string line(1_zu << 12, '\0');
+		while (stream.getline(&line[0], line.length())) {
+			line.resize(
+				static_cast<std::size_t>(std::max(
+					std::streamsize(0), stream.gcount() - 1)));
+			if (line == "\r") {
+				break;
+			}
+			std::size_t colonPos{line.find(':')};
+			if (colonPos == std::string::npos) {
+				throw Headers::Exception(
+					Headers::Error::NO_COLON_DELIMITER);
+			}
+			std::string value(line.substr(colonPos + 1));
+			line.resize(colonPos);
+			std::string &name = line;
+			Rain::String::trimWhitespace(name);
+			Rain::String::trimWhitespace(value);
+			headers.insert({name, value});
+			totalHeadersBytes += name.length() + value.length();
+			if (totalHeadersBytes > (1_zu << 16)) {
+				throw Headers::Exception(
+					Headers::Error::HEADERS_BLOCK_OVERFLOW);
+			}
+			line.resize(1_zu << 12);
+		}
+	}
+
+	// Exposes body parsing, which is unchanged.
+	class Request : public Rain::Networking::Http::Request {
+		public:
+		using Rain::Networking::Http::Request::recvBody;
+	};
+
+	// RequestMessageSpec::recvWith before RequestParser.
+	void recvWith(std::istream &stream, Request &req) {
+		stream >> req.method;
+		req.target.resize(1_zu << 12);
+		stream.getline(&req.target[0], req.target.size(), '\n');
+		req.target.resize(
+			static_cast<std::size_t>(std::max(
+				std::streamsize(0), stream.gcount() - 2)));
+		try {
+			req.version =
+				Version(req.target.substr(req.target.length() - 3));
+			req.target.resize(std::min(
+				req.target.length(), req.target.length() - 9));
+		} catch (...) {
+			req.version = Version::_0_9;
+		}
+		recvHeaders(stream, req.headers);
+		req.recvBody(stream);
+	}
+}
+
+// Presents an in-memory string as the receive buffer of a
+// Tcp Socket.
+class MemoryStreamBuf :
+	public Rain::Networking::Tcp::PeekableStreamBuf {
+	public:
+	MemoryStreamBuf(std::string &source) {
+		this->setg(
+			&source[0], &source[0], &source[0] + source.size());
+	}
+
+	virtual bool isFull() const noexcept override {
+		return false;
+	}
+	virtual bool recvMore() override { return false; }
+
+	protected:
+	virtual int_type underflow() override {
+		return this->gptr() == this->egptr()
+			? traits_type::eof()
+			: traits_type::to_int_type(*this->gptr());
+	}
+};
+
+// Runs parse cRequests times, returning requests per second
+// and allocations per request.
+template<typename Parse>
+std::pair<double, double> benchmark(
+	std::size_t cRequests,
+	Parse &&parse) {
+	std::size_t allocationsBegin{cAllocations};
+	auto timeBegin{std::chrono::steady_clock::now()};
+	for (std::size_t i{0}; i < cRequests; i++) {
+		parse();
+	}
+	std::chrono::duration<double> elapsed{
+		std::chrono::steady_clock::now() - timeBegin};
+	return {
+		cRequests / elapsed.count(),
+		static_cast<double>(cAllocations - allocationsBegin) /
+			cRequests};
+}
+
+int main() {
+	using namespace Rain::Literal;
+	using namespace Rain::Networking::Http;
+
+	std::string const requestStr{
+		"GET /static/scripts/main.js?version=7.6.4 HTTP/1.1\r\n"
+		"Host: www.example.com\r\n"
+		"User-Agent: Mozilla/5.0 (X11; Linux x86_64) "
+		"AppleWebKit/537.36 (KHTML, like Gecko)\r\n"
+		"Accept: "
+		"text/html,application/xhtml+xml,application/"
+		"xml;q=0.9,*/*;q=0.8\r\n"
+		"Accept-Language: en-US,en;q=0.5\r\n"
+		"Accept-Encoding: gzip, deflate, br\r\n"
+		"Referer: https://www.example.com/index.html\r\n"
+		"Cookie: session=0123456789abcdef; theme=dark\r\n"
+		"Connection: keep-alive\r\n"
+		"Cache-Control: max-age=0\r\n\r\n"};
+	std::size_t const C_REQUESTS{1_zu << 18};
+	std::string requestsStr;
+	for (std::size_t i{0}; i < C_REQUESTS; i++) {
+		requestsStr += requestStr;
+	}
+	std::cout << "Requests: " << C_REQUESTS << ", "
+						<< requestStr.size() << " bytes each."
+						<< std::endl;
+
+	auto const report = [](
+												char const *name,
+												std::pair<double, double> result) {
+		std::cout << name << ": "
+							<< static_cast<std::size_t>(result.first)
+							<< " requests/s, " << result.second
+							<< " allocations/request." << std::endl;
+	};
+
+	{
+		std::stringstream stream(requestsStr);
+		report(
+			"std::istream (previous)",
+			benchmark(C_REQUESTS, [&stream]() {
+				Baseline::Request req;
+				Baseline::recvWith(stream, req);
+			}));
+	}
+	{
+		std::stringstream stream(requestsStr);
+		report(
+			"Request::recvWith (std::istream copy)",
+			benchmark(C_REQUESTS, [&stream]() {
+				Request req;
+				stream >> req;
+			}));
+	}
+	{
+		MemoryStreamBuf streamBuf(requestsStr);
+		std::istream stream(&streamBuf);
+		report(
+			"Request::recvWith (in place)",
+			benchmark(C_REQUESTS, [&stream]() {
+				Request req;
+				stream >> req;
+			}));
+	}
+	{
+		RequestParser parser;
+		std::string_view remaining{requestsStr};
+		report(
+			"RequestParser",
+			benchmark(C_REQUESTS, [&parser, &remaining]() {
+				parser.reset();
+				parser.parse(remaining);
+				remaining.remove_prefix(parser.size());
+			}));
+	}
+
+	return 0;
+}
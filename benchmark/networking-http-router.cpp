@@ -0,0 +1,79 @@
+// Benchmark of routing request targets among 200 routes:
+// a linear scan of std::regex filters, as in
+// Http::Worker before Router, against Router. Reports
+// lookups per second.
+#include <rain.hpp>
+
+int main() {
+	using namespace Rain::Literal;
+	using Rain::Networking::Http::Router;
+
+	std::size_t const C_ROUTES{200}, C_LOOKUPS{1_zu << 16};
+
+	std::vector<std::regex> regexes;
+	Router router;
+	for (std::size_t i{0}; i < C_ROUTES; i++) {
+		std::string resource{
+			"/api/v1/resource" + std::to_string(i)};
+		regexes.emplace_back(resource + "/([^/]+)");
+		router.insert(resource + "/:id", i);
+	}
+
+	std::vector<std::string> targets;
+	std::mt19937_64 generator(0);
+	for (std::size_t i{0}; i < C_LOOKUPS; i++) {
+		targets.push_back(
+			"/api/v1/resource" +
+			std::to_string(generator() % C_ROUTES) + "/" +
+			std::to_string(generator() % 1000));
+	}
+
+	auto const report = [](
+												char const *name,
+												std::size_t checksum,
+												auto duration) {
+		std::cout << name << ": "
+							<< static_cast<std::size_t>(
+									 C_LOOKUPS /
+									 std::chrono::duration<double>(duration)
+										 .count())
+							<< " lookups/s (checksum " << checksum << ")."
+							<< std::endl;
+	};
+
+	{
+		std::size_t checksum{0};
+		auto timeBegin{std::chrono::steady_clock::now()};
+		for (std::string const &target : targets) {
+			std::smatch match;
+			for (std::size_t i{0}; i < C_ROUTES; i++) {
+				if (std::regex_match(target, match, regexes[i])) {
+					checksum += i + match[1].length();
+					break;
+				}
+			}
+		}
+		report(
+			"std::regex (linear)",
+			checksum,
+			std::chrono::steady_clock::now() - timeBegin);
+	}
+	{
+		std::size_t checksum{0};
+		auto timeBegin{std::chrono::steady_clock::now()};
+		for (std::string const &target : targets) {
+			router.match(
+				target,
+				[&checksum](
+					std::size_t value, Router::Match const &match) {
+					checksum += value + match["id"].length();
+				});
+		}
+		report(
+			"Router",
+			checksum,
+			std::chrono::steady_clock::now() - timeBegin);
+	}
+
+	return 0;
+}
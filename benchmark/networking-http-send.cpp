@@ -0,0 +1,237 @@
+// Loopback benchmark of sending responses: streamed
+// through the 1KB send buffer, as before vectored sends,
+// against the head and body gathered into one vectored
+// send, and then with OptimisticSocketOption. Reports
+// responses per second and, on Linux, the send/recv/poll
+// system calls made by the server per response, as well as
+// request latency quantiles.
+#include <rain.hpp>
+
+#ifdef RAIN_PLATFORM_LINUX
+	#include <dlfcn.h>
+	#include <poll.h>
+	#include <sys/socket.h>
+
+// Counts system calls made outside of the client thread, by
+// interposing the libc wrappers.
+std::atomic_size_t cSyscalls{0};
+thread_local bool isClient{false};
+
+template<typename Function>
+Function *nextSymbol(char const *name) {
+	static void *symbol{dlsym(RTLD_NEXT, name)};
+	return reinterpret_cast<Function *>(symbol);
+}
+
+extern "C" {
+ssize_t send(
+	int fd,
+	void const *buf,
+	size_t len,
+	int flags) {
+	cSyscalls += !isClient;
+	return nextSymbol<decltype(send)>("send")(
+		fd, buf, len, flags);
+}
+ssize_t sendmsg(int fd, msghdr const *msg, int flags) {
+	cSyscalls += !isClient;
+	return nextSymbol<decltype(sendmsg)>("sendmsg")(
+		fd, msg, flags);
+}
+ssize_t recv(int fd, void *buf, size_t len, int flags) {
+	cSyscalls += !isClient;
+	return nextSymbol<decltype(recv)>("recv")(
+		fd, buf, len, flags);
+}
+int poll(pollfd *fds, nfds_t nfds, int timeout) {
+	cSyscalls += !isClient;
+	return nextSymbol<decltype(poll)>("poll")(
+		fds, nfds, timeout);
+}
+}
+#endif
+
+using namespace Rain::Literal;
+using namespace Rain::Networking;
+
+// Streambuf over a string which is not a std::stringbuf, so
+// that the Body is streamed.
+class StreamedBuf : public std::streambuf {
+	public:
+	StreamedBuf(std::string &str) {
+		this->setg(&str[0], &str[0], &str[0] + str.size());
+	}
+};
+
+std::string body;
+
+template<template<typename> class... SocketOptions>
+class SendWorker :
+	public Http::Worker<
+		Http::Request,
+		Http::Response,
+		Ipv4FamilyInterface,
+		SocketOptions...> {
+	using Worker = Http::Worker<
+		Http::Request,
+		Http::Response,
+		Ipv4FamilyInterface,
+		SocketOptions...>;
+	using Worker::Worker;
+	using typename Worker::Request;
+	using typename Worker::Filters;
+	using typename Worker::Response;
+	using typename Worker::ResponseAction;
+
+	ResponseAction reqStreamed(
+		Request &,
+		std::smatch const &) {
+		StreamedBuf *streamedBuf{new StreamedBuf(body)};
+		Response res{Http::StatusCode::OK, {}, streamedBuf};
+		this->streamedBuf.reset(streamedBuf);
+		return {std::move(res)};
+	}
+	ResponseAction reqVectored(
+		Request &,
+		std::smatch const &) {
+		return {{Http::StatusCode::OK, {}, body}};
+	}
+
+	virtual Filters const &filters() override {
+		static Filters const filters{
+			{".*",
+				"/streamed",
+				{Http::Method::GET},
+				&SendWorker::reqStreamed},
+			{".*",
+				"/vectored",
+				{Http::Method::GET},
+				&SendWorker::reqVectored}};
+		return filters;
+	}
+
+	// Record the request latency reported below.
+	virtual bool onWorkMetrics() override { return true; }
+
+	// Outlives the Response which streams it.
+	std::unique_ptr<StreamedBuf> streamedBuf;
+};
+
+template<typename SendWorker>
+class SendServer : public Http::Server<SendWorker> {
+	using Http::Server<SendWorker>::Server;
+
+	virtual SendWorker makeWorker(
+		NativeSocket nativeSocket,
+		SocketInterface *interrupter) override {
+		return {nativeSocket, interrupter};
+	}
+
+	public:
+	~SendServer() { this->destruct(); }
+};
+
+// Runs each target against server, for each body length.
+template<typename Server>
+int benchmark(
+	Server &server,
+	std::vector<std::string> const &targets) {
+	for (std::size_t bodyLen : {64_zu, 1_zu << 12}) {
+		body.assign(bodyLen, 'a');
+		for (std::string const &target : targets) {
+			Client<
+				Ipv4FamilyInterface,
+				StreamTypeInterface,
+				TcpProtocolInterface>
+				client(Host{"localhost", server.host().service});
+			std::string const request{
+				"GET " + target + " HTTP/1.1\r\n\r\n"};
+			std::vector<char> buffer(1_zu << 16);
+
+			// Let the server settle before counting.
+			std::this_thread::sleep_for(100ms);
+#ifdef RAIN_PLATFORM_LINUX
+			cSyscalls = 0;
+#endif
+			// Streamed multi-send responses may stall on delayed
+			// ACKs, so each run is timed rather than counted.
+			std::size_t cResponses{0};
+			auto const timeBegin{std::chrono::steady_clock::now()};
+			while (
+				std::chrono::steady_clock::now() - timeBegin < 1s) {
+				cResponses++;
+				client.send(request);
+
+				// The head arrives in the first recv.
+				std::size_t cRemaining{0};
+				do {
+					std::size_t result{
+						client.recv(&buffer[0], buffer.size())};
+					if (result == 0) {
+						std::cout << "Response failed." << std::endl;
+						return 1;
+					}
+					if (cRemaining == 0) {
+						cRemaining = bodyLen + 4 +
+							std::string_view(&buffer[0], result)
+								.find("\r\n\r\n");
+					}
+					cRemaining -= result;
+				} while (cRemaining > 0);
+			}
+			double const elapsed{std::chrono::duration<double>(
+				std::chrono::steady_clock::now() - timeBegin)
+														 .count()};
+
+			std::cout << target << " (" << bodyLen
+								<< "B body): "
+								<< static_cast<std::size_t>(
+										 cResponses / elapsed)
+								<< " responses/s";
+#ifdef RAIN_PLATFORM_LINUX
+			std::cout << ", "
+								<< static_cast<double>(cSyscalls) /
+						 cResponses
+								<< " system calls/response";
+#endif
+			std::cout << "." << std::endl;
+		}
+	}
+
+	return 0;
+}
+
+int main() {
+#ifdef RAIN_PLATFORM_LINUX
+	isClient = true;
+#endif
+	{
+		SendServer<SendWorker<>> server(":0");
+		if (benchmark(server, {"/streamed", "/vectored"}) != 0) {
+			return 1;
+		}
+	}
+
+	// Optimistic Workers also skip the poll before each recv.
+	SendServer<SendWorker<OptimisticSocketOption>> server(
+		":0");
+	std::cout << "OptimisticSocketOption:" << std::endl;
+	if (benchmark(server, {"/vectored"}) != 0) {
+		return 1;
+	}
+	auto &counters{
+		ConnectedSocketSpecInterface::optimisticCounters};
+	std::cout << "recv hits: " << counters.recvHits
+						<< ", misses: " << counters.recvMisses
+						<< "." << std::endl;
+
+	// Server-side latency over all runs, from Rain::Metrics.
+	auto const latency{
+		ReqRes::WorkerSocketSpecInterfaceInterface::requestMetric
+			.snapshot()};
+	std::cout << "Request latency p50: "
+						<< latency.quantile(0.5) << "ns, p99: "
+						<< latency.quantile(0.99) << "ns, over "
+						<< latency.count << " requests." << std::endl;
+	return 0;
+}
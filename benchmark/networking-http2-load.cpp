@@ -0,0 +1,156 @@
+// Loopback HTTP/2 load over Http2::Client, against an
+// Http2::Worker served in-process. Reports requests per
+// second and latency quantiles.
+//
+// Each connection keeps many requests in flight on
+// concurrent streams, sending the next as soon as the
+// earliest is answered.
+//
+// Options:
+// --connections: concurrent connections (default 1).
+// --streams: requests in flight per connection (default
+// 	256).
+// --size: bytes per response body (default 64).
+// --duration: seconds (default 2).
+//
+// Run all benchmarks with `make benchmarks BUILD=1`, or
+// just this one with `make run PROJ=benchmark
+// BIN=networking-http2-load SRC=networking-http2-load.cpp
+// BUILD=1 ARGS="--streams 512"`.
+#include <rain.hpp>
+
+using namespace Rain::Literal;
+using namespace Rain::Networking;
+
+class LoadWorker : public Http2::Worker<> {
+	using Worker::Worker;
+
+	ResponseAction reqBody(Request &, std::smatch const &) {
+		return {Response{Http::StatusCode::OK, {}, body()}};
+	}
+
+	virtual Filters const &filters() override {
+		static Filters const filters{
+			{".*",
+				"/body",
+				{Http::Method::GET},
+				&LoadWorker::reqBody}};
+		return filters;
+	}
+
+	public:
+	static std::string &body() {
+		static std::string body;
+		return body;
+	}
+};
+
+class LoadServer : public Http::Server<LoadWorker> {
+	using Server::Server;
+
+	virtual LoadWorker makeWorker(
+		NativeSocket nativeSocket,
+		SocketInterface *interrupter) override {
+		return {nativeSocket, interrupter};
+	}
+
+	// Every connection comes from loopback, and would
+	// otherwise be rate limited.
+	virtual bool shouldRejectPeer(
+		AddressInfo const &) override {
+		return false;
+	}
+
+	public:
+	~LoadServer() { this->destruct(); }
+};
+
+int main(int argc, char const *argv[]) {
+	std::size_t connections{1}, streams{256}, size{64};
+	double duration{2};
+	Rain::String::CommandLineParser parser;
+	parser.addParser("connections", connections);
+	parser.addParser("streams", streams);
+	parser.addParser("size", size);
+	parser.addParser("duration", duration);
+	if (parser.parse(argc - 1, argv + 1)) {
+		std::cout << "Failed to parse options." << std::endl;
+		return 1;
+	}
+	LoadWorker::body().assign(size, 'x');
+
+	LoadServer server(":0");
+	Host const host{"localhost", server.host().service};
+	std::cout << "Serving on " << server.host() << " with "
+						<< connections << " connections of " << streams
+						<< " streams, " << size << "-byte responses."
+						<< std::endl;
+
+	Rain::Metrics::Registry registry;
+	Rain::Metrics::Histogram latency{
+		"rain_benchmark_latency_seconds",
+		"Latency of requests.",
+		registry};
+	std::atomic_size_t cRequests{0}, cErrors{0};
+	auto const timeBegin{std::chrono::steady_clock::now()},
+		timeEnd{
+			timeBegin +
+			std::chrono::duration_cast<
+				std::chrono::steady_clock::duration>(
+				std::chrono::duration<double>(duration))};
+	std::vector<std::thread> threads;
+	for (std::size_t idx{0}; idx < connections; idx++) {
+		threads.emplace_back([&]() {
+			try {
+				Http2::Client<> client(host);
+				std::deque<std::chrono::steady_clock::time_point>
+					timesSent;
+				auto const sendNext{[&]() {
+					timesSent.push_back(
+						std::chrono::steady_clock::now());
+					client.send(
+						{Http::Method::GET,
+							"/body",
+							{{{"Host", "localhost"}}}});
+				}};
+				for (std::size_t jdx{0}; jdx < streams; jdx++) {
+					sendNext();
+				}
+				while (!timesSent.empty()) {
+					Http::Response res{client.recv()};
+					if (
+						res.statusCode != Http::StatusCode::OK ||
+						res.body.inAvail() !=
+							static_cast<std::streamsize>(size)) {
+						throw std::runtime_error("Unexpected response.");
+					}
+					latency.record(
+						std::chrono::steady_clock::now() -
+						timesSent.front());
+					timesSent.pop_front();
+					cRequests++;
+					if (std::chrono::steady_clock::now() < timeEnd) {
+						sendNext();
+					}
+				}
+			} catch (...) {
+				cErrors++;
+			}
+		});
+	}
+	for (auto &thread : threads) {
+		thread.join();
+	}
+	double const elapsed{std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - timeBegin)
+												 .count()};
+
+	auto const snapshot{latency.snapshot()};
+	std::cout << static_cast<std::size_t>(cRequests / elapsed)
+						<< " requests/s, latency p50: "
+						<< snapshot.quantile(0.5) / 1000
+						<< "us, p99: " << snapshot.quantile(0.99) / 1000
+						<< "us, " << cErrors << " errors."
+						<< std::endl;
+	return 0;
+}
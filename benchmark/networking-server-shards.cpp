@@ -0,0 +1,112 @@
+// Loopback benchmark of Server accept rate as the number of
+// SO_REUSEPORT shards grows, up to the number of cores.
+//
+// SO_REUSEPORT is unavailable on Windows.
+#include <rain.hpp>
+
+int main() {
+#ifndef RAIN_PLATFORM_WINDOWS
+	using namespace Rain::Literal;
+	using namespace Rain::Networking;
+
+	// Workers close without linger as soon as they are
+	// accepted, so that neither side accumulates TIME_WAIT.
+	class NullWorker :
+		public Worker<
+			Ipv4FamilyInterface,
+			StreamTypeInterface,
+			TcpProtocolInterface,
+			NoLingerSocketOption> {
+		using Worker::Worker;
+
+		virtual void onWork() override {}
+	};
+
+	class NullServer :
+		public Server<
+			NullWorker,
+			Ipv4FamilyInterface,
+			StreamTypeInterface,
+			TcpProtocolInterface,
+			ReusePortSocketOption> {
+		using Server::Server;
+
+		virtual NullWorker makeWorker(
+			NativeSocket nativeSocket,
+			SocketInterface *interrupter) override {
+			return {nativeSocket, interrupter};
+		}
+
+		// Every connection comes from loopback, and would
+		// otherwise be rate limited.
+		virtual bool shouldRejectPeer(
+			AddressInfo const &) override {
+			return false;
+		}
+
+		public:
+		~NullServer() { this->destruct(); }
+	};
+
+	using NullClient = Client<
+		Ipv4FamilyInterface,
+		StreamTypeInterface,
+		TcpProtocolInterface,
+		NoLingerSocketOption>;
+
+	std::size_t const cCores{std::max(
+		1_zu,
+		static_cast<std::size_t>(
+			std::thread::hardware_concurrency()))},
+		cClients{2 * cCores};
+	auto const DURATION{1s};
+
+	std::cout << "Cores: " << cCores
+						<< ", clients: " << cClients
+						<< ", duration: " << DURATION << std::endl;
+	for (std::size_t shards{1};;
+			 shards = std::min(cCores, 2 * shards)) {
+		NullServer server(ServeOptions{.shards = shards}, ":0");
+		AddressInfo const addressInfo{getAddressInfos(
+			Host{"localhost", server.host().service},
+			Family::INET,
+			Type::STREAM,
+			Protocol::TCP)[0]};
+
+		std::atomic_size_t cConnections{0}, cFailures{0};
+		auto const timeBegin{std::chrono::steady_clock::now()};
+		{
+			std::vector<std::thread> clients;
+			for (std::size_t idx{0}; idx < cClients; idx++) {
+				clients.emplace_back([&]() {
+					while (
+						std::chrono::steady_clock::now() - timeBegin <
+						DURATION) {
+						try {
+							NullClient client(addressInfo, 1s);
+							cConnections++;
+						} catch (...) {
+							cFailures++;
+						}
+					}
+				});
+			}
+			for (auto &client : clients) {
+				client.join();
+			}
+		}
+		std::chrono::duration<double> const timeElapsed{
+			std::chrono::steady_clock::now() - timeBegin};
+
+		std::cout << "Shards: " << shards << ", accepts/s: "
+							<< static_cast<std::size_t>(
+									 cConnections / timeElapsed.count())
+							<< ", failures: " << cFailures << std::endl;
+		if (shards == cCores) {
+			break;
+		}
+	}
+#endif
+
+	return 0;
+}
@@ -0,0 +1,164 @@
+// Loopback WebSocket echo over WebSocket::Client, against
+// a WebSocket::Worker served in-process. Reports messages
+// per second and round-trip latency quantiles.
+//
+// Each connection sends the next message as soon as its
+// echo is received.
+//
+// Options:
+// --connections: concurrent connections (default 8).
+// --size: bytes per message (default 64).
+// --binary: 1 for binary messages of random bytes, 0 for
+// 	text messages (default 0).
+// --deflate: 1 to negotiate permessage-deflate (default
+// 	0).
+// --duration: seconds (default 2).
+//
+// Run all benchmarks with `make benchmarks BUILD=1`, or
+// just this one with `make run PROJ=benchmark
+// BIN=networking-websocket-echo
+// SRC=networking-websocket-echo.cpp BUILD=1 ARGS="--size
+// 65536 --deflate 1"`.
+#include <rain.hpp>
+
+using namespace Rain::Literal;
+using namespace Rain::Networking;
+
+class EchoWorker : public WebSocket::Worker<> {
+	using Worker::Worker;
+
+	ResponseAction reqEcho(Request &req, std::smatch const &) {
+		return this->upgrade(req, true);
+	}
+
+	virtual Filters const &filters() override {
+		static Filters const filters{
+			{".*",
+				"/echo",
+				{Http::Method::GET},
+				&EchoWorker::reqEcho}};
+		return filters;
+	}
+
+	virtual void onMessage(
+		WebSocket::Message &message) override {
+		this->send(message);
+	}
+};
+
+class EchoServer : public Http::Server<EchoWorker> {
+	using Server::Server;
+
+	virtual EchoWorker makeWorker(
+		NativeSocket nativeSocket,
+		SocketInterface *interrupter) override {
+		return {nativeSocket, interrupter};
+	}
+
+	// Every connection comes from loopback, and would
+	// otherwise be rate limited.
+	virtual bool shouldRejectPeer(
+		AddressInfo const &) override {
+		return false;
+	}
+
+	public:
+	~EchoServer() { this->destruct(); }
+};
+
+int main(int argc, char const *argv[]) {
+	std::size_t connections{8}, size{64};
+	bool isBinary{false}, toDeflate{false};
+	double duration{2};
+	Rain::String::CommandLineParser parser;
+	parser.addParser("connections", connections);
+	parser.addParser("size", size);
+	parser.addParser("binary", isBinary);
+	parser.addParser("deflate", toDeflate);
+	parser.addParser("duration", duration);
+	if (parser.parse(argc - 1, argv + 1)) {
+		std::cout << "Failed to parse options." << std::endl;
+		return 1;
+	}
+
+	// Text messages are repetitive, and compress well.
+	WebSocket::Message message;
+	if (isBinary) {
+		message.opcode = WebSocket::Opcode::BINARY;
+		std::mt19937_64 generator(0);
+		message.payload.resize(size);
+		for (char &byte : message.payload) {
+			byte = static_cast<char>(generator());
+		}
+	} else {
+		while (message.payload.size() < size) {
+			message.payload += "the rain in spain " +
+				std::to_string(message.payload.size()) + " ";
+		}
+		message.payload.resize(size);
+	}
+
+	EchoServer server(":0");
+	Host const host{"localhost", server.host().service};
+	std::cout << "Serving on " << server.host() << " with "
+						<< connections << " connections, " << size
+						<< "-byte " << (isBinary ? "binary" : "text")
+						<< " messages, "
+						<< (toDeflate ? "with" : "without")
+						<< " permessage-deflate." << std::endl;
+
+	Rain::Metrics::Registry registry;
+	Rain::Metrics::Histogram latency{
+		"rain_benchmark_latency_seconds",
+		"Round-trip latency of messages.",
+		registry};
+	std::atomic_size_t cMessages{0}, cErrors{0};
+	auto const timeBegin{std::chrono::steady_clock::now()},
+		timeEnd{
+			timeBegin +
+			std::chrono::duration_cast<
+				std::chrono::steady_clock::duration>(
+				std::chrono::duration<double>(duration))};
+	std::vector<std::thread> threads;
+	for (std::size_t idx{0}; idx < connections; idx++) {
+		threads.emplace_back([&]() {
+			try {
+				WebSocket::Client<> client(host);
+				client.upgrade("localhost", "/echo", toDeflate);
+				WebSocket::Message echo;
+				while (std::chrono::steady_clock::now() < timeEnd) {
+					auto const timeSent{
+						std::chrono::steady_clock::now()};
+					client.send(message);
+					if (
+						!client.recv(echo) ||
+						echo.payload.size() != message.payload.size()) {
+						throw std::runtime_error("Unexpected echo.");
+					}
+					latency.record(
+						std::chrono::steady_clock::now() - timeSent);
+					cMessages++;
+				}
+				client.close();
+				client.recv(echo);
+			} catch (...) {
+				cErrors++;
+			}
+		});
+	}
+	for (auto &thread : threads) {
+		thread.join();
+	}
+	double const elapsed{std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - timeBegin)
+												 .count()};
+
+	auto const snapshot{latency.snapshot()};
+	std::cout << static_cast<std::size_t>(cMessages / elapsed)
+						<< " messages/s, latency p50: "
+						<< snapshot.quantile(0.5) / 1000
+						<< "us, p99: " << snapshot.quantile(0.99) / 1000
+						<< "us, " << cErrors << " errors."
+						<< std::endl;
+	return 0;
+}
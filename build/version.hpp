@@ -1,6 +1,6 @@
 #pragma once
 
 #define RAIN_VERSION_MAJOR 7
-#define RAIN_VERSION_MINOR 5
-#define RAIN_VERSION_REVISION 7
+#define RAIN_VERSION_MINOR 6
+#define RAIN_VERSION_REVISION 24
 #define RAIN_VERSION_BUILD 9201
@@ -19,6 +19,7 @@
 #include "rain/functional.hpp"
 #include "rain/literal.hpp"
 #include "rain/math.hpp"
+#include "rain/metrics.hpp"
 #include "rain/multithreading.hpp"
 #include "rain/networking.hpp"
 #include "rain/platform.hpp"
@@ -136,5 +136,27 @@ namespace Rain::Algorithm {
 			mapIt->second = this->lruList.begin();
 			return {this->lruList.begin(), true};
 		}
+
+		// Removes the pair at a key, if it exists. Returns
+		// whether it existed.
+		bool erase(Key const &key) {
+			typename InternalHashMap::iterator const findIt{
+				this->hashMap.find(key)};
+			if (findIt == this->hashMap.end()) {
+				return false;
+			}
+			this->lruList.erase(findIt->second);
+			this->hashMap.erase(findIt);
+			return true;
+		}
+
+		// Removes the least-recently-used pair, and returns its
+		// value. The cache must not be empty.
+		Value evict() {
+			Value value{std::move(this->lruList.back().second)};
+			this->hashMap.erase(this->lruList.back().first);
+			this->lruList.pop_back();
+			return value;
+		}
 	};
 }
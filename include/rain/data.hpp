@@ -1,5 +1,7 @@
 // Includes all /data headers.
 #pragma once
 
+#include "data/deflate.hpp"
 #include "data/huffman.hpp"
 #include "data/serializer.hpp"
+#include "data/sha_1.hpp"
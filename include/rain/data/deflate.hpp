@@ -0,0 +1,620 @@
+// Raw DEFLATE (RFC 1951) compression and decompression.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Rain::Data::Deflate {
+	// Base lengths and extra bits of length symbols 257 to
+	// 285, and base distances and extra bits of distance
+	// symbols 0 to 29.
+	inline constexpr std::uint16_t LENGTH_BASES[]{3, 4, 5, 6,
+		7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51,
+		59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+	inline constexpr std::uint8_t LENGTH_EXTRAS[]{0, 0, 0, 0,
+		0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4,
+		4, 5, 5, 5, 5, 0};
+	inline constexpr std::uint16_t DISTANCE_BASES[]{1, 2, 3,
+		4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257,
+		385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193,
+		12289, 16385, 24577};
+	inline constexpr std::uint8_t DISTANCE_EXTRAS[]{0, 0, 0,
+		0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9,
+		10, 10, 11, 11, 12, 12, 13, 13};
+
+	// Compresses with LZ77 over a window of up to 32KB, into
+	// blocks of fixed Huffman codes.
+	//
+	// Each call to compress is independent of previous
+	// calls, and ends with a sync flush (an empty stored
+	// block), so that its output ends on a byte boundary
+	// with 00 00 FF FF, as permessage-deflate expects.
+	class Compressor {
+		private:
+		// Chains are searched for at most MAX_CHAIN candidates,
+		// or until a match of NICE_MATCH, as zlib does at its
+		// faster levels.
+		static std::size_t constexpr HASH_BITS{15},
+			MAX_CHAIN{16}, NICE_MATCH{64}, MIN_MATCH{3},
+			MAX_MATCH{258};
+
+		std::size_t const windowLen;
+
+		// Most recent position of each hash of three bytes, and
+		// the previous position with the same hash, for
+		// positions modulo windowLen. Positions are offset by
+		// `base`, past those of previous calls, so that the
+		// tables need not be cleared on each call. Zero is
+		// none.
+		std::vector<std::uint32_t> head, prev;
+		std::uint32_t base{0}, nextBase{0};
+
+		// Bits not yet appended to `out`, least significant
+		// first.
+		std::string *out;
+		std::uint64_t bitBuffer;
+		std::size_t cBits;
+
+		public:
+		// Distances are limited to 2^windowBits, from 2^8 to
+		// 2^15.
+		Compressor(std::size_t windowBits = 15) :
+			windowLen(
+				std::size_t(1)
+				<< std::clamp(
+						 windowBits, std::size_t(8), std::size_t(15))),
+			head(std::size_t(1) << HASH_BITS),
+			prev(this->windowLen) {}
+
+		// Appends the compressed in to out.
+		void compress(std::string_view in, std::string &out) {
+			this->out = &out;
+			this->bitBuffer = 0;
+			this->cBits = 0;
+
+			if (this->nextBase > UINT32_MAX / 2 - in.size()) {
+				std::fill(this->head.begin(), this->head.end(), 0);
+				std::fill(this->prev.begin(), this->prev.end(), 0);
+				this->nextBase = 0;
+			}
+			this->base = this->nextBase;
+			this->nextBase = this->base +
+				static_cast<std::uint32_t>(in.size()) + 1;
+
+			if (!in.empty()) {
+				// One block, not final, with fixed codes.
+				this->putBits(0b010, 3);
+				std::size_t pos{0};
+				while (pos < in.size()) {
+					std::size_t bestLen{0}, bestDistance{0};
+					if (pos + MIN_MATCH <= in.size()) {
+						std::size_t const maxLen{
+							std::min(MAX_MATCH, in.size() - pos)};
+						std::uint32_t candidate{
+							this->head[Compressor::hash(in, pos)]};
+						for (std::size_t cChain{0}; cChain < MAX_CHAIN &&
+								 candidate > this->base &&
+								 this->base + pos - candidate <
+									 this->windowLen;
+								 cChain++) {
+							std::size_t const from{
+								candidate - this->base - 1};
+							if (in[from + bestLen] == in[pos + bestLen]) {
+								std::size_t const len{Compressor::matchLen(
+									in.data() + from, in.data() + pos, maxLen)};
+								if (len > bestLen) {
+									bestLen = len;
+									bestDistance = pos - from;
+									if (len >= std::min(NICE_MATCH, maxLen)) {
+										break;
+									}
+								}
+							}
+							candidate = this->prev[from % this->windowLen];
+						}
+						this->insert(in, pos);
+					}
+
+					if (bestLen >= MIN_MATCH) {
+						this->putMatch(bestLen, bestDistance);
+						for (std::size_t idx{1}; idx < bestLen; idx++) {
+							if (pos + idx + MIN_MATCH <= in.size()) {
+								this->insert(in, pos + idx);
+							}
+						}
+						pos += bestLen;
+					} else {
+						this->putSymbol(
+							static_cast<unsigned char>(in[pos]));
+						pos++;
+					}
+				}
+				this->putSymbol(256);
+			}
+
+			// Empty stored block, which aligns to a byte.
+			this->putBits(0, 3);
+			if (this->cBits % 8 != 0) {
+				this->putBits(0, 8 - this->cBits % 8);
+			}
+			out.append("\x00\x00\xff\xff", 4);
+		}
+
+		private:
+		static std::size_t hash(
+			std::string_view in,
+			std::size_t pos) noexcept {
+			std::uint32_t const bytes{
+				static_cast<std::uint32_t>(
+					static_cast<unsigned char>(in[pos]))
+					<< 16 |
+				static_cast<std::uint32_t>(
+					static_cast<unsigned char>(in[pos + 1]))
+					<< 8 |
+				static_cast<unsigned char>(in[pos + 2])};
+			return (bytes * 2654435761u) >> (32 - HASH_BITS);
+		}
+
+		// Length of the common prefix of left and right, up to
+		// maxLen, compared a word at a time.
+		static std::size_t matchLen(
+			char const *left,
+			char const *right,
+			std::size_t maxLen) noexcept {
+			std::size_t len{0};
+			for (; len + 8 <= maxLen; len += 8) {
+				std::uint64_t leftWord, rightWord;
+				std::memcpy(&leftWord, left + len, 8);
+				std::memcpy(&rightWord, right + len, 8);
+				std::uint64_t const diff{leftWord ^ rightWord};
+				if (diff != 0) {
+					return len +
+						static_cast<std::size_t>(
+							(std::endian::native == std::endian::little
+									? std::countr_zero(diff)
+									: std::countl_zero(diff)) /
+							8);
+				}
+			}
+			while (len < maxLen && left[len] == right[len]) {
+				len++;
+			}
+			return len;
+		}
+
+		// Positions are stored plus one, so that zero is none.
+		void insert(std::string_view in, std::size_t pos) {
+			std::uint32_t const position{
+				this->base + static_cast<std::uint32_t>(pos) + 1};
+			std::uint32_t &head{
+				this->head[Compressor::hash(in, pos)]};
+			this->prev[pos % this->windowLen] = head;
+			head = position;
+		}
+
+		void putBits(std::uint32_t bits, std::size_t count) {
+			this->bitBuffer |= static_cast<std::uint64_t>(bits)
+				<< this->cBits;
+			this->cBits += count;
+			for (; this->cBits >= 8; this->cBits -= 8) {
+				this->out->push_back(
+					static_cast<char>(this->bitBuffer));
+				this->bitBuffer >>= 8;
+			}
+		}
+
+		// Huffman codes are packed from their most significant
+		// bit.
+		void putCode(std::uint32_t code, std::size_t len) {
+			std::uint32_t reversed{0};
+			for (std::size_t idx{0}; idx < len; idx++) {
+				reversed = (reversed << 1) | ((code >> idx) & 1);
+			}
+			this->putBits(reversed, len);
+		}
+
+		// Fixed literal/length codes (RFC 1951 3.2.6).
+		void putSymbol(std::uint32_t symbol) {
+			if (symbol < 144) {
+				this->putCode(0x30 + symbol, 8);
+			} else if (symbol < 256) {
+				this->putCode(0x190 + symbol - 144, 9);
+			} else if (symbol < 280) {
+				this->putCode(symbol - 256, 7);
+			} else {
+				this->putCode(0xc0 + symbol - 280, 8);
+			}
+		}
+
+		void putMatch(std::size_t len, std::size_t distance) {
+			std::size_t const lenIdx{static_cast<std::size_t>(
+				std::upper_bound(
+					std::begin(LENGTH_BASES),
+					std::end(LENGTH_BASES),
+					len) -
+				std::begin(LENGTH_BASES) - 1)};
+			this->putSymbol(
+				static_cast<std::uint32_t>(257 + lenIdx));
+			this->putBits(
+				static_cast<std::uint32_t>(
+					len - LENGTH_BASES[lenIdx]),
+				LENGTH_EXTRAS[lenIdx]);
+
+			std::size_t const distanceIdx{static_cast<std::size_t>(
+				std::upper_bound(
+					std::begin(DISTANCE_BASES),
+					std::end(DISTANCE_BASES),
+					distance) -
+				std::begin(DISTANCE_BASES) - 1)};
+			this->putCode(
+				static_cast<std::uint32_t>(distanceIdx), 5);
+			this->putBits(
+				static_cast<std::uint32_t>(
+					distance - DISTANCE_BASES[distanceIdx]),
+				DISTANCE_EXTRAS[distanceIdx]);
+		}
+	};
+
+	// Decompresses stored, fixed, and dynamic blocks.
+	//
+	// Unless reset, the last window of output is kept across
+	// calls, so that each call may refer to the output of
+	// previous calls, as with context takeover in
+	// permessage-deflate.
+	class Decompressor {
+		private:
+		// Canonical Huffman code, as the number of codes of
+		// each length, and symbols in order of their codes.
+		class Huffman {
+			public:
+			std::array<std::uint16_t, 16> counts;
+			std::array<std::uint16_t, 288> symbols;
+
+			// Returns false if lengths are over-subscribed.
+			bool build(
+				std::uint8_t const *lengths,
+				std::size_t n) {
+				this->counts.fill(0);
+				for (std::size_t idx{0}; idx < n; idx++) {
+					this->counts[lengths[idx]]++;
+				}
+				std::array<std::uint16_t, 16> offsets;
+				offsets[1] = 0;
+				int left{1};
+				for (std::size_t len{1}; len < 16; len++) {
+					left = left * 2 - this->counts[len];
+					if (left < 0) {
+						return false;
+					}
+					if (len < 15) {
+						offsets[len + 1] = static_cast<std::uint16_t>(
+							offsets[len] + this->counts[len]);
+					}
+				}
+				for (std::size_t idx{0}; idx < n; idx++) {
+					if (lengths[idx] != 0) {
+						this->symbols[offsets[lengths[idx]]++] =
+							static_cast<std::uint16_t>(idx);
+					}
+				}
+				return true;
+			}
+		};
+
+		// Reads bits least significant first, and bytes.
+		class BitReader {
+			public:
+			std::string_view in;
+			std::size_t pos{0};
+			std::uint32_t bitBuffer{0};
+			std::size_t cBits{0};
+
+			bool bits(std::size_t count, std::uint32_t &value) {
+				while (this->cBits < count) {
+					if (this->pos == this->in.size()) {
+						return false;
+					}
+					this->bitBuffer |=
+						static_cast<std::uint32_t>(
+							static_cast<unsigned char>(
+								this->in[this->pos++]))
+						<< this->cBits;
+					this->cBits += 8;
+				}
+				value = this->bitBuffer &
+					((std::uint32_t(1) << count) - 1);
+				this->bitBuffer >>= count;
+				this->cBits -= count;
+				return true;
+			}
+
+			// Decodes one symbol of huffman.
+			bool decode(
+				Huffman const &huffman,
+				std::uint32_t &symbol) {
+				int code{0}, first{0}, idx{0};
+				for (std::size_t len{1}; len < 16; len++) {
+					std::uint32_t bit;
+					if (!this->bits(1, bit)) {
+						return false;
+					}
+					code |= static_cast<int>(bit);
+					int const count{huffman.counts[len]};
+					if (code - count < first) {
+						symbol = huffman.symbols[idx + code - first];
+						return true;
+					}
+					idx += count;
+					first = (first + count) << 1;
+					code <<= 1;
+				}
+				return false;
+			}
+
+			std::size_t remainingBits() const noexcept {
+				return (this->in.size() - this->pos) * 8 +
+					this->cBits;
+			}
+		};
+
+		std::size_t const windowLen;
+
+		// Output kept for back-references, followed by the
+		// output of the current call.
+		std::string history;
+
+		public:
+		// Distances are limited to 2^windowBits, up to 2^15.
+		Decompressor(std::size_t windowBits = 15) :
+			windowLen(
+				std::size_t(1)
+				<< std::min(windowBits, std::size_t(15))) {}
+
+		// Forgets previous output.
+		void reset() { this->history.clear(); }
+
+		// Decompresses whole blocks of in, up to the final
+		// block or the last whole byte, appending to out.
+		// Returns false if in is malformed, or if more than
+		// maxLen bytes would be appended, after which the
+		// Decompressor must be reset.
+		bool decompress(
+			std::string_view in,
+			std::string &out,
+			std::size_t maxLen = SIZE_MAX) {
+			static std::array<Huffman, 2> const fixed{[]() {
+				std::array<std::uint8_t, 288> lengths;
+				std::fill(
+					lengths.begin(), lengths.begin() + 144, 8);
+				std::fill(
+					lengths.begin() + 144, lengths.begin() + 256, 9);
+				std::fill(
+					lengths.begin() + 256, lengths.begin() + 280, 7);
+				std::fill(lengths.begin() + 280, lengths.end(), 8);
+				std::array<Huffman, 2> fixed;
+				fixed[0].build(lengths.data(), 288);
+				std::fill(lengths.begin(), lengths.begin() + 30, 5);
+				fixed[1].build(lengths.data(), 30);
+				return fixed;
+			}()};
+
+			std::size_t const begin{this->history.size()};
+			BitReader reader{in};
+			bool isFinal{false};
+			while (!isFinal && reader.remainingBits() >= 8) {
+				std::uint32_t header;
+				if (!reader.bits(3, header)) {
+					return false;
+				}
+				isFinal = (header & 1) != 0;
+				switch (header >> 1) {
+					case 0:
+						if (!this->inflateStored(reader)) {
+							return false;
+						}
+						break;
+					case 1:
+						if (!this->inflateCodes(
+									reader,
+									fixed[0],
+									fixed[1],
+									begin,
+									maxLen)) {
+							return false;
+						}
+						break;
+					case 2: {
+						Huffman lengths, distances;
+						if (
+							!Decompressor::readDynamic(
+								reader, lengths, distances) ||
+							!this->inflateCodes(
+								reader,
+								lengths,
+								distances,
+								begin,
+								maxLen)) {
+							return false;
+						}
+						break;
+					}
+					default:
+						return false;
+				}
+				if (this->history.size() - begin > maxLen) {
+					return false;
+				}
+			}
+
+			out.append(this->history, begin);
+			if (this->history.size() > this->windowLen * 2) {
+				this->history.erase(
+					0, this->history.size() - this->windowLen);
+			}
+			return true;
+		}
+
+		private:
+		bool inflateStored(BitReader &reader) {
+			std::uint32_t len, nLen;
+			reader.bitBuffer >>= reader.cBits % 8;
+			reader.cBits -= reader.cBits % 8;
+			if (
+				!reader.bits(16, len) || !reader.bits(16, nLen) ||
+				len != (~nLen & 0xffff)) {
+				return false;
+			}
+			for (; len > 0 && reader.cBits >= 8; len--) {
+				std::uint32_t byte;
+				reader.bits(8, byte);
+				this->history.push_back(static_cast<char>(byte));
+			}
+			if (reader.in.size() - reader.pos < len) {
+				return false;
+			}
+			this->history.append(
+				reader.in.substr(reader.pos, len));
+			reader.pos += len;
+			return true;
+		}
+
+		bool inflateCodes(
+			BitReader &reader,
+			Huffman const &lengths,
+			Huffman const &distances,
+			std::size_t begin,
+			std::size_t maxLen) {
+			while (true) {
+				std::uint32_t symbol;
+				if (!reader.decode(lengths, symbol)) {
+					return false;
+				}
+				if (symbol < 256) {
+					this->history.push_back(
+						static_cast<char>(symbol));
+					continue;
+				} else if (symbol == 256) {
+					return true;
+				}
+
+				std::uint32_t lenExtra, distanceSymbol,
+					distanceExtra;
+				symbol -= 257;
+				if (
+					symbol >= 29 ||
+					!reader.bits(LENGTH_EXTRAS[symbol], lenExtra) ||
+					!reader.decode(distances, distanceSymbol) ||
+					distanceSymbol >= 30 ||
+					!reader.bits(
+						DISTANCE_EXTRAS[distanceSymbol],
+						distanceExtra)) {
+					return false;
+				}
+				std::size_t const len{
+					LENGTH_BASES[symbol] + lenExtra},
+					distance{
+						DISTANCE_BASES[distanceSymbol] + distanceExtra};
+				if (
+					distance > this->history.size() ||
+					distance > this->windowLen ||
+					this->history.size() + len - begin > maxLen) {
+					return false;
+				}
+
+				// Copies may overlap themselves.
+				std::size_t from{this->history.size() - distance};
+				for (std::size_t idx{0}; idx < len; idx++) {
+					this->history.push_back(
+						this->history[from + idx]);
+				}
+			}
+		}
+
+		static bool readDynamic(
+			BitReader &reader,
+			Huffman &lengths,
+			Huffman &distances) {
+			static std::size_t const ORDER[]{16, 17, 18, 0, 8, 7,
+				9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+			std::uint32_t cLengths, cDistances, cCodes;
+			if (
+				!reader.bits(5, cLengths) ||
+				!reader.bits(5, cDistances) ||
+				!reader.bits(4, cCodes)) {
+				return false;
+			}
+			cLengths += 257;
+			cDistances += 1;
+			cCodes += 4;
+			if (cLengths > 286 || cDistances > 30) {
+				return false;
+			}
+
+			std::array<std::uint8_t, 320> codeLengths{};
+			for (std::size_t idx{0}; idx < cCodes; idx++) {
+				std::uint32_t len;
+				if (!reader.bits(3, len)) {
+					return false;
+				}
+				codeLengths[ORDER[idx]] =
+					static_cast<std::uint8_t>(len);
+			}
+			Huffman codes;
+			if (!codes.build(codeLengths.data(), 19)) {
+				return false;
+			}
+
+			// Lengths of both codes are sent together, and runs
+			// may cross between them.
+			codeLengths.fill(0);
+			for (std::size_t idx{0};
+					 idx < cLengths + cDistances;) {
+				std::uint32_t symbol, repeat;
+				if (!reader.decode(codes, symbol)) {
+					return false;
+				}
+				if (symbol < 16) {
+					codeLengths[idx++] =
+						static_cast<std::uint8_t>(symbol);
+					continue;
+				}
+				std::uint8_t len{0};
+				if (symbol == 16) {
+					if (idx == 0 || !reader.bits(2, repeat)) {
+						return false;
+					}
+					len = codeLengths[idx - 1];
+					repeat += 3;
+				} else if (symbol == 17) {
+					if (!reader.bits(3, repeat)) {
+						return false;
+					}
+					repeat += 3;
+				} else {
+					if (!reader.bits(7, repeat)) {
+						return false;
+					}
+					repeat += 11;
+				}
+				if (idx + repeat > cLengths + cDistances) {
+					return false;
+				}
+				for (; repeat > 0; repeat--) {
+					codeLengths[idx++] = len;
+				}
+			}
+
+			// The end of block must have a code.
+			return codeLengths[256] != 0 &&
+				lengths.build(codeLengths.data(), cLengths) &&
+				distances.build(
+					codeLengths.data() + cLengths, cDistances);
+		}
+	};
+}
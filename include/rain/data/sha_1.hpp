@@ -0,0 +1,105 @@
+// SHA-1 message digest.
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Rain::Data::Sha1 {
+	// SHA-1 (RFC 3174) digest of `in`, as 20 raw bytes.
+	//
+	// SHA-1 is not collision-resistant, and is here only for
+	// protocols which require it, such as the WebSocket
+	// handshake.
+	inline std::string digest(std::string_view in) {
+		std::array<std::uint32_t, 5> state{
+			0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476,
+			0xc3d2e1f0};
+
+		// Processes one 64-byte block.
+		auto const process{[&state](unsigned char const *block) {
+			std::uint32_t w[80];
+			for (std::size_t idx{0}; idx < 16; idx++) {
+				w[idx] = static_cast<std::uint32_t>(block[idx * 4])
+						<< 24 |
+					static_cast<std::uint32_t>(block[idx * 4 + 1])
+						<< 16 |
+					static_cast<std::uint32_t>(block[idx * 4 + 2])
+						<< 8 |
+					static_cast<std::uint32_t>(block[idx * 4 + 3]);
+			}
+			for (std::size_t idx{16}; idx < 80; idx++) {
+				w[idx] = std::rotl(
+					w[idx - 3] ^ w[idx - 8] ^ w[idx - 14] ^
+						w[idx - 16],
+					1);
+			}
+
+			auto [a, b, c, d, e]{state};
+			for (std::size_t idx{0}; idx < 80; idx++) {
+				std::uint32_t f, k;
+				if (idx < 20) {
+					f = (b & c) | (~b & d);
+					k = 0x5a827999;
+				} else if (idx < 40) {
+					f = b ^ c ^ d;
+					k = 0x6ed9eba1;
+				} else if (idx < 60) {
+					f = (b & c) | (b & d) | (c & d);
+					k = 0x8f1bbcdc;
+				} else {
+					f = b ^ c ^ d;
+					k = 0xca62c1d6;
+				}
+				std::uint32_t const temp{
+					std::rotl(a, 5) + f + e + k + w[idx]};
+				e = d;
+				d = c;
+				c = std::rotl(b, 30);
+				b = a;
+				a = temp;
+			}
+			state[0] += a;
+			state[1] += b;
+			state[2] += c;
+			state[3] += d;
+			state[4] += e;
+		}};
+
+		std::size_t idx{0};
+		for (; in.size() - idx >= 64; idx += 64) {
+			process(
+				reinterpret_cast<unsigned char const *>(in.data()) +
+				idx);
+		}
+
+		// Pad the remainder with a 1 bit, zeros, and the
+		// length in bits, into one or two final blocks.
+		unsigned char tail[128]{};
+		std::size_t const cRemaining{in.size() - idx};
+		in.copy(reinterpret_cast<char *>(tail), cRemaining, idx);
+		tail[cRemaining] = 0x80;
+		std::size_t const tailLen{cRemaining < 56 ? 64u : 128u};
+		std::uint64_t const cBits{
+			static_cast<std::uint64_t>(in.size()) * 8};
+		for (std::size_t byte{0}; byte < 8; byte++) {
+			tail[tailLen - 1 - byte] =
+				static_cast<unsigned char>(cBits >> (byte * 8));
+		}
+		for (std::size_t offset{0}; offset < tailLen;
+				 offset += 64) {
+			process(tail + offset);
+		}
+
+		std::string result(20, '\0');
+		for (std::size_t word{0}; word < 5; word++) {
+			for (std::size_t byte{0}; byte < 4; byte++) {
+				result[word * 4 + byte] = static_cast<char>(
+					state[word] >> (24 - byte * 8));
+			}
+		}
+		return result;
+	}
+}
@@ -3,5 +3,6 @@
 #pragma once
 
 #include "functional/functional.hpp"
+#include "functional/move_only_function.hpp"
 #include "functional/trait.hpp"
 #include "functional/type.hpp"
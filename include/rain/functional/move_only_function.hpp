@@ -0,0 +1,167 @@
+// Move-only type-erased callable with small-buffer storage.
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Rain::Functional {
+	template<typename>
+	class MoveOnlyFunction;
+
+	// Move-only type-erased callable, like
+	// std::move_only_function.
+	//
+	// Callables of up to BUFFER_SIZE bytes which are nothrow
+	// move-constructible are stored inline, and constructing
+	// or moving the MoveOnlyFunction does not allocate.
+	// Larger callables are stored on the heap. Since it is
+	// never copied, a MoveOnlyFunction may store move-only
+	// captures, such as std::unique_ptr.
+	template<typename Result, typename... Args>
+	class MoveOnlyFunction<Result(Args...)> {
+		public:
+		static std::size_t const BUFFER_SIZE{64};
+
+		private:
+		// Type-erased operations on the stored callable, one
+		// static instance per callable type.
+		class Operations {
+			public:
+			Result (*invoke)(void *, Args &&...);
+
+			// Move-constructs into uninitialized storage, and
+			// destroys the source.
+			void (*relocate)(void *, void *) noexcept;
+			void (*destroy)(void *) noexcept;
+		};
+
+		template<typename Callable>
+		static bool constexpr IS_INLINE{
+			sizeof(Callable) <= BUFFER_SIZE &&
+			alignof(Callable) <= alignof(std::max_align_t) &&
+			std::is_nothrow_move_constructible_v<Callable>};
+
+		template<typename Callable>
+		static Callable *stored(void *buffer) noexcept {
+			if constexpr (IS_INLINE<Callable>) {
+				return std::launder(static_cast<Callable *>(buffer));
+			} else {
+				return *static_cast<Callable **>(buffer);
+			}
+		}
+
+		template<typename Callable>
+		static inline Operations const OPERATIONS{
+			[](void *buffer, Args &&...args) -> Result {
+				return std::invoke(
+					*MoveOnlyFunction::stored<Callable>(buffer),
+					std::forward<Args>(args)...);
+			},
+			[](void *to, void *from) noexcept {
+				if constexpr (IS_INLINE<Callable>) {
+					Callable *callable{
+						MoveOnlyFunction::stored<Callable>(from)};
+					new (to) Callable(std::move(*callable));
+					callable->~Callable();
+				} else {
+					*static_cast<Callable **>(to) =
+						*static_cast<Callable **>(from);
+				}
+			},
+			[](void *buffer) noexcept {
+				if constexpr (IS_INLINE<Callable>) {
+					MoveOnlyFunction::stored<Callable>(buffer)
+						->~Callable();
+				} else {
+					delete MoveOnlyFunction::stored<Callable>(buffer);
+				}
+			}};
+
+		alignas(std::max_align_t) unsigned char
+			buffer[BUFFER_SIZE];
+
+		// nullptr if empty.
+		Operations const *operations;
+
+		public:
+		MoveOnlyFunction() noexcept : operations(nullptr) {}
+		MoveOnlyFunction(std::nullptr_t) noexcept :
+			operations(nullptr) {}
+
+		// Implicit, so that callables may be passed wherever a
+		// MoveOnlyFunction is expected.
+		template<
+			typename Callable,
+			typename Decayed = std::decay_t<Callable>,
+			typename = std::enable_if_t<
+				!std::is_same_v<Decayed, MoveOnlyFunction> &&
+				std::is_invocable_r_v<Result, Decayed &, Args...>>>
+		MoveOnlyFunction(Callable &&callable) :
+			operations(&OPERATIONS<Decayed>) {
+			if constexpr (IS_INLINE<Decayed>) {
+				new (this->buffer)
+					Decayed(std::forward<Callable>(callable));
+			} else {
+				*reinterpret_cast<Decayed **>(this->buffer) =
+					new Decayed(std::forward<Callable>(callable));
+			}
+		}
+
+		MoveOnlyFunction(MoveOnlyFunction &&other) noexcept :
+			operations(other.operations) {
+			if (this->operations != nullptr) {
+				this->operations->relocate(
+					this->buffer, other.buffer);
+				other.operations = nullptr;
+			}
+		}
+		MoveOnlyFunction &operator=(
+			MoveOnlyFunction &&other) noexcept {
+			if (this != &other) {
+				this->reset();
+				if (other.operations != nullptr) {
+					other.operations->relocate(
+						this->buffer, other.buffer);
+					this->operations = other.operations;
+					other.operations = nullptr;
+				}
+			}
+			return *this;
+		}
+		MoveOnlyFunction &operator=(std::nullptr_t) noexcept {
+			this->reset();
+			return *this;
+		}
+
+		// Forbid copy.
+		MoveOnlyFunction(MoveOnlyFunction const &) = delete;
+		MoveOnlyFunction &operator=(MoveOnlyFunction const &) =
+			delete;
+
+		~MoveOnlyFunction() { this->reset(); }
+
+		explicit operator bool() const noexcept {
+			return this->operations != nullptr;
+		}
+
+		// Throws std::bad_function_call if empty.
+		Result operator()(Args... args) {
+			if (this->operations == nullptr) {
+				throw std::bad_function_call();
+			}
+			return this->operations->invoke(
+				this->buffer, std::forward<Args>(args)...);
+		}
+
+		private:
+		void reset() noexcept {
+			if (this->operations != nullptr) {
+				this->operations->destroy(this->buffer);
+				this->operations = nullptr;
+			}
+		}
+	};
+}
@@ -0,0 +1,320 @@
+// Low-overhead counters and latency histograms, exposed in
+// Prometheus text format.
+#pragma once
+
+#include "literal.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Rain::Metrics {
+	class Metric;
+
+	// A set of Metrics, which registers them on
+	// construction and unregisters them on destruction.
+	// Process-wide Metrics, including those of Rain itself,
+	// belong to `global()`.
+	//
+	// Registry is thread-safe.
+	class Registry {
+		private:
+		std::vector<Metric const *> metrics;
+		mutable std::mutex mtx;
+
+		public:
+		Registry() = default;
+
+		// Forbid copy/move.
+		Registry(Registry const &) = delete;
+		Registry &operator=(Registry const &) = delete;
+		Registry(Registry &&) = delete;
+		Registry &operator=(Registry &&) = delete;
+
+		static Registry &global() {
+			static Registry registry;
+			return registry;
+		}
+
+		void add(Metric const *metric) {
+			std::lock_guard lck(this->mtx);
+			this->metrics.push_back(metric);
+		}
+		void remove(Metric const *metric) {
+			std::lock_guard lck(this->mtx);
+			this->metrics.erase(std::find(
+				this->metrics.begin(), this->metrics.end(), metric));
+		}
+
+		// Writes all Metrics in Prometheus text format, in
+		// order of name.
+		void expose(std::ostream &stream) const;
+		std::string expose() const {
+			std::ostringstream stream;
+			this->expose(stream);
+			return stream.str();
+		}
+	};
+
+	// Base class of named Metrics.
+	//
+	// Metrics are updated often and read rarely, so updates
+	// go to one of a few stripes on separate cache lines,
+	// assigned round-robin to threads, and stripes are merged
+	// on read. Updates are relaxed atomic adds, and reads are
+	// consistent only per stripe.
+	class Metric {
+		public:
+		std::string const name, help;
+
+		private:
+		Registry &registry;
+
+		public:
+		Metric(
+			std::string const &name,
+			std::string const &help,
+			Registry &registry = Registry::global()) :
+			name(name),
+			help(help),
+			registry(registry) {
+			this->registry.add(this);
+		}
+		virtual ~Metric() { this->registry.remove(this); }
+
+		// Forbid copy/move.
+		Metric(Metric const &) = delete;
+		Metric &operator=(Metric const &) = delete;
+		Metric(Metric &&) = delete;
+		Metric &operator=(Metric &&) = delete;
+
+		// Writes HELP, TYPE, and samples in Prometheus text
+		// format.
+		virtual void expose(std::ostream &stream) const = 0;
+
+		protected:
+		static std::size_t const STRIPES{16};
+
+		// Stripe of the calling thread.
+		static std::size_t stripe() noexcept {
+			static std::atomic_size_t cThreads{0};
+			thread_local std::size_t const stripe{
+				cThreads++ % Metric::STRIPES};
+			return stripe;
+		}
+
+		void exposeHeader(
+			std::ostream &stream,
+			char const *type) const {
+			stream << "# HELP " << this->name << ' ' << this->help
+						 << "\n# TYPE " << this->name << ' ' << type
+						 << '\n';
+		}
+	};
+
+	inline void Registry::expose(std::ostream &stream) const {
+		std::vector<Metric const *> metrics;
+		{
+			std::lock_guard lck(this->mtx);
+			metrics = this->metrics;
+		}
+		std::sort(
+			metrics.begin(),
+			metrics.end(),
+			[](Metric const *a, Metric const *b) {
+				return a->name < b->name;
+			});
+		for (Metric const *metric : metrics) {
+			metric->expose(stream);
+		}
+	}
+
+	// Monotonically increasing count, e.g. of events or
+	// bytes.
+	class Counter : public Metric {
+		private:
+		struct alignas(64) Stripe {
+			std::atomic_uint64_t value;
+		};
+		std::array<Stripe, Metric::STRIPES> stripes{};
+
+		public:
+		using Metric::Metric;
+
+		void add(std::uint64_t value = 1) noexcept {
+			this->stripes[Metric::stripe()].value.fetch_add(
+				value, std::memory_order_relaxed);
+		}
+
+		std::uint64_t value() const noexcept {
+			std::uint64_t value{0};
+			for (Stripe const &stripe : this->stripes) {
+				value +=
+					stripe.value.load(std::memory_order_relaxed);
+			}
+			return value;
+		}
+
+		virtual void expose(
+			std::ostream &stream) const override {
+			this->exposeHeader(stream, "counter");
+			stream << this->name << ' ' << this->value() << '\n';
+		}
+	};
+
+	// Histogram of durations, with log-linear buckets in the
+	// manner of HDR histograms: each power of two of
+	// nanoseconds is split into SUB_BUCKETS linear buckets,
+	// so that quantiles are within 1/SUB_BUCKETS of the true
+	// value, over the entire range of durations.
+	//
+	// Exposed in seconds, with Prometheus buckets at each
+	// power of two of nanoseconds from about 1us to 1min.
+	class Histogram : public Metric {
+		public:
+		static std::size_t const SUB_BUCKET_BITS{3},
+			SUB_BUCKETS{1_zu << SUB_BUCKET_BITS},
+			BUCKETS{(64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS};
+
+		// Merged counts of a Histogram at some time.
+		class Snapshot {
+			public:
+			std::array<std::uint64_t, BUCKETS> buckets;
+			std::uint64_t count, sum;
+
+			// Upper bound of the q-quantile (0 <= q <= 1), in
+			// nanoseconds. Zero if empty.
+			std::uint64_t quantile(double q) const noexcept {
+				if (this->count == 0) {
+					return 0;
+				}
+				std::uint64_t rank{static_cast<std::uint64_t>(
+					q * static_cast<double>(this->count - 1))},
+					cumulative{0};
+				for (std::size_t idx{0}; idx < BUCKETS; idx++) {
+					cumulative += this->buckets[idx];
+					if (cumulative > rank) {
+						return Histogram::upperOf(idx);
+					}
+				}
+				return Histogram::upperOf(BUCKETS - 1);
+			}
+		};
+
+		private:
+		// Exposed bucket bounds, in log2 nanoseconds.
+		static std::size_t const EXPOSED_LOW{10},
+			EXPOSED_HIGH{36};
+
+		struct alignas(64) Stripe {
+			std::array<std::atomic_uint64_t, BUCKETS> buckets;
+			std::atomic_uint64_t sum;
+		};
+		std::array<Stripe, Metric::STRIPES> stripes{};
+
+		public:
+		using Metric::Metric;
+
+		void record(std::uint64_t nanoseconds) noexcept {
+			Stripe &stripe{this->stripes[Metric::stripe()]};
+			stripe.buckets[Histogram::bucketOf(nanoseconds)]
+				.fetch_add(1, std::memory_order_relaxed);
+			stripe.sum.fetch_add(
+				nanoseconds, std::memory_order_relaxed);
+		}
+		template<typename Rep, typename Period>
+		void record(
+			std::chrono::duration<Rep, Period> duration) noexcept {
+			this->record(static_cast<std::uint64_t>(std::max(
+				std::chrono::nanoseconds::rep(0),
+				std::chrono::duration_cast<std::chrono::nanoseconds>(
+					duration)
+					.count())));
+		}
+
+		Snapshot snapshot() const noexcept {
+			Snapshot snapshot{};
+			for (Stripe const &stripe : this->stripes) {
+				for (std::size_t idx{0}; idx < BUCKETS; idx++) {
+					std::uint64_t count{stripe.buckets[idx].load(
+						std::memory_order_relaxed)};
+					snapshot.buckets[idx] += count;
+					snapshot.count += count;
+				}
+				snapshot.sum +=
+					stripe.sum.load(std::memory_order_relaxed);
+			}
+			return snapshot;
+		}
+
+		virtual void expose(
+			std::ostream &stream) const override {
+			Snapshot const snapshot{this->snapshot()};
+			this->exposeHeader(stream, "histogram");
+
+			// Exposed bounds are powers of two, which are also
+			// bounds of internal buckets.
+			std::uint64_t cumulative{0};
+			std::size_t idx{0};
+			for (std::size_t exponent{Histogram::EXPOSED_LOW};
+					 exponent <= Histogram::EXPOSED_HIGH;
+					 exponent++) {
+				for (; idx < BUCKETS &&
+						 Histogram::upperOf(idx) <= 1_zu << exponent;
+						 idx++) {
+					cumulative += snapshot.buckets[idx];
+				}
+				stream << this->name << "_bucket{le=\""
+							 << static_cast<double>(1_zu << exponent) / 1e9
+							 << "\"} " << cumulative << '\n';
+			}
+			stream << this->name << "_bucket{le=\"+Inf\"} "
+						 << snapshot.count << '\n'
+						 << this->name << "_sum "
+						 << static_cast<double>(snapshot.sum) / 1e9
+						 << '\n'
+						 << this->name << "_count " << snapshot.count
+						 << '\n';
+		}
+
+		// Values below SUB_BUCKETS have a bucket each. Above,
+		// buckets are indexed by the position of the highest
+		// set bit, and the SUB_BUCKET_BITS bits below it.
+		static std::size_t bucketOf(
+			std::uint64_t value) noexcept {
+			if (value < SUB_BUCKETS) {
+				return static_cast<std::size_t>(value);
+			}
+			std::size_t exponent{
+				static_cast<std::size_t>(std::bit_width(value)) - 1};
+			return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS +
+				static_cast<std::size_t>(
+							 (value >> (exponent - SUB_BUCKET_BITS)) &
+							 (SUB_BUCKETS - 1));
+		}
+
+		// Exclusive upper bound of values in a bucket. The last
+		// bucket is unbounded, and saturates.
+		static std::uint64_t upperOf(std::size_t idx) noexcept {
+			if (idx < SUB_BUCKETS) {
+				return idx + 1;
+			}
+			std::size_t exponent{
+				idx / SUB_BUCKETS + SUB_BUCKET_BITS - 1},
+				sub{idx % SUB_BUCKETS};
+			if (idx == BUCKETS - 1) {
+				return UINT64_MAX;
+			}
+			return (SUB_BUCKETS + sub + 1)
+				<< (exponent - SUB_BUCKET_BITS);
+		}
+	};
+}
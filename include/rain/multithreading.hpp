@@ -1,6 +1,8 @@
 // Includes all /multithreading headers.
 #pragma once
 
+#include "multithreading/lock_free_queue.hpp"
 #include "multithreading/shared_lock_guard.hpp"
 #include "multithreading/thread_pool.hpp"
 #include "multithreading/unlock_guard.hpp"
+#include "multithreading/work_stealing_deque.hpp"
@@ -0,0 +1,121 @@
+// Bounded lock-free multi-producer multi-consumer queue.
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace Rain::Multithreading {
+	// Bounded lock-free multi-producer multi-consumer FIFO
+	// queue, after Vyukov. Each cell carries a sequence
+	// number which tells producers and consumers whether it
+	// is theirs to fill or empty, so that a push or pop costs
+	// a single CAS when uncontended.
+	//
+	// Value must be trivially copyable, and is usually a
+	// pointer.
+	template<typename Value>
+	class LockFreeQueue {
+		static_assert(std::is_trivially_copyable_v<Value>);
+
+		private:
+		class Cell {
+			public:
+			std::atomic_size_t sequence;
+			Value value;
+		};
+
+		// Producers and consumers are kept on separate cache
+		// lines.
+		static std::size_t const CACHE_LINE_SIZE{64};
+
+		std::size_t const capacity;
+		std::unique_ptr<Cell[]> const cells;
+		alignas(CACHE_LINE_SIZE) std::atomic_size_t pushPosition;
+		alignas(CACHE_LINE_SIZE) std::atomic_size_t popPosition;
+
+		public:
+		// Capacity is rounded up to a power of two.
+		LockFreeQueue(std::size_t capacity = 1024) :
+			capacity(std::bit_ceil(capacity)),
+			cells(new Cell[this->capacity]),
+			pushPosition(0),
+			popPosition(0) {
+			for (std::size_t idx{0}; idx < this->capacity; idx++) {
+				this->cells[idx].sequence.store(
+					idx, std::memory_order_relaxed);
+			}
+		}
+
+		// Forbid copy/move.
+		LockFreeQueue(LockFreeQueue const &) = delete;
+		LockFreeQueue &operator=(LockFreeQueue const &) = delete;
+		LockFreeQueue(LockFreeQueue &&) = delete;
+		LockFreeQueue &operator=(LockFreeQueue &&) = delete;
+
+		// Returns false if full.
+		bool push(Value value) noexcept {
+			std::size_t position{
+				this->pushPosition.load(std::memory_order_relaxed)};
+			Cell *cell;
+			while (true) {
+				cell = &this->cells[position & (this->capacity - 1)];
+				std::ptrdiff_t difference{
+					static_cast<std::ptrdiff_t>(cell->sequence.load(
+						std::memory_order_acquire)) -
+					static_cast<std::ptrdiff_t>(position)};
+				if (difference == 0) {
+					if (this->pushPosition.compare_exchange_weak(
+								position,
+								position + 1,
+								std::memory_order_relaxed)) {
+						break;
+					}
+				} else if (difference < 0) {
+					return false;
+				} else {
+					position = this->pushPosition.load(
+						std::memory_order_relaxed);
+				}
+			}
+			cell->value = value;
+			cell->sequence.store(
+				position + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Returns false if empty.
+		bool pop(Value &value) noexcept {
+			std::size_t position{
+				this->popPosition.load(std::memory_order_relaxed)};
+			Cell *cell;
+			while (true) {
+				cell = &this->cells[position & (this->capacity - 1)];
+				std::ptrdiff_t difference{
+					static_cast<std::ptrdiff_t>(cell->sequence.load(
+						std::memory_order_acquire)) -
+					static_cast<std::ptrdiff_t>(position + 1)};
+				if (difference == 0) {
+					if (this->popPosition.compare_exchange_weak(
+								position,
+								position + 1,
+								std::memory_order_relaxed)) {
+						break;
+					}
+				} else if (difference < 0) {
+					return false;
+				} else {
+					position = this->popPosition.load(
+						std::memory_order_relaxed);
+				}
+			}
+			value = cell->value;
+			cell->sequence.store(
+				position + this->capacity,
+				std::memory_order_release);
+			return true;
+		}
+	};
+}
@@ -3,25 +3,45 @@
 #pragma once
 
 #include "../error/consume_throwable.hpp"
-#include "../error/incrementer.hpp"
+#include "../functional/move_only_function.hpp"
 #include "../functional/type.hpp"
+#include "../metrics.hpp"
 #include "../platform.hpp"
 #include "../time/timeout.hpp"
+#include "lock_free_queue.hpp"
+#include "work_stealing_deque.hpp"
 
+#include <algorithm>
 #include <atomic>
+#include <bit>
 #include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
 #include <iostream>
-#include <list>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <source_location>
 #include <system_error>
 #include <thread>
+#include <type_traits>
+#include <vector>
 
 namespace Rain::Multithreading {
 	// ThreadPool manages an upper-bounded number of threads
 	// to work on a queue of tasks.
 	//
+	// Scheduling is work-stealing. Each thread owns a
+	// WorkStealingDeque, onto which tasks queued from that
+	// thread are pushed; tasks queued from elsewhere go to a
+	// shared LockFreeQueue. Threads without work of their own
+	// take from the shared queue, then steal from each other,
+	// and only then idle. Every queued task either wakes an
+	// idle thread or spawns a new one if the thread limit
+	// allows, so that tasks which block do not starve tasks
+	// queued behind them.
+	//
 	// If any Task may block, the ThreadPool may block during
 	// destruction. Otherwise, the ThreadPool is guaranteed
 	// not to block during destruction.
@@ -31,47 +51,222 @@ namespace Rain::Multithreading {
 		public:
 		// A task is simply a callable which is executed.
 		// Parameters should be captured in the lambda used as
-		// function. Should not throw.
-		using Task = std::function<void()>;
+		// function, and may be move-only. Should not throw.
+		//
+		// Captures of up to Task::BUFFER_SIZE bytes are queued
+		// and run without allocation.
+		using Task = Functional::MoveOnlyFunction<void()>;
+
+		// A subset of tasks on a ThreadPool which may be waited
+		// on without waiting on the rest, for fork/join
+		// parallelism.
+		//
+		// Unlike bare tasks, exceptions thrown by tasks in a
+		// TaskGroup are not consumed: the first is rethrown by
+		// `wait`.
+		//
+		// TaskGroup is thread-safe, and waits on its tasks
+		// during destruction.
+		class TaskGroup {
+			private:
+			ThreadPool &threadPool;
+
+			// Tasks queued but not completed. Only decremented
+			// under mtx, so that a waiter which sees zero under
+			// mtx may destroy the TaskGroup.
+			std::atomic_size_t cTasks;
+			std::mutex mtx;
+			std::condition_variable noTasksEv;
+
+			// First exception thrown by a task since the last
+			// `wait`. Locked by mtx.
+			std::exception_ptr exception;
+
+			public:
+			TaskGroup(ThreadPool &threadPool) :
+				threadPool(threadPool),
+				cTasks(0) {}
+
+			// Forbid copy/move.
+			TaskGroup(TaskGroup const &) = delete;
+			TaskGroup &operator=(TaskGroup const &) = delete;
+			TaskGroup(TaskGroup &&) = delete;
+			TaskGroup &operator=(TaskGroup &&) = delete;
+
+			~TaskGroup() {
+				Rain::Error::consumeThrowable(
+					[this]() { this->wait(); },
+					std::source_location::current())();
+			}
 
-		private:
-		// Maximum number of threads the ThreadPool will spawn.
-		// Zero is unbounded.
-		std::atomic_size_t maxThreads,
-			// A thread is idle if it is not waiting on newTaskEv.
-			cIdleThreads;
+			std::size_t getCTasks() const noexcept {
+				return this->cTasks;
+			}
 
-		// Locks cIdleThreads. Used when threads are idle.
-		mutable std::mutex cIdleThreadsMtx;
+			// Queues a callable onto the ThreadPool as part of
+			// this group. The callable is wrapped with a pointer
+			// to the group, so callables of up to
+			// Task::BUFFER_SIZE less a pointer do not allocate.
+			template<typename Callable>
+			void queueTask(Callable &&callable) {
+				this->cTasks++;
+				try {
+					this->threadPool.queueTask(
+						[this,
+							callable = std::forward<Callable>(
+								callable)]() mutable {
+							try {
+								callable();
+							} catch (...) {
+								std::lock_guard<std::mutex> lckGuard(
+									this->mtx);
+								if (!this->exception) {
+									this->exception = std::current_exception();
+								}
+							}
+							std::lock_guard<std::mutex> lckGuard(
+								this->mtx);
+							if (--this->cTasks == 0) {
+								this->noTasksEv.notify_all();
+							}
+						});
+				} catch (...) {
+					this->cTasks--;
+					throw;
+				}
+			}
 
-		// Tracks all threads.
-		std::list<std::thread> threads;
+			// Blocks until all tasks in the group have completed,
+			// or up to a timeout. Returns false if all completed,
+			// or true on timeout. Rethrows the first exception
+			// thrown by a task since the last wait, if any.
+			//
+			// If called from a thread of the ThreadPool, it runs
+			// tasks queued on the ThreadPool while waiting, which
+			// may include tasks outside this group. Thus, tasks
+			// may wait on TaskGroups without deadlocking a
+			// ThreadPool with bounded threads.
+			bool wait(Time::Timeout timeout = {}) {
+				while (this->cTasks != 0 && !timeout.isPassed() &&
+					this->threadPool.runQueuedTask()) {
+				}
 
-		// Locks this->threads.
-		mutable std::mutex threadsMtx;
+				std::unique_lock<std::mutex> lck(this->mtx);
+				auto predicate = [this]() {
+					return this->cTasks == 0;
+				};
+				if (timeout.isInfinite()) {
+					this->noTasksEv.wait(lck, predicate);
+				} else if (!this->noTasksEv.wait_until(
+										 lck,
+										 timeout.asTimepoint(),
+										 predicate)) {
+					return true;
+				}
+				if (this->exception) {
+					std::exception_ptr exception{this->exception};
+					this->exception = nullptr;
+					std::rethrow_exception(exception);
+				}
+				return false;
+			}
+		};
 
-		// Task queue.
-		std::queue<Task> tasks;
+		// Time tasks spend queued before they are run, across
+		// all ThreadPools.
+		static inline Metrics::Histogram queueWaitMetric{
+			"rain_thread_pool_queue_wait_seconds",
+			"Time tasks spend queued before running."};
 
-		// Locks this->tasks.
-		mutable std::mutex tasksMtx;
+		private:
+		// A queued Task, and when it was queued.
+		class QueuedTask {
+			public:
+			Task task;
+			std::chrono::steady_clock::time_point timeQueued;
+		};
+
+		// A thread, and the tasks queued from it.
+		class Worker {
+			public:
+			ThreadPool *threadPool;
+			std::size_t idx;
+			WorkStealingDeque<QueuedTask *> tasks;
+			std::thread thread;
+
+			// Set by queueTask to hand an idle Worker work.
+			// Written under idleMtx, but may be read without it.
+			std::atomic_bool woken{false};
+			std::condition_variable wakeEv;
+		};
+
+		// The Worker run by the current thread, if any.
+		static inline thread_local Worker *currentWorker{
+			nullptr};
+
+		// Maximum number of threads the ThreadPool will spawn.
+		// Zero is unbounded.
+		std::atomic_size_t maxThreads;
 
-		// Lock acquisition order is: tasksMtx, threadsMtx,
-		// cIdleThreadsMtx to avoid deadlock.
+		// Workers are allocated in chunks of doubling size, so
+		// that they may be indexed without locking while more
+		// are spawned. Chunk k holds 2^k Workers. Only the
+		// first cThreads Workers are valid.
+		static std::size_t const WORKER_CHUNKS{64};
+		std::unique_ptr<Worker[]> workerChunks[WORKER_CHUNKS];
+		std::atomic_size_t cThreads;
 
-		// Breaks when a new task comes, or when destructing.
-		std::condition_variable newTaskEv,
-			// Breaks when no tasks in progress and no tasks in
-			// queue.
-			noTasksEv;
+		// Locks spawning of Workers.
+		mutable std::mutex threadsMtx;
+
+		// Tasks queued from outside the ThreadPool, and those
+		// which did not fit in it.
+		static std::size_t const INJECTED_TASKS_CAPACITY{
+			std::size_t(1) << 12};
+		LockFreeQueue<QueuedTask *> injectedTasks;
+		std::queue<QueuedTask *> overflowTasks;
+		std::atomic_size_t cOverflowTasks;
+		mutable std::mutex overflowTasksMtx;
+
+		// Tasks are queued by pointer, and the Tasks pointed to
+		// are recycled here once run, so that queueing does not
+		// allocate once the ThreadPool is warm.
+		static std::size_t const FREE_TASKS_CAPACITY{
+			std::size_t(1) << 10};
+		LockFreeQueue<QueuedTask *> freeTasks;
+
+		// Idle Workers, most recently idle last, since those
+		// are more likely to be warm in cache. Idle Workers
+		// look for tasks a few times before sleeping, since
+		// waking a sleeping thread costs far more than a short
+		// search.
+		static std::size_t const IDLE_SEARCHES{64};
+		std::vector<Worker *> idleWorkers;
+		std::atomic_size_t cIdleThreads;
+		mutable std::mutex idleMtx;
+
+		// Tasks queued but not yet taken, and tasks either
+		// queued or in progress.
+		std::atomic_size_t cQueuedTasks, cTasks;
+
+		// Breaks when no tasks in progress and no tasks in
+		// queue.
+		std::mutex noTasksMtx;
+		std::condition_variable noTasksEv;
 
 		// In destructor. No new tasks will be taken.
 		std::atomic_bool destructing;
 
 		public:
-		ThreadPool(std::size_t maxThreads = 0) noexcept :
+		ThreadPool(std::size_t maxThreads = 0) :
 			maxThreads(maxThreads),
+			cThreads(0),
+			injectedTasks(ThreadPool::INJECTED_TASKS_CAPACITY),
+			cOverflowTasks(0),
+			freeTasks(ThreadPool::FREE_TASKS_CAPACITY),
 			cIdleThreads(0),
+			cQueuedTasks(0),
+			cTasks(0),
 			destructing(false) {}
 
 		// Forbid copy/move.
@@ -80,40 +275,24 @@ namespace Rain::Multithreading {
 		ThreadPool(ThreadPool &&) = delete;
 		ThreadPool &operator=(ThreadPool &&) = delete;
 
-		// Getters.
+		// Getters. These are consistent individually, but not
+		// with each other.
 		std::size_t getCQueuedTasks() const noexcept {
-			std::lock_guard<std::mutex> tasksLckGuard(
-				this->tasksMtx);
-			return this->tasks.size();
+			return this->cQueuedTasks;
 		}
 		std::size_t getCBusyThreads() const noexcept {
-			std::lock_guard<std::mutex> tasksLckGuard(
-				this->tasksMtx);
-			std::lock_guard<std::mutex> threadsLckGuard(
-				this->threadsMtx);
-			std::lock_guard<std::mutex> cIdleThreadsLckGuard(
-				this->cIdleThreadsMtx);
-			return this->threads.size() - this->cIdleThreads;
+			std::lock_guard<std::mutex> idleLckGuard(
+				this->idleMtx);
+			return this->cThreads - this->cIdleThreads;
 		}
 		std::size_t getCTasks() const noexcept {
-			std::lock_guard<std::mutex> tasksLckGuard(
-				this->tasksMtx);
-			std::lock_guard<std::mutex> threadsLckGuard(
-				this->threadsMtx);
-			std::lock_guard<std::mutex> cIdleThreadsLckGuard(
-				this->cIdleThreadsMtx);
-			return this->tasks.size() + this->threads.size() -
-				this->cIdleThreads;
+			return this->cTasks;
 		}
 		std::size_t getCIdleThreads() const noexcept {
-			// No need to lock here, since this atomic will always
-			// be consistent by itself.
 			return this->cIdleThreads;
 		}
 		std::size_t getCThreads() const noexcept {
-			std::lock_guard<std::mutex> threadsLckGuard(
-				this->threadsMtx);
-			return this->threads.size();
+			return this->cThreads;
 		}
 		std::size_t getMaxThreads() const noexcept {
 			return this->maxThreads;
@@ -124,165 +303,426 @@ namespace Rain::Multithreading {
 			this->maxThreads = newMaxThreads;
 		}
 
-		void queueTask(Task const &task) {
-			// Any time a new task is added, notify one waiting
-			// thread.
-			std::lock_guard<std::mutex> tasksLckGuard(
-				this->tasksMtx);
-			this->tasks.push(task);
-			this->newTaskEv.notify_one();
+		// The task is queued even if spawning a new thread for
+		// it throws, in which case it is run once an existing
+		// thread frees up.
+		void queueTask(Task &&task) {
+			QueuedTask *queued;
+			if (!this->freeTasks.pop(queued)) {
+				queued = new QueuedTask;
+			}
+			queued->task = std::move(task);
+			queued->timeQueued = std::chrono::steady_clock::now();
+
+			// Counted before it can be taken, so that cTasks never
+			// reaches zero early.
+			this->cTasks++;
+			this->cQueuedTasks++;
+			try {
+				Worker *worker{ThreadPool::currentWorker};
+				if (
+					worker != nullptr && worker->threadPool == this) {
+					worker->tasks.push(queued);
+				} else if (!this->injectedTasks.push(queued)) {
+					std::lock_guard<std::mutex> overflowTasksLckGuard(
+						this->overflowTasksMtx);
+					this->overflowTasks.push(queued);
+					this->cOverflowTasks++;
+				}
+			} catch (...) {
+				this->cQueuedTasks--;
+				this->cTasks--;
+				delete queued;
+				throw;
+			}
+
+			// Pairs with the fence in idle, so that either this
+			// sees the idle Worker, or it sees this task.
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (this->cIdleThreads != 0) {
+				std::lock_guard<std::mutex> idleLckGuard(
+					this->idleMtx);
+				if (!this->idleWorkers.empty()) {
+					Worker *worker{this->idleWorkers.back()};
+					this->idleWorkers.pop_back();
+					this->cIdleThreads--;
+					worker->woken = true;
+					worker->wakeEv.notify_one();
+					return;
+				}
+			}
 
 			// If no threads free, make a new thread if possible.
+			//
+			// May cause exception to try again if system resources
+			// are not available. In that case, it is good to set
+			// the max thread limit.
 			std::lock_guard<std::mutex> threadsLckGuard(
 				this->threadsMtx);
-			std::lock_guard<std::mutex> cIdleThreadsLckGuard(
-				this->cIdleThreadsMtx);
+			std::size_t cThreads{this->cThreads};
 			if (
-				this->cIdleThreads == 0 &&
-				(this->maxThreads == 0 ||
-					this->threads.size() < this->maxThreads)) {
-				// May cause exception to try again if system
-				// resources are not available. In that case, it is
-				// good to set the max thread limit.
-				this->threads.push_back(
-					std::thread(ThreadPool::threadFnc, this));
+				this->maxThreads != 0 &&
+				cThreads >= this->maxThreads) {
+				return;
+			}
+			std::size_t chunk{ThreadPool::chunkOf(cThreads)};
+			if (!this->workerChunks[chunk]) {
+				this->workerChunks[chunk].reset(
+					new Worker[std::size_t(1) << chunk]);
+			}
+			Worker &worker{this->worker(cThreads)};
+			worker.threadPool = this;
+			worker.idx = cThreads;
+
+			// Published before the thread starts, so that it is
+			// never idle while uncounted.
+			this->cThreads = cThreads + 1;
+			try {
+				worker.thread =
+					std::thread(ThreadPool::threadFnc, this, &worker);
+			} catch (...) {
+				this->cThreads = cThreads;
+				throw;
 			}
 		}
 
-		// Thread function.
-		// If Task throws, the error is ignored to stderr.
-		static void threadFnc(ThreadPool *threadPool) {
-			while (!threadPool->destructing) {
-				// Wait until task or destruction.
-				std::unique_ptr<Task> task;
-
-				// RAII incrementation in case of exception, with
-				// unique_ptr allowing for delayed initialization.
-				std::unique_ptr<
-					Error::Incrementer<std::atomic_size_t>>
-					incrementer;
-
-				{
-					// Before a thread idles, check to trigger a tasks
-					// done event.
-					std::unique_lock<std::mutex> tasksLck(
-						threadPool->tasksMtx);
-					{
-						std::lock_guard<std::mutex> threadsLckGuard(
-							threadPool->threadsMtx);
-						std::lock_guard<std::mutex>
-							cIdleThreadsLckGuard(
-								threadPool->cIdleThreadsMtx);
-
-						// Increment via constructor.
-						// If failure before destructor, the
-						// decrementing destructor will be called
-						// automatically.
-						incrementer.reset(new Error::Incrementer(
-							threadPool->cIdleThreads));
-
-						if (
-							threadPool->tasks.empty() &&
-							threadPool->cIdleThreads ==
-								threadPool->threads.size()) {
-							threadPool->noTasksEv.notify_all();
-						}
-					}
+		// Block until all tasks completed and none are in
+		// queue, or up to a timeout. Return false if all tasks
+		// completed, or true on timeout.
+		bool blockForTasks(Time::Timeout timeout = {}) {
+			std::unique_lock<std::mutex> noTasksLck(
+				this->noTasksMtx);
+			auto predicate = [this]() {
+				return this->cTasks == 0;
+			};
 
-					// Idle with just the tasksLck lock.
-					threadPool->newTaskEv.wait(
-						tasksLck, [threadPool]() {
-							return !threadPool->tasks.empty() ||
-								threadPool->destructing;
-						});
+			if (timeout.isInfinite()) {
+				this->noTasksEv.wait(noTasksLck, predicate);
+				return false;
+			} else {
+				return !this->noTasksEv.wait_until(
+					noTasksLck, timeout.asTimepoint(), predicate);
+			}
+		}
+
+		// Queues a callable, and returns a future for its
+		// result, or the exception it throws.
+		//
+		// Tasks which wait on futures block their thread
+		// without running other tasks; prefer TaskGroup there.
+		template<
+			typename Callable,
+			typename Result =
+				std::invoke_result_t<std::decay_t<Callable> &>>
+		std::future<Result> submit(Callable &&callable) {
+			std::packaged_task<Result()> task(
+				std::forward<Callable>(callable));
+			std::future<Result> future{task.get_future()};
+			this->queueTask(
+				[task = std::move(task)]() mutable { task(); });
+			return future;
+		}
 
-					{
-						std::lock_guard<std::mutex> threadsLckGuard(
-							threadPool->threadsMtx);
-						std::lock_guard<std::mutex>
-							cIdleThreadsLckGuard(
-								threadPool->cIdleThreadsMtx);
+		// Calls callable(idx) for every idx in [begin, end),
+		// split into chunks of up to grain indices which are run
+		// in parallel. Blocks until all have completed, and
+		// rethrows the first exception thrown, if any.
+		//
+		// By default, the range is split into a few chunks per
+		// thread the ThreadPool may run.
+		template<typename Index, typename Callable>
+		void parallelFor(
+			Index begin,
+			Index end,
+			Callable &&callable,
+			std::size_t grain = 0) {
+			if (begin >= end) {
+				return;
+			}
+			std::size_t size{
+				static_cast<std::size_t>(end - begin)};
+			grain = this->defaultGrain(size, grain);
+			auto const at = [begin, size](std::size_t offset) {
+				return begin +
+					static_cast<Index>(std::min(size, offset));
+			};
 
-						// Decrement via destructor.
-						incrementer.reset();
-					}
+			// The calling thread runs the first chunk itself.
+			TaskGroup taskGroup(*this);
+			for (std::size_t offset{grain}; offset < size;
+					 offset += grain) {
+				taskGroup.queueTask(
+					[&callable,
+						low{at(offset)},
+						high{at(offset + grain)}]() {
+						for (Index idx{low}; idx < high; idx++) {
+							callable(idx);
+						}
+					});
+			}
+			for (Index idx{begin}; idx < at(grain); idx++) {
+				callable(idx);
+			}
+			taskGroup.wait();
+		}
 
-					// Exit if necessary.
-					if (threadPool->destructing) {
-						return;
+		// Reduces transform(idx) for every idx in [begin, end)
+		// with reduce, starting from identity, in chunks of up
+		// to grain indices which are run in parallel. reduce
+		// must be associative, but need not be commutative:
+		// partial results are combined in order.
+		template<
+			typename Index,
+			typename Value,
+			typename Transform,
+			typename Reduce>
+		Value parallelReduce(
+			Index begin,
+			Index end,
+			Value identity,
+			Transform &&transform,
+			Reduce &&reduce,
+			std::size_t grain = 0) {
+			if (begin >= end) {
+				return identity;
+			}
+			std::size_t size{
+				static_cast<std::size_t>(end - begin)};
+			grain = this->defaultGrain(size, grain);
+
+			std::vector<Value> partials(
+				(size + grain - 1) / grain, identity);
+			this->parallelFor(
+				std::size_t(0),
+				partials.size(),
+				[&](std::size_t chunk) {
+					Index low{
+						begin + static_cast<Index>(chunk * grain)},
+						high{
+							begin +
+							static_cast<Index>(
+								std::min(size, (chunk + 1) * grain))};
+					for (Index idx{low}; idx < high; idx++) {
+						partials[chunk] = reduce(
+							std::move(partials[chunk]), transform(idx));
 					}
+				},
+				1);
 
-					// Otherwise, take a task.
-					task.reset(new Task(threadPool->tasks.front()));
-					threadPool->tasks.pop();
+			Value result{std::move(identity)};
+			for (Value &partial : partials) {
+				result =
+					reduce(std::move(result), std::move(partial));
+			}
+			return result;
+		}
 
-					// Release tasksMtx.
+		~ThreadPool() {
+			// Break any idle threads. Workers check destructing
+			// under idleMtx before idling.
+			this->destructing = true;
+			{
+				std::lock_guard<std::mutex> idleLckGuard(
+					this->idleMtx);
+				for (Worker *worker : this->idleWorkers) {
+					worker->wakeEv.notify_one();
 				}
+			}
 
-				// Execute the task. Task pointer is automatically
-				// freed afterwards.
-				Rain::Error::consumeThrowable(
-					*task, std::source_location::current())();
+			// Wait on remaining busy threads to shutdown.
+			// Any tasks not completed at this point won't be
+			// completed, and are freed here.
+			for (std::size_t idx{0}; idx < this->cThreads; idx++) {
+				if (this->worker(idx).thread.joinable()) {
+					this->worker(idx).thread.join();
+				}
+			}
+			QueuedTask *task;
+			while (this->takeTask(nullptr, task)) {
+				delete task;
+			}
+			while (this->freeTasks.pop(task)) {
+				delete task;
 			}
 		}
 
-		// Block until all tasks completed and none are in
-		// queue, or up to a timeout. Return false if all tasks
-		// completed, or true on timeout.
-		bool blockForTasks(Time::Timeout timeout = {}) {
-			// If no tasks, return immediately.
-			{
-				std::lock_guard<std::mutex> tasksLckGuard(
-					this->tasksMtx);
-				std::lock_guard<std::mutex> threadsLckGuard(
-					this->threadsMtx);
-				std::lock_guard<std::mutex> cIdleThreadsLckGuard(
-					this->cIdleThreadsMtx);
-				if (
-					this->tasks.size() == 0 &&
-					this->cIdleThreads == this->threads.size()) {
-					return false;
+		private:
+		// Chunk holding the Worker at idx.
+		static std::size_t chunkOf(std::size_t idx) noexcept {
+			return static_cast<std::size_t>(
+							 std::bit_width(idx + 1)) -
+				1;
+		}
+		Worker &worker(std::size_t idx) const noexcept {
+			std::size_t chunk{ThreadPool::chunkOf(idx)};
+			return this->workerChunks[chunk]
+				[idx + 1 - (std::size_t(1) << chunk)];
+		}
+
+		// Chunks per thread of a parallelFor without grain, so
+		// that threads which finish early can steal more work.
+		static std::size_t const CHUNKS_PER_THREAD{4};
+
+		// Grain to split size indices into, if not specified.
+		std::size_t defaultGrain(
+			std::size_t size,
+			std::size_t grain) const noexcept {
+			if (grain != 0) {
+				return grain;
+			}
+			std::size_t cThreads{this->maxThreads};
+			if (cThreads == 0) {
+				cThreads = std::max(
+					std::size_t(1),
+					static_cast<std::size_t>(
+						std::thread::hardware_concurrency()));
+			}
+			std::size_t cChunks{
+				cThreads * ThreadPool::CHUNKS_PER_THREAD};
+			return std::max(
+				std::size_t(1), (size + cChunks - 1) / cChunks);
+		}
+
+		// Takes a task from the Worker's own deque, the shared
+		// queue, or another Worker, in that order. worker may
+		// be nullptr to only take from others.
+		bool takeTask(Worker *worker, QueuedTask *&task) {
+			bool taken{
+				worker != nullptr && worker->tasks.pop(task)};
+			taken = taken || this->injectedTasks.pop(task);
+			if (!taken && this->cOverflowTasks != 0) {
+				std::lock_guard<std::mutex> overflowTasksLckGuard(
+					this->overflowTasksMtx);
+				if (!this->overflowTasks.empty()) {
+					task = this->overflowTasks.front();
+					this->overflowTasks.pop();
+					this->cOverflowTasks--;
+					taken = true;
 				}
 			}
 
-			// Otherwise, wait for event.
-			std::unique_lock<std::mutex> tasksLck(this->tasksMtx);
-			auto predicate = [this]() {
-				// tasksMtx is locked in predicate.
-
-				std::lock_guard<std::mutex> threadsLckGuard(
-					this->threadsMtx);
-				std::lock_guard<std::mutex> cIdleThreadsLckGuard(
-					this->cIdleThreadsMtx);
-				return this->tasks.empty() &&
-					this->cIdleThreads == this->threads.size();
-			};
+			// Steal round-robin, starting after this Worker, to
+			// spread thieves across victims.
+			std::size_t cThreads{this->cThreads},
+				start{worker == nullptr ? 0 : worker->idx + 1};
+			for (std::size_t idx{0}; !taken && idx < cThreads;
+					 idx++) {
+				Worker &victim{
+					this->worker((start + idx) % cThreads)};
+				taken =
+					&victim != worker && victim.tasks.steal(task);
+			}
 
-			if (timeout.isInfinite()) {
-				this->noTasksEv.wait(tasksLck, predicate);
+			if (taken) {
+				this->cQueuedTasks--;
+			}
+			return taken;
+		}
+
+		// Idles the Worker until it is woken by queueTask or
+		// destruction. Returns true if a task was found on the
+		// way to idling instead.
+		bool idle(Worker *worker, QueuedTask *&task) {
+			std::unique_lock<std::mutex> idleLck(this->idleMtx);
+			if (this->destructing) {
 				return false;
-			} else {
-				return !this->noTasksEv.wait_until(
-					tasksLck, timeout.asTimepoint(), predicate);
 			}
+			this->idleWorkers.push_back(worker);
+			this->cIdleThreads++;
+
+			// A task queued before this Worker was idle may not
+			// have woken anyone, so look at least once more.
+			idleLck.unlock();
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			bool taken{false};
+			for (std::size_t search{0};
+					 !taken && !worker->woken &&
+					 search < ThreadPool::IDLE_SEARCHES;
+					 search++) {
+				taken = this->takeTask(worker, task);
+				if (!taken) {
+					std::this_thread::yield();
+				}
+			}
+			idleLck.lock();
+
+			if (!taken) {
+				worker->wakeEv.wait(idleLck, [this, worker]() {
+					return worker->woken || this->destructing;
+				});
+			} else if (!worker->woken) {
+				this->idleWorkers.erase(std::find(
+					this->idleWorkers.begin(),
+					this->idleWorkers.end(),
+					worker));
+				this->cIdleThreads--;
+			}
+			worker->woken = false;
+			return taken;
 		}
 
-		~ThreadPool() {
-			// Break any idle threads.
-			this->destructing = true;
-			this->newTaskEv.notify_all();
+		// Thread function.
+		// If Task throws, the error is ignored to stderr.
+		static void threadFnc(
+			ThreadPool *threadPool,
+			Worker *worker) {
+			ThreadPool::currentWorker = worker;
+			QueuedTask *task;
+			while (!threadPool->destructing) {
+				if (
+					!threadPool->takeTask(worker, task) &&
+					!threadPool->idle(worker, task)) {
+					continue;
+				}
 
-			// Wait on remaining busy threads to shutdown.
-			// Any tasks not completed at this point won't be
-			// completed. Do not need to lock mutexes, since only
-			// ThreadFnc may be executing here, and that does not
-			// modify this->threads.
-			for (
-				auto it{this->threads.begin()};
-				it != this->threads.end();
-				it++) {
-				it->join();
+				if (threadPool->destructing) {
+					delete task;
+					return;
+				}
+
+				threadPool->runTask(task);
+			}
+		}
+
+		// Runs a task taken from the queue, then destroys its
+		// captures and recycles it.
+		void runTask(QueuedTask *task) {
+			ThreadPool::queueWaitMetric.record(
+				std::chrono::steady_clock::now() - task->timeQueued);
+			Rain::Error::consumeThrowable(
+				[task]() { task->task(); },
+				std::source_location::current())();
+			task->task = nullptr;
+			if (!this->freeTasks.push(task)) {
+				delete task;
+			}
+
+			if (--this->cTasks == 0) {
+				std::lock_guard<std::mutex> noTasksLckGuard(
+					this->noTasksMtx);
+				this->noTasksEv.notify_all();
+			}
+		}
+
+		// Runs a single queued task on the calling thread, if
+		// it is a thread of this ThreadPool. Tasks queued from
+		// this thread are preferred.
+		//
+		// Other threads do not run tasks, since they may be
+		// long-running tasks unrelated to the caller.
+		bool runQueuedTask() {
+			Worker *worker{ThreadPool::currentWorker};
+			if (
+				worker == nullptr || worker->threadPool != this ||
+				this->destructing) {
+				return false;
+			}
+			QueuedTask *task;
+			if (!this->takeTask(worker, task)) {
+				return false;
 			}
+			this->runTask(task);
+			return true;
 		}
 	};
 }
@@ -0,0 +1,183 @@
+// Lock-free single-owner deque from which other threads may
+// steal, after Chase and Lev.
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace Rain::Multithreading {
+	// Lock-free single-owner deque from which other threads
+	// may steal, after Chase and Lev (2005), with the memory
+	// orderings of Lê et al. (2013).
+	//
+	// Only the owning thread may push and pop, at the bottom.
+	// Any thread may steal from the top. The deque grows
+	// without bound; arrays which are outgrown are kept alive
+	// until destruction, since thieves may still be reading
+	// from them.
+	//
+	// Value must be trivially copyable, and is usually a
+	// pointer.
+	template<typename Value>
+	class WorkStealingDeque {
+		static_assert(std::is_trivially_copyable_v<Value>);
+
+		private:
+		// Circular array with capacity a power of two.
+		class Array {
+			public:
+			std::size_t const capacity;
+			std::unique_ptr<std::atomic<Value>[]> const values;
+
+			// The array this one was grown from.
+			std::unique_ptr<Array> const previous;
+
+			Array(
+				std::size_t capacity,
+				std::unique_ptr<Array> &&previous = {}) :
+				capacity(capacity),
+				values(new std::atomic<Value>[capacity]),
+				previous(std::move(previous)) {}
+
+			Value get(std::ptrdiff_t idx) const noexcept {
+				return this->values[static_cast<std::size_t>(idx) &
+					(this->capacity - 1)]
+					.load(std::memory_order_relaxed);
+			}
+			void put(std::ptrdiff_t idx, Value value) noexcept {
+				this->values[static_cast<std::size_t>(idx) &
+					(this->capacity - 1)]
+					.store(value, std::memory_order_relaxed);
+			}
+		};
+
+		// Values occupy [top, bottom).
+		std::atomic<std::ptrdiff_t> top, bottom;
+		std::atomic<Array *> array;
+
+		// Owns array and, through it, all outgrown arrays.
+		std::unique_ptr<Array> arrayOwner;
+
+		public:
+		WorkStealingDeque(std::size_t capacity = 64) :
+			top(0),
+			bottom(0),
+			arrayOwner(new Array(std::bit_ceil(capacity))) {
+			this->array.store(
+				this->arrayOwner.get(), std::memory_order_relaxed);
+		}
+
+		// Forbid copy/move.
+		WorkStealingDeque(WorkStealingDeque const &) = delete;
+		WorkStealingDeque &operator=(WorkStealingDeque const &) =
+			delete;
+		WorkStealingDeque(WorkStealingDeque &&) = delete;
+		WorkStealingDeque &operator=(WorkStealingDeque &&) =
+			delete;
+
+		// Approximate if called concurrently.
+		std::size_t size() const noexcept {
+			std::ptrdiff_t bottom{
+				this->bottom.load(std::memory_order_relaxed)},
+				top{this->top.load(std::memory_order_relaxed)};
+			return bottom > top
+				? static_cast<std::size_t>(bottom - top)
+				: 0;
+		}
+		bool empty() const noexcept { return this->size() == 0; }
+
+		// Owner only. May throw if growing fails.
+		void push(Value value) {
+			std::ptrdiff_t bottom{
+				this->bottom.load(std::memory_order_relaxed)},
+				top{this->top.load(std::memory_order_acquire)};
+			Array *array{
+				this->array.load(std::memory_order_relaxed)};
+			if (
+				bottom - top >
+				static_cast<std::ptrdiff_t>(array->capacity) - 1) {
+				array = this->grow(array, top, bottom);
+			}
+			array->put(bottom, value);
+			std::atomic_thread_fence(std::memory_order_release);
+			this->bottom.store(
+				bottom + 1, std::memory_order_relaxed);
+		}
+
+		// Owner only. Returns false if empty.
+		bool pop(Value &value) noexcept {
+			std::ptrdiff_t bottom{
+				this->bottom.load(std::memory_order_relaxed) - 1};
+			Array *array{
+				this->array.load(std::memory_order_relaxed)};
+			this->bottom.store(bottom, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			std::ptrdiff_t top{
+				this->top.load(std::memory_order_relaxed)};
+
+			if (top > bottom) {
+				this->bottom.store(
+					bottom + 1, std::memory_order_relaxed);
+				return false;
+			}
+
+			value = array->get(bottom);
+			if (top == bottom) {
+				// Last value races with thieves.
+				bool won{this->top.compare_exchange_strong(
+					top,
+					top + 1,
+					std::memory_order_seq_cst,
+					std::memory_order_relaxed)};
+				this->bottom.store(
+					bottom + 1, std::memory_order_relaxed);
+				return won;
+			}
+			return true;
+		}
+
+		// Any thread. Returns false only if empty; contention
+		// with other thieves is retried.
+		bool steal(Value &value) noexcept {
+			while (true) {
+				std::ptrdiff_t top{
+					this->top.load(std::memory_order_acquire)};
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				std::ptrdiff_t bottom{
+					this->bottom.load(std::memory_order_acquire)};
+				if (top >= bottom) {
+					return false;
+				}
+
+				value = this->array.load(std::memory_order_acquire)
+									->get(top);
+				if (this->top.compare_exchange_strong(
+							top,
+							top + 1,
+							std::memory_order_seq_cst,
+							std::memory_order_relaxed)) {
+					return true;
+				}
+			}
+		}
+
+		private:
+		// Owner only. Doubles the capacity of array.
+		Array *grow(
+			Array *array,
+			std::ptrdiff_t top,
+			std::ptrdiff_t bottom) {
+			Array *grown{new Array(
+				2 * array->capacity, std::move(this->arrayOwner))};
+			this->arrayOwner.reset(grown);
+			for (std::ptrdiff_t idx{top}; idx < bottom; idx++) {
+				grown->put(idx, array->get(idx));
+			}
+			this->array.store(grown, std::memory_order_release);
+			return grown;
+		}
+	};
+}
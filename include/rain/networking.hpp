@@ -1,20 +1,29 @@
 // Includes all /networking headers.
 #pragma once
 
+#include "networking/awaitable_socket.hpp"
+#include "networking/buffer_pool.hpp"
 #include "networking/client.hpp"
 #include "networking/exception.hpp"
 #include "networking/host.hpp"
 #include "networking/http.hpp"
+#include "networking/http2.hpp"
 #include "networking/media_type.hpp"
 #include "networking/native_socket.hpp"
+#include "networking/rate_limiter.hpp"
+#include "networking/reactor.hpp"
 #include "networking/req_res.hpp"
 #include "networking/resolve.hpp"
+#include "networking/resolver.hpp"
 #include "networking/server.hpp"
 #include "networking/smtp.hpp"
 #include "networking/socket.hpp"
 #include "networking/socket_option.hpp"
 #include "networking/specification.hpp"
+#include "networking/task.hpp"
 #include "networking/tcp.hpp"
 #include "networking/tls.hpp"
+#include "networking/waker.hpp"
+#include "networking/websocket.hpp"
 #include "networking/worker.hpp"
 #include "networking/wsa.hpp"
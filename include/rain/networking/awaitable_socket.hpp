@@ -0,0 +1,167 @@
+// Awaitable send, recv, and connect, which await readiness
+// on a Reactor instead of polling.
+//
+// These are kept apart from socket.hpp, so that Sockets
+// which do not use a Reactor do not include it.
+#pragma once
+
+#include "client.hpp"
+#include "reactor.hpp"
+#include "socket.hpp"
+#include "task.hpp"
+
+#include <string>
+#include <vector>
+
+namespace Rain::Networking {
+	// Adds awaitable send and recv overloads to a connected
+	// Socket, so that the awaiting coroutine does not hold
+	// its thread while waiting. The coroutine is resumed on
+	// the event loop of the Reactor. Otherwise, these behave
+	// as send and recv, and the buffer must outlive the Task.
+	//
+	// Both are attempted before awaiting, as on optimistic
+	// Sockets.
+	template<typename Socket>
+	class AwaitableSocket : public Socket {
+		public:
+		using Socket::Socket;
+		using Socket::send;
+		using Socket::recv;
+
+		Task<std::size_t> send(
+			Reactor &reactor,
+			char const *buffer,
+			std::size_t bufferLen,
+			Time::Timeout timeout = 15s) {
+			std::size_t bytesSent{0};
+			while (bytesSent < bufferLen) {
+				auto result{::send(
+					this->nativeSocket(),
+#ifdef RAIN_PLATFORM_WINDOWS
+					buffer + bytesSent,
+					static_cast<int>(bufferLen - bytesSent),
+					0)};
+#else
+					reinterpret_cast<const void *>(buffer + bytesSent),
+					bufferLen - bytesSent,
+					MSG_NOSIGNAL)};
+#endif
+				if (
+					result == NATIVE_SOCKET_ERROR &&
+					getSystemError() == Error::WOULD_BLOCK) {
+					if (!co_await reactor.ready(
+								this->nativeSocket(),
+								Reactor::Interest::WRITE,
+								timeout)) {
+						break;
+					}
+					continue;
+				}
+				bytesSent += validateSystemCall(result);
+			}
+			this->sentBytesMetric.add(bytesSent);
+			co_return bytesSent;
+		}
+		Task<std::size_t> send(
+			Reactor &reactor,
+			std::string const &buffer,
+			Time::Timeout timeout = 15s) {
+			return this->send(
+				reactor, &buffer[0], buffer.length(), timeout);
+		}
+		Task<std::size_t> recv(
+			Reactor &reactor,
+			char *buffer,
+			std::size_t bufferLen,
+			Time::Timeout timeout = 15s) {
+			while (true) {
+				auto result{::recv(
+					this->nativeSocket(),
+#ifdef RAIN_PLATFORM_WINDOWS
+					buffer,
+					static_cast<int>(bufferLen),
+#else
+					reinterpret_cast<void *>(buffer),
+					bufferLen,
+#endif
+					0)};
+				if (
+					result != NATIVE_SOCKET_ERROR ||
+					getSystemError() != Error::WOULD_BLOCK) {
+					std::size_t cReceived{static_cast<std::size_t>(
+						validateSystemCall(result))};
+					this->receivedBytesMetric.add(cReceived);
+					co_return cReceived;
+				}
+				if (!co_await reactor.ready(
+							this->nativeSocket(),
+							Reactor::Interest::READ,
+							timeout)) {
+					co_return 0;
+				}
+			}
+		}
+		Task<std::size_t> recv(
+			Reactor &reactor,
+			std::string &buffer,
+			Time::Timeout timeout = 15s) {
+			buffer.resize(buffer.capacity());
+			std::size_t result{co_await this->recv(
+				reactor, &buffer[0], buffer.length(), timeout)};
+			buffer.resize(result);
+			co_return result;
+		}
+	};
+
+	// Additionally adds an awaitable connect to a Client
+	// constructed without a target. Addresses are attempted
+	// in order, each with the remaining timeout, on a new
+	// Socket each. Throws on failure, as with the
+	// constructors.
+	template<typename Client>
+	class AwaitableClient : public AwaitableSocket<Client> {
+		public:
+		using AwaitableSocket<Client>::AwaitableSocket;
+
+		Task<> connect(
+			Reactor &reactor,
+			std::vector<AddressInfo> addressInfos,
+			Time::Timeout timeout = 15s) {
+			for (AddressInfo const &addressInfo : addressInfos) {
+				AwaitableClient attempt;
+				bool connected{false};
+				try {
+					connected =
+						!ClientSocketSpecInterface::connectBegin(
+							attempt.nativeSocket(), addressInfo);
+				} catch (...) {
+					continue;
+				}
+				if (
+					!connected &&
+					co_await reactor.ready(
+						attempt.nativeSocket(),
+						Reactor::Interest::WRITE,
+						timeout)) {
+					// Readiness includes failure, which poll tells
+					// apart.
+					connected = ClientSocketSpecInterface::isConnected(
+						SocketInterface::poll(
+							std::vector<NativeSocket>{
+								attempt.nativeSocket()},
+							{SocketInterface::PollFlag::WRITE_NORMAL},
+							0s)[0]);
+				}
+				if (connected) {
+					this->swap(&attempt);
+					co_return;
+				}
+				if (timeout.isPassed()) {
+					break;
+				}
+			}
+			throw Exception(Error::TIMED_OUT);
+		}
+	};
+}
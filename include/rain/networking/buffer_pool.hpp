@@ -0,0 +1,211 @@
+// Thread-safe pool of size-classed buffers, shared by the
+// streambufs of connected Sockets.
+#pragma once
+
+#include "../literal.hpp"
+#include "../metrics.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Rain::Networking {
+	// Thread-safe pool of buffers, in power-of-two size
+	// classes between minLength and maxLength, so that
+	// connections may grow and release their buffers without
+	// allocating each time.
+	//
+	// Each class keeps at most maxIdleBytes of idle buffers;
+	// any more are freed when returned. Buffers longer than
+	// maxLength are allocated exactly, and freed when
+	// returned, without counting towards hits or misses.
+	class BufferPool {
+		public:
+		// Owning handle to a buffer of a BufferPool, which
+		// returns it to the pool on destruction. Empty handles
+		// hold no buffer.
+		class Buffer {
+			friend BufferPool;
+
+			private:
+			BufferPool *pool{nullptr};
+			char *_data{nullptr};
+			std::size_t length{0};
+
+			Buffer(
+				BufferPool *pool,
+				char *data,
+				std::size_t length) :
+				pool(pool),
+				_data(data),
+				length(length) {}
+
+			public:
+			Buffer() = default;
+			~Buffer() { this->reset(); }
+
+			// Move-only.
+			Buffer(Buffer const &) = delete;
+			Buffer &operator=(Buffer const &) = delete;
+			Buffer(Buffer &&other) noexcept :
+				pool(other.pool),
+				_data(other._data),
+				length(other.length) {
+				other._data = nullptr;
+				other.length = 0;
+			}
+			Buffer &operator=(Buffer &&other) noexcept {
+				if (this != &other) {
+					this->reset();
+					std::swap(this->pool, other.pool);
+					std::swap(this->_data, other._data);
+					std::swap(this->length, other.length);
+				}
+				return *this;
+			}
+
+			char *data() const noexcept { return this->_data; }
+			std::size_t size() const noexcept {
+				return this->length;
+			}
+			explicit operator bool() const noexcept {
+				return this->_data != nullptr;
+			}
+
+			// Returns the buffer to its pool, leaving the handle
+			// empty.
+			void reset() noexcept {
+				if (this->_data != nullptr) {
+					this->pool->release(this->_data, this->length);
+					this->_data = nullptr;
+					this->length = 0;
+				}
+			}
+		};
+
+		// Hits and misses across all BufferPools.
+		static inline Metrics::Counter hitsMetric{
+			"rain_buffer_pool_hits_total",
+			"Buffers acquired from an idle buffer of a pool."},
+			missesMetric{
+				"rain_buffer_pool_misses_total",
+				"Buffers acquired by allocating anew."};
+
+		private:
+		// Idle buffers of one size class.
+		struct SizeClass {
+			std::mutex mtx;
+			std::vector<std::unique_ptr<char[]>> idle;
+		};
+
+		std::size_t const _minLength, _maxLength, maxIdleBytes;
+		std::vector<SizeClass> sizeClasses;
+		std::atomic_uint64_t cHits{0}, cMisses{0};
+
+		// Index of the smallest class of at least length,
+		// which must be at most maxLength.
+		std::size_t sizeClassOf(
+			std::size_t length) const noexcept {
+			return static_cast<std::size_t>(
+				std::countr_zero(std::bit_ceil(
+					std::max(length, this->_minLength)))) -
+				static_cast<std::size_t>(
+					std::countr_zero(this->_minLength));
+		}
+
+		void release(char *data, std::size_t length) noexcept {
+			std::unique_ptr<char[]> buffer(data);
+			if (length > this->_maxLength) {
+				return;
+			}
+			SizeClass &sizeClass{
+				this->sizeClasses[this->sizeClassOf(length)]};
+			std::lock_guard lck(sizeClass.mtx);
+			if (
+				(sizeClass.idle.size() + 1) * length <=
+				this->maxIdleBytes) {
+				// Capacity is reserved on construction, so this
+				// does not throw.
+				sizeClass.idle.push_back(std::move(buffer));
+			}
+		}
+
+		public:
+		// Lengths are rounded up to powers of two.
+		BufferPool(
+			std::size_t minLength = 1_zu << 12,
+			std::size_t maxLength = 1_zu << 18,
+			std::size_t maxIdleBytes = 1_zu << 22) :
+			_minLength(std::bit_ceil(std::max(minLength, 1_zu))),
+			_maxLength(
+				std::max(this->_minLength, std::bit_ceil(maxLength))),
+			maxIdleBytes(maxIdleBytes),
+			sizeClasses(this->sizeClassOf(this->_maxLength) + 1) {
+			for (std::size_t idx{0}; idx < this->sizeClasses.size();
+					 idx++) {
+				this->sizeClasses[idx].idle.reserve(
+					this->maxIdleBytes / (this->_minLength << idx));
+			}
+		}
+
+		// Forbid copy/move, as Buffers refer to their pool.
+		BufferPool(BufferPool const &) = delete;
+		BufferPool &operator=(BufferPool const &) = delete;
+		BufferPool(BufferPool &&) = delete;
+		BufferPool &operator=(BufferPool &&) = delete;
+
+		std::size_t minLength() const noexcept {
+			return this->_minLength;
+		}
+		std::size_t maxLength() const noexcept {
+			return this->_maxLength;
+		}
+
+		// Acquires a buffer of at least length, from the
+		// smallest class which fits.
+		Buffer acquire(std::size_t length) {
+			if (length > this->_maxLength) {
+				return {this, new char[length], length};
+			}
+			std::size_t const sizeClassIdx{
+				this->sizeClassOf(length)};
+			std::size_t const classLength{
+				this->_minLength << sizeClassIdx};
+			SizeClass &sizeClass{this->sizeClasses[sizeClassIdx]};
+			{
+				std::lock_guard lck(sizeClass.mtx);
+				if (!sizeClass.idle.empty()) {
+					char *data{sizeClass.idle.back().release()};
+					sizeClass.idle.pop_back();
+					this->cHits++;
+					BufferPool::hitsMetric.add();
+					return {this, data, classLength};
+				}
+			}
+			this->cMisses++;
+			BufferPool::missesMetric.add();
+			return {this, new char[classLength], classLength};
+		}
+
+		// Acquires which reused an idle buffer, and which
+		// allocated anew, respectively.
+		std::uint64_t hits() const noexcept {
+			return this->cHits;
+		}
+		std::uint64_t misses() const noexcept {
+			return this->cMisses;
+		}
+
+		// Pool for Sockets which do not belong to a Server.
+		// Never destroyed, so that Sockets destroyed during
+		// static destruction may still return their buffers.
+		static BufferPool &global() {
+			static BufferPool *pool{new BufferPool};
+			return *pool;
+		}
+	};
+}
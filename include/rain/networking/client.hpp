@@ -3,9 +3,12 @@
 // Host or AddressInfo on construct.
 #pragma once
 
+#include "resolver.hpp"
 #include "socket.hpp"
 
-#include <future>
+#include <algorithm>
+#include <memory>
+#include <vector>
 
 namespace Rain::Networking {
 	class ClientSocketSpecInterfaceInterface :
@@ -22,16 +25,18 @@ namespace Rain::Networking {
 			ClientSocketSpecInterfaceInterface;
 
 		public:
-		// Code-sharing: connect any opened NativeSocket to a
-		// single AddressInfo. Returns false on success, true on
-		// failure.
-		//
-		// The templates given to ClientSocket do not matter to
-		// this function.
-		static bool connect(
+		// Delay between staggered connects to successive
+		// addresses, as recommended by RFC 8305.
+		static inline std::chrono::milliseconds const
+			CONNECTION_ATTEMPT_DELAY{250};
+
+		// Begins a connect on any opened NativeSocket to a
+		// single AddressInfo. Returns true if the connect is in
+		// progress, and must be awaited by poll, and false if
+		// it completed immediately. Throws on error.
+		static bool connectBegin(
 			NativeSocket nativeSocket,
-			AddressInfo const &addressInfo,
-			Time::Timeout timeout = 15s) {
+			AddressInfo const &addressInfo) {
 			Error connectError{Error::NONE};
 			if (
 				::connect(
@@ -51,30 +56,49 @@ namespace Rain::Networking {
 					// Both of these flags arise for non-blocking
 					// sockets, and necessitate waiting for connect
 					// via poll.
-					break;
+					return true;
 				default:
 					// Unexpected error.
 					throw Exception(static_cast<Error>(connectError));
 			}
+		}
 
-			// connect has returned IN_PROGRESS or WOULD_BLOCK for
-			// this non-blocking socket, and we should wait with
-			// poll. If returned event is not EXACTLY
-			// WRITE_NORMAL, then return failure instead.
-			//
-			// Note that send/recv are more permissive in their
-			// poll return checking; they allow of any combination
-			// of flags as long as READ_NORMAL/WRITE_NORMAL is
-			// included. It is okay to be as permissive on
-			// POSIX-systems for poll after connect, but on
-			// Windows, WRITE_NORMAL may return even though an
-			// error was triggered and connect failed. Thus, we
-			// need to be stricter here, as it does not affect
-			// POSIX connected-checking either.
-			return SocketInterface::poll(
-							 std::vector<NativeSocket>{nativeSocket},
-							 {PollFlag::WRITE_NORMAL},
-							 timeout)[0] != PollFlag::WRITE_NORMAL;
+		// Whether poll events returned for an in-progress
+		// connect indicate success. If returned event is not
+		// EXACTLY WRITE_NORMAL, then connect has failed.
+		//
+		// Note that send/recv are more permissive in their poll
+		// return checking; they allow of any combination of
+		// flags as long as READ_NORMAL/WRITE_NORMAL is
+		// included. It is okay to be as permissive on
+		// POSIX-systems for poll after connect, but on Windows,
+		// WRITE_NORMAL may return even though an error was
+		// triggered and connect failed. Thus, we need to be
+		// stricter here, as it does not affect POSIX
+		// connected-checking either.
+		static bool isConnected(PollFlag events) noexcept {
+			return events == PollFlag::WRITE_NORMAL;
+		}
+
+		// Code-sharing: connect any opened NativeSocket to a
+		// single AddressInfo. Returns false on success, true on
+		// failure.
+		//
+		// The templates given to ClientSocket do not matter to
+		// this function.
+		static bool connect(
+			NativeSocket nativeSocket,
+			AddressInfo const &addressInfo,
+			Time::Timeout timeout = 15s) {
+			if (!ClientSocketSpecInterface::connectBegin(
+						nativeSocket, addressInfo)) {
+				return false;
+			}
+			return !ClientSocketSpecInterface::isConnected(
+				SocketInterface::poll(
+					std::vector<NativeSocket>{nativeSocket},
+					{PollFlag::WRITE_NORMAL},
+					timeout)[0]);
 		}
 	};
 
@@ -94,96 +118,115 @@ namespace Rain::Networking {
 			ClientSocketSpecInterface;
 
 		private:
-		// Multi-address version of connect. Spawns multiple
-		// identical Sockets, each a duplicate of the
+		// Multi-address version of connect, racing staggered
+		// non-blocking connects in the manner of Happy Eyeballs
+		// (RFC 8305), on this thread. Addresses are attempted
+		// in order, alternating between families, and a new
+		// attempt begins each CONNECTION_ATTEMPT_DELAY, or as
+		// soon as the previous one fails. Each attempt is an
+		// identical Socket, a duplicate of the
 		// resource-managed Socket. When any of them connects,
-		// swaps it with the current resource-managing Socket.
-		// Return false on success, true on failure (all).
+		// it is swapped with the current resource-managing
+		// Socket, and the rest are closed. Return false on
+		// success, true on failure (all).
 		bool connect(
 			std::vector<AddressInfo> const &addressInfos,
 			Time::Timeout timeout = 15s) {
-			std::mutex mtx;
-
-			// Stores all the futures. Must be destructed after
-			// lck, since the async functions may use mtx.
-			std::vector<std::future<void>> futures;
+			std::vector<AddressInfo const *> const ordered{
+				ClientSocketSpec::interleave(addressInfos)};
+			std::vector<std::unique_ptr<ClientSocketSpec<Socket>>>
+				attempts;
+			std::vector<NativeSocket> nativeSockets;
+			std::size_t cBegun{0};
+			Time::Timeout nextAttempt;
 
-			// Signalled when any of the futures finish
-			// successfully.
-			//
-			// TODO: If all futures finish unsuccessfully before
-			// the timeout, this still waits until the timeout.
-			std::unique_lock lck(mtx);
-			std::condition_variable ev;
+			while (true) {
+				// Begin the next attempt when it is due, or when no
+				// attempts remain in progress.
+				if (
+					cBegun < ordered.size() &&
+					(attempts.empty() || nextAttempt.isPassed())) {
+					std::unique_ptr<ClientSocketSpec<Socket>> attempt;
+					bool connected{false}, inProgress{false};
 
-			// mtx locks _nativeSocket. _nativeSocket (managed by
-			// superclass) is not directly accessible, so we need
-			// to swap it in. This variable determines if the swap
-			// has occurred yet (e.g. successfully connected).
-			bool connected{false};
-			std::atomic_size_t attemptsCompleted{0};
+					// Attempts which fail to begin are skipped, as
+					// with attempts which fail later.
+					Rain::Error::consumeThrowable([&]() {
+						attempt.reset(new ClientSocketSpec<Socket>);
+						inProgress =
+							ClientSocketSpecInterface::connectBegin(
+								attempt->nativeSocket(), *ordered[cBegun]);
+						connected = !inProgress;
+					})();
+					cBegun++;
+					nextAttempt = CONNECTION_ATTEMPT_DELAY;
+					if (connected) {
+						this->swap(attempt.get());
+						return false;
+					}
+					if (inProgress) {
+						nativeSockets.push_back(attempt->nativeSocket());
+						attempts.push_back(std::move(attempt));
+					}
+					continue;
+				}
+				if (attempts.empty() || timeout.isPassed()) {
+					return true;
+				}
 
-			for (
-				std::size_t idx{0}; idx < addressInfos.size();
-				idx++) {
-				// Each thread spawns an identical client and
-				// attempts to connect with that client. On success,
-				// locks the mutex and swaps.
-				futures.push_back(
-					std::async(
-						std::launch::async,
-						[this,
-							&mtx,
-							&ev,
-							&connected,
-							&attemptsCompleted,
-							&addressInfo = addressInfos[idx],
-							timeout]() {
-							// Ignore any connect exceptions; any
-							// exceptions reported during tests probably
-							// originates from here.
-							Rain::Error::consumeThrowable([this,
-																							&mtx,
-																							&connected,
-																							&addressInfo,
-																							timeout]() {
-								// Calls the single-address constructor.
-								ClientSocketSpec<Socket> attemptSocket(
-									addressInfo, timeout);
-								std::lock_guard lck(mtx);
-								if (!connected) {
-									connected = true;
-									this->swap(&attemptSocket);
-								}
-							})();
+				std::vector<PollFlag> events{SocketInterface::poll(
+					nativeSockets,
+					std::vector<PollFlag>(
+						nativeSockets.size(), PollFlag::WRITE_NORMAL),
+					cBegun < ordered.size()
+						? std::min(timeout, nextAttempt)
+						: timeout)};
+				for (std::size_t idx{0}; idx < attempts.size();) {
+					// Losing attempts are closed on destruction.
+					if (ClientSocketSpecInterface::isConnected(
+								events[idx])) {
+						this->swap(attempts[idx].get());
+						return false;
+					}
 
-							// Fail or succeed, notify that we are done
-							// anyway.
-							attemptsCompleted++;
-							ev.notify_one();
-						}));
+					// Failed attempts are closed immediately, and
+					// the next attempt is due.
+					if (events[idx] != PollFlag::NONE) {
+						nextAttempt = 0s;
+						attempts.erase(attempts.begin() + idx);
+						nativeSockets.erase(nativeSockets.begin() + idx);
+						events.erase(events.begin() + idx);
+					} else {
+						idx++;
+					}
+				}
 			}
+		}
 
-			// Wait until notified or timeout, or notified that
-			// all attempts have failed early.
-			auto pred = [&connected,
-										&attemptsCompleted,
-										attemptsTotal = futures.size()]() {
-				return connected ||
-					attemptsCompleted == attemptsTotal;
-			};
-			if (timeout.isInfinite()) {
-				ev.wait(lck, pred);
-			} else {
-				ev.wait_until(lck, timeout.asTimepoint(), pred);
+		// Orders addresses by alternating families, keeping
+		// their order within each family, starting with the
+		// family of the first address (RFC 8305, Section 4).
+		static std::vector<AddressInfo const *> interleave(
+			std::vector<AddressInfo> const &addressInfos) {
+			std::vector<AddressInfo const *> first, second;
+			for (AddressInfo const &addressInfo : addressInfos) {
+				(addressInfo.address.ss_family ==
+						 addressInfos[0].address.ss_family
+						 ? first
+						 : second)
+					.push_back(&addressInfo);
 			}
-
-			return !connected;
-
-			// Now that this->_nativeSocket is set, we need to
-			// wait for all the futures to terminate via
-			// destructor. this->_nativeSocket will not be
-			// modified anymore.
+			std::vector<AddressInfo const *> ordered;
+			for (std::size_t idx{0};
+					 idx < std::max(first.size(), second.size());
+					 idx++) {
+				for (auto const *family : {&first, &second}) {
+					if (idx < family->size()) {
+						ordered.push_back((*family)[idx]);
+					}
+				}
+			}
+			return ordered;
 		}
 
 		public:
@@ -240,6 +283,23 @@ namespace Rain::Networking {
 			}
 		}
 
+		// Resolves host with a caching Resolver, which does not
+		// block on lookups which it has cached.
+		ClientSocketSpec(
+			Host const &host,
+			Resolver &resolver,
+			Time::Timeout timeout = 15s) {
+			if (this->connect(
+						resolver.getAddressInfos(
+							host,
+							this->family(),
+							this->type(),
+							this->protocol()),
+						timeout)) {
+				throw Exception(Error::TIMED_OUT);
+			}
+		}
+
 		// Multi-priority connect: attempts groups in order,
 		// with the same timeout for each group.
 		ClientSocketSpec(
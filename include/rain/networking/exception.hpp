@@ -30,10 +30,15 @@ namespace Rain::Networking {
 		RES_QUERY_FAILED = 1_zu << 16,
 		NS_INITPARSE_FAILED,
 		NS_MSG_COUNT_FAILED,
+		DNS_QUERY_FAILED,
+		DNS_NAME_INVALID,
 
 		// Additional errors from base SocketInterface are
 		// thrown here too.
-		POLL_INVALID
+		POLL_INVALID,
+
+		// Server configuration errors.
+		REUSE_PORT_REQUIRED
 	};
 	class ErrorCategory : public std::error_category {
 		public:
@@ -48,8 +53,15 @@ namespace Rain::Networking {
 					return "ns_initparse failed.";
 				case Error::NS_MSG_COUNT_FAILED:
 					return "ns_msg_count failed.";
+				case Error::DNS_QUERY_FAILED:
+					return "DNS query failed.";
+				case Error::DNS_NAME_INVALID:
+					return "DNS name invalid.";
 				case Error::POLL_INVALID:
 					return "poll on invalid socket.";
+				case Error::REUSE_PORT_REQUIRED:
+					return "Sharded Server requires "
+								 "ReusePortSocketOption.";
 				default:
 					break;
 			}
@@ -3,13 +3,19 @@
 
 #include "http/body.hpp"
 #include "http/client.hpp"
+#include "http/file_stream_buf.hpp"
+#include "http/frozen_response.hpp"
 #include "http/header.hpp"
 #include "http/headers.hpp"
 #include "http/message.hpp"
 #include "http/method.hpp"
+#include "http/producer_stream_buf.hpp"
 #include "http/query_params.hpp"
 #include "http/request.hpp"
+#include "http/request_parser.hpp"
 #include "http/response.hpp"
+#include "http/response_cache.hpp"
+#include "http/router.hpp"
 #include "http/server.hpp"
 #include "http/socket.hpp"
 #include "http/status_code.hpp"
@@ -3,6 +3,9 @@
 
 #include "../../literal.hpp"
 #include "../../string/string.hpp"
+#include "../tcp/socket.hpp"
+#include "file_stream_buf.hpp"
+#include "producer_stream_buf.hpp"
 
 #include <fstream>
 #include <istream>
@@ -39,6 +42,14 @@ namespace Rain::Networking::Http {
 		Body(std::filebuf &&filebuf) :
 			std::istream(new std::filebuf(std::move(filebuf))),
 			toDelete(this->rdbuf()) {}
+		Body(FileStreamBuf &&fileStreamBuf) :
+			std::istream(
+				new FileStreamBuf(std::move(fileStreamBuf))),
+			toDelete(this->rdbuf()) {}
+		Body(ProducerStreamBuf &&producerStreamBuf) :
+			std::istream(
+				new ProducerStreamBuf(std::move(producerStreamBuf))),
+			toDelete(this->rdbuf()) {}
 
 		// Disable copy constructors.
 		Body(Body const &) = delete;
@@ -91,9 +102,31 @@ namespace Rain::Networking::Http {
 
 		// Stream operator. Cannot stream in >> directly, since
 		// need to know Content-Length/Transfer-Encoding.
+		//
+		// FileStreamBufs are sent without copying through user
+		// space when the stream supports it.
 		friend inline std::ostream &operator<<(
 			std::ostream &stream,
 			Rain::Networking::Http::Body &body) {
+			FileStreamBuf *fileStreamBuf{
+				dynamic_cast<FileStreamBuf *>(body.rdbuf())};
+			Tcp::FileSenderInterface *fileSender{
+				dynamic_cast<Tcp::FileSenderInterface *>(
+					stream.rdbuf())};
+			if (
+				fileStreamBuf != nullptr && fileSender != nullptr) {
+				std::size_t remaining{fileStreamBuf->remaining()},
+					bytesSent{fileSender->sendFile(
+						fileStreamBuf->nativeFile(),
+						fileStreamBuf->offset(),
+						remaining)};
+				fileStreamBuf->consume(bytesSent);
+				if (bytesSent < remaining) {
+					stream.setstate(std::ios::badbit);
+				}
+				return stream;
+			}
+
 			// Will set failbit on stream if rdbuf is empty. So,
 			// only execute if rdbuf is not empty.
 			stream << body.rdbuf();
@@ -0,0 +1,218 @@
+// Streambuf over a byte range of a file, for Bodies which
+// may be sent without copying through user space.
+#pragma once
+
+#include "../../error/exception.hpp"
+#include "../../literal.hpp"
+#include "../../platform.hpp"
+
+#include <filesystem>
+#include <memory>
+#include <streambuf>
+#include <utility>
+
+#ifdef RAIN_PLATFORM_WINDOWS
+	#include <fcntl.h>
+	#include <io.h>
+	#include <sys/stat.h>
+#else
+	#include <fcntl.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace Rain::Networking::Http {
+	// Read-only streambuf over a byte range of a file, by
+	// default the whole file.
+	//
+	// A Body wrapping a FileStreamBuf is sent to Tcp Sockets
+	// with sendfile(2) where available, directly from the page
+	// cache. Otherwise, it is read through a buffer, as with
+	// std::filebuf. showmanyc is exact, so Content-Length is
+	// set from the range.
+	class FileStreamBuf : public std::streambuf {
+		public:
+		enum class Error {
+			OPEN_FAILED = 1,
+			RANGE_OUT_OF_BOUNDS
+		};
+		class ErrorCategory : public std::error_category {
+			public:
+			char const *name() const noexcept {
+				return "Rain::Networking::Http::FileStreamBuf";
+			}
+			std::string message(int error) const noexcept {
+				switch (static_cast<Error>(error)) {
+					case Error::OPEN_FAILED:
+						return "Failed to open file.";
+					case Error::RANGE_OUT_OF_BOUNDS:
+						return "Range exceeds file size.";
+					default:
+						return "Generic.";
+				}
+			}
+		};
+		using Exception =
+			Rain::Error::Exception<Error, ErrorCategory>;
+
+		static inline std::size_t const BUFFER_LEN{1_zu << 14};
+
+		private:
+		// CRT file descriptor on Windows, and POSIX otherwise.
+		int file;
+		std::size_t fileSize;
+
+		// Offset of egptr in the file, and end of the range.
+		std::size_t position, end;
+
+		// Only allocated if the file is read through the
+		// streambuf.
+		std::unique_ptr<char[]> buffer;
+
+		public:
+		// Throws if the file cannot be opened.
+		FileStreamBuf(std::filesystem::path const &path) {
+#ifdef RAIN_PLATFORM_WINDOWS
+			this->file =
+				_wopen(path.c_str(), _O_RDONLY | _O_BINARY);
+			struct _stat64 status;
+			if (
+				this->file != -1 &&
+				_fstat64(this->file, &status) != 0) {
+				_close(this->file);
+				this->file = -1;
+			}
+#else
+			this->file =
+				open(path.c_str(), O_RDONLY | O_CLOEXEC);
+			struct stat status;
+			if (
+				this->file != -1 &&
+				(fstat(this->file, &status) != 0 ||
+					!S_ISREG(status.st_mode))) {
+				close(this->file);
+				this->file = -1;
+			}
+#endif
+			if (this->file == -1) {
+				throw Exception(Error::OPEN_FAILED);
+			}
+			this->fileSize =
+				static_cast<std::size_t>(status.st_size);
+			this->position = 0;
+			this->end = this->fileSize;
+		}
+
+		// Forbid copy.
+		FileStreamBuf(FileStreamBuf const &) = delete;
+		FileStreamBuf &operator=(FileStreamBuf const &) = delete;
+
+		// Move keeps the get area, which points into the moved
+		// buffer.
+		FileStreamBuf(FileStreamBuf &&other) noexcept :
+			std::streambuf(other),
+			file(std::exchange(other.file, -1)),
+			fileSize(other.fileSize),
+			position(other.position),
+			end(other.end),
+			buffer(std::move(other.buffer)) {
+			other.setg(nullptr, nullptr, nullptr);
+		}
+		FileStreamBuf &operator=(FileStreamBuf &&) = delete;
+
+		~FileStreamBuf() {
+			if (this->file != -1) {
+#ifdef RAIN_PLATFORM_WINDOWS
+				_close(this->file);
+#else
+				close(this->file);
+#endif
+			}
+		}
+
+		int nativeFile() const noexcept { return this->file; }
+		std::size_t size() const noexcept {
+			return this->fileSize;
+		}
+
+		// Restricts the streambuf to length bytes from offset.
+		// Throws if the range exceeds the file.
+		void range(std::size_t offset, std::size_t length) {
+			if (
+				offset > this->fileSize ||
+				length > this->fileSize - offset) {
+				throw Exception(Error::RANGE_OUT_OF_BOUNDS);
+			}
+			this->position = offset;
+			this->end = offset + length;
+			this->setg(nullptr, nullptr, nullptr);
+		}
+
+		// Offset and length of the unread part of the range.
+		std::size_t offset() const noexcept {
+			return this->position -
+				static_cast<std::size_t>(
+					this->egptr() - this->gptr());
+		}
+		std::size_t remaining() const noexcept {
+			return this->end - this->offset();
+		}
+
+		// Marks count bytes as read after they have been sent
+		// without the streambuf.
+		void consume(std::size_t count) noexcept {
+			this->position = this->offset() + count;
+			this->setg(nullptr, nullptr, nullptr);
+		}
+
+		protected:
+		virtual std::streamsize showmanyc() override {
+			std::size_t remaining{this->remaining()};
+			return remaining == 0
+				? -1
+				: static_cast<std::streamsize>(remaining);
+		}
+
+		virtual int_type underflow() override {
+			if (this->gptr() != this->egptr()) {
+				return traits_type::to_int_type(*this->gptr());
+			}
+			if (this->position == this->end) {
+				return traits_type::eof();
+			}
+			if (!this->buffer) {
+				this->buffer.reset(new char[BUFFER_LEN]);
+			}
+			std::size_t toRead{
+				std::min(BUFFER_LEN, this->end - this->position)};
+#ifdef RAIN_PLATFORM_WINDOWS
+			long long result{-1};
+			if (
+				_lseeki64(
+					this->file,
+					static_cast<long long>(this->position),
+					SEEK_SET) != -1) {
+				result = _read(
+					this->file,
+					this->buffer.get(),
+					static_cast<unsigned int>(toRead));
+			}
+#else
+			ssize_t result{pread(
+				this->file,
+				this->buffer.get(),
+				toRead,
+				static_cast<off_t>(this->position))};
+#endif
+			if (result <= 0) {
+				return traits_type::eof();
+			}
+			this->position += static_cast<std::size_t>(result);
+			this->setg(
+				this->buffer.get(),
+				this->buffer.get(),
+				this->buffer.get() + result);
+			return traits_type::to_int_type(*this->gptr());
+		}
+	};
+}
@@ -0,0 +1,130 @@
+// Immutable pre-serialized HTTP response, which Workers
+// may send any number of times.
+#pragma once
+
+#include "body.hpp"
+#include "headers.hpp"
+#include "version.hpp"
+
+#include <array>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+namespace Rain::Networking::Http {
+	// Immutable response, serialized once, for responses
+	// which do not change between requests, such as health
+	// checks, redirects, and error pages. Copies share the
+	// same bytes, and may be sent by any number of Workers at
+	// once, each in one vectored send, without copying them.
+	//
+	// Its Date is patched in when sent, from
+	// Header::HttpDate::nowStr. Other headers are fixed when
+	// frozen, as is its version, usually HTTP/1.1.
+	class FrozenResponse {
+		private:
+		class Block {
+			public:
+			// The response, serialized, with a placeholder Date.
+			std::string bytes;
+
+			// Offsets of the Date value, and of the body.
+			std::size_t dateOffset, bodyOffset;
+		};
+		std::shared_ptr<Block const> block;
+
+		public:
+		// Empty, which is not sent.
+		FrozenResponse() = default;
+
+		// Serializes res, which must be HTTP/1.0 or HTTP/1.1,
+		// with any pp-chain of sendWith, and replaces its Date.
+		// Bodies are read to their end, and serialized with
+		// their Content-Length, so that the body is the same
+		// bytes over HTTP/0.9 and HTTP/2, which do not frame
+		// it by chunks. Responses with a Transfer-Encoding or
+		// trailers cannot be frozen.
+		template<typename Response>
+		explicit FrozenResponse(Response &res) {
+			if (res.version == Version::_0_9) {
+				throw typename Response::Exception(
+					Response::Error::HTTP_VERSION_NOT_SUPPORTED);
+			}
+			if (
+				res.headers.find("Transfer-Encoding") !=
+					res.headers.end() ||
+				!res.trailers.empty()) {
+				throw typename Response::Exception(
+					Response::Error::MALFORMED_BODY);
+			}
+			if (res.body.rdbuf() != nullptr) {
+				std::string body{
+					std::istreambuf_iterator<char>(res.body), {}};
+				res.body = body.empty()
+					? Body()
+					: Body(
+							std::stringbuf(std::move(body), std::ios::in));
+			}
+
+			// The Date is written after the response line, where
+			// its offset is known, rather than among the other
+			// headers, any of which may hold the same value. Epoch
+			// is a placeholder of the same length as any other
+			// date.
+			res.headers.erase("Date");
+			std::ostringstream stream;
+			res.sendWith(stream);
+
+			auto block{std::make_shared<Block>()};
+			block->bytes = std::move(stream).str();
+			std::size_t const lineEnd{
+				block->bytes.find("\r\n") + 2};
+			block->bytes.insert(
+				lineEnd,
+				"Date: " +
+					static_cast<std::string>(Header::HttpDate()) +
+					"\r\n");
+			block->dateOffset = lineEnd + 6;
+			block->bodyOffset = block->bytes.find("\r\n\r\n") + 4;
+			this->block = std::move(block);
+		}
+		template<typename Response>
+		explicit FrozenResponse(Response &&res) :
+			FrozenResponse(res) {}
+
+		explicit operator bool() const noexcept {
+			return this->block != nullptr;
+		}
+
+		// The serialized response, with the placeholder Date.
+		std::string_view bytes() const noexcept {
+			return this->block->bytes;
+		}
+
+		// The body, as sent to HTTP/0.9 requests.
+		std::string_view body() const noexcept {
+			return std::string_view(this->block->bytes)
+				.substr(this->block->bodyOffset);
+		}
+
+		// Buffers to send, in order: the head up to its Date,
+		// the current Date, and the rest of the head, followed
+		// by the body if withBody.
+		std::array<std::string_view, 3> buffers(
+			bool withBody = true) const {
+			std::string_view const bytes{this->block->bytes},
+				date{Header::HttpDate::nowStr()};
+			std::size_t const dateEnd{
+				this->block->dateOffset + date.size()};
+			return {
+				bytes.substr(0, this->block->dateOffset),
+				date,
+				bytes.substr(
+					dateEnd,
+					withBody ? std::string_view::npos
+									 : this->block->bodyOffset - dateEnd)};
+		}
+	};
+}
@@ -2,5 +2,8 @@
 #pragma once
 
 #include "header/authorization.hpp"
+#include "header/cache_control.hpp"
+#include "header/http_date.hpp"
+#include "header/range.hpp"
 #include "header/set_cookie.hpp"
 #include "header/transfer_encoding.hpp"
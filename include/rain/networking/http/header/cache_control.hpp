@@ -0,0 +1,115 @@
+// Type for the Cache-Control header.
+#pragma once
+
+#include "../../../string/string.hpp"
+
+#include <charconv>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace Rain::Networking::Http::Header {
+	// Directives of Cache-Control (RFC 9111 5.2) which affect
+	// caching by Rain. Directive names are case-insensitive;
+	// unknown directives, and the field names of no-cache and
+	// private, are ignored.
+	class CacheControl {
+		public:
+		bool noCache{false}, noStore{false}, isPrivate{false},
+			isPublic{false};
+		std::optional<std::size_t> maxAge, sMaxAge;
+
+		CacheControl() = default;
+
+		// Parses a comma-separated list of directives, with
+		// optional `=` arguments, which may be quoted.
+		// Malformed delta-seconds are ignored.
+		CacheControl(std::string_view str) {
+			while (!str.empty()) {
+				std::size_t comma{str.find(',')};
+				std::string_view directive{String::trimWhitespace(
+					str.substr(0, std::min(comma, str.size())))};
+				str.remove_prefix(
+					comma == std::string_view::npos ? str.size()
+																					: comma + 1);
+
+				std::size_t const equals{directive.find('=')};
+				std::string name{String::trimWhitespace(
+					directive.substr(
+						0, std::min(equals, directive.size())))};
+				String::toLower(name);
+				std::string_view argument;
+				if (equals != std::string_view::npos) {
+					argument = String::trimWhitespace(
+						directive.substr(equals + 1));
+				}
+
+				// Quoted arguments may contain commas, which are not
+				// supported by the directives recognized here.
+				if (name == "no-cache") {
+					this->noCache = true;
+				} else if (name == "no-store") {
+					this->noStore = true;
+				} else if (name == "private") {
+					this->isPrivate = true;
+				} else if (name == "public") {
+					this->isPublic = true;
+				} else if (name == "max-age") {
+					this->maxAge =
+						CacheControl::parseSeconds(argument);
+				} else if (name == "s-maxage") {
+					this->sMaxAge =
+						CacheControl::parseSeconds(argument);
+				}
+			}
+		}
+
+		operator std::string() const {
+			std::string str;
+			auto append{[&str](std::string_view directive) {
+				str += str.empty() ? "" : ", ";
+				str += directive;
+			}};
+			if (this->noCache) {
+				append("no-cache");
+			}
+			if (this->noStore) {
+				append("no-store");
+			}
+			if (this->isPrivate) {
+				append("private");
+			}
+			if (this->isPublic) {
+				append("public");
+			}
+			if (this->maxAge) {
+				append("max-age=" + std::to_string(*this->maxAge));
+			}
+			if (this->sMaxAge) {
+				append(
+					"s-maxage=" + std::to_string(*this->sMaxAge));
+			}
+			return str;
+		}
+
+		private:
+		// delta-seconds, optionally quoted.
+		static std::optional<std::size_t> parseSeconds(
+			std::string_view str) {
+			if (
+				str.size() >= 2 && str.front() == '"' &&
+				str.back() == '"') {
+				str = str.substr(1, str.size() - 2);
+			}
+			std::size_t seconds;
+			if (
+				str.empty() ||
+				std::from_chars(
+					str.data(), str.data() + str.size(), seconds)
+						.ptr != str.data() + str.size()) {
+				return {};
+			}
+			return seconds;
+		}
+	};
+}
@@ -0,0 +1,193 @@
+// Type for HTTP-date headers, e.g. Date and Last-Modified.
+#pragma once
+
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace Rain::Networking::Http::Header {
+	// A time to the second, as in Date, Expires,
+	// Last-Modified, and If-Modified-Since (RFC 9110 5.6.7).
+	// Always sent as IMF-fixdate, e.g. `Sun, 06 Nov 1994
+	// 08:49:37 GMT`.
+	class HttpDate {
+		private:
+		static inline char const *const DAYS[]{
+			"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"},
+			*const MONTHS[]{
+				"Jan",
+				"Feb",
+				"Mar",
+				"Apr",
+				"May",
+				"Jun",
+				"Jul",
+				"Aug",
+				"Sep",
+				"Oct",
+				"Nov",
+				"Dec"};
+
+		public:
+		std::chrono::sys_seconds time;
+
+		HttpDate(std::chrono::sys_seconds time = {}) :
+			time(time) {}
+
+		// Current time, to the second.
+		static HttpDate now() {
+			return {std::chrono::floor<std::chrono::seconds>(
+				std::chrono::system_clock::now())};
+		}
+
+		// IMF-fixdate of the current second, formatted at most
+		// once a second on each thread. Valid until the next
+		// call on the same thread.
+		static std::string_view nowStr() {
+			thread_local std::chrono::sys_seconds timeFormatted;
+			thread_local std::string formatted;
+			HttpDate const timeNow{HttpDate::now()};
+			if (
+				formatted.empty() || timeNow.time != timeFormatted) {
+				timeFormatted = timeNow.time;
+				formatted = timeNow;
+			}
+			return formatted;
+		}
+
+		// Parses IMF-fixdate, and the obsolete RFC 850 and
+		// asctime formats, which recipients must also accept.
+		// Returns nullopt if malformed.
+		//
+		// IMF-fixdate: `Sun, 06 Nov 1994 08:49:37 GMT`.
+		// RFC 850: `Sunday, 06-Nov-94 08:49:37 GMT`.
+		// asctime: `Sun Nov  6 08:49:37 1994`.
+		static std::optional<HttpDate> parse(
+			std::string_view str) {
+			// Split into tokens on whitespace, commas, and
+			// dashes, ignoring the day name.
+			std::string_view tokens[6];
+			std::size_t cTokens{0};
+			while (!str.empty()) {
+				std::size_t const begin{
+					str.find_first_not_of(" ,-")};
+				if (begin == std::string_view::npos) {
+					break;
+				}
+				str.remove_prefix(begin);
+				std::size_t const end{
+					std::min(str.find_first_of(" ,-"), str.size())};
+				if (cTokens == 6) {
+					return {};
+				}
+				tokens[cTokens++] = str.substr(0, end);
+				str.remove_prefix(end);
+			}
+
+			std::string_view day, month, year, time;
+			if (cTokens == 6 && tokens[5] == "GMT") {
+				day = tokens[1];
+				month = tokens[2];
+				year = tokens[3];
+				time = tokens[4];
+			} else if (cTokens == 5) {
+				month = tokens[1];
+				day = tokens[2];
+				time = tokens[3];
+				year = tokens[4];
+			} else {
+				return {};
+			}
+
+			unsigned monthValue{0};
+			while (
+				monthValue < 12 &&
+				month != HttpDate::MONTHS[monthValue]) {
+				monthValue++;
+			}
+			unsigned dayValue, hours, minutes, seconds;
+			int yearValue;
+			if (
+				monthValue == 12 ||
+				!HttpDate::parseNumber(day, 1, 2, dayValue) ||
+				!HttpDate::parseNumber(year, 2, 4, yearValue) ||
+				year.size() == 3 || time.size() != 8 ||
+				time[2] != ':' || time[5] != ':' ||
+				!HttpDate::parseNumber(
+					time.substr(0, 2), 2, 2, hours) ||
+				!HttpDate::parseNumber(
+					time.substr(3, 2), 2, 2, minutes) ||
+				!HttpDate::parseNumber(
+					time.substr(6, 2), 2, 2, seconds) ||
+				hours > 23 || minutes > 59 || seconds > 60) {
+				return {};
+			}
+
+			// Two-digit years are from 1970 to 2069.
+			if (year.size() == 2) {
+				yearValue += yearValue < 70 ? 2000 : 1900;
+			}
+			std::chrono::year_month_day const date{
+				std::chrono::year(yearValue),
+				std::chrono::month(monthValue + 1),
+				std::chrono::day(dayValue)};
+			if (!date.ok()) {
+				return {};
+			}
+			return HttpDate{
+				std::chrono::sys_days(date) +
+				std::chrono::hours(hours) +
+				std::chrono::minutes(minutes) +
+				std::chrono::seconds(seconds)};
+		}
+
+		operator std::string() const {
+			std::chrono::sys_days const days{
+				std::chrono::floor<std::chrono::days>(this->time)};
+			std::chrono::year_month_day const date{days};
+			std::chrono::hh_mm_ss const time{this->time - days};
+
+			// IMF-fixdate is always 29 characters.
+			char buffer[32];
+			std::snprintf(
+				buffer,
+				sizeof(buffer),
+				"%s, %02u %s %04d %02d:%02d:%02d GMT",
+				HttpDate::DAYS[std::chrono::weekday(days)
+												 .c_encoding()],
+				static_cast<unsigned>(date.day()),
+				HttpDate::MONTHS
+					[static_cast<unsigned>(date.month()) - 1],
+				static_cast<int>(date.year()),
+				static_cast<int>(time.hours().count()),
+				static_cast<int>(time.minutes().count()),
+				static_cast<int>(time.seconds().count()));
+			return buffer;
+		}
+
+		friend bool operator==(
+			HttpDate const &,
+			HttpDate const &) = default;
+		friend auto operator<=>(
+			HttpDate const &,
+			HttpDate const &) = default;
+
+		private:
+		// Parses a decimal of minDigits to maxDigits digits.
+		template<typename Value>
+		static bool parseNumber(
+			std::string_view str,
+			std::size_t minDigits,
+			std::size_t maxDigits,
+			Value &value) {
+			return str.size() >= minDigits &&
+				str.size() <= maxDigits &&
+				std::from_chars(
+					str.data(), str.data() + str.size(), value)
+						.ptr == str.data() + str.size();
+		}
+	};
+}
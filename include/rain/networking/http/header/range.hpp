@@ -0,0 +1,59 @@
+// Type for the Range header.
+#pragma once
+
+#include <algorithm>
+#include <optional>
+#include <string>
+
+namespace Rain::Networking::Http::Header {
+	// A single byte range: `bytes=first-last`, `bytes=first-`,
+	// or the suffix `bytes=-last`, where last is then a
+	// length. Multiple ranges are not supported, and may be
+	// ignored per RFC 9110.
+	class Range {
+		public:
+		std::optional<std::size_t> first, last;
+
+		Range(
+			std::optional<std::size_t> first = {},
+			std::optional<std::size_t> last = {}) :
+			first(first),
+			last(last) {}
+
+		// Resolves the range against a representation of size
+		// bytes. Returns false if it is unsatisfiable.
+		bool resolve(
+			std::size_t size,
+			std::size_t &offset,
+			std::size_t &length) const noexcept {
+			if (!this->first) {
+				if (!this->last || this->last.value() == 0) {
+					return false;
+				}
+				length = std::min(size, this->last.value());
+				offset = size - length;
+				return true;
+			}
+			if (
+				this->first.value() >= size ||
+				(this->last &&
+					this->last.value() < this->first.value())) {
+				return false;
+			}
+			offset = this->first.value();
+			length =
+				std::min(size - 1, this->last.value_or(size - 1)) -
+				offset + 1;
+			return true;
+		}
+
+		operator std::string() const {
+			return "bytes=" +
+				(this->first ? std::to_string(this->first.value())
+										 : "") +
+				"-" +
+				(this->last ? std::to_string(this->last.value())
+										: "");
+		}
+	};
+}
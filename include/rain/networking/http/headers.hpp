@@ -9,6 +9,8 @@
 #include "../media_type.hpp"
 #include "header.hpp"
 
+#include <charconv>
+#include <optional>
 #include <unordered_map>
 
 namespace Rain::Networking::Http {
@@ -193,6 +195,91 @@ namespace Rain::Networking::Http {
 			this->operator[]("Host") = value;
 		}
 
+		// Absent, malformed, and multiple ranges are nullopt,
+		// and may be ignored.
+		std::optional<Header::Range> range() {
+			auto it = this->find("Range");
+			if (it == this->end()) {
+				return {};
+			}
+			std::string_view rangeStr{String::trimWhitespace(
+				std::string_view(it->second))};
+			std::size_t dash{rangeStr.find('-')};
+			if (
+				!rangeStr.starts_with("bytes=") ||
+				dash == std::string_view::npos ||
+				rangeStr.find(',') != std::string_view::npos) {
+				return {};
+			}
+
+			// Each bound is either empty or a number.
+			Header::Range range;
+			std::string_view bounds[2]{
+				String::trimWhitespace(rangeStr.substr(6, dash - 6)),
+				String::trimWhitespace(rangeStr.substr(dash + 1))};
+			std::optional<std::size_t> *values[2]{
+				&range.first, &range.last};
+			for (std::size_t idx{0}; idx < 2; idx++) {
+				if (bounds[idx].empty()) {
+					continue;
+				}
+				char const *end{
+					bounds[idx].data() + bounds[idx].size()};
+				std::size_t value;
+				if (
+					std::from_chars(bounds[idx].data(), end, value)
+						.ptr != end) {
+					return {};
+				}
+				*values[idx] = value;
+			}
+			if (!range.first && !range.last) {
+				return {};
+			}
+			return range;
+		}
+		void range(Header::Range const &value) {
+			this->operator[]("Range") = value;
+		}
+
+		// Absent is an empty CacheControl.
+		Header::CacheControl cacheControl() {
+			auto it = this->find("Cache-Control");
+			return it == this->end()
+				? Header::CacheControl()
+				: Header::CacheControl(it->second);
+		}
+		void cacheControl(Header::CacheControl const &value) {
+			this->operator[]("Cache-Control") = value;
+		}
+
+		// HTTP-date headers. Absent and malformed dates are
+		// nullopt.
+		std::optional<Header::HttpDate> date() {
+			return this->httpDate("Date");
+		}
+		void date(Header::HttpDate const &value) {
+			this->operator[]("Date") = value;
+		}
+		std::optional<Header::HttpDate> expires() {
+			return this->httpDate("Expires");
+		}
+		void expires(Header::HttpDate const &value) {
+			this->operator[]("Expires") = value;
+		}
+		std::optional<Header::HttpDate> ifModifiedSince() {
+			return this->httpDate("If-Modified-Since");
+		}
+		void ifModifiedSince(Header::HttpDate const &value) {
+			this->operator[]("If-Modified-Since") = value;
+		}
+		std::optional<Header::HttpDate> lastModified() {
+			return this->httpDate("Last-Modified");
+		}
+		void lastModified(Header::HttpDate const &value) {
+			this->operator[]("Last-Modified") = value;
+		}
+
 		std::string server() {
 			return this->find("Server")->second;
 		}
@@ -302,6 +389,17 @@ namespace Rain::Networking::Http {
 			transferEncoding.pop_back();
 		}
 
+		private:
+		std::optional<Header::HttpDate> httpDate(
+			std::string const &key) {
+			auto it = this->find(key);
+			if (it == this->end()) {
+				return {};
+			}
+			return Header::HttpDate::parse(it->second);
+		}
+
+		public:
 		// Stream operators.
 		friend inline std::ostream &operator<<(
 			std::ostream &stream,
@@ -317,55 +415,47 @@ namespace Rain::Networking::Http {
 		friend inline std::istream &operator>>(
 			std::istream &stream,
 			Rain::Networking::Http::Headers &headers) {
-			// TODO: Optimize for string copying.
-
 			using namespace Rain::Literal;
 
 			// HTTP header lines can be up to 4K long.
 			// Total size of headers cannot exceed 64K.
+			//
+			// Names and values are trimmed in place, and copied
+			// once into the headers.
 			std::size_t totalHeadersBytes{0};
 			std::string line(1_zu << 12, '\0');
 			while (stream.getline(&line[0], line.length())) {
-				line.resize(
+				std::string_view lineView(
+					line.data(),
 					static_cast<std::size_t>(std::max(
 						std::streamsize(0), stream.gcount() - 1)));
 
 				// If line is only \r, we are done.
-				if (line == "\r") {
+				if (lineView == "\r") {
 					break;
 				}
 
-				// Copy header value to another string.
-				std::size_t colonPos{line.find(':')};
-
-				if (colonPos == std::string::npos) {
+				std::size_t colonPos{lineView.find(':')};
+				if (colonPos == std::string_view::npos) {
 					// Failed to find colon, malformed.
 					throw Rain::Networking::Http::Headers::Exception(
 						Rain::Networking::Http::Headers::Error::
 							NO_COLON_DELIMITER);
 				}
 
-				std::string value(line.substr(colonPos + 1));
-
-				// Resize line to only include the header name.
-				line.resize(colonPos);
-
-				// Alias with name and trim whitespace.
-				std::string &name = line;
-				Rain::String::trimWhitespace(name);
-				Rain::String::trimWhitespace(value);
+				std::string_view name{Rain::String::trimWhitespace(
+					lineView.substr(0, colonPos))},
+					value{Rain::String::trimWhitespace(
+						lineView.substr(colonPos + 1))};
 
 				// Add to headers.
-				headers.insert({name, value});
+				headers.emplace(name, value);
 				totalHeadersBytes += name.length() + value.length();
 				if (totalHeadersBytes > (1_zu << 16)) {
 					throw Rain::Networking::Http::Headers::Exception(
 						Rain::Networking::Http::Headers::Error::
 							HEADERS_BLOCK_OVERFLOW);
 				}
-
-				// Prepare for next line.
-				line.resize(1_zu << 12);
 			}
 
 			return stream;
@@ -8,10 +8,16 @@
 
 #include "../../string.hpp"
 #include "../req_res/message.hpp"
+#include "../tcp/socket.hpp"
 #include "body.hpp"
 #include "headers.hpp"
 #include "version.hpp"
 
+#include <algorithm>
+#include <charconv>
+#include <sstream>
+#include <string_view>
+
 namespace Rain::Networking::Http {
 	class MessageSpecInterface :
 		virtual public ReqRes::MessageInterface {
@@ -120,26 +126,131 @@ namespace Rain::Networking::Http {
 			}
 		};
 
+		// Decodes chunked Transfer-Encoding (RFC 9112 7.1).
+		// Chunk extensions are ignored, and trailer fields are
+		// added to trailers, if not nullptr. The source is left
+		// just past the body, at the next message.
+		//
+		// Malformed or truncated chunks end the body early, and
+		// leave the source at an unknown place, so that
+		// isMalformed is set and the connection must close.
 		class ChunkedTransferEncodingIStreamBuf :
 			public std::streambuf {
+			// MessageSpec updates trailers when moved.
+			template<typename>
+			friend class MessageSpec;
+
 			private:
+			// Longest chunk size or trailer line, and most
+			// trailer lines, accepted.
+			static std::size_t const MAX_LINE_LEN{1_zu << 13},
+				MAX_TRAILERS{1_zu << 7};
+
 			// The TCP Socket stream from which we will read from
 			// to fill up this streambuf.
 			std::streambuf *const sourceStreamBuf;
 
+			Headers *trailers;
+
 			// Bytes remaining in the current chunk. Can be zero,
 			// in which case we process the next chunk.
 			std::size_t chunkLenRemaining;
 
+			// Set once the last chunk and its trailers have been
+			// received, or on malformed input, which also sets
+			// isMalformed.
+			bool isDone, isMalformed;
+
 			// Internal buffer.
 			std::string buffer;
 
+			// Receives a line without its terminating CRLF (or
+			// bare LF) into line. Fails if the source ends first,
+			// or if the line is too long.
+			bool recvLine(std::string &line) {
+				line.clear();
+				while (true) {
+					int_type ch{this->sourceStreamBuf->sbumpc()};
+					if (traits_type::eq_int_type(
+								ch, traits_type::eof())) {
+						return false;
+					}
+					if (ch == '\n') {
+						if (!line.empty() && line.back() == '\r') {
+							line.pop_back();
+						}
+						return true;
+					}
+					if (line.length() == MAX_LINE_LEN) {
+						return false;
+					}
+					line.push_back(traits_type::to_char_type(ch));
+				}
+			}
+
+			// Receives the chunk-size line of the next chunk into
+			// chunkLenRemaining, ignoring any chunk-ext.
+			//
+			// chunk = chunk-size [ chunk-ext ] CRLF ...
+			// chunk-ext = *( BWS ";" BWS ext-name
+			// 	[ BWS "=" BWS ext-val ] )
+			bool recvChunkSize() {
+				std::string line;
+				if (!this->recvLine(line)) {
+					return false;
+				}
+
+				// chunk-size is hexadecimal, and may not overflow.
+				char const *const end{line.data() + line.length()};
+				auto [ptr, ec]{std::from_chars(
+					line.data(), end, this->chunkLenRemaining, 16)};
+				if (ec != std::errc()) {
+					return false;
+				}
+				while (
+					ptr != end && (*ptr == ' ' || *ptr == '\t')) {
+					ptr++;
+				}
+				return ptr == end || *ptr == ';';
+			}
+
+			// Receives the trailer section after the last chunk,
+			// up to and including its terminating CRLF.
+			//
+			// trailer-section = *( field-line CRLF )
+			bool recvTrailers() {
+				std::string line;
+				for (std::size_t cTrailers{0};; cTrailers++) {
+					if (!this->recvLine(line)) {
+						return false;
+					}
+					if (line.empty()) {
+						return true;
+					}
+					std::size_t const colon{line.find(':')};
+					if (
+						cTrailers == MAX_TRAILERS ||
+						colon == 0 || colon == std::string::npos) {
+						return false;
+					}
+					if (this->trailers != nullptr) {
+						(*this->trailers)[line.substr(0, colon)] =
+							String::trimWhitespace(
+								std::string_view(line).substr(colon + 1));
+					}
+				}
+			}
+
 			public:
 			ChunkedTransferEncodingIStreamBuf(
 				std::streambuf *sourceStreamBuf,
+				Headers *trailers = nullptr,
 				std::size_t bufferLen = 1_zu << 10) :
 				sourceStreamBuf(sourceStreamBuf),
-				chunkLenRemaining(0) {
+				trailers(trailers),
+				chunkLenRemaining(0),
+				isDone(false),
+				isMalformed(false) {
 				this->buffer.reserve(bufferLen);
 				this->buffer.resize(this->buffer.capacity());
 
@@ -156,34 +267,43 @@ namespace Rain::Networking::Http {
 			ChunkedTransferEncodingIStreamBuf &operator=(
 				ChunkedTransferEncodingIStreamBuf const &) = delete;
 
+			// Whether the body was cut short by malformed or
+			// truncated chunks.
+			bool malformed() const noexcept {
+				return this->isMalformed;
+			}
+
 			protected:
-			// Re-fill the buffer from the source, decrementing
-			// contentLength if necessary.
+			// Ends the body as malformed.
+			int_type fail() noexcept {
+				this->isDone = this->isMalformed = true;
+				return traits_type::eof();
+			}
+
+			// Re-fill the buffer from the current chunk, moving on
+			// to the next chunk if necessary.
 			virtual int_type underflow() noexcept override {
 				// Only refill buffer if it has been exhausted.
-				if (this->gptr() == this->egptr()) {
-					// If chunkLenRemaining is 0, we need to interpret
-					// it more.
+				if (this->gptr() != this->egptr()) {
+					return traits_type::to_int_type(*this->gptr());
+				}
+				if (this->isDone) {
+					return traits_type::eof();
+				}
+
+				try {
 					if (this->chunkLenRemaining == 0) {
-						std::string chunkLenBuffer(20, '\0');
-						std::istream chunkLenStream(
-							this->sourceStreamBuf);
-						chunkLenStream.getline(
-							&chunkLenBuffer[0],
-							chunkLenBuffer.length(),
-							'\n');
-
-						// -2 for \r\0.
-						chunkLenBuffer.resize(
-							static_cast<std::size_t>(std::max(
-								std::streamsize(0),
-								chunkLenStream.gcount() - 2)));
-						this->chunkLenRemaining =
-							static_cast<std::size_t>(std::strtoumax(
-								chunkLenBuffer.c_str(), NULL, 10));
-
-						// If chunk length parsed to 0, we are done.
+						if (!this->recvChunkSize()) {
+							return this->fail();
+						}
+
+						// The last chunk has size 0, and is followed by
+						// trailers.
 						if (this->chunkLenRemaining == 0) {
+							if (!this->recvTrailers()) {
+								return this->fail();
+							}
+							this->isDone = true;
 							return traits_type::eof();
 						}
 					}
@@ -200,26 +320,130 @@ namespace Rain::Networking::Http {
 					// None filled, so the stream has probably been
 					// closed.
 					if (cFilled == 0) {
-						return traits_type::eof();
+						return this->fail();
 					}
 
-					// If chunkLenRemaining has just been set to 0,
-					// ignore the \r\n coming right after.
+					// Each chunk ends with CRLF, without which the
+					// body ends after this data.
 					if (this->chunkLenRemaining == 0) {
-						this->sourceStreamBuf->sbumpc();
-						this->sourceStreamBuf->sbumpc();
+						std::string line;
+						if (!this->recvLine(line) || !line.empty()) {
+							this->isDone = this->isMalformed = true;
+						}
 					}
 
 					this->setg(
 						&this->buffer[0],
 						&this->buffer[0],
 						&this->buffer[0] + cFilled);
+				} catch (...) {
+					return this->fail();
 				}
-
 				return traits_type::to_int_type(*this->gptr());
 			}
 		};
 
+		// Encodes bytes written to it as chunks of up to
+		// chunkLen onto a sink, which is flushed after each
+		// chunk. close sends the last chunk and trailers.
+		class ChunkedTransferEncodingOStreamBuf :
+			public std::streambuf {
+			private:
+			// The TCP Socket stream to which chunks are sent.
+			std::streambuf *const sinkStreamBuf;
+
+			// Set once a send to the sink falls short.
+			bool isFailed;
+
+			// Internal buffer, of one chunk.
+			std::string buffer;
+
+			// Sends s to the sink, failing if it falls short.
+			bool sendToSink(std::string_view s) {
+				std::streamsize const len{
+					static_cast<std::streamsize>(s.size())};
+				this->isFailed = this->isFailed ||
+					this->sinkStreamBuf->sputn(s.data(), len) != len;
+				return !this->isFailed;
+			}
+
+			public:
+			ChunkedTransferEncodingOStreamBuf(
+				std::streambuf *sinkStreamBuf,
+				std::size_t chunkLen = 1_zu << 14) :
+				sinkStreamBuf(sinkStreamBuf),
+				isFailed(false),
+				buffer(std::max(chunkLen, 1_zu), '\0') {
+				this->setp(
+					&this->buffer[0],
+					&this->buffer[0] + this->buffer.length());
+			}
+
+			// Disable copy.
+			ChunkedTransferEncodingOStreamBuf(
+				ChunkedTransferEncodingOStreamBuf const &) = delete;
+			ChunkedTransferEncodingOStreamBuf &operator=(
+				ChunkedTransferEncodingOStreamBuf const &) = delete;
+
+			// Sends any buffered bytes as a chunk, then the last
+			// chunk with trailers. Returns false if any send has
+			// failed.
+			bool close(Headers const &trailers) {
+				if (this->sync() == -1) {
+					return false;
+				}
+				std::ostringstream lastChunk;
+				lastChunk << "0\r\n" << trailers << "\r\n";
+				return this->sendToSink(lastChunk.view()) &&
+					this->sinkStreamBuf->pubsync() != -1;
+			}
+
+			protected:
+			// Sends the full buffer as a chunk, then buffers ch.
+			virtual int_type overflow(
+				int_type ch = traits_type::eof()) override {
+				if (this->sync() == -1) {
+					return traits_type::eof();
+				}
+				if (!traits_type::eq_int_type(
+							ch, traits_type::eof())) {
+					*this->pptr() = traits_type::to_char_type(ch);
+					this->pbump(1);
+				}
+				return traits_type::not_eof(ch);
+			}
+
+			// Sends buffered bytes as a chunk, if any, and
+			// flushes the sink, so that partial chunks are not
+			// held back.
+			virtual int sync() override {
+				std::size_t const chunkLen{static_cast<std::size_t>(
+					this->pptr() - this->pbase())};
+				if (chunkLen > 0) {
+					// chunk = chunk-size CRLF chunk-data CRLF
+					char chunkSize[sizeof(std::size_t) * 2 + 2];
+					char *end{std::to_chars(
+						chunkSize,
+						chunkSize + sizeof(chunkSize),
+						chunkLen,
+						16)
+											.ptr};
+					*end++ = '\r';
+					*end++ = '\n';
+					this->sendToSink({chunkSize, end}) &&
+						this->sendToSink({this->pbase(), chunkLen}) &&
+						this->sendToSink("\r\n");
+					this->setp(
+						&this->buffer[0],
+						&this->buffer[0] + this->buffer.length());
+				}
+				return this->isFailed ||
+						this->sinkStreamBuf->pubsync() == -1
+					? -1
+					: 0;
+			}
+		};
+
 		public:
 		virtual void recvBody(std::istream &stream) = 0;
 		virtual void ppEstimateContentLength(bool) = 0;
@@ -241,12 +465,25 @@ namespace Rain::Networking::Http {
 		// streambuf.
 		Body body;
 
+		// Trailer fields, sent after a body with chunked
+		// Transfer-Encoding, or received after one once it has
+		// been read to its end.
+		Headers trailers;
+
+		// Longest chunk sent, when the body is sent with
+		// chunked Transfer-Encoding.
+		std::size_t chunkLen{1_zu << 14};
+
 		private:
 		// Dynamic storage for streambufs created for body
 		// parsing.
 		std::vector<std::unique_ptr<std::streambuf>>
 			bodyTransferEncodingStreamBufs;
 
+		// Set by ppEstimateContentLength when the body is to be
+		// sent with chunked Transfer-Encoding.
+		bool toEncodeChunked{false};
+
 		public:
 		// Constructor arguments passed in from R/R. Move
 		// construct heavy arguments with rvalue references.
@@ -264,12 +501,45 @@ namespace Rain::Networking::Http {
 			version(other.version),
 			headers(std::move(other.headers)),
 			body(std::move(other.body)),
+			trailers(std::move(other.trailers)),
+			chunkLen(other.chunkLen),
 			bodyTransferEncodingStreamBufs(
-				std::move(other.bodyTransferEncodingStreamBufs)) {}
+				std::move(other.bodyTransferEncodingStreamBufs)),
+			toEncodeChunked(other.toEncodeChunked) {
+			// Decoders add trailers to this message instead.
+			for (auto &streamBuf :
+					 this->bodyTransferEncodingStreamBufs) {
+				auto decoder{
+					dynamic_cast<ChunkedTransferEncodingIStreamBuf *>(
+						streamBuf.get())};
+				if (decoder != nullptr) {
+					decoder->trailers = &this->trailers;
+				}
+			}
+		}
+
+		// Whether the body, as read so far, was cut short by
+		// malformed or truncated chunks. The stream it was
+		// received from is then at an unknown place, and
+		// should not be read further.
+		bool isBodyMalformed() const {
+			for (auto const &streamBuf :
+					 this->bodyTransferEncodingStreamBufs) {
+				auto decoder{dynamic_cast<
+					ChunkedTransferEncodingIStreamBuf const *>(
+					streamBuf.get())};
+				if (decoder != nullptr && decoder->malformed()) {
+					return true;
+				}
+			}
+			return false;
+		}
 
 		// Pre/post-processors.
 		public:
-		// Process sets Content-Length if possible.
+		// Process sets Content-Length if possible. Otherwise,
+		// from HTTP/1.1, bodies of indeterminate length are sent
+		// with chunked Transfer-Encoding, as they are produced.
 		virtual void ppEstimateContentLength(
 			bool allowZero) override {
 			std::vector<Header::TransferEncoding>
@@ -289,12 +559,31 @@ namespace Rain::Networking::Http {
 				// otherwise.
 				std::streamsize inAvail{this->body.inAvail()};
 
+				// Only in-memory and file bodies are determinate;
+				// other streambufs may only know what they have
+				// buffered so far.
+				std::streambuf *bodyStreamBuf{this->body.rdbuf()};
+				bool const isDeterminate{
+					bodyStreamBuf == nullptr ||
+					dynamic_cast<std::stringbuf *>(bodyStreamBuf) !=
+						nullptr ||
+					dynamic_cast<std::filebuf *>(bodyStreamBuf) !=
+						nullptr ||
+					dynamic_cast<FileStreamBuf *>(bodyStreamBuf) !=
+						nullptr};
+
 				// Set Content-Length if body is determinate.
 				if (inAvail == -1 && allowZero) {
 					this->headers.contentLength(0);
-				} else if (inAvail > 0) {
+				} else if (isDeterminate && inAvail > 0) {
 					this->headers.contentLength(
 						static_cast<std::size_t>(inAvail));
+				} else if (
+					!isDeterminate && transferEncoding.empty() &&
+					this->version >= Version::_1_1) {
+					this->headers.transferEncoding(
+						{Header::TransferEncoding::CHUNKED});
+					this->toEncodeChunked = true;
 				}
 			}
 		}
@@ -311,6 +600,110 @@ namespace Rain::Networking::Http {
 		}
 
 		protected:
+		// Sends head, followed by the body if withBody.
+		//
+		// Over Tcp Sockets, the head and an in-memory body are
+		// sent together in one vectored send, and file bodies
+		// with sendfile(2). Otherwise, both are streamed, and
+		// the head is flushed before a chunked body.
+		void sendHeadAndBody(
+			std::ostream &stream,
+			std::string_view head,
+			bool withBody) {
+			// As with operator<<, nothing is sent on a stream which
+			// is not good.
+			if (!stream.good()) {
+				stream.setstate(std::ios::failbit);
+				return;
+			}
+
+			if (withBody && this->toEncodeChunked) {
+				stream << head;
+				stream.flush();
+				ChunkedTransferEncodingOStreamBuf chunked(
+					stream.rdbuf(), this->chunkLen);
+
+				// Whenever the body has nothing buffered, what has
+				// been taken from it is sent before asking it for
+				// more, so that each producer call is sent as it
+				// returns. A body which fails is left without its
+				// last chunk, so that it is not taken as complete.
+				std::streambuf *bodyStreamBuf{this->body.rdbuf()};
+				char buffer[1_zu << 12];
+				while (bodyStreamBuf != nullptr) {
+					try {
+						std::streamsize const cAvail{
+							bodyStreamBuf->in_avail()};
+						if (cAvail <= 0) {
+							if (
+								chunked.pubsync() == -1 ||
+								std::streambuf::traits_type::eq_int_type(
+									bodyStreamBuf->sgetc(),
+									std::streambuf::traits_type::eof())) {
+								break;
+							}
+							continue;
+						}
+						std::streamsize const cTaken{
+							bodyStreamBuf->sgetn(
+								buffer,
+								std::min(
+									cAvail,
+									static_cast<std::streamsize>(
+										sizeof(buffer))))};
+						if (chunked.sputn(buffer, cTaken) != cTaken) {
+							break;
+						}
+					} catch (...) {
+						stream.setstate(std::ios::badbit);
+						return;
+					}
+				}
+				if (!chunked.close(this->trailers)) {
+					stream.setstate(std::ios::badbit);
+				}
+				return;
+			}
+
+			Tcp::VectoredSenderInterface *vectoredSender{
+				dynamic_cast<Tcp::VectoredSenderInterface *>(
+					stream.rdbuf())};
+			std::stringbuf *bodyStringBuf{nullptr};
+			if (withBody) {
+				bodyStringBuf =
+					dynamic_cast<std::stringbuf *>(this->body.rdbuf());
+			}
+			if (
+				vectoredSender != nullptr &&
+				(!withBody || this->body.rdbuf() == nullptr ||
+					bodyStringBuf != nullptr)) {
+				// The unread part of the body is at the end of its
+				// view.
+				std::string_view bodyView;
+				if (bodyStringBuf != nullptr) {
+					bodyView = bodyStringBuf->view();
+					bodyView.remove_prefix(
+						bodyView.size() -
+						static_cast<std::size_t>(std::max(
+							std::streamsize(0), this->body.inAvail())));
+				}
+				std::string_view const buffers[]{head, bodyView};
+				if (!vectoredSender->send(buffers)) {
+					stream.setstate(std::ios::badbit);
+				} else if (bodyStringBuf != nullptr) {
+					bodyStringBuf->pubseekoff(
+						0, std::ios::end, std::ios::in);
+				}
+				return;
+			}
+
+			stream << head;
+			if (withBody) {
+				stream << this->body;
+			}
+			stream.flush();
+		}
+
 		// Body parsing function shared between R/R.
 		virtual void recvBody(std::istream &stream) override {
 			// Create streambuf for body based on
@@ -379,7 +772,7 @@ namespace Rain::Networking::Http {
 						this->bodyTransferEncodingStreamBufs
 							.emplace_back(
 								new ChunkedTransferEncodingIStreamBuf(
-									curStreamBuf));
+									curStreamBuf, &this->trailers));
 						break;
 
 					// No default.
@@ -25,7 +25,10 @@ namespace Rain::Networking::Http {
 			CONNECT,
 			OPTIONS,
 			TRACE,
-			PATCH
+			PATCH,
+			// Begins the HTTP/2 connection preface (RFC 9113
+			// 3.4), and is otherwise not allowed.
+			PRI
 		};
 
 		private:
@@ -45,7 +48,8 @@ namespace Rain::Networking::Http {
 				{"CONNECT", CONNECT},
 				{"OPTIONS", OPTIONS},
 				{"TRACE", TRACE},
-				{"PATCH", PATCH}};
+				{"PATCH", PATCH},
+				{"PRI", PRI}};
 
 		// Direct constructors. Parsing strings may throw.
 		constexpr Method(Value value = GET) noexcept :
@@ -74,6 +78,8 @@ namespace Rain::Networking::Http {
 					return "OPTIONS";
 				case TRACE:
 					return "TRACE";
+				case PRI:
+					return "PRI";
 				case PATCH:
 				// Default never occurs since value is private.
 				default:
@@ -0,0 +1,94 @@
+// Streambuf over bytes generated as they are read, for
+// Bodies which are streamed with constant memory.
+#pragma once
+
+#include <functional>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <utility>
+
+namespace Rain::Networking::Http {
+	// Read-only streambuf over bytes pushed by a producer as
+	// they are read. Whenever the buffer is exhausted, the
+	// producer is called to push the next bytes to the given
+	// ostream, and returns false once it has pushed its last;
+	// it is not called again after.
+	//
+	// Only the bytes of one call are held at once, so a body
+	// of any length is produced in the memory of its largest
+	// call. showmanyc is indeterminate, so a Body wrapping a
+	// ProducerStreamBuf is sent with chunked
+	// Transfer-Encoding from HTTP/1.1, and each call is sent
+	// as it returns, up to the chunkLen of its message.
+	class ProducerStreamBuf : public std::streambuf {
+		public:
+		using Producer = std::function<bool(std::ostream &)>;
+
+		private:
+		Producer producer;
+
+		// Set once the producer has returned false.
+		bool isDone{false};
+
+		// Bytes of the latest call, whose capacity is reused
+		// across calls.
+		std::string buffer;
+
+		public:
+		ProducerStreamBuf(Producer &&producer) :
+			producer(std::move(producer)) {}
+
+		// Disable copy.
+		ProducerStreamBuf(ProducerStreamBuf const &) = delete;
+		ProducerStreamBuf &operator=(ProducerStreamBuf const &) =
+			delete;
+
+		// Unread bytes are moved along with the buffer.
+		ProducerStreamBuf(ProducerStreamBuf &&other) noexcept :
+			std::streambuf(other),
+			producer(std::move(other.producer)),
+			isDone(other.isDone) {
+			std::size_t const offset{static_cast<std::size_t>(
+				other.gptr() - other.eback())},
+				end{static_cast<std::size_t>(
+					other.egptr() - other.eback())};
+			this->buffer = std::move(other.buffer);
+			this->setg(
+				this->buffer.data(),
+				this->buffer.data() + offset,
+				this->buffer.data() + end);
+			other.setg(nullptr, nullptr, nullptr);
+		}
+		ProducerStreamBuf &operator=(ProducerStreamBuf &&) =
+			delete;
+
+		protected:
+		// Calls the producer until it pushes any bytes, or
+		// finishes.
+		virtual int_type underflow() override {
+			if (this->gptr() != this->egptr()) {
+				return traits_type::to_int_type(*this->gptr());
+			}
+			while (!this->isDone) {
+				this->buffer.clear();
+				std::ostringstream stream(std::move(this->buffer));
+				this->isDone = !this->producer(stream);
+				this->buffer = std::move(stream).str();
+				if (!this->buffer.empty()) {
+					this->setg(
+						this->buffer.data(),
+						this->buffer.data(),
+						this->buffer.data() + this->buffer.length());
+					return traits_type::to_int_type(*this->gptr());
+				}
+			}
+			return traits_type::eof();
+		}
+
+		// The length is not known ahead of time.
+		virtual std::streamsize showmanyc() override {
+			return this->isDone ? -1 : 0;
+		}
+	};
+}
@@ -2,8 +2,10 @@
 #pragma once
 
 #include "../req_res/request.hpp"
+#include "../tcp/socket.hpp"
 #include "message.hpp"
 #include "method.hpp"
+#include "request_parser.hpp"
 
 namespace Rain::Networking::Http {
 	class RequestMessageSpecInterface :
@@ -17,7 +19,8 @@ namespace Rain::Networking::Http {
 			METHOD_NOT_ALLOWED,
 			MALFORMED_VERSION,
 			MALFORMED_HEADERS,
-			MALFORMED_BODY
+			MALFORMED_BODY,
+			MALFORMED_REQUEST_LINE
 		};
 		class ErrorCategory : public std::error_category {
 			public:
@@ -38,6 +41,8 @@ namespace Rain::Networking::Http {
 						return "Malformed HTTP body, possibly due to "
 									 "Transfer-Encoding and "
 									 "Content-Length.";
+					case Error::MALFORMED_REQUEST_LINE:
+						return "Malformed HTTP request line.";
 					default:
 						return "Generic.";
 				}
@@ -90,19 +95,19 @@ namespace Rain::Networking::Http {
 			this->ppDefaultContentType();
 
 			// Startline/request line.
+			std::ostringstream head;
 			switch (this->version) {
 				case Version::_1_0:
 				case Version::_1_1:
-					stream << this->method << " " << this->target
-								 << " HTTP/" << this->version << "\r\n";
-					stream << this->headers << "\r\n" << this->body;
+					head << this->method << " " << this->target
+							 << " HTTP/" << this->version << "\r\n"
+							 << this->headers << "\r\n";
 					break;
 
 				case Version::_0_9:
-					stream << this->method << " " << this->target
-								 << "\r\n";
-
 					// HTTP/0.9 Requests don't have headers nor body.
+					head << this->method << " " << this->target
+							 << "\r\n";
 					break;
 
 				default:
@@ -110,58 +115,81 @@ namespace Rain::Networking::Http {
 						Error::HTTP_VERSION_NOT_SUPPORTED);
 			}
 
-			stream.flush();
+			this->sendHeadAndBody(
+				stream, head.view(), this->version != Version::_0_9);
 		}
 		virtual void recvWith(std::istream &stream) override {
-			// Receive startline. Take care to limit token length
-			// to avoid suffering from maliciously long tokens.
+			// The head is parsed in place in the receive buffer of
+			// a Tcp Socket where possible, and otherwise from a
+			// copy.
+			RequestParser parser;
+			std::string head;
+			Tcp::PeekableStreamBuf *peekable{
+				dynamic_cast<Tcp::PeekableStreamBuf *>(
+					stream.rdbuf())};
+			bool inPlace;
 			try {
-				stream >> this->method;
+				inPlace = this->recvHead(stream, parser, head);
 			} catch (...) {
-				throw Exception(Error::METHOD_NOT_ALLOWED);
+				throw Exception(
+					parser.hasRequestLine()
+						? Error::MALFORMED_HEADERS
+						: Error::MALFORMED_REQUEST_LINE);
 			}
 
-			// Target. May be terminated with \n instead of ' ' in
-			// the case of HTTP/0.9.
-			this->target.resize(1_zu << 12);
-			stream.getline(
-				&this->target[0], this->target.size(), '\n');
-
-			// -2 for \r\0.
-			this->target.resize(
-				static_cast<std::size_t>(std::max(
-					std::streamsize(0), stream.gcount() - 2)));
-
-			// Version. Response version requires special parsing,
-			// so this can't be abstracted out.
 			try {
-				// versionStr is 8 characters (e.g. HTTP/1.1), so we
-				// reserve +3 for the nullptr and \r, and delimiter.
-				// versionStr must be in the format HTTP/-.-.
-				this->version = Version(
-					this->target.substr(this->target.length() - 3));
-
-				// Remove the version from the target.
-				this->target.resize(
-					std::min(
-						this->target.length(),
-						this->target.length() - 9));
+				this->method = Method(std::string(parser.method()));
 			} catch (...) {
-				// Bad version, assume it is 0.9, and the target
-				// remains the same.
+				throw Exception(Error::METHOD_NOT_ALLOWED);
+			}
+			this->target = parser.target();
+
+			// Version is empty for HTTP/0.9, and otherwise must
+			// be in the format HTTP/-.-.
+			std::string_view version{parser.version()};
+			if (version.empty()) {
 				this->version = Version::_0_9;
+			} else if (
+				version.size() != 8 ||
+				version.substr(0, 5) != "HTTP/") {
+				throw Exception(Error::MALFORMED_VERSION);
+			} else {
+				try {
+					this->version =
+						Version(std::string(version.substr(5)));
+				} catch (...) {
+					throw Exception(
+						Error::HTTP_VERSION_NOT_SUPPORTED);
+				}
 			}
 
-			// Receive headers & body.
+			// PRI only begins the HTTP/2 connection preface, whose
+			// remainder is left to be received by HTTP/2.
+			if (
+				this->method == Method::PRI &&
+				(this->version != Version::_2_0 ||
+					this->target != "*" || parser.cHeaders() != 0)) {
+				throw Exception(Error::METHOD_NOT_ALLOWED);
+			}
+
+			// Headers are copied out before the head is consumed
+			// from the receive buffer.
+			this->headers.reserve(parser.cHeaders());
+			for (std::size_t idx{0}; idx < parser.cHeaders();
+					 idx++) {
+				auto header{parser.header(idx)};
+				this->headers.emplace(
+					std::string(header.first),
+					std::string(header.second));
+			}
+			if (inPlace) {
+				peekable->consume(parser.size());
+			}
+
+			// Receive body.
 			switch (this->version) {
 				case Version::_1_0:
 				case Version::_1_1: {
-					try {
-						stream >> this->headers;
-					} catch (...) {
-						throw Exception(Error::MALFORMED_HEADERS);
-					}
-
 					try {
 						this->recvBody(stream);
 					} catch (...) {
@@ -174,11 +202,74 @@ namespace Rain::Networking::Http {
 					// No headers or body.
 					break;
 
+				case Version::_2_0:
+					if (this->method == Method::PRI) {
+						break;
+					}
+					throw Exception(
+						Error::HTTP_VERSION_NOT_SUPPORTED);
+
 				default:
 					throw Exception(
 						Error::HTTP_VERSION_NOT_SUPPORTED);
 			}
 		}
+
+		private:
+		// Parses the head from stream. Returns true if parser
+		// refers to the receive buffer of stream, whose head
+		// has yet to be consumed, or false if it refers to
+		// head.
+		bool recvHead(
+			std::istream &stream,
+			RequestParser &parser,
+			std::string &head) {
+			Tcp::PeekableStreamBuf *peekable{
+				dynamic_cast<Tcp::PeekableStreamBuf *>(
+					stream.rdbuf())};
+			if (peekable != nullptr) {
+				// Until the head outgrows the receive buffer.
+				while (!parser.parse(peekable->peek())) {
+					if (peekable->isFull()) {
+						break;
+					}
+					if (!peekable->recvMore()) {
+						stream.setstate(std::ios::eofbit);
+						throw Exception(Error::MALFORMED_HEADERS);
+					}
+				}
+				if (parser.isComplete()) {
+					return true;
+				}
+				head = peekable->peek();
+				peekable->consume(head.size());
+			}
+
+			// Lines are taken one at a time, so that no bytes past
+			// the head are consumed. Lines longer than the line
+			// buffer are taken in pieces.
+			char line[1_zu << 10];
+			while (!parser.isComplete()) {
+				stream.getline(line, sizeof(line));
+				std::size_t count{
+					static_cast<std::size_t>(stream.gcount())};
+				if (stream.good()) {
+					head.append(line, count - 1);
+					head.push_back('\n');
+					parser.parse(head);
+				} else if (
+					!stream.eof() && count == sizeof(line) - 1) {
+					stream.clear();
+					head.append(line, count);
+					if (head.size() > RequestParser::MAX_HEAD_SIZE) {
+						parser.parse(head);
+					}
+				} else {
+					throw Exception(Error::MALFORMED_HEADERS);
+				}
+			}
+			return false;
+		}
 	};
 
 	// Shorthand.
@@ -0,0 +1,360 @@
+// Zero-copy incremental parser for HTTP/1.x request heads.
+#pragma once
+
+#include "../../error/exception.hpp"
+#include "../../literal.hpp"
+#include "../../string/string.hpp"
+
+#include <array>
+#include <bit>
+#include <string_view>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+#endif
+
+namespace Rain::Networking::Http {
+	// Incremental parser for the head (request line and
+	// headers) of an HTTP/1.x request.
+	//
+	// The parser works in place on a caller-owned buffer, and
+	// produces std::string_views into it for the method,
+	// target, version, and headers; it does not allocate.
+	// Parsing resumes where it left off as the buffer grows
+	// across partial reads, so each byte is scanned about
+	// once. Line ends and header colons are found 16 bytes at
+	// a time with SSE2 where available.
+	//
+	// HTTP/0.9 request lines (without a version) complete the
+	// head immediately. Empty lines before the request line
+	// are skipped, and bare LF is accepted in place of CRLF.
+	class RequestParser {
+		public:
+		enum class Error {
+			MALFORMED_REQUEST_LINE = 1,
+			NO_COLON_DELIMITER,
+			BARE_CARRIAGE_RETURN,
+			TOO_MANY_HEADERS,
+			HEAD_OVERFLOW
+		};
+		class ErrorCategory : public std::error_category {
+			public:
+			char const *name() const noexcept {
+				return "Rain::Networking::Http::RequestParser";
+			}
+			std::string message(int error) const noexcept {
+				switch (static_cast<Error>(error)) {
+					case Error::MALFORMED_REQUEST_LINE:
+						return "Malformed request line.";
+					case Error::NO_COLON_DELIMITER:
+						return "No colon delimiter in header line.";
+					case Error::BARE_CARRIAGE_RETURN:
+						return "Carriage return not followed by line "
+									 "feed.";
+					case Error::TOO_MANY_HEADERS:
+						return "Too many headers.";
+					case Error::HEAD_OVERFLOW:
+						return "Request head cannot exceed 64KB.";
+					default:
+						return "Generic.";
+				}
+			}
+		};
+		using Exception =
+			Rain::Error::Exception<Error, ErrorCategory>;
+
+		static std::size_t const MAX_HEADERS{128},
+			MAX_HEAD_SIZE{1_zu << 16};
+
+		private:
+		// Tokens are stored as offsets, so that the buffer may
+		// move between calls to `parse`.
+		class Token {
+			public:
+			std::size_t offset, length;
+		};
+
+		enum class State { REQUEST_LINE, HEADERS, COMPLETE };
+
+		static std::size_t const NPOS{SIZE_MAX};
+
+		std::string_view buffer;
+		State state;
+
+		// Start of the line being parsed, the offset up to
+		// which it has been scanned, and its colon, if found.
+		std::size_t lineBegin, scanned, colon;
+
+		Token methodToken, targetToken, versionToken;
+		std::array<std::pair<Token, Token>, MAX_HEADERS>
+			headerTokens;
+		std::size_t cHeaderTokens;
+
+		public:
+		RequestParser() noexcept { this->reset(); }
+
+		// Prepare to parse a new head.
+		void reset() noexcept {
+			this->buffer = {};
+			this->state = State::REQUEST_LINE;
+			this->lineBegin = this->scanned = 0;
+			this->colon = RequestParser::NPOS;
+			this->methodToken = this->targetToken =
+				this->versionToken = {0, 0};
+			this->cHeaderTokens = 0;
+		}
+
+		// Parses as much of buffer as is available. Returns
+		// true once the head is complete, in which case it
+		// occupies the first `size` bytes of buffer, and false
+		// if more bytes are needed. Throws on a malformed head.
+		//
+		// Between calls, buffer may move or grow, but its
+		// existing bytes must not change.
+		bool parse(std::string_view buffer) {
+			this->buffer = buffer;
+			while (this->state != State::COMPLETE) {
+				if (!(this->state == State::REQUEST_LINE
+								? this->parseRequestLine()
+								: this->parseHeaderLine())) {
+					if (this->buffer.size() > MAX_HEAD_SIZE) {
+						throw Exception(Error::HEAD_OVERFLOW);
+					}
+					return false;
+				}
+			}
+			return true;
+		}
+
+		bool isComplete() const noexcept {
+			return this->state == State::COMPLETE;
+		}
+		bool hasRequestLine() const noexcept {
+			return this->state != State::REQUEST_LINE;
+		}
+
+		// Bytes of the buffer parsed so far, which is the size
+		// of the head once complete.
+		std::size_t size() const noexcept {
+			return this->lineBegin;
+		}
+
+		// Views into the buffer last passed to `parse`. Valid
+		// once the request line has been parsed. version is
+		// empty for HTTP/0.9, and otherwise in the form
+		// HTTP/-.-.
+		std::string_view method() const noexcept {
+			return this->view(this->methodToken);
+		}
+		std::string_view target() const noexcept {
+			return this->view(this->targetToken);
+		}
+		std::string_view version() const noexcept {
+			return this->view(this->versionToken);
+		}
+
+		// Header names and values, with surrounding whitespace
+		// trimmed, in the order received.
+		std::size_t cHeaders() const noexcept {
+			return this->cHeaderTokens;
+		}
+		std::pair<std::string_view, std::string_view> header(
+			std::size_t idx) const noexcept {
+			return {
+				this->view(this->headerTokens[idx].first),
+				this->view(this->headerTokens[idx].second)};
+		}
+
+		// Finds the first occurrence of any of a, b, or c in
+		// [begin, end), or end if none.
+		static char const *findFirstOf(
+			char const *begin,
+			char const *end,
+			char a,
+			char b,
+			char c) noexcept {
+#if defined(__SSE2__) || defined(_M_X64)
+			__m128i const aMask{_mm_set1_epi8(a)},
+				bMask{_mm_set1_epi8(b)}, cMask{_mm_set1_epi8(c)};
+			for (; end - begin >= 16; begin += 16) {
+				__m128i chunk{_mm_loadu_si128(
+					reinterpret_cast<__m128i const *>(begin))};
+				int found{_mm_movemask_epi8(_mm_or_si128(
+					_mm_or_si128(
+						_mm_cmpeq_epi8(chunk, aMask),
+						_mm_cmpeq_epi8(chunk, bMask)),
+					_mm_cmpeq_epi8(chunk, cMask)))};
+				if (found != 0) {
+					return begin +
+						std::countr_zero(
+							static_cast<unsigned int>(found));
+				}
+			}
+#endif
+			for (; begin != end && *begin != a && *begin != b &&
+					 *begin != c;
+					 begin++) {
+			}
+			return begin;
+		}
+
+		private:
+		std::string_view view(Token token) const noexcept {
+			return this->buffer.substr(
+				token.offset, token.length);
+		}
+		Token tokenOf(std::string_view str) const noexcept {
+			return {
+				static_cast<std::size_t>(
+					str.data() - this->buffer.data()),
+				str.size()};
+		}
+
+		// Finds the end of the current line, continuing from
+		// `scanned`. Returns false if the line is incomplete.
+		// Otherwise, end is set to the offset of the line
+		// terminator, and next to the offset after it.
+		bool findLineEnd(std::size_t &end, std::size_t &next) {
+			char const *data{this->buffer.data()};
+			std::size_t found{static_cast<std::size_t>(
+				RequestParser::findFirstOf(
+					data + this->scanned,
+					data + this->buffer.size(),
+					'\r',
+					'\n',
+					'\n') -
+				data)};
+			return this->endLineAt(found, end, next);
+		}
+
+		// Given the offset of the first CR or LF after the line
+		// begins, determines where the line ends.
+		bool endLineAt(
+			std::size_t found,
+			std::size_t &end,
+			std::size_t &next) {
+			if (found == this->buffer.size()) {
+				this->scanned = found;
+				return false;
+			}
+			end = found;
+			if (this->buffer[found] == '\n') {
+				next = found + 1;
+				return true;
+			}
+			if (found + 1 == this->buffer.size()) {
+				this->scanned = found;
+				return false;
+			}
+			if (this->buffer[found + 1] != '\n') {
+				throw Exception(Error::BARE_CARRIAGE_RETURN);
+			}
+			next = found + 2;
+			return true;
+		}
+
+		// Moves on to the line starting at next.
+		void nextLine(std::size_t next) noexcept {
+			this->lineBegin = this->scanned = next;
+			this->colon = RequestParser::NPOS;
+		}
+
+		// method SP target [SP version] CRLF.
+		bool parseRequestLine() {
+			while (
+				this->lineBegin < this->buffer.size() &&
+				(this->buffer[this->lineBegin] == '\r' ||
+					this->buffer[this->lineBegin] == '\n')) {
+				this->nextLine(this->lineBegin + 1);
+			}
+
+			std::size_t end, next;
+			if (!this->findLineEnd(end, next)) {
+				return false;
+			}
+			std::string_view line{this->buffer.substr(
+				this->lineBegin, end - this->lineBegin)};
+			std::size_t methodEnd{line.find(' ')},
+				targetEnd{line.rfind(' ')};
+			if (
+				methodEnd == 0 ||
+				methodEnd == std::string_view::npos ||
+				methodEnd + 1 == line.size()) {
+				throw Exception(Error::MALFORMED_REQUEST_LINE);
+			}
+
+			this->methodToken =
+				this->tokenOf(line.substr(0, methodEnd));
+			if (targetEnd == methodEnd) {
+				// HTTP/0.9 has no version, headers, or body.
+				this->targetToken =
+					this->tokenOf(line.substr(methodEnd + 1));
+				this->state = State::COMPLETE;
+			} else {
+				if (
+					targetEnd == methodEnd + 1 ||
+					targetEnd + 1 == line.size()) {
+					throw Exception(Error::MALFORMED_REQUEST_LINE);
+				}
+				this->targetToken = this->tokenOf(line.substr(
+					methodEnd + 1, targetEnd - methodEnd - 1));
+				this->versionToken =
+					this->tokenOf(line.substr(targetEnd + 1));
+				this->state = State::HEADERS;
+			}
+			this->nextLine(next);
+			return true;
+		}
+
+		// name ":" OWS value OWS CRLF, or the final CRLF.
+		bool parseHeaderLine() {
+			char const *data{this->buffer.data()};
+			if (this->colon == RequestParser::NPOS) {
+				std::size_t found{static_cast<std::size_t>(
+					RequestParser::findFirstOf(
+						data + this->scanned,
+						data + this->buffer.size(),
+						':',
+						'\r',
+						'\n') -
+					data)};
+				if (
+					found != this->buffer.size() &&
+					this->buffer[found] == ':') {
+					this->colon = found;
+					this->scanned = found + 1;
+				} else {
+					std::size_t end, next;
+					if (!this->endLineAt(found, end, next)) {
+						return false;
+					}
+					if (end != this->lineBegin) {
+						throw Exception(Error::NO_COLON_DELIMITER);
+					}
+					this->state = State::COMPLETE;
+					this->nextLine(next);
+					return true;
+				}
+			}
+
+			std::size_t end, next;
+			if (!this->findLineEnd(end, next)) {
+				return false;
+			}
+			if (this->cHeaderTokens == MAX_HEADERS) {
+				throw Exception(Error::TOO_MANY_HEADERS);
+			}
+			this->headerTokens[this->cHeaderTokens++] = {
+				this->tokenOf(String::trimWhitespace(
+					this->buffer.substr(
+						this->lineBegin,
+						this->colon - this->lineBegin))),
+				this->tokenOf(String::trimWhitespace(
+					this->buffer.substr(
+						this->colon + 1, end - this->colon - 1)))};
+			this->nextLine(next);
+			return true;
+		}
+	};
+}
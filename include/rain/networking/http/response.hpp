@@ -152,6 +152,37 @@ namespace Rain::Networking::Http {
 				version),
 			statusCode(statusCode),
 			reasonPhrase(reasonPhrase) {}
+		// Response with a file, or the byte range of it
+		// requested: 200 without a range, 206 with a satisfiable
+		// range, and 416 with an unsatisfiable one. The file is
+		// sent with sendfile(2) where available.
+		ResponseMessageSpec(
+			std::optional<Header::Range> const &range,
+			FileStreamBuf &&fileStreamBuf,
+			Headers &&headers = {},
+			Version version = {}) :
+			Message(std::move(headers), {}, version),
+			statusCode(StatusCode::OK) {
+			std::size_t size{fileStreamBuf.size()}, offset, length;
+			this->headers["Accept-Ranges"] = "bytes";
+			if (range) {
+				if (!range.value().resolve(size, offset, length)) {
+					this->statusCode =
+						StatusCode::REQUESTED_RANGE_NOT_SATISFIABLE;
+					this->headers["Content-Range"] =
+						"bytes */" + std::to_string(size);
+					return;
+				}
+				fileStreamBuf.range(offset, length);
+				this->statusCode = StatusCode::PARTIAL_CONTENT;
+				this->headers["Content-Range"] = "bytes " +
+					std::to_string(offset) + "-" +
+					std::to_string(offset + length - 1) + "/" +
+					std::to_string(size);
+			}
+			this->headers.contentLength(fileStreamBuf.remaining());
+			this->body = Body(std::move(fileStreamBuf));
+		}
 		ResponseMessageSpec(ResponseMessageSpec &&other) :
 			Message(std::move(other)),
 			statusCode(other.statusCode),
@@ -162,23 +193,29 @@ namespace Rain::Networking::Http {
 		// Overrides for Super versions implement protocol
 		// behavior.
 		virtual void sendWith(std::ostream &stream) override {
-			// pp-chain.
-			this->ppEstimateContentLength(true);
+			// pp-chain. 1xx responses must not have a
+			// Content-Length.
+			this->ppEstimateContentLength(
+				this->statusCode.getCategory() !=
+				StatusCode::Category::INFORMATIONAL);
 			this->ppDefaultContentType();
 
+			// The head is assembled first, so that it may be sent
+			// together with the body.
+			std::ostringstream head;
 			switch (this->version) {
 				case Version::_1_0:
 				case Version::_1_1:
-					// Send startline/response line.
-					stream << "HTTP/" << this->version << " "
-								 << this->statusCode << " "
-								 << (this->reasonPhrase.empty()
-												? this->statusCode.getReasonPhrase()
-												: this->reasonPhrase)
-								 << "\r\n";
-
-					// Send headers.
-					stream << this->headers << "\r\n";
+					// Startline/response line.
+					head << "HTTP/" << this->version << " "
+							 << this->statusCode << " "
+							 << (this->reasonPhrase.empty()
+											? this->statusCode.getReasonPhrase()
+											: this->reasonPhrase)
+							 << "\r\n";
+
+					// Headers.
+					head << this->headers << "\r\n";
 					break;
 
 				case Version::_0_9:
@@ -190,8 +227,7 @@ namespace Rain::Networking::Http {
 			}
 
 			// HTTP/0.9, 1.0, 1.1 responses all have bodies.
-			stream << this->body;
-			stream.flush();
+			this->sendHeadAndBody(stream, head.view(), true);
 		}
 		virtual void recvWith(std::istream &stream) override {
 			// Version. Same as in Request, reserve 11 characters.
@@ -0,0 +1,430 @@
+// Shared cache of serialized HTTP responses, which Workers
+// send without calling their handlers.
+#pragma once
+
+#include "../../algorithm/lru.hpp"
+#include "../../literal.hpp"
+#include "../../metrics.hpp"
+#include "../../string/string.hpp"
+#include "headers.hpp"
+#include "method.hpp"
+#include "status_code.hpp"
+#include "version.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Rain::Networking::Http {
+	// Thread-safe cache of serialized responses to GET
+	// requests, bounded in bytes, and shared by Workers (see
+	// WorkerSocketSpec::responseCache).
+	//
+	// Responses are keyed on host and target, and on the
+	// values of the request headers named by their Vary. They
+	// are fresh for their s-maxage, max-age, or Expires, in
+	// that order (RFC 9111 4.2.1). Responses without explicit
+	// freshness are not stored, and neither are responses
+	// which are no-store, no-cache, or private, partial, or
+	// which have Set-Cookie or `Vary: *`, or bodies which are
+	// not in memory.
+	//
+	// Requests with Authorization, Range, or Cache-Control
+	// no-store bypass the cache. Requests with Cache-Control
+	// no-cache or max-age=0 are always handled anew, and their
+	// responses stored.
+	class ResponseCache {
+		public:
+		// A stored response. Immutable once stored, so that it
+		// may be sent without holding the cache.
+		class Entry {
+			public:
+			// The response, serialized. Its head ends at headLen,
+			// just before the CRLF ending it, so that Age may be
+			// added when sent.
+			std::string bytes;
+			std::size_t headLen;
+
+			// Head of the 304 response to conditional requests,
+			// also without the CRLF ending it.
+			std::string notModified;
+
+			// Validators, if any.
+			std::optional<std::string> eTag;
+			std::optional<Header::HttpDate> lastModified;
+
+			// Request headers named by Vary, and their values.
+			std::vector<std::pair<std::string, std::string>>
+				varied;
+
+			std::chrono::steady_clock::time_point timeStored,
+				timeExpires;
+
+			std::string_view head() const noexcept {
+				return std::string_view(this->bytes)
+					.substr(0, this->headLen);
+			}
+			std::string_view body() const noexcept {
+				return std::string_view(this->bytes)
+					.substr(this->headLen + 2);
+			}
+
+			// Bytes counted towards the capacity of the cache.
+			std::size_t size() const noexcept {
+				return this->bytes.size() + this->notModified.size();
+			}
+
+			// Whether a conditional request may be answered with
+			// 304. If-None-Match takes precedence over
+			// If-Modified-Since, and compares weakly (RFC 9110
+			// 13.1.2).
+			bool isNotModified(Headers &headers) const {
+				auto it{headers.find("If-None-Match")};
+				if (it != headers.end()) {
+					if (!this->eTag) {
+						return false;
+					}
+					std::string_view eTags{it->second};
+					while (!eTags.empty()) {
+						std::size_t const comma{eTags.find(',')};
+						std::string_view const eTag{
+							String::trimWhitespace(eTags.substr(
+								0, std::min(comma, eTags.size())))};
+						if (
+							eTag == "*" ||
+							Entry::opaqueTagOf(eTag) ==
+								Entry::opaqueTagOf(*this->eTag)) {
+							return true;
+						}
+						eTags.remove_prefix(
+							comma == std::string_view::npos ? eTags.size()
+																							: comma + 1);
+					}
+					return false;
+				}
+				std::optional<Header::HttpDate> const
+					ifModifiedSince{headers.ifModifiedSince()};
+				return ifModifiedSince && this->lastModified &&
+					*this->lastModified <= *ifModifiedSince;
+			}
+
+			private:
+			// Entity-tags without their weak prefix.
+			static std::string_view opaqueTagOf(
+				std::string_view eTag) {
+				if (eTag.starts_with("W/")) {
+					eTag.remove_prefix(2);
+				}
+				return eTag;
+			}
+		};
+
+		// Lookups across all ResponseCaches, and whether they
+		// found a fresh response.
+		static inline Metrics::Counter hitsMetric{
+			"rain_http_response_cache_hits_total",
+			"Requests answered by a response cache."},
+			missesMetric{
+				"rain_http_response_cache_misses_total",
+				"Requests not answered by a response cache."};
+
+		private:
+		// Variants of a response, by the values of its Vary.
+		// At most MAX_VARIANTS are kept per key, replacing the
+		// oldest.
+		using Variants =
+			std::vector<std::shared_ptr<Entry const>>;
+		static std::size_t const MAX_VARIANTS{8};
+
+		std::size_t const _capacity, maxEntryLen;
+
+		std::mutex mtx;
+		Algorithm::LruCache<std::string, Variants> lruCache{
+			SIZE_MAX};
+		std::size_t cBytes{0};
+		std::atomic_uint64_t cHits{0}, cMisses{0};
+
+		public:
+		// Stores up to capacity bytes of responses, each of at
+		// most maxEntryLen, by default an eighth of capacity.
+		ResponseCache(
+			std::size_t capacity = 1_zu << 26,
+			std::size_t maxEntryLen = 0) :
+			_capacity(capacity),
+			maxEntryLen(
+				maxEntryLen == 0
+					? capacity / 8
+					: std::min(maxEntryLen, capacity)) {}
+
+		// Forbid copy/move, as Workers refer to it.
+		ResponseCache(ResponseCache const &) = delete;
+		ResponseCache &operator=(ResponseCache const &) = delete;
+		ResponseCache(ResponseCache &&) = delete;
+		ResponseCache &operator=(ResponseCache &&) = delete;
+
+		std::size_t capacity() const noexcept {
+			return this->_capacity;
+		}
+
+		// Bytes of responses stored.
+		std::size_t size() {
+			std::lock_guard lck(this->mtx);
+			return this->cBytes;
+		}
+
+		// Lookups which found a fresh response, and which did
+		// not, respectively.
+		std::uint64_t hits() const noexcept {
+			return this->cHits;
+		}
+		std::uint64_t misses() const noexcept {
+			return this->cMisses;
+		}
+
+		// Key of a request, or nullopt if it bypasses the
+		// cache. HEAD requests share the responses of GET.
+		template<typename Request>
+		static std::optional<std::string> keyOf(Request &req) {
+			if (
+				(req.method != Method::GET &&
+					req.method != Method::HEAD) ||
+				(req.version != Version::_1_0 &&
+					req.version != Version::_1_1) ||
+				req.headers.find("Authorization") !=
+					req.headers.end() ||
+				req.headers.find("Range") != req.headers.end() ||
+				req.headers.cacheControl().noStore) {
+				return {};
+			}
+			std::string key{req.headers.host().asStr()};
+			String::toLower(key);
+			key += ' ';
+			key += req.target;
+			return key;
+		}
+
+		// Fresh response to a request with key, if stored.
+		std::shared_ptr<Entry const> find(
+			std::string const &key,
+			Headers &headers) {
+			Header::CacheControl const cacheControl{
+				headers.cacheControl()};
+			auto pragmaIt{headers.find("Pragma")};
+			if (
+				cacheControl.noCache ||
+				cacheControl.maxAge == 0_zu ||
+				(pragmaIt != headers.end() &&
+					pragmaIt->second.find("no-cache") !=
+						std::string::npos)) {
+				return this->miss();
+			}
+
+			auto const timeNow{std::chrono::steady_clock::now()};
+			std::lock_guard lck(this->mtx);
+			auto lruIt{this->lruCache.find(key)};
+			if (lruIt == this->lruCache.end()) {
+				return this->miss();
+			}
+			Variants const &variants{lruIt->second};
+			for (auto variant{variants.rbegin()};
+					 variant != variants.rend();
+					 variant++) {
+				Entry const &entry{**variant};
+				if (
+					entry.timeExpires > timeNow &&
+					std::all_of(
+						entry.varied.begin(),
+						entry.varied.end(),
+						[&headers](auto const &varied) {
+							auto it{headers.find(varied.first)};
+							return (it == headers.end() ? ""
+																					: it->second) ==
+								varied.second;
+						})) {
+					this->cHits++;
+					ResponseCache::hitsMetric.add();
+					return *variant;
+				}
+			}
+			return this->miss();
+		}
+
+		// Serializes and stores a response to a GET request with
+		// key and headers, if it may be stored. Returns the
+		// serialized response, which is stored unless it is too
+		// long, or nullptr if it may not be stored, in which
+		// case res is left as is.
+		template<typename Response>
+		std::shared_ptr<Entry const> insert(
+			std::string &&key,
+			Headers &headers,
+			Response &res) {
+			std::shared_ptr<Entry> entry{
+				ResponseCache::entryOf(headers, res)};
+			if (
+				entry == nullptr ||
+				entry->size() > this->maxEntryLen) {
+				return entry;
+			}
+
+			std::lock_guard lck(this->mtx);
+			auto lruIt{this->lruCache.find(key)};
+			if (lruIt == this->lruCache.end()) {
+				lruIt = this->lruCache
+									.insertOrAssign(std::move(key), Variants())
+									.first;
+			}
+
+			// Replace the variant with the same Vary values, and
+			// any which are stale.
+			Variants &variants{lruIt->second};
+			std::erase_if(variants, [&](auto const &variant) {
+				if (
+					variant->varied == entry->varied ||
+					variant->timeExpires <= entry->timeStored) {
+					this->cBytes -= variant->size();
+					return true;
+				}
+				return false;
+			});
+			if (variants.size() == ResponseCache::MAX_VARIANTS) {
+				this->cBytes -= variants.front()->size();
+				variants.erase(variants.begin());
+			}
+			variants.push_back(entry);
+			this->cBytes += entry->size();
+
+			while (this->cBytes > this->_capacity) {
+				for (auto const &variant : this->lruCache.evict()) {
+					this->cBytes -= variant->size();
+				}
+			}
+			return entry;
+		}
+
+		private:
+		std::shared_ptr<Entry const> miss() {
+			this->cMisses++;
+			ResponseCache::missesMetric.add();
+			return nullptr;
+		}
+
+		// Serializes a response which may be stored, or returns
+		// nullptr.
+		template<typename Response>
+		static std::shared_ptr<Entry> entryOf(
+			Headers &headers,
+			Response &res) {
+			Header::CacheControl const cacheControl{
+				res.headers.cacheControl()};
+			std::streambuf *bodyStreamBuf{res.body.rdbuf()};
+			if (
+				res.statusCode < 200 ||
+				res.statusCode == StatusCode::PARTIAL_CONTENT ||
+				res.statusCode == StatusCode::NOT_MODIFIED ||
+				cacheControl.noStore || cacheControl.noCache ||
+				cacheControl.isPrivate ||
+				res.headers.find("Set-Cookie") !=
+					res.headers.end() ||
+				(bodyStreamBuf != nullptr &&
+					dynamic_cast<std::stringbuf *>(bodyStreamBuf) ==
+						nullptr)) {
+				return nullptr;
+			}
+
+			// Explicit freshness lifetime, preferring shared
+			// directives. Invalid Expires are in the past.
+			std::chrono::seconds lifetime{0};
+			if (cacheControl.sMaxAge || cacheControl.maxAge) {
+				lifetime = std::chrono::seconds(
+					cacheControl.sMaxAge.value_or(
+						cacheControl.maxAge.value_or(0)));
+			} else if (res.headers.find("Expires") !=
+				res.headers.end()) {
+				std::optional<Header::HttpDate> const expires{
+					res.headers.expires()};
+				if (expires) {
+					lifetime = expires->time -
+						res.headers.date()
+							.value_or(Header::HttpDate::now())
+							.time;
+				}
+			}
+			if (lifetime <= std::chrono::seconds(0)) {
+				return nullptr;
+			}
+
+			// Request headers named by Vary.
+			std::shared_ptr<Entry> entry{
+				std::make_shared<Entry>()};
+			auto varyIt{res.headers.find("Vary")};
+			if (varyIt != res.headers.end()) {
+				std::string_view vary{varyIt->second};
+				while (!vary.empty()) {
+					std::size_t const comma{vary.find(',')};
+					std::string name{String::trimWhitespace(
+						vary.substr(0, std::min(comma, vary.size())))};
+					vary.remove_prefix(
+						comma == std::string_view::npos ? vary.size()
+																						: comma + 1);
+					if (name == "*") {
+						return nullptr;
+					}
+					if (name.empty()) {
+						continue;
+					}
+					auto it{headers.find(name)};
+					entry->varied.emplace_back(
+						std::move(name),
+						it == headers.end() ? "" : it->second);
+				}
+			}
+
+			std::ostringstream stream;
+			res.sendWith(stream);
+			entry->bytes = std::move(stream).str();
+			entry->headLen = entry->bytes.find("\r\n\r\n") + 2;
+
+			// 304 responses repeat the headers which a 200
+			// response would have had, except for its content.
+			StatusCode const notModifiedCode{
+				StatusCode::NOT_MODIFIED};
+			std::ostringstream notModified;
+			notModified << "HTTP/" << res.version << ' '
+									<< notModifiedCode << ' '
+									<< notModifiedCode.getReasonPhrase()
+									<< "\r\n";
+			for (char const *name :
+					 {"Cache-Control",
+						 "Content-Location",
+						 "Date",
+						 "ETag",
+						 "Expires",
+						 "Last-Modified",
+						 "Vary"}) {
+				auto it{res.headers.find(name)};
+				if (it != res.headers.end()) {
+					notModified << it->first << ": " << it->second
+											<< "\r\n";
+				}
+			}
+			entry->notModified = std::move(notModified).str();
+
+			auto eTagIt{res.headers.find("ETag")};
+			if (eTagIt != res.headers.end()) {
+				entry->eTag = eTagIt->second;
+			}
+			entry->lastModified = res.headers.lastModified();
+			entry->timeStored = std::chrono::steady_clock::now();
+			entry->timeExpires = entry->timeStored + lifetime;
+			return entry;
+		}
+	};
+}
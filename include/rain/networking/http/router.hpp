@@ -0,0 +1,360 @@
+// Radix tree routing of request paths to handlers.
+#pragma once
+
+#include "../../error/exception.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Rain::Networking::Http {
+	// Radix tree which maps paths to the values of every
+	// pattern they match.
+	//
+	// Patterns are literal, except for segments beginning
+	// with `:` or `*`. `:name` matches a single non-empty
+	// segment, and `*name` matches the rest of the path,
+	// which may be empty, and must be last. For example,
+	// `/users/:id/*rest` matches `/users/42/posts/7`, with id
+	// `42` and rest `posts/7`.
+	//
+	// Matching takes time linear in the length of the path,
+	// and independent of the number of patterns, except where
+	// parameters and literals overlap.
+	class Router {
+		public:
+		enum class Error {
+			EMPTY_PARAMETER_NAME = 1,
+			WILDCARD_NOT_LAST,
+			TOO_MANY_PARAMETERS
+		};
+		class ErrorCategory : public std::error_category {
+			public:
+			char const *name() const noexcept {
+				return "Rain::Networking::Http::Router";
+			}
+			std::string message(int error) const noexcept {
+				switch (static_cast<Error>(error)) {
+					case Error::EMPTY_PARAMETER_NAME:
+						return "Pattern parameter has no name.";
+					case Error::WILDCARD_NOT_LAST:
+						return "Pattern wildcard must be last.";
+					case Error::TOO_MANY_PARAMETERS:
+						return "Too many pattern parameters.";
+					default:
+						return "Generic.";
+				}
+			}
+		};
+		using Exception =
+			Rain::Error::Exception<Error, ErrorCategory>;
+
+		static std::size_t const MAX_PARAMETERS{16};
+
+		// Parameters of a matched pattern, as views into the
+		// matched path and the pattern's names.
+		class Match {
+			public:
+			std::array<
+				std::pair<std::string_view, std::string_view>,
+				MAX_PARAMETERS>
+				parameters;
+			std::size_t cParameters{0};
+
+			// Value of the named parameter, or empty if none.
+			std::string_view operator[](
+				std::string_view name) const noexcept {
+				for (std::size_t idx{0}; idx < this->cParameters;
+						 idx++) {
+					if (this->parameters[idx].first == name) {
+						return this->parameters[idx].second;
+					}
+				}
+				return {};
+			}
+		};
+
+		private:
+		// A pattern ending at a Node.
+		class Terminal {
+			public:
+			std::size_t value;
+			std::vector<std::string> names;
+		};
+
+		class Node {
+			public:
+			// Literal edge from the parent. Literal children
+			// begin with distinct characters.
+			std::string prefix;
+			std::vector<std::unique_ptr<Node>> children;
+
+			// Children matching a parameter or the wildcard.
+			std::unique_ptr<Node> parameter, wildcard;
+
+			std::vector<Terminal> terminals;
+		};
+
+		Node root;
+
+		// A piece of a pattern being inserted.
+		class Segment {
+			public:
+			enum class Kind { LITERAL, PARAMETER, WILDCARD };
+
+			Kind kind;
+			std::string_view literal;
+		};
+
+		public:
+		// Adds a pattern. Throws on a malformed pattern, in
+		// which case the Router is unchanged.
+		void insert(
+			std::string_view pattern,
+			std::size_t value) {
+			// The pattern is split and validated in full before
+			// any Node is touched.
+			std::vector<Segment> segments;
+			std::vector<std::string> names;
+			std::size_t idx{0};
+			while (idx < pattern.size()) {
+				bool segmentBegin{
+					idx == 0 || pattern[idx - 1] == '/'};
+				if (segmentBegin && pattern[idx] == ':') {
+					std::size_t end{std::min(
+						pattern.find('/', idx), pattern.size())};
+					if (end == idx + 1) {
+						throw Exception(Error::EMPTY_PARAMETER_NAME);
+					}
+					names.emplace_back(
+						pattern.substr(idx + 1, end - idx - 1));
+					segments.push_back({Segment::Kind::PARAMETER, {}});
+					idx = end;
+				} else if (segmentBegin && pattern[idx] == '*') {
+					if (pattern.find('/', idx) != pattern.npos) {
+						throw Exception(Error::WILDCARD_NOT_LAST);
+					}
+					names.emplace_back(pattern.substr(idx + 1));
+					segments.push_back({Segment::Kind::WILDCARD, {}});
+					idx = pattern.size();
+				} else {
+					// Literal up to the next parameter or wildcard.
+					std::size_t end{idx};
+					while (true) {
+						std::size_t slash{pattern.find('/', end)};
+						if (slash == pattern.npos) {
+							end = pattern.size();
+							break;
+						}
+						end = slash + 1;
+						if (
+							end == pattern.size() || pattern[end] == ':' ||
+							pattern[end] == '*') {
+							break;
+						}
+					}
+					segments.push_back(
+						{Segment::Kind::LITERAL,
+							pattern.substr(idx, end - idx)});
+					idx = end;
+				}
+			}
+			if (names.size() > MAX_PARAMETERS) {
+				throw Exception(Error::TOO_MANY_PARAMETERS);
+			}
+
+			Node *node{&this->root};
+			for (Segment const &segment : segments) {
+				switch (segment.kind) {
+					case Segment::Kind::PARAMETER:
+						node = Router::child(node->parameter);
+						break;
+					case Segment::Kind::WILDCARD:
+						node = Router::child(node->wildcard);
+						break;
+					case Segment::Kind::LITERAL:
+						node = Router::descend(node, segment.literal);
+						break;
+				}
+			}
+			node->terminals.push_back({value, std::move(names)});
+		}
+
+		// Adds a literal path, or if isPrefix, every path
+		// beginning with it, without interpreting `:` or `*`.
+		void insertLiteral(
+			std::string_view literal,
+			bool isPrefix,
+			std::size_t value) {
+			Node *node{Router::descend(&this->root, literal)};
+			if (isPrefix) {
+				node = Router::child(node->wildcard);
+			}
+			node->terminals.push_back({value, {}});
+		}
+
+		// Calls callback(value, Match const &) for every pattern
+		// which matches path, in no particular order.
+		template<typename Callback>
+		void match(std::string_view path, Callback &&callback)
+			const {
+			std::array<std::string_view, MAX_PARAMETERS> values;
+			Router::match(this->root, path, values, 0, callback);
+		}
+
+		// If a regular expression matches only a literal,
+		// optionally followed by `/?` or `.*`, appends to
+		// literals the strings it matches (or prefixes of them
+		// if isPrefix is set) and returns true. Otherwise,
+		// returns false, and the regular expression must be
+		// matched in full.
+		static bool literalsOfRegex(
+			std::string_view source,
+			std::vector<std::string> &literals,
+			bool &isPrefix) {
+			static std::string_view const META{"^$.|?*+()[]{}"};
+			std::string literal;
+			isPrefix = false;
+			for (std::size_t idx{0}; idx < source.size(); idx++) {
+				char c{source[idx]};
+				if (source.substr(idx) == ".*") {
+					isPrefix = true;
+					break;
+				} else if (source.substr(idx) == "/?") {
+					literals.push_back(literal);
+					literal.push_back('/');
+					break;
+				} else if (c == '\\') {
+					// Escaped punctuation is literal; other escapes
+					// are character classes.
+					if (
+						idx + 1 == source.size() ||
+						std::isalnum(static_cast<unsigned char>(
+							source[idx + 1]))) {
+						return false;
+					}
+					literal.push_back(source[++idx]);
+				} else if (META.find(c) == META.npos) {
+					literal.push_back(c);
+				} else {
+					return false;
+				}
+			}
+			literals.push_back(std::move(literal));
+			return true;
+		}
+
+		private:
+		static Node *child(std::unique_ptr<Node> &node) {
+			if (!node) {
+				node.reset(new Node);
+			}
+			return node.get();
+		}
+
+		// Returns the Node at which literal ends, splitting
+		// edges as necessary.
+		static Node *descend(
+			Node *node,
+			std::string_view literal) {
+			while (!literal.empty()) {
+				std::unique_ptr<Node> *next{nullptr};
+				for (auto &child : node->children) {
+					if (child->prefix.front() == literal.front()) {
+						next = &child;
+						break;
+					}
+				}
+				if (next == nullptr) {
+					node->children.emplace_back(new Node);
+					node->children.back()->prefix = literal;
+					return node->children.back().get();
+				}
+
+				std::string &prefix{(*next)->prefix};
+				std::size_t common{0};
+				while (common < prefix.size() &&
+					common < literal.size() &&
+					prefix[common] == literal[common]) {
+					common++;
+				}
+				if (common < prefix.size()) {
+					std::unique_ptr<Node> split(new Node);
+					split->prefix = prefix.substr(0, common);
+					prefix.erase(0, common);
+					split->children.push_back(std::move(*next));
+					*next = std::move(split);
+				}
+				node = next->get();
+				literal.remove_prefix(common);
+			}
+			return node;
+		}
+
+		template<typename Callback>
+		static void match(
+			Node const &node,
+			std::string_view rest,
+			std::array<std::string_view, MAX_PARAMETERS> &values,
+			std::size_t cValues,
+			Callback &callback) {
+			if (rest.empty()) {
+				Router::emit(node, values, callback);
+			}
+			if (node.wildcard) {
+				values[cValues] = rest;
+				Router::emit(*node.wildcard, values, callback);
+			}
+			if (!rest.empty()) {
+				for (auto const &child : node.children) {
+					if (rest.starts_with(child->prefix)) {
+						Router::match(
+							*child,
+							rest.substr(child->prefix.size()),
+							values,
+							cValues,
+							callback);
+						break;
+					}
+				}
+			}
+			if (node.parameter) {
+				std::size_t end{
+					std::min(rest.find('/'), rest.size())};
+				if (end != 0) {
+					values[cValues] = rest.substr(0, end);
+					Router::match(
+						*node.parameter,
+						rest.substr(end),
+						values,
+						cValues + 1,
+						callback);
+				}
+			}
+		}
+
+		template<typename Callback>
+		static void emit(
+			Node const &node,
+			std::array<std::string_view, MAX_PARAMETERS> const
+				&values,
+			Callback &callback) {
+			for (Terminal const &terminal : node.terminals) {
+				// Literal prefixes match a wildcard without naming
+				// it.
+				Match match;
+				match.cParameters = terminal.names.size();
+				for (std::size_t idx{0}; idx < match.cParameters;
+						 idx++) {
+					match.parameters[idx] = {
+						terminal.names[idx], values[idx]};
+				}
+				callback(terminal.value, match);
+			}
+		}
+	};
+}
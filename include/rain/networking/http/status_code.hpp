@@ -60,6 +60,7 @@ namespace Rain::Networking::Http {
 			UNSUPPORTED_MEDIA_TYPE = 415,
 			REQUESTED_RANGE_NOT_SATISFIABLE = 416,
 			EXPECTATION_FAILED = 417,
+			UPGRADE_REQUIRED = 426,
 
 			INTERNAL_SERVER_ERROR = 500,
 			NOT_IMPLEMENTED = 501,
@@ -137,6 +138,7 @@ namespace Rain::Networking::Http {
 				case UNSUPPORTED_MEDIA_TYPE:
 				case REQUESTED_RANGE_NOT_SATISFIABLE:
 				case EXPECTATION_FAILED:
+				case UPGRADE_REQUIRED:
 					return Category::CLIENT_ERROR;
 
 				case INTERNAL_SERVER_ERROR:
@@ -223,6 +225,8 @@ namespace Rain::Networking::Http {
 					return "Requested Range Not Satisfiable";
 				case EXPECTATION_FAILED:
 					return "Expectation Failed";
+				case UPGRADE_REQUIRED:
+					return "Upgrade Required";
 
 				case INTERNAL_SERVER_ERROR:
 					return "Internal Server Error";
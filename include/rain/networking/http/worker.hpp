@@ -1,11 +1,19 @@
 // HTTP Worker specialization.
 #pragma once
 
+#include "../../metrics.hpp"
 #include "../req_res/worker.hpp"
+#include "frozen_response.hpp"
+#include "response_cache.hpp"
+#include "router.hpp"
 #include "socket.hpp"
 
+#include <algorithm>
+#include <array>
+#include <memory>
 #include <optional>
 #include <regex>
+#include <span>
 #include <unordered_set>
 
 namespace Rain::Networking::Http {
@@ -14,6 +22,14 @@ namespace Rain::Networking::Http {
 		virtual public ConnectedSocketSpecInterface,
 		virtual public ReqRes::
 			WorkerSocketSpecInterfaceInterface {
+		public:
+		// Routing tables compiled across all Workers. Filters
+		// compile theirs once on construction, so this should
+		// not grow with accepted connections.
+		static inline Metrics::Counter routesCompiledMetric{
+			"rain_http_routes_compiled_total",
+			"Routing tables compiled from RequestFilters."};
+
 		protected:
 		// For easy binding to request handlers.
 		template<typename Handler, typename... Args>
@@ -45,16 +61,21 @@ namespace Rain::Networking::Http {
 		//
 		// The state with a response and no flag is invalid and
 		// cannot be constructed.
+		//
+		// A FrozenResponse may be sent in place of a
+		// ResponseMessageSpec. It is sent as frozen, without
+		// the pp-chain or send overrides of this Worker.
 		class ResponseAction {
 			public:
 			std::optional<ResponseMessageSpec> response;
+			FrozenResponse frozen;
 
 			// If true, closes after the ResponseMessageSpec is
 			// sent, or aborts with no ResponseMessageSpec.
 			std::optional<bool> toClose;
 
 			// No action, proceed to next filter.
-			ResponseAction() : toClose(), response() {}
+			ResponseAction() : response(), frozen(), toClose() {}
 
 			// Send response, optionally close.
 			ResponseAction(
@@ -64,6 +85,14 @@ namespace Rain::Networking::Http {
 					std::forward<ResponseMessageSpec>(response)),
 				toClose(toClose) {}
 
+			// Send frozen response, optionally close.
+			ResponseAction(
+				FrozenResponse const &frozen,
+				bool toClose = false) :
+				response(),
+				frozen(frozen),
+				toClose(toClose) {}
+
 			// Don't send response, optionally close.
 			ResponseAction(std::nullptr_t, bool toClose) :
 				response(),
@@ -79,8 +108,23 @@ namespace Rain::Networking::Http {
 				ResponseAction &&) = default;
 		};
 
+		class Routes;
+
 		// Subclasses specify behavior by defining filters for
 		// incoming requests.
+		//
+		// Filters whose handler takes a std::smatch match host
+		// and target by regular expression. Filters whose
+		// handler takes a Router::Match instead match target by
+		// Router pattern (e.g. `/users/:id/*rest`), ignoring
+		// any query or fragment. In both cases, filters are
+		// tried in order.
+		//
+		// Filters are compiled into a Router once, by Filters,
+		// so that only matching filters are tried. Regular
+		// expressions which are literals, optionally followed by
+		// `/?` or `.*`, are routed as such, and other regular
+		// expressions are matched in full.
 		class RequestFilter {
 			public:
 			std::regex host;
@@ -92,12 +136,21 @@ namespace Rain::Networking::Http {
 			// ResponseAction is returned, the next filter is
 			// checked.
 			//
-			// void * is type erasure.
+			// void * is type erasure. Exactly one of handler and
+			// routeHandler is set.
 			std::function<ResponseAction(
 				void *,
 				RequestMessageSpec &,
 				std::smatch const &)>
 				handler;
+			std::function<ResponseAction(
+				void *,
+				RequestMessageSpec &,
+				Router::Match const &)>
+				routeHandler;
+
+			// Sources of host and target, if given as strings.
+			std::optional<std::string> hostSource, targetSource;
 
 			// Handlers are bound inside this function.
 			template<
@@ -124,7 +177,138 @@ namespace Rain::Networking::Http {
 					// Derived.
 					return (*static_cast<Derived *>(instance).*memFn)(
 						req, match);
-				}) {}
+				}),
+				hostSource(RequestFilter::sourceOf(host)),
+				targetSource(RequestFilter::sourceOf(target)) {}
+
+			// Routed by pattern. Parameters in the Router::Match
+			// are views into the request target. Throws on a
+			// malformed pattern.
+			template<typename Host, typename Derived>
+			RequestFilter(
+				Host &&host,
+				std::string const &pattern,
+				std::set<Method> &&methods,
+				ResponseAction (Derived::*memFn)(
+					RequestMessageSpec &,
+					Router::Match const &)) :
+				host(std::forward<Host>(host)),
+				methods(std::forward<std::set<Method>>(methods)),
+				routeHandler([memFn](
+											 void *instance,
+											 RequestMessageSpec &req,
+											 Router::Match const &match) {
+					return (*static_cast<Derived *>(instance).*memFn)(
+						req, match);
+				}),
+				hostSource(RequestFilter::sourceOf(host)),
+				targetSource(pattern) {
+				Router().insert(pattern, 0);
+			}
+
+			private:
+			template<typename Source>
+			static std::optional<std::string> sourceOf(
+				Source const &source) {
+				if constexpr (std::is_convertible_v<
+												Source const &,
+												std::string_view>) {
+					return std::string(std::string_view(source));
+				} else {
+					return {};
+				}
+			}
+		};
+
+		// Routing table compiled from a list of RequestFilters.
+		class Routes {
+			public:
+			static std::size_t const C_METHODS{Method::PRI + 1};
+
+			enum class HostMatch { ANY, LITERAL, REGEX };
+
+			// Per filter.
+			std::vector<std::pair<HostMatch, std::string>> hosts;
+
+			// Per method, patterns matched against the path, and
+			// literal regular expressions matched against the
+			// whole target.
+			std::array<Router, C_METHODS> patterns, literals;
+
+			// Filters whose target must be matched by regular
+			// expression.
+			std::vector<std::size_t> regexes;
+
+			Routes(std::vector<RequestFilter> const &filters) {
+				WorkerSocketSpecInterfaceInterface::
+					routesCompiledMetric.add();
+				for (std::size_t idx{0}; idx < filters.size();
+						 idx++) {
+					RequestFilter const &filter{filters[idx]};
+					std::vector<std::string> hostLiterals,
+						targetLiterals;
+					bool isPrefix;
+					if (
+						filter.hostSource &&
+						Router::literalsOfRegex(
+							*filter.hostSource, hostLiterals, isPrefix) &&
+						hostLiterals.size() == 1 &&
+						(!isPrefix || hostLiterals[0].empty())) {
+						this->hosts.emplace_back(
+							isPrefix ? HostMatch::ANY : HostMatch::LITERAL,
+							hostLiterals[0]);
+					} else {
+						this->hosts.emplace_back(HostMatch::REGEX, "");
+					}
+
+					if (filter.routeHandler) {
+						for (Method method : filter.methods) {
+							this->patterns[method].insert(
+								*filter.targetSource, idx);
+						}
+					} else if (
+						filter.targetSource &&
+						Router::literalsOfRegex(
+							*filter.targetSource,
+							targetLiterals,
+							isPrefix)) {
+						for (Method method : filter.methods) {
+							for (std::string const &literal :
+									 targetLiterals) {
+								this->literals[method].insertLiteral(
+									literal, isPrefix, idx);
+							}
+						}
+					} else {
+						this->regexes.push_back(idx);
+					}
+				}
+			}
+		};
+
+		// RequestFilters, with the Routes compiled from them on
+		// construction. Workers which return the same Filters
+		// share its Routes, so that they are not compiled again
+		// on each accept.
+		class Filters {
+			private:
+			std::vector<RequestFilter> filters;
+			Routes routes;
+
+			public:
+			Filters(std::vector<RequestFilter> filters) :
+				filters(std::move(filters)),
+				routes(this->filters) {}
+			Filters(std::initializer_list<RequestFilter> filters) :
+				Filters(std::vector<RequestFilter>(filters)) {}
+
+			std::vector<RequestFilter> const &list()
+				const noexcept {
+				return this->filters;
+			}
+			Routes const &compiled() const noexcept {
+				return this->routes;
+			}
 		};
 	};
 
@@ -151,18 +335,103 @@ namespace Rain::Networking::Http {
 		using typename Http::WorkerSocketSpecInterface<
 			RequestMessageSpec,
 			ResponseMessageSpec>::RequestFilter;
+		using typename Http::WorkerSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec>::Filters;
 
 		// Shorthands available for the subclass.
 		using Request = RequestMessageSpec;
 		using Response = ResponseMessageSpec;
 
+		// Serves Metrics::Registry::global(), which includes
+		// Server, Worker, and ThreadPool metrics, in Prometheus
+		// text format on GET target. Add it to filters() like
+		// any other filter. Per-request Worker metrics are only
+		// recorded with onWorkMetrics.
+		static RequestFilter metricsFilter(
+			std::string const &target = "/metrics") {
+			return {
+				".*",
+				target,
+				{Method::GET},
+				&WorkerSocketSpec::reqMetrics};
+		}
+
 		private:
+		using typename Http::WorkerSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec>::Routes;
+
+		// Index of a candidate filter, and its Router::Match.
+		using Candidate = std::pair<std::size_t, Router::Match>;
+
+		ResponseAction reqMetrics(
+			RequestMessageSpec &,
+			std::smatch const &) {
+			return {
+				{StatusCode::OK,
+					{{{"Content-Type",
+						"text/plain; version=0.0.4; charset=utf-8"}}},
+					Metrics::Registry::global().expose()}};
+		}
+
+		// Responses are only held behind a complete request
+		// head, and not behind a malformed one, or the unread
+		// body of the current request.
+		virtual bool isRequestBuffered(
+			std::string_view buffered) override {
+			RequestParser parser;
+			try {
+				return parser.parse(buffered);
+			} catch (...) {
+				return false;
+			}
+		}
+
 		// Subclasses define behavior by overriding a virtual
 		// list of handlers. Must return at least one filter.
-		// The lifetime of the returned vector must persist
-		// until the destructor (best kept as a static
-		// variable).
-		virtual std::vector<RequestFilter> const &filters() = 0;
+		// The lifetime of the returned Filters must persist
+		// until the destructor (best kept as a static variable,
+		// so that its Routes are compiled once for all
+		// Workers).
+		virtual Filters const &filters() = 0;
+
+		// Subclasses may cache responses to GET requests by
+		// returning a ResponseCache shared across Workers, with
+		// the same lifetime as filters. Fresh responses are then
+		// sent from the cache without calling filters, or as 304
+		// to conditional requests. By default, nothing is
+		// cached.
+		//
+		// Cached responses are serialized as by
+		// ResponseMessageSpec::sendWith, so overrides of send
+		// do not apply to them.
+		virtual ResponseCache *responseCache() {
+			return nullptr;
+		}
+
+		// Called after a 101 (Switching Protocols) response is
+		// sent, with the request which asked for it, or with
+		// the `PRI * HTTP/2.0` request which begins the HTTP/2
+		// connection preface, to speak the new protocol on the
+		// connection until it returns. Returns as onRequest.
+		// Must not throw.
+		//
+		// By default, there is no other protocol to speak, and
+		// the connection is closed.
+		virtual bool onUpgrade(RequestMessageSpec &) {
+			return true;
+		}
+
+		// Called with each request before it is routed, to
+		// switch protocols regardless of filters. Returns a
+		// ResponseAction as a filter would, which is acted on
+		// in place of routing, unless it is "no action".
+		//
+		// By default, no action.
+		virtual ResponseAction onPreroute(RequestMessageSpec &) {
+			return {};
+		}
 
 		// Called when filter handlers throw. Returns false to
 		// continue to receiving next ResponseMessageSpec, and
@@ -185,80 +454,328 @@ namespace Rain::Networking::Http {
 		// Handle non-error Request. Must not throw.
 		virtual bool onRequest(
 			RequestMessageSpec &req) final override {
-			// Run through filters and try to send.
-			std::smatch targetMatch;
-			for (RequestFilter const &filter : this->filters()) {
-				if (
-					std::regex_match(
-						req.headers.host().asStr(), filter.host) &&
-					std::regex_match(
-						req.target, targetMatch, filter.target) &&
-					filter.methods.find(req.method) !=
-						filter.methods.end()) {
-					// Matched, call handler and process.
-					try {
-						// This will be cast to a derived type.
-						ResponseAction result{
-							filter.handler(this, req, targetMatch)};
-
-						// Ignore the rest of the unprocessed body.
-						req.body.ignore(
-							std::numeric_limits<std::streamsize>::max());
-
-						// Did the filter decide to make an action?
-						if (result.toClose) {
-							if (result.response) {
-								// Version of the response will always be
-								// set equal to the version of the request.
-								result.response.value().version =
-									req.version;
-								try {
-									this->send(result.response.value());
-								} catch (...) {
-									return true;
-								}
-							}
+			// The HTTP/2 connection preface switches protocols
+			// without a 101 (Switching Protocols).
+			if (req.method == Method::PRI) {
+				return this->onUpgrade(req);
+			}
 
-							// Always close if the version < 1.1.
-							if (
-								result.toClose.value() ||
-								req.version == Version::_0_9 ||
-								req.version == Version::_1_0) {
-								Rain::Error::consumeThrowable(
-									[this]() { this->shutdown(); })();
-								return true;
-							}
-							return false;
-						}
+			// Requests may switch protocols before routing.
+			std::optional<std::string> cacheKey;
+			try {
+				ResponseAction result{this->onPreroute(req)};
+				if (result.toClose) {
+					return this->act(req, result, cacheKey);
+				}
+			} catch (...) {
+				return this->onFilterException();
+			}
 
-						// If result is empty, try next filter.
+			// Fresh cached responses are sent without routing.
+			ResponseCache *responseCache{this->responseCache()};
+			if (responseCache != nullptr) {
+				cacheKey = ResponseCache::keyOf(req);
+				std::shared_ptr<ResponseCache::Entry const> entry;
+				if (cacheKey) {
+					entry =
+						responseCache->find(*cacheKey, req.headers);
+				}
+				if (entry != nullptr) {
+					if (this->rejectMalformedBody(req)) {
+						return true;
+					}
+					try {
+						this->sendCached(req, *entry);
 					} catch (...) {
-						return this->onFilterException();
+						return true;
+					}
+					if (
+						req.version == Version::_0_9 ||
+						req.version == Version::_1_0) {
+						Rain::Error::consumeThrowable(
+							[this]() { this->shutdown(); })();
+						return true;
 					}
+					return false;
 				}
 			}
 
-			// No filters returned a ResponseAction, send 404.
+			std::optional<ResponseAction> result;
 			try {
+				result.emplace(this->dispatch(req));
+			} catch (...) {
+				return this->onFilterException();
+			}
+			if (this->rejectMalformedBody(req)) {
+				return true;
+			}
+			return this->act(req, *result, cacheKey);
+		};
+
+		protected:
+		// Routes req to the first candidate filter which
+		// returns a ResponseAction, or else returns a 404 (Not
+		// Found) response. Throws if a filter throws.
+		//
+		// Subclasses which receive requests other than as
+		// HTTP/1.x (HTTP/2 streams, say) may dispatch them to
+		// the same filters, and send the ResponseAction
+		// themselves.
+		ResponseAction dispatch(RequestMessageSpec &req) {
+			Filters const &filters{this->filters()};
+			Routes const &routes{filters.compiled()};
+
+			// Candidate filters are collected from the Routers,
+			// then tried in order. The vector is reused across
+			// requests on the same thread.
+			thread_local std::vector<Candidate> cache;
+			std::vector<Candidate> candidates;
+			candidates.swap(cache);
+			candidates.clear();
+			auto collect{[&candidates](
+										 std::size_t idx,
+										 Router::Match const &match) {
+				candidates.emplace_back(idx, match);
+			}};
+			std::string_view target{req.target};
+			std::string_view path{target.substr(
+				0,
+				std::min(
+					target.find_first_of("?#"), target.size()))};
+			routes.patterns[req.method].match(path, collect);
+			routes.literals[req.method].match(target, collect);
+			for (std::size_t idx : routes.regexes) {
+				if (
+					filters.list()[idx].methods.find(req.method) !=
+					filters.list()[idx].methods.end()) {
+					candidates.emplace_back(idx, Router::Match{});
+				}
+			}
+			std::sort(
+				candidates.begin(),
+				candidates.end(),
+				[](Candidate const &a, Candidate const &b) {
+					return a.first < b.first;
+				});
+
+			ResponseAction result{
+				this->firstAction(req, filters, candidates)};
+			if (candidates.capacity() > cache.capacity()) {
+				cache.swap(candidates);
+			}
+			return result;
+		}
+
+		private:
+		// Tries candidate filters in order, and returns the
+		// first ResponseAction, or a 404 (Not Found) response
+		// if none returns one. Throws if a filter throws.
+		ResponseAction firstAction(
+			RequestMessageSpec &req,
+			Filters const &filters,
+			std::vector<Candidate> const &candidates) {
+			Routes const &routes{filters.compiled()};
+			std::optional<std::string> host;
+			std::smatch targetMatch;
+			for (std::size_t idx{0}; idx < candidates.size();
+					 idx++) {
+				auto const &[filterIdx, routeMatch]{candidates[idx]};
+				// Skip duplicates.
+				if (
+					idx > 0 &&
+					candidates[idx - 1].first == filterIdx) {
+					continue;
+				}
+				RequestFilter const &filter{
+					filters.list()[filterIdx]};
+				auto const &[hostMatch, hostLiteral]{
+					routes.hosts[filterIdx]};
+				if (hostMatch != Routes::HostMatch::ANY) {
+					if (!host) {
+						host = req.headers.host().asStr();
+					}
+					if (
+						hostMatch == Routes::HostMatch::LITERAL
+							? *host != hostLiteral
+							: !std::regex_match(*host, filter.host)) {
+						continue;
+					}
+				}
+				if (
+					!filter.routeHandler &&
+					!std::regex_match(
+						req.target, targetMatch, filter.target)) {
+					continue;
+				}
+
+				// Matched, call handler. This will be cast to a
+				// derived type.
+				ResponseAction result{
+					filter.routeHandler
+						? filter.routeHandler(this, req, routeMatch)
+						: filter.handler(this, req, targetMatch)};
+
+				// Ignore the rest of the unprocessed body.
+				req.body.ignore(
+					std::numeric_limits<std::streamsize>::max());
+
+				// Did the filter decide to make an action? If not,
+				// try the next filter.
+				if (result.toClose) {
+					return result;
+				}
+			}
+
+			// No filters returned a ResponseAction, send 404.
+			return {ResponseMessageSpec{StatusCode::NOT_FOUND}};
+		}
+
+		// Receives the rest of the body of req. If its chunks
+		// were malformed, responds with 400 (Bad Request) in
+		// place of any ResponseAction, and closes, since the
+		// connection is no longer at the start of a request.
+		// Returns whether it did. Must not throw.
+		bool rejectMalformedBody(RequestMessageSpec &req) {
+			Rain::Error::consumeThrowable([&req]() {
+				req.body.ignore(
+					std::numeric_limits<std::streamsize>::max());
+			})();
+			if (!req.isBodyMalformed()) {
+				return false;
+			}
+			Rain::Error::consumeThrowable([this]() {
 				this->send(
-					ResponseMessageSpec{
-						StatusCode::NOT_FOUND,
-						{},
-						{},
-						{},
-						req.version});
+					ResponseMessageSpec{StatusCode::BAD_REQUEST});
+				this->shutdown();
+			})();
+			return true;
+		}
+
+		// Sends the response of a ResponseAction, if any, then
+		// closes if it says so. Responses to GET requests with
+		// a cacheKey are stored if possible. Returns as
+		// onRequest. Must not throw.
+		bool act(
+			RequestMessageSpec &req,
+			ResponseAction &result,
+			std::optional<std::string> &cacheKey) {
+			if (result.frozen) {
+				try {
+					this->sendFrozen(req, result.frozen);
+				} catch (...) {
+					return true;
+				}
+			} else if (result.response) {
+				// Version of the response will always be set equal
+				// to the version of the request.
+				result.response.value().version = req.version;
+
+				// The connection then belongs to the new protocol.
 				if (
-					req.version == Version::_0_9 ||
-					req.version == Version::_1_0) {
-					Rain::Error::consumeThrowable(
-						[this]() { this->shutdown(); })();
+					result.response.value().statusCode ==
+					StatusCode::SWITCHING_PROTOCOLS) {
+					try {
+						this->send(result.response.value());
+					} catch (...) {
+						return true;
+					}
+					return this->onUpgrade(req);
+				}
+				try {
+					std::shared_ptr<ResponseCache::Entry const> entry;
+					if (
+						cacheKey && req.method == Method::GET &&
+						req.version == Version::_1_1) {
+						entry = this->responseCache()->insert(
+							std::move(*cacheKey),
+							req.headers,
+							result.response.value());
+					}
+					if (entry != nullptr) {
+						this->sendCached(req, *entry);
+					} else {
+						this->send(result.response.value());
+					}
+				} catch (...) {
 					return true;
 				}
-				return false;
-			} catch (...) {
+			}
+
+			// Always close if the version < 1.1.
+			if (
+				result.toClose.value() ||
+				req.version == Version::_0_9 ||
+				req.version == Version::_1_0) {
+				Rain::Error::consumeThrowable(
+					[this]() { this->shutdown(); })();
 				return true;
 			}
-		};
+			return false;
+		}
+
+		// Sends a cached response, or its 304 if req is
+		// conditional and it has not been modified, with its
+		// Age.
+		void sendCached(
+			RequestMessageSpec &req,
+			ResponseCache::Entry const &entry) {
+			bool const isNotModified{
+				entry.isNotModified(req.headers)};
+			char age[48];
+			int const ageLen{std::snprintf(
+				age,
+				sizeof(age),
+				"Age: %lld\r\n\r\n",
+				static_cast<long long>(
+					std::chrono::duration_cast<std::chrono::seconds>(
+						std::chrono::steady_clock::now() -
+						entry.timeStored)
+						.count()))};
+			std::string_view const buffers[]{
+				isNotModified ? std::string_view(entry.notModified)
+											: entry.head(),
+				{age, static_cast<std::size_t>(ageLen)},
+				isNotModified || req.method == Method::HEAD
+					? std::string_view()
+					: entry.body()};
+			this->sendBuffers(buffers);
+		}
+
+		// Sends a frozen response with the current Date, or
+		// only its body to HTTP/0.9 requests.
+		void sendFrozen(
+			RequestMessageSpec &req,
+			FrozenResponse const &frozen) {
+			if (req.version == Version::_0_9) {
+				std::string_view const body{frozen.body()};
+				this->sendBuffers({&body, 1});
+				return;
+			}
+			auto const buffers{
+				frozen.buffers(req.method != Method::HEAD)};
+			this->sendBuffers(buffers);
+		}
+
+		// Sends buffers in order. Over Tcp Sockets, this is one
+		// vectored send, without copying into the send buffer.
+		void sendBuffers(
+			std::span<std::string_view const> buffers) {
+			Tcp::VectoredSenderInterface *vectoredSender{
+				dynamic_cast<Tcp::VectoredSenderInterface *>(
+					this->rdbuf())};
+			if (vectoredSender != nullptr) {
+				if (!vectoredSender->send(buffers)) {
+					this->setstate(std::ios::badbit);
+				}
+				return;
+			}
+			for (std::string_view buffer : buffers) {
+				this->write(
+					buffer.data(),
+					static_cast<std::streamsize>(buffer.size()));
+			}
+			this->flush();
+		}
 
 		// Catch exceptions during request receiving. Must not
 		// throw.
@@ -290,6 +807,8 @@ namespace Rain::Networking::Http {
 							MALFORMED_HEADERS:
 						case RequestMessageSpecInterface::Error::
 							MALFORMED_BODY:
+						case RequestMessageSpecInterface::Error::
+							MALFORMED_REQUEST_LINE:
 							this->send(
 								ResponseMessageSpec{
 									StatusCode::BAD_REQUEST});
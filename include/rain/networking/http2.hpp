@@ -0,0 +1,10 @@
+// Includes all /http2 headers.
+#pragma once
+
+#include "http2/client.hpp"
+#include "http2/error_code.hpp"
+#include "http2/frame.hpp"
+#include "http2/hpack.hpp"
+#include "http2/settings.hpp"
+#include "http2/socket.hpp"
+#include "http2/worker.hpp"
@@ -0,0 +1,539 @@
+// HTTP/2 Client, with prior knowledge.
+#pragma once
+
+#include "../../error/exception.hpp"
+#include "../http/client.hpp"
+#include "socket.hpp"
+
+#include <deque>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Rain::Networking::Http2 {
+	class ClientSocketSpecInterfaceInterface :
+		virtual public Http::ClientSocketSpecInterfaceInterface,
+		virtual public Http2::ConnectedSocketSpecInterface {
+		public:
+		using ConnectedSocketSpecInterface =
+			Http2::ConnectedSocketSpecInterface;
+
+		enum class Error { CONNECTION_FAILED = 1, STREAM_RESET };
+		class ErrorCategory : public std::error_category {
+			public:
+			char const *name() const noexcept {
+				return "Rain::Networking::Http2::Client";
+			}
+			std::string message(int error) const noexcept {
+				switch (static_cast<Error>(error)) {
+					case Error::CONNECTION_FAILED:
+						return "HTTP/2 connection failed or closed.";
+					case Error::STREAM_RESET:
+						return "HTTP/2 stream reset before its "
+									 "response.";
+					default:
+						return "Generic.";
+				}
+			}
+		};
+		using Exception =
+			Rain::Error::Exception<Error, ErrorCategory>;
+	};
+
+	template<
+		typename RequestMessageSpec,
+		typename ResponseMessageSpec>
+	class ClientSocketSpecInterface :
+		virtual public ClientSocketSpecInterfaceInterface,
+		virtual public Http::ClientSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec> {
+		public:
+		using ClientSocketSpecInterfaceInterface =
+			Http2::ClientSocketSpecInterfaceInterface;
+
+		using Http::ClientSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec>::send;
+		using Http::ClientSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec>::recv;
+	};
+
+	// HTTP/2 Client (RFC 9113), over cleartext with prior
+	// knowledge: the connection begins with the preface,
+	// without upgrading from HTTP/1.1.
+	//
+	// Each request is sent on a new stream, without waiting
+	// for earlier responses, and responses are received in
+	// the order of their requests, so that many requests are
+	// in flight at once. Sends wait for a stream once
+	// SETTINGS_MAX_CONCURRENT_STREAMS are open, and for flow
+	// control windows, receiving responses meanwhile. Server
+	// push is disabled.
+	template<
+		typename RequestMessageSpec,
+		typename ResponseMessageSpec,
+		typename Socket>
+	class ClientSocketSpec :
+		public Socket,
+		virtual public ClientSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec> {
+		using Socket::Socket;
+
+		public:
+		using ClientSocketSpecInterface =
+			Http2::ClientSocketSpecInterface<
+				RequestMessageSpec,
+				ResponseMessageSpec>;
+
+		using ClientSocketSpecInterface::send;
+		using ClientSocketSpecInterface::recv;
+
+		private:
+		// A stream, until its response is received.
+		class Stream {
+			public:
+			std::int64_t sendWindow, recvWindow;
+
+			// Set once the response ends, or the stream is reset.
+			bool isDone{false};
+			ErrorCode errorCode{ErrorCode::NO_ERROR};
+
+			// The response, as received.
+			bool hasHead{false};
+			Http::StatusCode statusCode;
+			Http::Headers headers, trailers;
+			std::string body;
+		};
+		std::unordered_map<std::uint32_t, Stream> streams;
+
+		// Streams whose responses are not yet received, in the
+		// order of their requests.
+		std::deque<std::uint32_t> order;
+
+		std::uint32_t nextStreamId{1}, cOpen{0};
+		bool isPrefaced{false};
+
+		// Until the server's SETTINGS are received, streams are
+		// limited as by most servers, rather than unlimited, so
+		// that they are not refused (RFC 9113 6.5.2).
+		bool isSettingsReceived{false};
+		static constexpr std::uint32_t INITIAL_MAX_STREAMS{100};
+
+		// Streams past this are not processed by the server,
+		// once it sends GOAWAY.
+		std::uint32_t lastStreamId{UINT32_MAX};
+
+		// Stream of a header block continued in CONTINUATION
+		// frames, the block so far, and whether it ends the
+		// stream.
+		std::uint32_t continuedStreamId{0};
+		std::string headerBlock;
+		bool isBlockEndStream{false};
+
+		// Reused across streams.
+		std::vector<Hpack::Field> fields;
+		std::string sendBlock;
+
+		public:
+		// Sends req on a new stream. Throws if the connection
+		// fails, or the server has sent GOAWAY.
+		virtual void send(RequestMessageSpec &req) override {
+			if (!this->isPrefaced) {
+				this->isPrefaced = true;
+				this->setNoDelay();
+				this->write(
+					PREFACE.data(),
+					static_cast<std::streamsize>(PREFACE.size()));
+				this->localSettings.enablePush = false;
+				this->localSettings.maxHeaderListSize =
+					static_cast<std::uint32_t>(
+						this->decoder.maxListSize);
+				this->sendPreface();
+			}
+			while (
+				this->cOpen >=
+				(this->isSettingsReceived
+						? this->remoteSettings.maxConcurrentStreams
+						: std::min<std::uint32_t>(
+								this->remoteSettings.maxConcurrentStreams,
+								ClientSocketSpec::INITIAL_MAX_STREAMS))) {
+				this->recvFrame();
+			}
+			if (this->nextStreamId > this->lastStreamId) {
+				throw typename ClientSocketSpec::Exception(
+					ClientSocketSpec::Error::CONNECTION_FAILED);
+			}
+
+			std::uint32_t const id{this->nextStreamId};
+			this->nextStreamId += 2;
+			Stream &stream{this->streams[id]};
+			stream.sendWindow =
+				this->remoteSettings.initialWindowSize;
+			stream.recvWindow = this->streamWindowSize;
+			this->order.push_back(id);
+			this->cOpen++;
+
+			req.ppEstimateContentLength(false);
+			req.ppDefaultContentType();
+			std::string const body(
+				std::istreambuf_iterator<char>(req.body),
+				std::istreambuf_iterator<char>());
+			auto const hostIt{req.headers.find("Host")};
+			this->sendBlock.clear();
+			this->encoder.encode(
+				this->sendBlock,
+				":method",
+				static_cast<std::string>(req.method));
+			this->encoder.encode(
+				this->sendBlock, ":scheme", "http");
+			if (hostIt != req.headers.end()) {
+				this->encoder.encode(
+					this->sendBlock, ":authority", hostIt->second);
+			}
+			this->encoder.encode(
+				this->sendBlock, ":path", req.target);
+			for (auto const &[name, value] : req.headers) {
+				if (
+					!ClientSocketSpec::isCaseAgnosticEqual(
+						name, "Host") &&
+					!ClientSocketSpec::isConnectionSpecific(name)) {
+					this->encoder.encode(this->sendBlock, name, value);
+				}
+			}
+			this->sendHeaders(id, this->sendBlock, body.empty());
+
+			// The body is sent as flow control allows.
+			std::string_view remaining{body};
+			while (!remaining.empty() && !stream.isDone) {
+				std::int64_t const window{std::min<std::int64_t>(
+					{this->sendWindow,
+						stream.sendWindow,
+						this->remoteSettings.maxFrameSize})};
+				if (window <= 0) {
+					this->recvFrame();
+					continue;
+				}
+				std::string_view const data{remaining.substr(
+					0, static_cast<std::size_t>(window))};
+				remaining.remove_prefix(data.size());
+				this->sendFrame(
+					FrameType::DATA,
+					remaining.empty() ? FrameHead::END_STREAM
+														: std::uint8_t{0},
+					id,
+					data);
+				this->sendWindow -=
+					static_cast<std::int64_t>(data.size());
+				stream.sendWindow -=
+					static_cast<std::int64_t>(data.size());
+			}
+			this->flush();
+		}
+
+		// Receives the response to the earliest request whose
+		// response is not yet received. Throws if its stream
+		// is reset, or the connection fails.
+		virtual ResponseMessageSpec &recv(
+			ResponseMessageSpec &res) override {
+			if (this->order.empty()) {
+				throw typename ClientSocketSpec::Exception(
+					ClientSocketSpec::Error::STREAM_RESET);
+			}
+			std::uint32_t const id{this->order.front()};
+			while (!this->streams[id].isDone) {
+				this->recvFrame();
+			}
+			this->order.pop_front();
+			auto node{this->streams.extract(id)};
+			Stream &stream{node.mapped()};
+			if (
+				stream.errorCode != ErrorCode::NO_ERROR ||
+				!stream.hasHead) {
+				throw typename ClientSocketSpec::Exception(
+					ClientSocketSpec::Error::STREAM_RESET);
+			}
+			res.statusCode = stream.statusCode;
+			res.headers = std::move(stream.headers);
+			res.trailers = std::move(stream.trailers);
+			res.body = stream.body.empty()
+				? Http::Body()
+				: Http::Body(std::stringbuf(
+						std::move(stream.body), std::ios::in));
+			res.version = Http::Version::_2_0;
+			return res;
+		}
+
+		private:
+		// Receives and handles the next frame, flushing frames
+		// sent meanwhile (e.g. WINDOW_UPDATE) before waiting
+		// for it. Throws, after sending GOAWAY on a connection
+		// error, if the connection fails.
+		void recvFrame() {
+			if (!this->isFrameBuffered()) {
+				this->flush();
+			}
+			FrameHead head;
+			std::string_view payload;
+			if (!Http2::ConnectedSocketSpecInterface::
+						recvFrame(head, payload)) {
+				throw typename ClientSocketSpec::Exception(
+					ClientSocketSpec::Error::CONNECTION_FAILED);
+			}
+			ErrorCode const errorCode{
+				this->onFrame(head, payload)};
+			if (errorCode != ErrorCode::NO_ERROR) {
+				Rain::Error::consumeThrowable([this, errorCode]() {
+					this->sendGoaway(0, errorCode);
+					this->flush();
+				})();
+				throw typename ClientSocketSpec::Exception(
+					ClientSocketSpec::Error::CONNECTION_FAILED);
+			}
+		}
+
+		// Handles a frame. Returns the connection error it
+		// causes, if any.
+		ErrorCode onFrame(
+			FrameHead const &head,
+			std::string_view payload) {
+			if (head.length > this->localSettings.maxFrameSize) {
+				return ErrorCode::FRAME_SIZE_ERROR;
+			}
+			if (
+				this->continuedStreamId != 0 &&
+				(head.type != FrameType::CONTINUATION ||
+					head.streamId != this->continuedStreamId)) {
+				return ErrorCode::PROTOCOL_ERROR;
+			}
+
+			if (head.streamId == 0) {
+				if (head.type == FrameType::GOAWAY) {
+					if (payload.size() < 8) {
+						return ErrorCode::FRAME_SIZE_ERROR;
+					}
+					this->lastStreamId =
+						ClientSocketSpec::readUint32(payload) &
+						Settings::MAX_WINDOW_SIZE;
+					for (auto &[id, stream] : this->streams) {
+						if (id > this->lastStreamId) {
+							this->close(stream, ErrorCode::REFUSED_STREAM);
+						}
+					}
+					return ErrorCode::NO_ERROR;
+				}
+				if (
+					head.type == FrameType::SETTINGS &&
+					!head.hasFlag(FrameHead::ACK)) {
+					this->isSettingsReceived = true;
+				}
+				std::int64_t windowDelta;
+				ErrorCode const errorCode{this->onConnectionFrame(
+					head, payload, windowDelta)};
+				for (auto &[id, stream] : this->streams) {
+					stream.sendWindow += windowDelta;
+				}
+				return errorCode;
+			}
+
+			auto const it{this->streams.find(head.streamId)};
+			Stream *stream{
+				it == this->streams.end() || it->second.isDone
+					? nullptr
+					: &it->second};
+			switch (head.type) {
+				case FrameType::HEADERS:
+					if (!ClientSocketSpec::unpad(head, payload)) {
+						return ErrorCode::PROTOCOL_ERROR;
+					}
+					this->headerBlock.assign(payload);
+					this->isBlockEndStream =
+						head.hasFlag(FrameHead::END_STREAM);
+					if (!head.hasFlag(FrameHead::END_HEADERS)) {
+						this->continuedStreamId = head.streamId;
+						return ErrorCode::NO_ERROR;
+					}
+					return this->onHeaderBlock(stream);
+				case FrameType::CONTINUATION:
+					if (this->continuedStreamId == 0) {
+						return ErrorCode::PROTOCOL_ERROR;
+					}
+					this->headerBlock.append(payload);
+					if (
+						this->headerBlock.size() >
+						this->decoder.maxListSize) {
+						return ErrorCode::ENHANCE_YOUR_CALM;
+					}
+					if (!head.hasFlag(FrameHead::END_HEADERS)) {
+						return ErrorCode::NO_ERROR;
+					}
+					this->continuedStreamId = 0;
+					return this->onHeaderBlock(stream);
+				case FrameType::DATA:
+					if (!this->onConnectionData(head.length)) {
+						return ErrorCode::FLOW_CONTROL_ERROR;
+					}
+					if (stream == nullptr) {
+						return ErrorCode::NO_ERROR;
+					}
+					if (
+						!stream->hasHead ||
+						!ClientSocketSpec::unpad(head, payload)) {
+						return ErrorCode::PROTOCOL_ERROR;
+					}
+					stream->recvWindow -= head.length;
+					if (stream->recvWindow < 0) {
+						this->sendRstStream(
+							head.streamId, ErrorCode::FLOW_CONTROL_ERROR);
+						this->close(
+							*stream, ErrorCode::FLOW_CONTROL_ERROR);
+						return ErrorCode::NO_ERROR;
+					}
+					stream->body.append(payload);
+					if (head.hasFlag(FrameHead::END_STREAM)) {
+						this->close(*stream, ErrorCode::NO_ERROR);
+					} else if (
+						stream->recvWindow <
+						this->streamWindowSize / 2) {
+						this->sendWindowUpdate(
+							head.streamId,
+							this->streamWindowSize -
+								static_cast<std::uint32_t>(
+									stream->recvWindow));
+						stream->recvWindow = this->streamWindowSize;
+					}
+					return ErrorCode::NO_ERROR;
+				case FrameType::RST_STREAM:
+					if (payload.size() != 4) {
+						return ErrorCode::FRAME_SIZE_ERROR;
+					}
+					if (stream != nullptr) {
+						ErrorCode const errorCode{static_cast<ErrorCode>(
+							ClientSocketSpec::readUint32(payload))};
+						this->close(
+							*stream,
+							errorCode == ErrorCode::NO_ERROR &&
+									!stream->hasHead
+								? ErrorCode::CANCEL
+								: errorCode);
+					}
+					return ErrorCode::NO_ERROR;
+				case FrameType::WINDOW_UPDATE:
+					if (stream == nullptr) {
+						return payload.size() != 4
+							? ErrorCode::FRAME_SIZE_ERROR
+							: ErrorCode::NO_ERROR;
+					}
+					return ClientSocketSpec::onWindowUpdate(
+						payload, stream->sendWindow);
+				case FrameType::PRIORITY:
+					return ErrorCode::NO_ERROR;
+				case FrameType::SETTINGS:
+				case FrameType::PUSH_PROMISE:
+				case FrameType::PING:
+				case FrameType::GOAWAY:
+					return ErrorCode::PROTOCOL_ERROR;
+				default:
+					return ErrorCode::NO_ERROR;
+			}
+		}
+
+		// Handles a complete header block: the response head
+		// of a stream, after any informational (1xx) heads, or
+		// its trailers.
+		ErrorCode onHeaderBlock(Stream *stream) {
+			this->fields.clear();
+			try {
+				this->decoder.decode(
+					this->headerBlock, this->fields);
+			} catch (...) {
+				return ErrorCode::COMPRESSION_ERROR;
+			}
+			if (stream == nullptr) {
+				return ErrorCode::NO_ERROR;
+			}
+
+			if (!stream->hasHead) {
+				if (
+					this->fields.empty() ||
+					this->fields.front().first != ":status") {
+					return ErrorCode::PROTOCOL_ERROR;
+				}
+				try {
+					stream->statusCode =
+						Http::StatusCode(this->fields.front().second);
+				} catch (...) {
+					return ErrorCode::PROTOCOL_ERROR;
+				}
+				if (
+					stream->statusCode.getCategory() ==
+					Http::StatusCode::Category::INFORMATIONAL) {
+					return this->isBlockEndStream
+						? ErrorCode::PROTOCOL_ERROR
+						: ErrorCode::NO_ERROR;
+				}
+				stream->hasHead = true;
+				for (std::size_t idx{1}; idx < this->fields.size();
+						 idx++) {
+					stream->headers.emplace(
+						std::move(this->fields[idx].first),
+						std::move(this->fields[idx].second));
+				}
+			} else {
+				if (!this->isBlockEndStream) {
+					return ErrorCode::PROTOCOL_ERROR;
+				}
+				for (auto &[name, value] : this->fields) {
+					stream->trailers.emplace(
+						std::move(name), std::move(value));
+				}
+			}
+			if (this->isBlockEndStream) {
+				this->close(*stream, ErrorCode::NO_ERROR);
+			}
+			return ErrorCode::NO_ERROR;
+		}
+
+		void close(Stream &stream, ErrorCode errorCode) {
+			if (!stream.isDone) {
+				stream.isDone = true;
+				stream.errorCode = errorCode;
+				this->cOpen--;
+			}
+		}
+	};
+
+	// Shorthand, but importantly names *SocketSpec, which is
+	// consistent across each layer, and overwritten by the
+	// next protocol layer, useful for deducing types on the
+	// previous layer (e.g. for TLS).
+	template<
+		typename RequestMessageSpec = Http::Request,
+		typename ResponseMessageSpec = Http::Response,
+		typename SocketFamilyInterface = Ipv4FamilyInterface,
+		template<typename> class... SocketOptions>
+	class Client :
+		public ClientSocketSpec<
+			RequestMessageSpec,
+			ResponseMessageSpec,
+			Http::Client<
+				RequestMessageSpec,
+				ResponseMessageSpec,
+				SocketFamilyInterface,
+				SocketOptions...>> {
+		public:
+		using ClientSocketSpec = ClientSocketSpec<
+			RequestMessageSpec,
+			ResponseMessageSpec,
+			Http::Client<
+				RequestMessageSpec,
+				ResponseMessageSpec,
+				SocketFamilyInterface,
+				SocketOptions...>>;
+		using ClientSocketSpec::ClientSocketSpec;
+	};
+}
@@ -0,0 +1,29 @@
+// HTTP/2 error codes.
+#pragma once
+
+#ifdef NO_ERROR
+	#undef NO_ERROR
+#endif
+
+#include <cstdint>
+
+namespace Rain::Networking::Http2 {
+	// Reasons for RST_STREAM and GOAWAY frames (RFC 9113 7).
+	// Unknown codes are treated as INTERNAL_ERROR.
+	enum class ErrorCode : std::uint32_t {
+		NO_ERROR = 0x0,
+		PROTOCOL_ERROR = 0x1,
+		INTERNAL_ERROR = 0x2,
+		FLOW_CONTROL_ERROR = 0x3,
+		SETTINGS_TIMEOUT = 0x4,
+		STREAM_CLOSED = 0x5,
+		FRAME_SIZE_ERROR = 0x6,
+		REFUSED_STREAM = 0x7,
+		CANCEL = 0x8,
+		COMPRESSION_ERROR = 0x9,
+		CONNECT_ERROR = 0xa,
+		ENHANCE_YOUR_CALM = 0xb,
+		INADEQUATE_SECURITY = 0xc,
+		HTTP_1_1_REQUIRED = 0xd
+	};
+}
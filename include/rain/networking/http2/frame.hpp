@@ -0,0 +1,76 @@
+// Parsing and serialization of HTTP/2 frame heads.
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace Rain::Networking::Http2 {
+	// Types of frames (RFC 9113 6). Frames of other types
+	// are ignored.
+	enum class FrameType : std::uint8_t {
+		DATA = 0x0,
+		HEADERS = 0x1,
+		PRIORITY = 0x2,
+		RST_STREAM = 0x3,
+		SETTINGS = 0x4,
+		PUSH_PROMISE = 0x5,
+		PING = 0x6,
+		GOAWAY = 0x7,
+		WINDOW_UPDATE = 0x8,
+		CONTINUATION = 0x9
+	};
+
+	// Head of a frame (RFC 9113 4.1), which precedes its
+	// payload.
+	class FrameHead {
+		public:
+		static std::size_t const LEN{9};
+
+		// Flags, by the types of frame which define them.
+		static std::uint8_t const END_STREAM{0x1}, ACK{0x1},
+			END_HEADERS{0x4}, PADDED{0x8}, PRIORITY{0x20};
+
+		std::uint32_t length{0};
+		FrameType type{FrameType::DATA};
+		std::uint8_t flags{0};
+
+		// The reserved bit is ignored.
+		std::uint32_t streamId{0};
+
+		bool hasFlag(std::uint8_t flag) const noexcept {
+			return (this->flags & flag) != 0;
+		}
+
+		// Parses a head from the front of buffered, in place.
+		// Returns false if buffered does not yet hold all of
+		// it.
+		bool parse(std::string_view buffered) noexcept {
+			if (buffered.size() < LEN) {
+				return false;
+			}
+			auto const byte{[&buffered](std::size_t idx) {
+				return static_cast<std::uint32_t>(
+					static_cast<unsigned char>(buffered[idx]));
+			}};
+			this->length = byte(0) << 16 | byte(1) << 8 | byte(2);
+			this->type = static_cast<FrameType>(byte(3));
+			this->flags = static_cast<std::uint8_t>(byte(4));
+			this->streamId = (byte(5) & 0x7f) << 24 |
+				byte(6) << 16 | byte(7) << 8 | byte(8);
+			return true;
+		}
+
+		// Serializes into buffer, which must hold LEN bytes.
+		void serialize(char *buffer) const noexcept {
+			buffer[0] = static_cast<char>(this->length >> 16);
+			buffer[1] = static_cast<char>(this->length >> 8);
+			buffer[2] = static_cast<char>(this->length);
+			buffer[3] = static_cast<char>(this->type);
+			buffer[4] = static_cast<char>(this->flags);
+			buffer[5] = static_cast<char>(this->streamId >> 24);
+			buffer[6] = static_cast<char>(this->streamId >> 16);
+			buffer[7] = static_cast<char>(this->streamId >> 8);
+			buffer[8] = static_cast<char>(this->streamId);
+		}
+	};
+}
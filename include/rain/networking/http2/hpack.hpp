@@ -0,0 +1,7 @@
+// Includes all /hpack headers.
+#pragma once
+
+#include "hpack/decoder.hpp"
+#include "hpack/encoder.hpp"
+#include "hpack/huffman.hpp"
+#include "hpack/table.hpp"
@@ -0,0 +1,193 @@
+// HPACK header block decoder (RFC 7541 6).
+#pragma once
+
+#include "../../../error/exception.hpp"
+#include "../../../literal.hpp"
+#include "huffman.hpp"
+#include "table.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Rain::Networking::Http2::Hpack {
+	// Decodes header blocks, with a dynamic table mirroring
+	// that of the encoder of the peer.
+	//
+	// Once a block fails to decode, the tables of either end
+	// may differ, and the connection must be closed with
+	// COMPRESSION_ERROR.
+	class Decoder {
+		public:
+		enum class Error {
+			MALFORMED_BLOCK = 1,
+			TABLE_SIZE_EXCEEDED,
+			LIST_TOO_LONG
+		};
+		class ErrorCategory : public std::error_category {
+			public:
+			char const *name() const noexcept {
+				return "Rain::Networking::Http2::Hpack::Decoder";
+			}
+			std::string message(int error) const noexcept {
+				switch (static_cast<Error>(error)) {
+					case Error::MALFORMED_BLOCK:
+						return "Malformed HPACK header block.";
+					case Error::TABLE_SIZE_EXCEEDED:
+						return "Dynamic table resized past the "
+									 "maximum.";
+					case Error::LIST_TOO_LONG:
+						return "Header list too long.";
+					default:
+						return "Generic.";
+				}
+			}
+		};
+		using Exception =
+			Rain::Error::Exception<Error, ErrorCategory>;
+
+		// Largest table size the encoder may choose, as
+		// advertised by SETTINGS_HEADER_TABLE_SIZE.
+		std::size_t maxTableSize;
+
+		// Longest header list decoded from one block, in the
+		// sizes of its fields, as advertised by
+		// SETTINGS_MAX_HEADER_LIST_SIZE.
+		std::size_t maxListSize{1_zu << 16};
+
+		private:
+		DynamicTable table;
+
+		public:
+		Decoder(std::size_t maxTableSize = 4096) :
+			maxTableSize(maxTableSize),
+			table(maxTableSize) {}
+
+		// Decodes block, appending its fields. Throws if block
+		// is malformed, or its list is too long.
+		void decode(
+			std::string_view block,
+			std::vector<Field> &fields) {
+			std::size_t listSize{0};
+			bool isBeginning{true};
+			while (!block.empty()) {
+				unsigned char const first{
+					static_cast<unsigned char>(block[0])};
+
+				// Dynamic table size updates only begin a block.
+				if ((first & 0xe0) == 0x20) {
+					std::size_t const maxSize{
+						Decoder::decodeInt(block, 5)};
+					if (!isBeginning) {
+						throw Exception(Error::MALFORMED_BLOCK);
+					}
+					if (maxSize > this->maxTableSize) {
+						throw Exception(Error::TABLE_SIZE_EXCEEDED);
+					}
+					this->table.resize(maxSize);
+					continue;
+				}
+				isBeginning = false;
+
+				if ((first & 0x80) != 0) {
+					auto const [name, value]{
+						this->fieldAt(Decoder::decodeInt(block, 7))};
+					fields.emplace_back(name, value);
+				} else {
+					bool const toIndex{(first & 0x40) != 0};
+					std::size_t const nameIdx{
+						Decoder::decodeInt(block, toIndex ? 6 : 4)};
+					Field field;
+					if (nameIdx == 0) {
+						Decoder::decodeString(block, field.first);
+					} else {
+						field.first = this->fieldAt(nameIdx).first;
+					}
+					Decoder::decodeString(block, field.second);
+					if (toIndex) {
+						this->table.insert(
+							std::string(field.first),
+							std::string(field.second));
+					}
+					fields.push_back(std::move(field));
+				}
+
+				listSize += DynamicTable::sizeOf(
+					fields.back().first, fields.back().second);
+				if (listSize > this->maxListSize) {
+					throw Exception(Error::LIST_TOO_LONG);
+				}
+			}
+		}
+
+		// Consumes an integer with an N-bit prefix (RFC 7541
+		// 5.1) from the front of block. Integers past 2^32 are
+		// malformed.
+		static std::size_t decodeInt(
+			std::string_view &block,
+			std::size_t prefixLen) {
+			std::size_t const max{(1_zu << prefixLen) - 1};
+			std::size_t value{
+				static_cast<unsigned char>(block[0]) & max};
+			block.remove_prefix(1);
+			if (value < max) {
+				return value;
+			}
+			for (std::size_t shift{0};; shift += 7) {
+				if (block.empty() || shift > 28) {
+					throw Exception(Error::MALFORMED_BLOCK);
+				}
+				unsigned char const byte{
+					static_cast<unsigned char>(block[0])};
+				block.remove_prefix(1);
+				value += static_cast<std::size_t>(byte & 0x7f)
+					<< shift;
+				if ((byte & 0x80) == 0) {
+					return value;
+				}
+			}
+		}
+
+		// Consumes a string literal (RFC 7541 5.2) from the
+		// front of block into str.
+		static void decodeString(
+			std::string_view &block,
+			std::string &str) {
+			if (block.empty()) {
+				throw Exception(Error::MALFORMED_BLOCK);
+			}
+			bool const isHuffman{
+				(static_cast<unsigned char>(block[0]) & 0x80) != 0};
+			std::size_t const len{Decoder::decodeInt(block, 7)};
+			if (len > block.size()) {
+				throw Exception(Error::MALFORMED_BLOCK);
+			}
+			if (isHuffman) {
+				if (!Huffman::decode(str, block.substr(0, len))) {
+					throw Exception(Error::MALFORMED_BLOCK);
+				}
+			} else {
+				str.assign(block.substr(0, len));
+			}
+			block.remove_prefix(len);
+		}
+
+		private:
+		// The field at a 1-based index into the static table,
+		// followed by the dynamic table.
+		std::pair<std::string_view, std::string_view> fieldAt(
+			std::size_t idx) const {
+			if (idx == 0) {
+				throw Exception(Error::MALFORMED_BLOCK);
+			}
+			if (idx <= STATIC_TABLE.size()) {
+				return STATIC_TABLE[idx - 1];
+			}
+			idx -= STATIC_TABLE.size() + 1;
+			if (idx >= this->table.count()) {
+				throw Exception(Error::MALFORMED_BLOCK);
+			}
+			return this->table[idx];
+		}
+	};
+}
@@ -0,0 +1,240 @@
+// HPACK header block encoder (RFC 7541 6).
+#pragma once
+
+#include "../../../literal.hpp"
+#include "huffman.hpp"
+#include "table.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace Rain::Networking::Http2::Hpack {
+	// Encodes header blocks, with a dynamic table mirrored
+	// by the decoder of the peer.
+	//
+	// Fields in either table are encoded by index, and other
+	// fields as literals, which are inserted into the dynamic
+	// table unless they are sensitive or unlikely to recur.
+	// String literals are Huffman-coded where shorter.
+	class Encoder {
+		private:
+		DynamicTable table;
+
+		// Largest table size used, however large the peer
+		// allows.
+		std::size_t const capacity;
+
+		// Smallest and final sizes since the last block, which
+		// are signalled at the beginning of the next.
+		std::size_t minSize, nextSize;
+		bool isResized{false};
+
+		// Insertion numbers of the newest dynamic field with
+		// each name and value, keyed by `name\0value`, and
+		// with each name.
+		std::unordered_map<std::string, std::size_t> fieldIds,
+			nameIds;
+
+		// Keys of dynamic fields, newest first, which are
+		// forgotten once evicted.
+		std::deque<std::string> keys;
+
+		// Reused across fields.
+		std::string key;
+
+		public:
+		Encoder(std::size_t capacity = 4096) :
+			table(capacity),
+			capacity(capacity),
+			minSize(capacity),
+			nextSize(capacity) {}
+
+		// Follows SETTINGS_HEADER_TABLE_SIZE of the peer, up to
+		// capacity.
+		void resize(std::size_t maxSize) {
+			maxSize = std::min(maxSize, this->capacity);
+			this->minSize = this->isResized
+				? std::min(this->minSize, maxSize)
+				: maxSize;
+			this->nextSize = maxSize;
+			this->isResized = true;
+			this->table.resize(maxSize);
+			this->forget();
+		}
+
+		// Appends a field to block, whose name is lowercased. A
+		// block begins with the first field appended to an
+		// empty string.
+		void encode(
+			std::string &block,
+			std::string_view name,
+			std::string_view value) {
+			if (block.empty() && this->isResized) {
+				if (this->minSize < this->nextSize) {
+					Encoder::encodeInt(block, 0x20, 5, this->minSize);
+				}
+				Encoder::encodeInt(block, 0x20, 5, this->nextSize);
+				this->isResized = false;
+			}
+
+			this->key.assign(name);
+			for (char &ch : this->key) {
+				ch = static_cast<char>(
+					std::tolower(static_cast<unsigned char>(ch)));
+			}
+			std::size_t const nameLen{name.size()};
+			name = std::string_view(this->key);
+
+			// Fully matched fields are sent by index.
+			std::size_t nameIdx{0};
+			auto const staticIt{Encoder::staticNames().find(name)};
+			if (staticIt != Encoder::staticNames().end()) {
+				nameIdx = staticIt->second;
+				for (std::size_t idx{nameIdx};
+						 idx <= STATIC_TABLE.size() &&
+						 STATIC_TABLE[idx - 1].first == name;
+						 idx++) {
+					if (STATIC_TABLE[idx - 1].second == value) {
+						Encoder::encodeInt(block, 0x80, 7, idx);
+						return;
+					}
+				}
+			}
+			this->key.push_back('\0');
+			this->key.append(value);
+			auto const fieldIt{this->fieldIds.find(this->key)};
+			if (fieldIt != this->fieldIds.end()) {
+				Encoder::encodeInt(
+					block, 0x80, 7, this->indexOf(fieldIt->second));
+				return;
+			}
+			name = std::string_view(this->key).substr(0, nameLen);
+			if (nameIdx == 0) {
+				auto const nameIt{
+					this->nameIds.find(std::string(name))};
+				if (nameIt != this->nameIds.end()) {
+					nameIdx = this->indexOf(nameIt->second);
+				}
+			}
+
+			// Credentials are never indexed, even by
+			// intermediaries (RFC 7541 7.1.3).
+			bool const isSensitive{
+				name == "authorization" ||
+				name == "proxy-authorization" ||
+				(name == "cookie" && value.size() < 20)};
+			bool const toIndex{
+				!isSensitive && name != ":path" &&
+				name != "content-length" && name != "age" &&
+				name != "etag" && name != "set-cookie" &&
+				DynamicTable::sizeOf(name, value) <=
+					this->table.maxSize() / 4 * 3};
+			if (toIndex) {
+				Encoder::encodeInt(block, 0x40, 6, nameIdx);
+			} else {
+				Encoder::encodeInt(
+					block, isSensitive ? 0x10 : 0x00, 4, nameIdx);
+			}
+			if (nameIdx == 0) {
+				Encoder::encodeString(block, name);
+			}
+			Encoder::encodeString(block, value);
+
+			if (toIndex) {
+				std::size_t const id{this->table.next()};
+				this->table.insert(
+					std::string(name), std::string(value));
+				this->fieldIds[this->key] = id;
+				this->nameIds[std::string(name)] = id;
+				this->keys.push_front(this->key);
+				this->forget();
+			}
+		}
+
+		// Appends an integer with an N-bit prefix (RFC 7541
+		// 5.1), whose first byte is ORed with flags.
+		static void encodeInt(
+			std::string &block,
+			unsigned char flags,
+			std::size_t prefixLen,
+			std::size_t value) {
+			std::size_t const max{(1_zu << prefixLen) - 1};
+			if (value < max) {
+				block.push_back(static_cast<char>(flags | value));
+				return;
+			}
+			block.push_back(static_cast<char>(flags | max));
+			value -= max;
+			while (value >= 0x80) {
+				block.push_back(static_cast<char>(0x80 | value));
+				value >>= 7;
+			}
+			block.push_back(static_cast<char>(value));
+		}
+
+		// Appends a string literal (RFC 7541 5.2).
+		static void encodeString(
+			std::string &block,
+			std::string_view str) {
+			std::size_t const encodedLen{
+				Huffman::encodedLen(str)};
+			if (encodedLen < str.size()) {
+				Encoder::encodeInt(block, 0x80, 7, encodedLen);
+				Huffman::encode(block, str);
+			} else {
+				Encoder::encodeInt(block, 0x00, 7, str.size());
+				block.append(str);
+			}
+		}
+
+		private:
+		// Index of each name in the static table, of its first
+		// field.
+		static std::unordered_map<std::string_view, std::size_t>
+			const &staticNames() {
+			static std::unordered_map<
+				std::string_view,
+				std::size_t> const staticNames{[]() {
+				std::unordered_map<std::string_view, std::size_t>
+					staticNames;
+				for (std::size_t idx{STATIC_TABLE.size()}; idx > 0;
+						 idx--) {
+					staticNames[STATIC_TABLE[idx - 1].first] = idx;
+				}
+				return staticNames;
+			}()};
+			return staticNames;
+		}
+
+		std::size_t indexOf(std::size_t id) const noexcept {
+			return STATIC_TABLE.size() + this->table.next() - id;
+		}
+
+		// Forgets the keys of evicted fields.
+		void forget() {
+			while (this->keys.size() > this->table.count()) {
+				std::size_t const id{
+					this->table.next() - this->keys.size()};
+				std::string const &key{this->keys.back()};
+				auto const fieldIt{this->fieldIds.find(key)};
+				if (
+					fieldIt != this->fieldIds.end() &&
+					fieldIt->second == id) {
+					this->fieldIds.erase(fieldIt);
+				}
+				auto const nameIt{this->nameIds.find(
+					key.substr(0, key.find('\0')))};
+				if (
+					nameIt != this->nameIds.end() &&
+					nameIt->second == id) {
+					this->nameIds.erase(nameIt);
+				}
+				this->keys.pop_back();
+			}
+		}
+	};
+}
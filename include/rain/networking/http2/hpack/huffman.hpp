@@ -0,0 +1,194 @@
+// Huffman coding of HPACK string literals (RFC 7541 5.2).
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Rain::Networking::Http2::Hpack {
+	// The static Huffman code of HPACK (RFC 7541 Appendix B).
+	//
+	// The code is canonical: codes of each length are
+	// consecutive, in order of symbol, and follow the last
+	// code of the previous length. Codes are thus built from
+	// their lengths alone, and decoded by comparing the next
+	// 32 bits against the limit of each length.
+	class Huffman {
+		public:
+		// Symbol 256, whose prefixes pad encoded strings.
+		static std::size_t const EOS{256};
+
+		// Code lengths of each symbol.
+		static constexpr std::array<std::uint8_t, 257>
+			CODE_LENS{
+				13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28,
+				28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 30, 28,
+				28, 28, 28, 28, 28, 28, 28, 28, 6, 10, 10, 12,
+				13, 6, 8, 11, 10, 10, 8, 11, 8, 6, 6, 6,
+				5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 7, 8,
+				15, 6, 12, 10, 13, 6, 7, 7, 7, 7, 7, 7,
+				7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+				7, 7, 7, 7, 8, 7, 8, 13, 19, 13, 14, 6,
+				15, 5, 6, 5, 6, 5, 6, 6, 6, 5, 7, 7,
+				6, 6, 6, 5, 6, 7, 6, 5, 5, 6, 7, 7,
+				7, 7, 7, 15, 11, 14, 13, 28, 20, 22, 20, 20,
+				22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23,
+				24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23,
+				22, 23, 23, 24, 22, 21, 20, 22, 22, 23, 23, 21,
+				23, 22, 22, 24, 21, 22, 23, 23, 21, 21, 22, 21,
+				23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23,
+				26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27,
+				27, 26, 24, 25, 19, 21, 26, 27, 27, 26, 27, 24,
+				21, 21, 26, 26, 28, 27, 27, 27, 20, 24, 20, 21,
+				22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23,
+				26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27,
+				27, 27, 27, 26, 30};
+
+		private:
+		static std::size_t const MIN_LEN{5}, MAX_LEN{30};
+
+		class Tables {
+			public:
+			// Right-aligned code of each symbol.
+			std::array<std::uint32_t, 257> codes{};
+
+			// Symbols in order of code.
+			std::array<std::uint16_t, 257> symbols{};
+
+			// For each length, the first code of that length,
+			// the index in symbols of its symbol, and the limit
+			// below which left-aligned 32-bit codes are at most
+			// that long.
+			std::array<std::uint32_t, MAX_LEN + 1> firstCodes{},
+				firstIndices{};
+			std::array<std::uint64_t, MAX_LEN + 1> limits{};
+
+			// For each leading byte, the shortest length to try.
+			std::array<std::uint8_t, 256> minLens{};
+
+			constexpr Tables() {
+				std::array<std::uint32_t, MAX_LEN + 1> counts{};
+				for (std::uint8_t len : CODE_LENS) {
+					counts[len]++;
+				}
+				std::uint32_t code{0}, index{0};
+				for (std::size_t len{1}; len <= MAX_LEN; len++) {
+					this->firstCodes[len] = code;
+					this->firstIndices[len] = index;
+					code = (code + counts[len]) << 1;
+					index += counts[len];
+					this->limits[len] =
+						static_cast<std::uint64_t>(
+							this->firstCodes[len] + counts[len])
+						<< (32 - len);
+				}
+
+				std::array<std::uint32_t, MAX_LEN + 1> next{
+					this->firstIndices};
+				for (std::size_t symbol{0}; symbol <= EOS;
+						 symbol++) {
+					std::uint8_t const len{CODE_LENS[symbol]};
+					this->codes[symbol] = this->firstCodes[len] +
+						(next[len] - this->firstIndices[len]);
+					this->symbols[next[len]++] =
+						static_cast<std::uint16_t>(symbol);
+				}
+
+				std::size_t len{MIN_LEN};
+				for (std::uint64_t byte{0}; byte < 256; byte++) {
+					while (byte << 24 >= this->limits[len]) {
+						len++;
+					}
+					this->minLens[byte] =
+						static_cast<std::uint8_t>(len);
+				}
+			}
+		};
+		static Tables const TABLES;
+
+		public:
+		// Length of str once encoded.
+		static std::size_t encodedLen(
+			std::string_view str) noexcept {
+			std::size_t cBits{0};
+			for (char ch : str) {
+				cBits += CODE_LENS[static_cast<unsigned char>(ch)];
+			}
+			return (cBits + 7) / 8;
+		}
+
+		// Appends str, encoded and padded with the prefix of
+		// EOS, to to.
+		static void encode(
+			std::string &to,
+			std::string_view str) {
+			to.reserve(to.size() + Huffman::encodedLen(str));
+			std::uint64_t bits{0};
+			std::size_t cBits{0};
+			for (char ch : str) {
+				unsigned char const symbol{
+					static_cast<unsigned char>(ch)};
+				bits = bits << CODE_LENS[symbol] |
+					TABLES.codes[symbol];
+				cBits += CODE_LENS[symbol];
+				while (cBits >= 8) {
+					cBits -= 8;
+					to.push_back(static_cast<char>(bits >> cBits));
+				}
+			}
+			if (cBits > 0) {
+				to.push_back(static_cast<char>(
+					bits << (8 - cBits) | (0xff >> cBits)));
+			}
+		}
+
+		// Appends str, decoded, to to. Returns false if str
+		// contains EOS, or its padding is longer than 7 bits or
+		// not the prefix of EOS.
+		static bool decode(
+			std::string &to,
+			std::string_view str) {
+			// Bits are buffered left-aligned.
+			std::uint64_t bits{0};
+			std::size_t cBits{0}, idx{0};
+			while (true) {
+				while (cBits <= 56 && idx < str.size()) {
+					bits |= static_cast<std::uint64_t>(
+										static_cast<unsigned char>(str[idx++]))
+						<< (56 - cBits);
+					cBits += 8;
+				}
+				if (cBits == 0) {
+					return true;
+				}
+
+				std::uint64_t const top{bits >> 32};
+				std::size_t len{TABLES.minLens[top >> 24]};
+				while (top >= TABLES.limits[len]) {
+					len++;
+				}
+				if (len > cBits) {
+					// Padding is all that remains.
+					return cBits < 8 &&
+						top >> (32 - cBits) == 0xffu >> (8 - cBits);
+				}
+				std::uint32_t const code{
+					static_cast<std::uint32_t>(top >> (32 - len))};
+				std::uint16_t const symbol{
+					TABLES.symbols
+						[TABLES.firstIndices[len] + code -
+							TABLES.firstCodes[len]]};
+				if (symbol == EOS) {
+					return false;
+				}
+				to.push_back(static_cast<char>(symbol));
+				bits <<= len;
+				cBits -= len;
+			}
+		}
+	};
+
+	// Built once the class is complete.
+	inline constexpr Huffman::Tables Huffman::TABLES{};
+}
@@ -0,0 +1,160 @@
+// HPACK static and dynamic tables (RFC 7541 2.3).
+#pragma once
+
+#include <array>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace Rain::Networking::Http2::Hpack {
+	// A header field, by lowercase name and value.
+	using Field = std::pair<std::string, std::string>;
+
+	// Fields of the static table (RFC 7541 Appendix A),
+	// whose indices begin at 1.
+	inline constexpr std::
+		array<std::pair<std::string_view, std::string_view>, 61>
+			STATIC_TABLE{{{":authority", ""},
+				{":method", "GET"},
+				{":method", "POST"},
+				{":path", "/"},
+				{":path", "/index.html"},
+				{":scheme", "http"},
+				{":scheme", "https"},
+				{":status", "200"},
+				{":status", "204"},
+				{":status", "206"},
+				{":status", "304"},
+				{":status", "400"},
+				{":status", "404"},
+				{":status", "500"},
+				{"accept-charset", ""},
+				{"accept-encoding", "gzip, deflate"},
+				{"accept-language", ""},
+				{"accept-ranges", ""},
+				{"accept", ""},
+				{"access-control-allow-origin", ""},
+				{"age", ""},
+				{"allow", ""},
+				{"authorization", ""},
+				{"cache-control", ""},
+				{"content-disposition", ""},
+				{"content-encoding", ""},
+				{"content-language", ""},
+				{"content-length", ""},
+				{"content-location", ""},
+				{"content-range", ""},
+				{"content-type", ""},
+				{"cookie", ""},
+				{"date", ""},
+				{"etag", ""},
+				{"expect", ""},
+				{"expires", ""},
+				{"from", ""},
+				{"host", ""},
+				{"if-match", ""},
+				{"if-modified-since", ""},
+				{"if-none-match", ""},
+				{"if-range", ""},
+				{"if-unmodified-since", ""},
+				{"last-modified", ""},
+				{"link", ""},
+				{"location", ""},
+				{"max-forwards", ""},
+				{"proxy-authenticate", ""},
+				{"proxy-authorization", ""},
+				{"range", ""},
+				{"referer", ""},
+				{"refresh", ""},
+				{"retry-after", ""},
+				{"server", ""},
+				{"set-cookie", ""},
+				{"strict-transport-security", ""},
+				{"transfer-encoding", ""},
+				{"user-agent", ""},
+				{"vary", ""},
+				{"via", ""},
+				{"www-authenticate", ""}}};
+
+	// The dynamic table, of the most recently inserted
+	// fields, whose indices follow those of the static table.
+	// Insertions evict the oldest fields until the size of
+	// the table is at most its maximum size.
+	class DynamicTable {
+		private:
+		// Newest first.
+		std::deque<Field> fields;
+
+		std::size_t _size{0}, _maxSize;
+
+		// Fields ever inserted, which numbers each field by
+		// its insertion.
+		std::size_t cInserted{0};
+
+		public:
+		// Size of a field: its name and value, and 32 bytes of
+		// overhead.
+		static std::size_t sizeOf(
+			std::string_view name,
+			std::string_view value) noexcept {
+			return name.size() + value.size() + 32;
+		}
+
+		DynamicTable(std::size_t maxSize = 4096) :
+			_maxSize(maxSize) {}
+
+		std::size_t size() const noexcept { return this->_size; }
+		std::size_t maxSize() const noexcept {
+			return this->_maxSize;
+		}
+		std::size_t count() const noexcept {
+			return this->fields.size();
+		}
+
+		// The field at idx, from 0 for the newest.
+		Field const &operator[](std::size_t idx) const {
+			return this->fields[idx];
+		}
+
+		// The insertion number of the oldest field, or of the
+		// next field if empty. The field numbered id is at
+		// index cInserted - 1 - id while it remains.
+		std::size_t oldest() const noexcept {
+			return this->cInserted - this->fields.size();
+		}
+		std::size_t next() const noexcept {
+			return this->cInserted;
+		}
+
+		// Fields larger than the maximum size empty the table,
+		// and are not inserted.
+		void insert(std::string &&name, std::string &&value) {
+			std::size_t const size{
+				DynamicTable::sizeOf(name, value)};
+			this->evict(
+				size > this->_maxSize ? 0 : this->_maxSize - size);
+			this->cInserted++;
+			if (size <= this->_maxSize) {
+				this->fields.emplace_front(
+					std::move(name), std::move(value));
+				this->_size += size;
+			}
+		}
+
+		void resize(std::size_t maxSize) {
+			this->_maxSize = maxSize;
+			this->evict(maxSize);
+		}
+
+		private:
+		void evict(std::size_t size) {
+			while (this->_size > size) {
+				Field const &field{this->fields.back()};
+				this->_size -=
+					DynamicTable::sizeOf(field.first, field.second);
+				this->fields.pop_back();
+			}
+		}
+	};
+}
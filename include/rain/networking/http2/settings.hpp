@@ -0,0 +1,149 @@
+// HTTP/2 connection settings.
+#pragma once
+
+#include "error_code.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Rain::Networking::Http2 {
+	// Identifiers of settings (RFC 9113 6.5.2). Others are
+	// ignored.
+	enum class SettingId : std::uint16_t {
+		HEADER_TABLE_SIZE = 0x1,
+		ENABLE_PUSH = 0x2,
+		MAX_CONCURRENT_STREAMS = 0x3,
+		INITIAL_WINDOW_SIZE = 0x4,
+		MAX_FRAME_SIZE = 0x5,
+		MAX_HEADER_LIST_SIZE = 0x6
+	};
+
+	// Settings sent by one end of a connection, which bind
+	// the other end. Initially the defaults of RFC 9113
+	// 6.5.2, which apply until the first SETTINGS frame.
+	class Settings {
+		public:
+		// Bounds of window sizes and maxFrameSize.
+		static std::uint32_t const MAX_WINDOW_SIZE{0x7fffffff},
+			MIN_FRAME_SIZE{1u << 14},
+			MAX_FRAME_SIZE{(1u << 24) - 1};
+
+		std::uint32_t headerTableSize{4096};
+		bool enablePush{true};
+		std::uint32_t maxConcurrentStreams{UINT32_MAX},
+			initialWindowSize{65535},
+			maxFrameSize{MIN_FRAME_SIZE},
+			maxHeaderListSize{UINT32_MAX};
+
+		// Applies the payload of a SETTINGS frame. Returns
+		// FRAME_SIZE_ERROR, PROTOCOL_ERROR, or
+		// FLOW_CONTROL_ERROR if it is malformed or a value is
+		// out of range, and NO_ERROR otherwise.
+		ErrorCode apply(std::string_view payload) noexcept {
+			if (payload.size() % 6 != 0) {
+				return ErrorCode::FRAME_SIZE_ERROR;
+			}
+			for (; !payload.empty(); payload.remove_prefix(6)) {
+				auto const byte{[&payload](std::size_t idx) {
+					return static_cast<std::uint32_t>(
+						static_cast<unsigned char>(payload[idx]));
+				}};
+				std::uint32_t const value{byte(2) << 24 |
+					byte(3) << 16 | byte(4) << 8 | byte(5)};
+				SettingId const id{
+					static_cast<SettingId>(byte(0) << 8 | byte(1))};
+				switch (id) {
+					case SettingId::HEADER_TABLE_SIZE:
+						this->headerTableSize = value;
+						break;
+					case SettingId::ENABLE_PUSH:
+						if (value > 1) {
+							return ErrorCode::PROTOCOL_ERROR;
+						}
+						this->enablePush = value == 1;
+						break;
+					case SettingId::MAX_CONCURRENT_STREAMS:
+						this->maxConcurrentStreams = value;
+						break;
+					case SettingId::INITIAL_WINDOW_SIZE:
+						if (value > MAX_WINDOW_SIZE) {
+							return ErrorCode::FLOW_CONTROL_ERROR;
+						}
+						this->initialWindowSize = value;
+						break;
+					case SettingId::MAX_FRAME_SIZE:
+						if (
+							value < MIN_FRAME_SIZE ||
+							value > MAX_FRAME_SIZE) {
+							return ErrorCode::PROTOCOL_ERROR;
+						}
+						this->maxFrameSize = value;
+						break;
+					case SettingId::MAX_HEADER_LIST_SIZE:
+						this->maxHeaderListSize = value;
+						break;
+					default:
+						// Unknown settings are ignored.
+						break;
+				}
+			}
+			return ErrorCode::NO_ERROR;
+		}
+
+		// Serializes, as the payload of a SETTINGS frame, the
+		// settings which differ from the defaults.
+		std::string serialize() const {
+			Settings const defaults;
+			std::string payload;
+			auto const append{
+				[&payload](SettingId id, std::uint32_t value) {
+					std::uint16_t const idValue{
+						static_cast<std::uint16_t>(id)};
+					char const setting[6]{
+						static_cast<char>(idValue >> 8),
+						static_cast<char>(idValue),
+						static_cast<char>(value >> 24),
+						static_cast<char>(value >> 16),
+						static_cast<char>(value >> 8),
+						static_cast<char>(value)};
+					payload.append(setting, 6);
+				}};
+			if (
+				this->headerTableSize != defaults.headerTableSize) {
+				append(
+					SettingId::HEADER_TABLE_SIZE,
+					this->headerTableSize);
+			}
+			if (this->enablePush != defaults.enablePush) {
+				append(SettingId::ENABLE_PUSH, this->enablePush);
+			}
+			if (
+				this->maxConcurrentStreams !=
+				defaults.maxConcurrentStreams) {
+				append(
+					SettingId::MAX_CONCURRENT_STREAMS,
+					this->maxConcurrentStreams);
+			}
+			if (
+				this->initialWindowSize !=
+				defaults.initialWindowSize) {
+				append(
+					SettingId::INITIAL_WINDOW_SIZE,
+					this->initialWindowSize);
+			}
+			if (this->maxFrameSize != defaults.maxFrameSize) {
+				append(
+					SettingId::MAX_FRAME_SIZE, this->maxFrameSize);
+			}
+			if (
+				this->maxHeaderListSize !=
+				defaults.maxHeaderListSize) {
+				append(
+					SettingId::MAX_HEADER_LIST_SIZE,
+					this->maxHeaderListSize);
+			}
+			return payload;
+		}
+	};
+}
@@ -0,0 +1,475 @@
+// HTTP/2 frame engine, shared by Workers and Clients once
+// the connection preface is exchanged.
+#pragma once
+
+#include "../../literal.hpp"
+#include "../../platform.hpp"
+#include "../tcp/socket.hpp"
+#include "error_code.hpp"
+#include "frame.hpp"
+#include "hpack.hpp"
+#include "settings.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#ifndef RAIN_PLATFORM_WINDOWS
+	#include <netinet/tcp.h>
+#endif
+
+namespace Rain::Networking::Http2 {
+	// Sent by clients to begin each connection (RFC 9113
+	// 3.4), followed by a SETTINGS frame.
+	inline constexpr std::string_view PREFACE{
+		"PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"};
+
+	// Sends and receives frames (RFC 9113 4) on a connection
+	// which speaks HTTP/2, and keeps the state common to
+	// both ends: settings, HPACK tables, and connection flow
+	// control windows.
+	//
+	// Frames are parsed in place in the receive buffer where
+	// they fit, and sent through the send buffer, so that
+	// frames of many streams are sent together. Larger
+	// payloads are sent directly, in one vectored send with
+	// their head. Nothing is sent until flush.
+	class ConnectedSocketSpecInterface :
+		virtual public Tcp::ConnectedSocketSpecInterface {
+		public:
+		using Tcp::ConnectedSocketSpecInterface::send;
+		using Tcp::ConnectedSocketSpecInterface::recv;
+
+		// Flow control windows advertised to the peer, of the
+		// connection and of each stream, which are replenished
+		// once half of them is used.
+		std::uint32_t connectionWindowSize{1u << 24},
+			streamWindowSize{1u << 20};
+
+		protected:
+		// Settings of this end, sent in its first SETTINGS
+		// frame, and of the peer, as received.
+		Settings localSettings, remoteSettings;
+
+		Hpack::Encoder encoder;
+		Hpack::Decoder decoder;
+
+		// Bytes which may be sent on the connection, and which
+		// the peer may still send.
+		std::int64_t sendWindow{65535}, recvWindow{65535};
+
+		private:
+		// Bytes of the last payload received in place, which
+		// are consumed before the next frame.
+		std::size_t cConsumable{0};
+
+		// Payloads which are not received in place.
+		std::string payloadBuffer;
+
+		// Payloads at least this long are sent directly,
+		// rather than through the send buffer.
+		static std::size_t const DIRECT_SEND_LEN{1_zu << 12};
+
+		protected:
+		// Sends small frames at once, rather than holding them
+		// (by Nagle's algorithm) until the last is acknowledged,
+		// which peers may delay while they await the frames.
+		void setNoDelay() noexcept {
+			int const value{1};
+			setsockopt(
+				this->nativeSocket(),
+				IPPROTO_TCP,
+				TCP_NODELAY,
+				reinterpret_cast<char const *>(&value),
+				sizeof(value));
+		}
+
+		// Sends the first SETTINGS frame, with localSettings
+		// and streamWindowSize, and widens the connection
+		// window to connectionWindowSize.
+		void sendPreface() {
+			this->localSettings.initialWindowSize =
+				this->streamWindowSize;
+			this->sendFrame(
+				FrameType::SETTINGS,
+				0,
+				0,
+				this->localSettings.serialize());
+			if (this->connectionWindowSize > this->recvWindow) {
+				this->sendWindowUpdate(
+					0,
+					this->connectionWindowSize -
+						static_cast<std::uint32_t>(this->recvWindow));
+				this->recvWindow = this->connectionWindowSize;
+			}
+		}
+
+		void sendFrame(
+			FrameType type,
+			std::uint8_t flags,
+			std::uint32_t streamId,
+			std::string_view payload) {
+			char headBuffer[FrameHead::LEN];
+			FrameHead{
+				static_cast<std::uint32_t>(payload.size()),
+				type,
+				flags,
+				streamId}
+				.serialize(headBuffer);
+			std::string_view const buffers[]{
+				{headBuffer, FrameHead::LEN}, payload};
+
+			Tcp::VectoredSenderInterface *vectoredSender{
+				dynamic_cast<Tcp::VectoredSenderInterface *>(
+					this->rdbuf())};
+			if (
+				vectoredSender != nullptr &&
+				payload.size() >= DIRECT_SEND_LEN) {
+				if (!vectoredSender->send(buffers)) {
+					this->setstate(std::ios::badbit);
+				}
+				return;
+			}
+			for (std::string_view buffer : buffers) {
+				this->write(
+					buffer.data(),
+					static_cast<std::streamsize>(buffer.size()));
+			}
+		}
+
+		// Sends a header block, in a HEADERS frame followed by
+		// CONTINUATION frames as the peer's maxFrameSize
+		// requires.
+		void sendHeaders(
+			std::uint32_t streamId,
+			std::string_view block,
+			bool isEndStream) {
+			FrameType type{FrameType::HEADERS};
+			do {
+				std::string_view const fragment{block.substr(
+					0, this->remoteSettings.maxFrameSize)};
+				block.remove_prefix(fragment.size());
+				std::uint8_t flags{
+					block.empty() ? FrameHead::END_HEADERS
+												: std::uint8_t{0}};
+				if (type == FrameType::HEADERS && isEndStream) {
+					flags |= FrameHead::END_STREAM;
+				}
+				this->sendFrame(type, flags, streamId, fragment);
+				type = FrameType::CONTINUATION;
+			} while (!block.empty());
+		}
+
+		void sendWindowUpdate(
+			std::uint32_t streamId,
+			std::uint32_t increment) {
+			char const payload[4]{
+				static_cast<char>(increment >> 24),
+				static_cast<char>(increment >> 16),
+				static_cast<char>(increment >> 8),
+				static_cast<char>(increment)};
+			this->sendFrame(
+				FrameType::WINDOW_UPDATE, 0, streamId, {payload, 4});
+		}
+
+		void sendRstStream(
+			std::uint32_t streamId,
+			ErrorCode errorCode) {
+			std::uint32_t const code{
+				static_cast<std::uint32_t>(errorCode)};
+			char const payload[4]{
+				static_cast<char>(code >> 24),
+				static_cast<char>(code >> 16),
+				static_cast<char>(code >> 8),
+				static_cast<char>(code)};
+			this->sendFrame(
+				FrameType::RST_STREAM, 0, streamId, {payload, 4});
+		}
+
+		// Sends GOAWAY, after which no stream past lastStreamId
+		// is processed.
+		void sendGoaway(
+			std::uint32_t lastStreamId,
+			ErrorCode errorCode) {
+			std::uint32_t const code{
+				static_cast<std::uint32_t>(errorCode)};
+			char const payload[8]{
+				static_cast<char>(lastStreamId >> 24),
+				static_cast<char>(lastStreamId >> 16),
+				static_cast<char>(lastStreamId >> 8),
+				static_cast<char>(lastStreamId),
+				static_cast<char>(code >> 24),
+				static_cast<char>(code >> 16),
+				static_cast<char>(code >> 8),
+				static_cast<char>(code)};
+			this->sendFrame(FrameType::GOAWAY, 0, 0, {payload, 8});
+		}
+
+		// Whether any bytes of the next frame have been
+		// received.
+		bool isFrameBuffered() {
+			Tcp::PeekableStreamBuf *peekable{
+				dynamic_cast<Tcp::PeekableStreamBuf *>(
+					this->rdbuf())};
+			if (peekable == nullptr) {
+				return this->rdbuf()->in_avail() > 0;
+			}
+			peekable->consume(std::exchange(this->cConsumable, 0));
+			return !peekable->peek().empty();
+		}
+
+		// Receives the next frame. Its payload is valid until
+		// the next frame is received, and is left unreceived if
+		// it is longer than localSettings.maxFrameSize, after
+		// which the connection must be closed with
+		// FRAME_SIZE_ERROR. Returns false on timeout or close.
+		bool recvFrame(
+			FrameHead &head,
+			std::string_view &payload) {
+			payload = {};
+			Tcp::PeekableStreamBuf *peekable{
+				dynamic_cast<Tcp::PeekableStreamBuf *>(
+					this->rdbuf())};
+			if (peekable == nullptr) {
+				char headBuffer[FrameHead::LEN];
+				if (!this->read(headBuffer, FrameHead::LEN)) {
+					return false;
+				}
+				head.parse({headBuffer, FrameHead::LEN});
+				if (head.length > this->localSettings.maxFrameSize) {
+					return true;
+				}
+				this->payloadBuffer.resize(head.length);
+				if (!this->read(
+							this->payloadBuffer.data(),
+							static_cast<std::streamsize>(head.length))) {
+					return false;
+				}
+				payload = this->payloadBuffer;
+				return true;
+			}
+
+			peekable->consume(std::exchange(this->cConsumable, 0));
+			while (!head.parse(peekable->peek())) {
+				if (!peekable->recvMore()) {
+					return false;
+				}
+			}
+			peekable->consume(FrameHead::LEN);
+			if (head.length > this->localSettings.maxFrameSize) {
+				return true;
+			}
+
+			// In place, if the buffer holds the whole payload.
+			std::string_view buffered{peekable->peek()};
+			while (
+				buffered.size() < head.length &&
+				!peekable->isFull()) {
+				if (!peekable->recvMore()) {
+					return false;
+				}
+				buffered = peekable->peek();
+			}
+			if (buffered.size() >= head.length) {
+				payload = buffered.substr(0, head.length);
+				this->cConsumable = head.length;
+				return true;
+			}
+
+			this->payloadBuffer.resize(head.length);
+			for (std::size_t offset{0}; offset < head.length;) {
+				buffered = peekable->peek();
+				if (buffered.empty()) {
+					if (!peekable->recvMore()) {
+						return false;
+					}
+					continue;
+				}
+				buffered = buffered.substr(0, head.length - offset);
+				buffered.copy(
+					this->payloadBuffer.data() + offset,
+					buffered.size());
+				peekable->consume(buffered.size());
+				offset += buffered.size();
+			}
+			payload = this->payloadBuffer;
+			return true;
+		}
+
+		// Strips the padding (RFC 9113 6.1) of a DATA or
+		// HEADERS payload, and the priority of a HEADERS
+		// payload. Returns false if the padding is too long.
+		static bool unpad(
+			FrameHead const &head,
+			std::string_view &payload) noexcept {
+			std::size_t padLen{0};
+			if (head.hasFlag(FrameHead::PADDED)) {
+				if (payload.empty()) {
+					return false;
+				}
+				padLen = static_cast<unsigned char>(payload[0]);
+				payload.remove_prefix(1);
+			}
+			if (
+				head.type == FrameType::HEADERS &&
+				head.hasFlag(FrameHead::PRIORITY)) {
+				if (payload.size() < 5) {
+					return false;
+				}
+				payload.remove_prefix(5);
+			}
+			if (padLen > payload.size()) {
+				return false;
+			}
+			payload.remove_suffix(padLen);
+			return true;
+		}
+
+		// Handles a frame on stream 0, other than GOAWAY.
+		// Returns the connection error it causes, if any.
+		//
+		// Stream windows change by the returned delta of the
+		// peer's initial window size.
+		ErrorCode onConnectionFrame(
+			FrameHead const &head,
+			std::string_view payload,
+			std::int64_t &windowDelta) {
+			windowDelta = 0;
+			switch (head.type) {
+				case FrameType::SETTINGS: {
+					if (head.hasFlag(FrameHead::ACK)) {
+						return payload.empty()
+							? ErrorCode::NO_ERROR
+							: ErrorCode::FRAME_SIZE_ERROR;
+					}
+					std::uint32_t const initialWindowSize{
+						this->remoteSettings.initialWindowSize};
+					ErrorCode const errorCode{
+						this->remoteSettings.apply(payload)};
+					if (errorCode != ErrorCode::NO_ERROR) {
+						return errorCode;
+					}
+					windowDelta =
+						static_cast<std::int64_t>(
+							this->remoteSettings.initialWindowSize) -
+						initialWindowSize;
+					this->encoder.resize(
+						this->remoteSettings.headerTableSize);
+					this->sendFrame(
+						FrameType::SETTINGS, FrameHead::ACK, 0, {});
+					return ErrorCode::NO_ERROR;
+				}
+				case FrameType::PING:
+					if (payload.size() != 8) {
+						return ErrorCode::FRAME_SIZE_ERROR;
+					}
+					if (!head.hasFlag(FrameHead::ACK)) {
+						this->sendFrame(
+							FrameType::PING, FrameHead::ACK, 0, payload);
+					}
+					return ErrorCode::NO_ERROR;
+				case FrameType::WINDOW_UPDATE:
+					return ConnectedSocketSpecInterface::
+						onWindowUpdate(payload, this->sendWindow);
+				case FrameType::DATA:
+				case FrameType::HEADERS:
+				case FrameType::PRIORITY:
+				case FrameType::RST_STREAM:
+				case FrameType::PUSH_PROMISE:
+				case FrameType::CONTINUATION:
+					return ErrorCode::PROTOCOL_ERROR;
+				default:
+					return ErrorCode::NO_ERROR;
+			}
+		}
+
+		// Widens window by the increment of a WINDOW_UPDATE
+		// payload. Returns the error it causes, if any.
+		static ErrorCode onWindowUpdate(
+			std::string_view payload,
+			std::int64_t &window) noexcept {
+			if (payload.size() != 4) {
+				return ErrorCode::FRAME_SIZE_ERROR;
+			}
+			std::uint32_t const increment{
+				ConnectedSocketSpecInterface::readUint32(payload) &
+				Settings::MAX_WINDOW_SIZE};
+			if (increment == 0) {
+				return ErrorCode::PROTOCOL_ERROR;
+			}
+			window += increment;
+			return window > Settings::MAX_WINDOW_SIZE
+				? ErrorCode::FLOW_CONTROL_ERROR
+				: ErrorCode::NO_ERROR;
+		}
+
+		// Accounts for len bytes of DATA received on the
+		// connection, replenishing the window once half of it
+		// is used. Returns false if the peer overran it.
+		bool onConnectionData(std::size_t len) {
+			this->recvWindow -= static_cast<std::int64_t>(len);
+			if (this->recvWindow < 0) {
+				return false;
+			}
+			if (
+				this->recvWindow < this->connectionWindowSize / 2) {
+				this->sendWindowUpdate(
+					0,
+					this->connectionWindowSize -
+						static_cast<std::uint32_t>(this->recvWindow));
+				this->recvWindow = this->connectionWindowSize;
+			}
+			return true;
+		}
+
+		// Headers of HTTP/1.x connections, which are not sent
+		// over HTTP/2 (RFC 9113 8.2.2).
+		static bool isConnectionSpecific(std::string_view name) {
+			for (std::string_view specific :
+					 {"Connection",
+						 "Keep-Alive",
+						 "Proxy-Connection",
+						 "Transfer-Encoding",
+						 "Upgrade"}) {
+				if (ConnectedSocketSpecInterface::
+							isCaseAgnosticEqual(name, specific)) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		static bool isCaseAgnosticEqual(
+			std::string_view left,
+			std::string_view right) {
+			return std::equal(
+				left.begin(),
+				left.end(),
+				right.begin(),
+				right.end(),
+				[](char leftCh, char rightCh) {
+					return std::tolower(leftCh) ==
+						std::tolower(rightCh);
+				});
+		}
+
+		static std::uint32_t readUint32(
+			std::string_view bytes) noexcept {
+			return static_cast<std::uint32_t>(
+							 static_cast<unsigned char>(bytes[0]))
+				<< 24 |
+				static_cast<std::uint32_t>(
+					static_cast<unsigned char>(bytes[1]))
+				<< 16 |
+				static_cast<std::uint32_t>(
+					static_cast<unsigned char>(bytes[2]))
+				<< 8 |
+				static_cast<std::uint32_t>(
+					static_cast<unsigned char>(bytes[3]));
+		}
+	};
+}
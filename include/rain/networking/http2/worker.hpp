@@ -0,0 +1,1026 @@
+// HTTP/2 Worker, which upgrades from HTTP/1.1.
+#pragma once
+
+#include "../../error/consume_throwable.hpp"
+#include "../../literal.hpp"
+#include "../../string/base_64.hpp"
+#include "../../string/string.hpp"
+#include "../http/worker.hpp"
+#include "../waker.hpp"
+#include "socket.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Rain::Networking::Http2 {
+	template<
+		typename RequestMessageSpec,
+		typename ResponseMessageSpec>
+	class WorkerSocketSpecInterface :
+		virtual public Http::WorkerSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec>,
+		virtual public Http2::ConnectedSocketSpecInterface {
+		public:
+		using Http::WorkerSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec>::send;
+		using Http::WorkerSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec>::recv;
+
+		// Most streams open at once, advertised as
+		// SETTINGS_MAX_CONCURRENT_STREAMS. Streams past it are
+		// refused.
+		std::uint32_t maxConcurrentStreams{256};
+
+		// Longest request body received. Longer requests are
+		// responded to with 413 (Request Entity Too Large).
+		std::size_t maxBodyLen{1_zu << 24};
+
+		protected:
+		// Waits until a frame begins to arrive. Returns false
+		// if the peer stays silent for onWorkIdleTimeout, or
+		// the Server is interrupted.
+		bool awaitFrame() {
+			if (this->isFrameBuffered()) {
+				return true;
+			}
+			return this->poll(
+							 PollFlag::READ_NORMAL,
+							 Time::Timeout(
+								 std::chrono::steady_clock::now() +
+								 this->onWorkIdleTimeout())) !=
+				PollFlag::NONE;
+		}
+	};
+
+	// HTTP/2 Worker (RFC 9113), over cleartext (h2c). Serves
+	// HTTP/1.x until the client upgrades with `Upgrade: h2c`,
+	// or begins the connection with the HTTP/2 preface (prior
+	// knowledge). Each stream is then a request, routed to
+	// the same filters as HTTP/1.x requests, with version
+	// 2.0.
+	//
+	// Streams are multiplexed on the connection: frames of
+	// many requests may arrive interleaved, and each is
+	// dispatched once it ends. Filters are called on the
+	// ThreadPool of the Server, so that a slow filter does
+	// not hold the streams behind it, and filters of the same
+	// Worker may run at once; they must not use the Worker as
+	// a Socket. Without a ThreadPool, filters are called on
+	// the thread of the connection instead. Responses are
+	// sent by the thread of the connection, as their stream
+	// and connection flow control windows allow,
+	// round-robin, and frames are batched into as few sends
+	// as possible. Bodies which produce slowly hold the
+	// connection. The response cache of the Worker is not
+	// used.
+	//
+	// Upgraded connections hold their thread until closed,
+	// in reactor mode as well. They are closed with GOAWAY
+	// once idle for onWorkIdleTimeout. onWorkRequestTimeout,
+	// if set, bounds the whole of the upgraded connection.
+	template<
+		typename RequestMessageSpec,
+		typename ResponseMessageSpec,
+		typename Socket>
+	class WorkerSocketSpec :
+		public Socket,
+		virtual public WorkerSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec> {
+		using Socket::Socket;
+
+		public:
+		using WorkerSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec>::send;
+		using WorkerSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec>::recv;
+
+		protected:
+		using typename Http::WorkerSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec>::ResponseAction;
+
+		private:
+		// An open stream, which receives its request until the
+		// request ends, and then sends its response.
+		class Stream {
+			public:
+			// Flow control windows of the stream.
+			std::int64_t sendWindow, recvWindow;
+
+			// The request, as received.
+			std::string method, target, authority, body;
+			Http::Headers headers, trailers;
+
+			// Set once the request ends.
+			bool isResponding{false};
+
+			// Set while its filters run on the ThreadPool.
+			bool isDispatched{false};
+
+			// The response, and its body left to send: in memory,
+			// or read from a streambuf.
+			std::optional<ResponseMessageSpec> response;
+			Http::FrozenResponse frozen;
+			std::string_view bodyView;
+			std::streambuf *bodyStreamBuf{nullptr};
+
+			// Whether the stream waits in sendQueue.
+			bool isQueued{false};
+		};
+		std::unordered_map<std::uint32_t, Stream> streams;
+
+		// Responding streams with body left to send and window
+		// to send it, in the order they are sent to.
+		std::deque<std::uint32_t> sendQueue;
+
+		// Highest stream opened by the peer.
+		std::uint32_t lastStreamId{0};
+
+		// Once GOAWAY is sent or received, no more streams are
+		// opened, and the connection closes once the open
+		// streams end.
+		bool isGoingAway{false};
+
+		// Stream of a header block continued in CONTINUATION
+		// frames, the block so far, and whether it ends the
+		// stream.
+		std::uint32_t continuedStreamId{0};
+		std::string headerBlock;
+		bool isBlockEndStream{false};
+
+		// Reused across streams.
+		std::vector<Hpack::Field> fields;
+		std::string sendBlock, dataBuffer;
+
+		// ResponseAction of a stream whose filters have
+		// returned on the ThreadPool.
+		class Dispatched {
+			public:
+			std::uint32_t id;
+			bool isHead;
+			ResponseAction action;
+		};
+
+		// Streams dispatched to the ThreadPool, whose
+		// ResponseActions are handed back to the thread of the
+		// connection, which waker wakes. Created once the first
+		// stream is dispatched.
+		class Dispatcher {
+			public:
+			Waker waker;
+			std::mutex mtx;
+			std::vector<Dispatched> done;
+
+			// Last, so that its tasks end before the rest is
+			// destroyed.
+			Multithreading::ThreadPool::TaskGroup taskGroup;
+
+			Dispatcher(Multithreading::ThreadPool &threadPool) :
+				taskGroup(threadPool) {}
+		};
+		std::unique_ptr<Dispatcher> dispatcher;
+
+		// Streams dispatched but not yet answered, and those of
+		// them reset since, which still count towards
+		// maxConcurrentStreams until their filters return.
+		std::size_t cDispatched{0}, cCancelled{0};
+
+		// What a connection waits on next.
+		enum class Awaited { FRAME, DISPATCHED, NONE };
+
+		// Responds to requests which upgrade to h2c (RFC 7540
+		// 3.2) with 101 (Switching Protocols). Requests with
+		// bodies, which clients may hold behind `Expect:
+		// 100-continue`, are served over HTTP/1.1 instead.
+		virtual ResponseAction onPreroute(
+			RequestMessageSpec &req) override {
+			if (
+				req.version != Http::Version::_1_1 ||
+				req.headers.contentLength() != 0 ||
+				!req.headers.transferEncoding().empty() ||
+				req.headers.count("HTTP2-Settings") != 1 ||
+				!WorkerSocketSpec::hasToken(
+					req.headers, "Upgrade", "h2c") ||
+				!WorkerSocketSpec::hasToken(
+					req.headers, "Connection", "HTTP2-Settings")) {
+				return {};
+			}
+			return {
+				ResponseMessageSpec{
+					Http::StatusCode::SWITCHING_PROTOCOLS,
+					{{{"Connection", "Upgrade"}, {"Upgrade", "h2c"}}}},
+				true};
+		}
+
+		// Speaks HTTP/2 after the preface, or the 101, until
+		// the connection is closed.
+		virtual bool onUpgrade(
+			RequestMessageSpec &req) override {
+			Rain::Error::consumeThrowable(
+				[this, &req]() { this->serve(req); })();
+			Rain::Error::consumeThrowable(
+				[this]() { this->shutdown(); })();
+
+			// Filters of dispatched streams may still be running
+			// on the Worker.
+			if (this->dispatcher) {
+				Rain::Error::consumeThrowable([this]() {
+					this->dispatcher->taskGroup.wait();
+				})();
+			}
+			return true;
+		}
+
+		void serve(RequestMessageSpec &req) {
+			// The 101 may have been held behind another request.
+			this->cork(false);
+			this->flush();
+			this->setNoDelay();
+
+			// After the preface request line, the rest of the
+			// preface remains. Upgraded connections answer the
+			// request on stream 1, and then expect the whole
+			// preface.
+			std::string_view preface{
+				PREFACE.substr(PREFACE.find("SM"))};
+			bool const isUpgraded{
+				req.method != Http::Method::PRI};
+			if (isUpgraded) {
+				std::string settings{
+					req.headers.find("HTTP2-Settings")->second};
+				for (char &ch : settings) {
+					ch = ch == '-' ? '+' : ch == '_' ? '/' : ch;
+				}
+				if (
+					this->remoteSettings.apply(
+						String::Base64::decode(settings)) !=
+					ErrorCode::NO_ERROR) {
+					return;
+				}
+				this->encoder.resize(
+					this->remoteSettings.headerTableSize);
+				preface = PREFACE;
+			}
+
+			this->localSettings.maxConcurrentStreams =
+				this->maxConcurrentStreams;
+			this->localSettings.maxHeaderListSize =
+				static_cast<std::uint32_t>(
+					this->decoder.maxListSize);
+			this->sendPreface();
+			this->flush();
+
+			if (isUpgraded) {
+				Stream &stream{this->open(1)};
+				stream.method = static_cast<std::string>(req.method);
+				stream.target = std::move(req.target);
+				stream.headers = std::move(req.headers);
+				this->onRequestEnd(1, stream);
+			}
+			char buffer[PREFACE.size()];
+			if (
+				!this->read(buffer, preface.size()) ||
+				std::string_view(buffer, preface.size()) !=
+					preface) {
+				this->sendGoaway(
+					this->lastStreamId, ErrorCode::PROTOCOL_ERROR);
+				this->flush();
+				return;
+			}
+
+			// Output is flushed whenever input runs out, and the
+			// connection closes once the peer stops reading.
+			ErrorCode errorCode{ErrorCode::NO_ERROR};
+			while (this->good()) {
+				this->answerDispatched();
+				this->pump();
+				if (!this->isFrameBuffered()) {
+					this->flush();
+					if (this->isGoingAway && this->streams.empty()) {
+						break;
+					}
+					Awaited const awaited{
+						this->awaitFrameOrDispatched()};
+					if (awaited == Awaited::NONE) {
+						break;
+					} else if (awaited == Awaited::DISPATCHED) {
+						continue;
+					}
+				}
+
+				FrameHead head;
+				std::string_view payload;
+				if (!this->recvFrame(head, payload)) {
+					return;
+				}
+				errorCode = this->onFrame(head, payload);
+				if (errorCode != ErrorCode::NO_ERROR) {
+					break;
+				}
+			}
+			this->sendGoaway(this->lastStreamId, errorCode);
+			this->flush();
+		}
+
+		// Handles a frame. Returns the connection error it
+		// causes, if any. Stream errors reset their stream.
+		ErrorCode onFrame(
+			FrameHead const &head,
+			std::string_view payload) {
+			if (head.length > this->localSettings.maxFrameSize) {
+				return ErrorCode::FRAME_SIZE_ERROR;
+			}
+			if (
+				this->continuedStreamId != 0 &&
+				(head.type != FrameType::CONTINUATION ||
+					head.streamId != this->continuedStreamId)) {
+				return ErrorCode::PROTOCOL_ERROR;
+			}
+
+			if (head.streamId == 0) {
+				if (head.type == FrameType::GOAWAY) {
+					this->isGoingAway = true;
+					return payload.size() < 8
+						? ErrorCode::FRAME_SIZE_ERROR
+						: ErrorCode::NO_ERROR;
+				}
+				std::int64_t windowDelta;
+				ErrorCode const errorCode{this->onConnectionFrame(
+					head, payload, windowDelta)};
+				if (windowDelta != 0) {
+					for (auto &[id, stream] : this->streams) {
+						stream.sendWindow += windowDelta;
+						if (
+							stream.sendWindow >
+							Settings::MAX_WINDOW_SIZE) {
+							return ErrorCode::FLOW_CONTROL_ERROR;
+						}
+						this->queue(id, stream);
+					}
+				}
+				return errorCode;
+			}
+
+			switch (head.type) {
+				case FrameType::HEADERS:
+					if (
+						head.streamId % 2 == 0 ||
+						!WorkerSocketSpec::unpad(head, payload)) {
+						return ErrorCode::PROTOCOL_ERROR;
+					}
+					this->headerBlock.assign(payload);
+					this->isBlockEndStream =
+						head.hasFlag(FrameHead::END_STREAM);
+					if (!head.hasFlag(FrameHead::END_HEADERS)) {
+						this->continuedStreamId = head.streamId;
+						return ErrorCode::NO_ERROR;
+					}
+					return this->onHeaderBlock(head.streamId);
+				case FrameType::CONTINUATION:
+					if (this->continuedStreamId == 0) {
+						return ErrorCode::PROTOCOL_ERROR;
+					}
+					this->headerBlock.append(payload);
+					if (
+						this->headerBlock.size() >
+						this->decoder.maxListSize) {
+						return ErrorCode::ENHANCE_YOUR_CALM;
+					}
+					if (!head.hasFlag(FrameHead::END_HEADERS)) {
+						return ErrorCode::NO_ERROR;
+					}
+					this->continuedStreamId = 0;
+					return this->onHeaderBlock(head.streamId);
+				case FrameType::DATA:
+					return this->onDataFrame(head, payload);
+				case FrameType::RST_STREAM:
+					if (payload.size() != 4) {
+						return ErrorCode::FRAME_SIZE_ERROR;
+					}
+					if (head.streamId > this->lastStreamId) {
+						return ErrorCode::PROTOCOL_ERROR;
+					}
+					this->erase(head.streamId);
+					return ErrorCode::NO_ERROR;
+				case FrameType::WINDOW_UPDATE: {
+					auto const it{this->streams.find(head.streamId)};
+					if (it == this->streams.end()) {
+						return head.streamId > this->lastStreamId
+							? ErrorCode::PROTOCOL_ERROR
+							: ErrorCode::NO_ERROR;
+					}
+					ErrorCode const errorCode{
+						WorkerSocketSpec::onWindowUpdate(
+							payload, it->second.sendWindow)};
+					if (errorCode == ErrorCode::FRAME_SIZE_ERROR) {
+						return errorCode;
+					} else if (errorCode != ErrorCode::NO_ERROR) {
+						this->resetStream(head.streamId, errorCode);
+					} else {
+						this->queue(head.streamId, it->second);
+					}
+					return ErrorCode::NO_ERROR;
+				}
+				case FrameType::PRIORITY:
+					// Priorities are not followed.
+					if (payload.size() != 5) {
+						this->resetStream(
+							head.streamId, ErrorCode::FRAME_SIZE_ERROR);
+					}
+					return ErrorCode::NO_ERROR;
+				case FrameType::SETTINGS:
+				case FrameType::PUSH_PROMISE:
+				case FrameType::PING:
+				case FrameType::GOAWAY:
+					return ErrorCode::PROTOCOL_ERROR;
+				default:
+					// Unknown frames are ignored.
+					return ErrorCode::NO_ERROR;
+			}
+		}
+
+		// Handles a complete header block: the request head of
+		// a new stream, or the trailers of an open one.
+		ErrorCode onHeaderBlock(std::uint32_t id) {
+			// The block must be decoded, whatever happens to its
+			// stream, for the tables to stay in sync.
+			this->fields.clear();
+			try {
+				this->decoder.decode(
+					this->headerBlock, this->fields);
+			} catch (...) {
+				return ErrorCode::COMPRESSION_ERROR;
+			}
+
+			auto const it{this->streams.find(id)};
+			if (it != this->streams.end()) {
+				Stream &stream{it->second};
+				if (stream.isResponding) {
+					this->resetStream(id, ErrorCode::STREAM_CLOSED);
+					return ErrorCode::NO_ERROR;
+				}
+				for (auto &[name, value] : this->fields) {
+					if (
+						!this->isBlockEndStream ||
+						(!name.empty() && name[0] == ':')) {
+						this->resetStream(id, ErrorCode::PROTOCOL_ERROR);
+						return ErrorCode::NO_ERROR;
+					}
+					stream.trailers.emplace(
+						std::move(name), std::move(value));
+				}
+				this->onRequestEnd(id, stream);
+				return ErrorCode::NO_ERROR;
+			}
+
+			// Streams are opened in increasing order, and those
+			// already closed are forgotten, but refused (RFC 9113
+			// 5.1).
+			if (id <= this->lastStreamId) {
+				this->sendRstStream(id, ErrorCode::STREAM_CLOSED);
+				return ErrorCode::NO_ERROR;
+			}
+			if (this->isGoingAway) {
+				this->sendRstStream(id, ErrorCode::REFUSED_STREAM);
+				return ErrorCode::NO_ERROR;
+			}
+			this->lastStreamId = id;
+			if (
+				this->streams.size() + this->cCancelled >=
+				this->maxConcurrentStreams) {
+				this->sendRstStream(id, ErrorCode::REFUSED_STREAM);
+				return ErrorCode::NO_ERROR;
+			}
+
+			// Pseudo-headers precede the others (RFC 9113 8.3),
+			// and Cookie may be split across fields.
+			Stream &stream{this->open(id)};
+			bool isMalformed{false}, isRegular{false};
+			std::string cookie;
+			for (auto &[name, value] : this->fields) {
+				if (!name.empty() && name[0] == ':') {
+					if (name == ":scheme") {
+						continue;
+					}
+					std::string *pseudo{nullptr};
+					if (name == ":method") {
+						pseudo = &stream.method;
+					} else if (name == ":path") {
+						pseudo = &stream.target;
+					} else if (name == ":authority") {
+						pseudo = &stream.authority;
+					}
+					if (
+						isRegular || pseudo == nullptr ||
+						!pseudo->empty()) {
+						isMalformed = true;
+						break;
+					}
+					*pseudo = std::move(value);
+				} else if (name == "cookie") {
+					isRegular = true;
+					cookie.append(cookie.empty() ? "" : "; ");
+					cookie.append(value);
+				} else {
+					isRegular = true;
+					stream.headers.emplace(
+						std::move(name), std::move(value));
+				}
+			}
+			if (
+				isMalformed || stream.method.empty() ||
+				stream.target.empty()) {
+				this->resetStream(id, ErrorCode::PROTOCOL_ERROR);
+				return ErrorCode::NO_ERROR;
+			}
+			if (!cookie.empty()) {
+				stream.headers.emplace("Cookie", std::move(cookie));
+			}
+			if (
+				!stream.authority.empty() &&
+				stream.headers.find("Host") ==
+					stream.headers.end()) {
+				stream.headers.emplace("Host", stream.authority);
+			}
+			if (this->isBlockEndStream) {
+				this->onRequestEnd(id, stream);
+			}
+			return ErrorCode::NO_ERROR;
+		}
+
+		ErrorCode onDataFrame(
+			FrameHead const &head,
+			std::string_view payload) {
+			if (!this->onConnectionData(head.length)) {
+				return ErrorCode::FLOW_CONTROL_ERROR;
+			}
+			auto const it{this->streams.find(head.streamId)};
+			if (it == this->streams.end()) {
+				return head.streamId > this->lastStreamId
+					? ErrorCode::PROTOCOL_ERROR
+					: ErrorCode::NO_ERROR;
+			}
+			Stream &stream{it->second};
+			if (stream.isResponding) {
+				this->resetStream(
+					head.streamId, ErrorCode::STREAM_CLOSED);
+				return ErrorCode::NO_ERROR;
+			}
+			if (!WorkerSocketSpec::unpad(head, payload)) {
+				return ErrorCode::PROTOCOL_ERROR;
+			}
+			stream.recvWindow -= head.length;
+			if (stream.recvWindow < 0) {
+				this->resetStream(
+					head.streamId, ErrorCode::FLOW_CONTROL_ERROR);
+				return ErrorCode::NO_ERROR;
+			}
+
+			// Too long requests are responded to early, and the
+			// rest of their bodies refused (RFC 9113 8.1).
+			if (
+				payload.size() >
+				this->maxBodyLen - stream.body.size()) {
+				stream.isResponding = true;
+				ResponseAction action{ResponseMessageSpec{
+					Http::StatusCode::REQUEST_ENTITY_TOO_LARGE}};
+				this->answer(head.streamId, stream, false, action);
+				this->resetStream(
+					head.streamId, ErrorCode::NO_ERROR);
+				return ErrorCode::NO_ERROR;
+			}
+			stream.body.append(payload);
+
+			if (head.hasFlag(FrameHead::END_STREAM)) {
+				this->onRequestEnd(head.streamId, stream);
+			} else if (
+				stream.recvWindow < this->streamWindowSize / 2) {
+				this->sendWindowUpdate(
+					head.streamId,
+					this->streamWindowSize -
+						static_cast<std::uint32_t>(stream.recvWindow));
+				stream.recvWindow = this->streamWindowSize;
+			}
+			return ErrorCode::NO_ERROR;
+		}
+
+		// Dispatches the request of a stream which has ended,
+		// to the ThreadPool if there is one. The head of its
+		// response is sent once its filters return.
+		void onRequestEnd(std::uint32_t id, Stream &stream) {
+			stream.isResponding = true;
+
+			std::optional<Http::Method> method;
+			try {
+				method.emplace(stream.method);
+			} catch (...) {
+			}
+			if (!method || *method == Http::Method::PRI) {
+				ResponseAction action{ResponseMessageSpec{
+					Http::StatusCode::METHOD_NOT_ALLOWED}};
+				this->answer(id, stream, false, action);
+				return;
+			}
+
+			// The request is built where its filters run, from
+			// the stream, which stays with the connection.
+			bool const isHead{*method == Http::Method::HEAD};
+			auto respond{[this,
+										 method{*method},
+										 target{std::move(stream.target)},
+										 headers{std::move(stream.headers)},
+										 body{std::move(stream.body)},
+										 trailers{std::move(stream.trailers)}]()
+										 mutable -> ResponseAction {
+				RequestMessageSpec req{
+					method,
+					std::move(target),
+					std::move(headers),
+					body.empty()
+						? Http::Body()
+						: Http::Body(std::stringbuf(
+								std::move(body), std::ios::in)),
+					Http::Version::_2_0};
+				req.trailers = std::move(trailers);
+				try {
+					return this->dispatch(req);
+				} catch (...) {
+					return {ResponseMessageSpec{
+						Http::StatusCode::INTERNAL_SERVER_ERROR}};
+				}
+			}};
+
+			Multithreading::ThreadPool *threadPool{
+				this->serverThreadPool()};
+			if (threadPool == nullptr) {
+				ResponseAction action{respond()};
+				this->answer(id, stream, isHead, action);
+				return;
+			}
+			if (!this->dispatcher) {
+				this->dispatcher.reset(new Dispatcher(*threadPool));
+			}
+			this->dispatcher->taskGroup.queueTask(
+				[this, id, isHead, respond{std::move(respond)}]()
+					mutable {
+					Dispatched dispatched{id, isHead, respond()};
+					{
+						std::lock_guard<std::mutex> lckGuard(
+							this->dispatcher->mtx);
+						this->dispatcher->done.push_back(
+							std::move(dispatched));
+					}
+					this->dispatcher->waker.wake();
+				});
+			stream.isDispatched = true;
+			this->cDispatched++;
+		}
+
+		// Sends the heads of the responses of streams whose
+		// filters have returned. Streams reset since are
+		// skipped, and no longer count as cancelled.
+		void answerDispatched() {
+			if (this->cDispatched == 0) {
+				return;
+			}
+			std::vector<Dispatched> done;
+			{
+				std::lock_guard<std::mutex> lckGuard(
+					this->dispatcher->mtx);
+				done.swap(this->dispatcher->done);
+			}
+			for (Dispatched &dispatched : done) {
+				this->cDispatched--;
+				auto const it{this->streams.find(dispatched.id)};
+				if (it == this->streams.end()) {
+					this->cCancelled--;
+				} else {
+					it->second.isDispatched = false;
+					this->answer(
+						dispatched.id,
+						it->second,
+						dispatched.isHead,
+						dispatched.action);
+				}
+			}
+		}
+
+		// As awaitFrame, but also wakes once a dispatched
+		// stream is done. The connection is not idle while
+		// streams are dispatched.
+		Awaited awaitFrameOrDispatched() {
+			if (this->cDispatched == 0) {
+				return this->awaitFrame() ? Awaited::FRAME
+																	: Awaited::NONE;
+			}
+			if (this->isFrameBuffered()) {
+				return Awaited::FRAME;
+			}
+			using PollFlag = SocketInterface::PollFlag;
+			std::vector<PollFlag> const flags{
+				SocketInterface::poll(
+					{this,
+						this->interrupter(),
+						&this->dispatcher->waker},
+					{PollFlag::READ_NORMAL,
+						PollFlag::READ_NORMAL,
+						PollFlag::READ_NORMAL},
+					{})};
+			if (flags[1] != PollFlag::NONE) {
+				return Awaited::NONE;
+			} else if (flags[0] != PollFlag::NONE) {
+				return Awaited::FRAME;
+			}
+			this->dispatcher->waker.drain();
+			return Awaited::DISPATCHED;
+		}
+
+		// Sends the head of the response of a ResponseAction,
+		// and queues its body. Closing actions close the
+		// connection with GOAWAY, once the open streams end.
+		void answer(
+			std::uint32_t id,
+			Stream &stream,
+			bool isHead,
+			ResponseAction &action) {
+			if (
+				action.toClose.value_or(true) &&
+				!this->isGoingAway) {
+				this->isGoingAway = true;
+				this->sendGoaway(
+					this->lastStreamId, ErrorCode::NO_ERROR);
+			}
+
+			this->sendBlock.clear();
+			if (action.frozen) {
+				// Frozen responses are sent from their HTTP/1.1
+				// serialization, with the current Date.
+				stream.frozen = action.frozen;
+				stream.bodyView = stream.frozen.body();
+				std::string_view head{stream.frozen.bytes()};
+				head.remove_suffix(stream.bodyView.size() + 2);
+				this->encoder.encode(
+					this->sendBlock, ":status", head.substr(9, 3));
+				head.remove_prefix(head.find("\r\n") + 2);
+				while (!head.empty()) {
+					std::size_t const colon{head.find(':')},
+						end{head.find("\r\n")};
+					std::string_view const name{
+						head.substr(0, colon)};
+					if (!WorkerSocketSpec::isConnectionSpecific(
+								name)) {
+						this->encoder.encode(
+							this->sendBlock,
+							name,
+							WorkerSocketSpec::isCaseAgnosticEqual(
+								name, "Date")
+								? Http::Header::HttpDate::nowStr()
+								: String::trimWhitespace(head.substr(
+										colon + 1, end - colon - 1)));
+					}
+					head.remove_prefix(end + 2);
+				}
+			} else if (action.response) {
+				ResponseMessageSpec &res{
+					stream.response.emplace(
+						std::move(action.response.value()))};
+
+				// Other protocols are not spoken over streams.
+				if (
+					res.statusCode ==
+					Http::StatusCode::SWITCHING_PROTOCOLS) {
+					this->resetStream(
+						id, ErrorCode::HTTP_1_1_REQUIRED);
+					return;
+				}
+
+				res.version = Http::Version::_2_0;
+				res.ppEstimateContentLength(true);
+				res.ppDefaultContentType();
+				this->encoder.encode(
+					this->sendBlock,
+					":status",
+					static_cast<std::string>(res.statusCode));
+				for (auto const &[name, value] : res.headers) {
+					if (!WorkerSocketSpec::isConnectionSpecific(
+								name)) {
+						this->encoder.encode(
+							this->sendBlock, name, value);
+					}
+				}
+
+				// In-memory bodies are sent from in place.
+				stream.bodyStreamBuf = res.body.rdbuf();
+				std::stringbuf *bodyStringBuf{
+					dynamic_cast<std::stringbuf *>(
+						stream.bodyStreamBuf)};
+				if (bodyStringBuf != nullptr) {
+					stream.bodyView = bodyStringBuf->view();
+					stream.bodyView.remove_prefix(
+						stream.bodyView.size() -
+						static_cast<std::size_t>(std::max(
+							std::streamsize(0), res.body.inAvail())));
+					stream.bodyStreamBuf = nullptr;
+				}
+			} else {
+				this->resetStream(id, ErrorCode::CANCEL);
+				return;
+			}
+
+			bool const isEndStream{
+				isHead ||
+				(stream.bodyStreamBuf == nullptr &&
+					stream.bodyView.empty())};
+			this->sendHeaders(id, this->sendBlock, isEndStream);
+			if (isEndStream) {
+				this->streams.erase(id);
+			} else {
+				this->queue(id, stream);
+			}
+		}
+
+		// Sends DATA frames, round-robin across queued streams,
+		// while the connection window allows.
+		void pump() {
+			while (
+				this->sendWindow > 0 && !this->sendQueue.empty()) {
+				std::uint32_t const id{this->sendQueue.front()};
+				this->sendQueue.pop_front();
+				auto const it{this->streams.find(id)};
+				if (it == this->streams.end()) {
+					continue;
+				}
+				Stream &stream{it->second};
+				stream.isQueued = false;
+				if (stream.sendWindow <= 0) {
+					continue;
+				}
+
+				std::size_t const len{
+					static_cast<std::size_t>(std::min<std::int64_t>(
+						{this->sendWindow,
+							stream.sendWindow,
+							this->remoteSettings.maxFrameSize}))};
+				std::string_view data;
+				bool isEnd;
+				if (stream.bodyStreamBuf == nullptr) {
+					data = stream.bodyView.substr(0, len);
+					stream.bodyView.remove_prefix(data.size());
+					isEnd = stream.bodyView.empty();
+				} else {
+					this->dataBuffer.resize(len);
+					data = std::string_view(
+						this->dataBuffer.data(),
+						static_cast<std::size_t>(std::max(
+							std::streamsize(0),
+							stream.bodyStreamBuf->sgetn(
+								this->dataBuffer.data(),
+								static_cast<std::streamsize>(len)))));
+					isEnd = data.size() < len ||
+						std::streambuf::traits_type::eq_int_type(
+							stream.bodyStreamBuf->sgetc(),
+							std::streambuf::traits_type::eof());
+				}
+
+				// Trailers follow the body, and end the stream.
+				bool const hasTrailers{
+					isEnd && stream.response &&
+					!stream.response->trailers.empty()};
+				this->sendFrame(
+					FrameType::DATA,
+					isEnd && !hasTrailers ? FrameHead::END_STREAM
+																: std::uint8_t{0},
+					id,
+					data);
+				this->sendWindow -=
+					static_cast<std::int64_t>(data.size());
+				stream.sendWindow -=
+					static_cast<std::int64_t>(data.size());
+				if (hasTrailers) {
+					this->sendBlock.clear();
+					for (auto const &[name, value] :
+							 stream.response->trailers) {
+						this->encoder.encode(
+							this->sendBlock, name, value);
+					}
+					this->sendHeaders(id, this->sendBlock, true);
+				}
+				if (isEnd) {
+					this->streams.erase(it);
+				} else {
+					this->queue(id, stream);
+				}
+			}
+		}
+
+		Stream &open(std::uint32_t id) {
+			Stream &stream{this->streams[id]};
+			stream.sendWindow =
+				this->remoteSettings.initialWindowSize;
+			stream.recvWindow = this->streamWindowSize;
+			this->lastStreamId = id;
+			return stream;
+		}
+
+		// Queues a responding stream, if it is not queued and
+		// has window to send.
+		void queue(std::uint32_t id, Stream &stream) {
+			if (
+				stream.isResponding && !stream.isQueued &&
+				stream.sendWindow > 0 &&
+				(stream.bodyStreamBuf != nullptr ||
+					!stream.bodyView.empty())) {
+				this->sendQueue.push_back(id);
+				stream.isQueued = true;
+			}
+		}
+
+		void resetStream(std::uint32_t id, ErrorCode errorCode) {
+			this->sendRstStream(id, errorCode);
+			this->erase(id);
+		}
+
+		// Forgets a stream before it ends. A dispatched stream
+		// is cancelled instead, until its filters return.
+		void erase(std::uint32_t id) {
+			auto const it{this->streams.find(id)};
+			if (it == this->streams.end()) {
+				return;
+			}
+			if (it->second.isDispatched) {
+				this->cCancelled++;
+			}
+			this->streams.erase(it);
+		}
+
+		// Whether a comma-separated header contains token,
+		// case-insensitively.
+		static bool hasToken(
+			Http::Headers const &headers,
+			std::string const &key,
+			std::string_view token) {
+			auto const [begin, end]{headers.equal_range(key)};
+			for (auto it{begin}; it != end; it++) {
+				std::string_view list{it->second};
+				while (!list.empty()) {
+					std::size_t const comma{
+						std::min(list.find(','), list.size())};
+					std::string_view const item{
+						String::trimWhitespace(list.substr(0, comma))};
+					if (WorkerSocketSpec::isCaseAgnosticEqual(
+								item, token)) {
+						return true;
+					}
+					list.remove_prefix(
+						std::min(comma + 1, list.size()));
+				}
+			}
+			return false;
+		}
+	};
+
+	// Shorthand, but importantly names *SocketSpec, which is
+	// consistent across each layer, and overwritten by the
+	// next protocol layer, useful for deducing types on the
+	// previous layer (e.g. for TLS).
+	template<
+		typename RequestMessageSpec = Http::Request,
+		typename ResponseMessageSpec = Http::Response,
+		typename SocketFamilyInterface = Ipv4FamilyInterface,
+		template<typename> class... SocketOptions>
+	class Worker :
+		public WorkerSocketSpec<
+			RequestMessageSpec,
+			ResponseMessageSpec,
+			Http::Worker<
+				RequestMessageSpec,
+				ResponseMessageSpec,
+				SocketFamilyInterface,
+				SocketOptions...>> {
+		public:
+		using WorkerSocketSpec = WorkerSocketSpec<
+			RequestMessageSpec,
+			ResponseMessageSpec,
+			Http::Worker<
+				RequestMessageSpec,
+				ResponseMessageSpec,
+				SocketFamilyInterface,
+				SocketOptions...>>;
+		using WorkerSocketSpec::WorkerSocketSpec;
+	};
+}
@@ -0,0 +1,238 @@
+// Fixed-memory table of per-peer rate limits, keyed by
+// binary address.
+#pragma once
+
+#include "resolve.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <vector>
+
+namespace Rain::Networking {
+	// Fixed-memory table of per-peer rate limits, keyed by
+	// binary address. Each peer may be admitted at most
+	// `threshold` times per sliding `window`.
+	//
+	// Windows are approximated by a sliding window counter:
+	// the count in the current fixed window, plus the count
+	// in the previous one weighted by how much of it still
+	// overlaps the sliding window. Checks are O(1).
+	//
+	// The table is set-associative, with a fixed number of
+	// entries allocated on construction. Entries whose
+	// windows have both passed are free for reuse. If a set
+	// is full, the entry with the smallest count is evicted,
+	// so that a flood of distinct peers forgets the least
+	// active ones first. Memory thus stays flat regardless of
+	// the number of distinct peers.
+	//
+	// Sets are locked in stripes, so that concurrent checks
+	// rarely contend. RateLimiter is thread-safe.
+	class RateLimiter {
+		public:
+		// IPv4 addresses are stored as IPv4-mapped IPv6
+		// addresses, so that peers on dual-stack Sockets share
+		// keys across families. Ports are ignored.
+		using Key = std::array<unsigned char, 16>;
+
+		static Key keyOf(
+			sockaddr_storage const &address,
+			socklen_t) noexcept {
+			Key key{};
+			if (address.ss_family == AF_INET6) {
+				sockaddr_in6 addressIn6;
+				std::memcpy(
+					&addressIn6, &address, sizeof(addressIn6));
+				std::memcpy(
+					key.data(), &addressIn6.sin6_addr, key.size());
+			} else if (address.ss_family == AF_INET) {
+				sockaddr_in addressIn;
+				std::memcpy(&addressIn, &address, sizeof(addressIn));
+				key[10] = key[11] = 0xff;
+				std::memcpy(
+					key.data() + 12, &addressIn.sin_addr, 4);
+			}
+			return key;
+		}
+		static Key keyOf(
+			AddressInfo const &addressInfo) noexcept {
+			return RateLimiter::keyOf(
+				addressInfo.address, addressInfo.addressLen);
+		}
+
+		private:
+		using Clock = std::chrono::steady_clock;
+
+		// Entries per set, which are searched linearly.
+		static inline std::size_t const SET_SIZE{8};
+
+		// Sets share STRIPES_MAX locks at most, round-robin.
+		static inline std::size_t const STRIPES_MAX{256};
+
+		struct Entry {
+			Key key;
+
+			// Index of the current fixed window since the Clock
+			// epoch. Zero if the entry has never been used.
+			std::int64_t windowIdx;
+			std::uint32_t cCurrent, cPrevious;
+		};
+
+		// Stripes are padded to avoid false sharing.
+		struct alignas(64) Stripe {
+			std::mutex mtx;
+		};
+
+		std::size_t const threshold;
+		Clock::duration const window;
+
+		std::size_t const cSets, cStripes;
+		std::vector<Entry> entries;
+		std::unique_ptr<Stripe[]> stripes;
+
+		// Randomizes set assignment, so that peers cannot
+		// choose addresses which collide on purpose.
+		std::uint64_t const seed;
+
+		public:
+		// capacity is rounded up to a multiple of SET_SIZE.
+		RateLimiter(
+			std::size_t threshold,
+			Clock::duration window,
+			std::size_t capacity = 1_zu << 16) :
+			threshold(threshold),
+			window(window),
+			cSets(std::max(
+				1_zu,
+				(capacity + RateLimiter::SET_SIZE - 1) /
+					RateLimiter::SET_SIZE)),
+			cStripes(
+				std::min(this->cSets, RateLimiter::STRIPES_MAX)),
+			entries(this->cSets * RateLimiter::SET_SIZE, Entry{}),
+			stripes(new Stripe[this->cStripes]),
+			seed(
+				(static_cast<std::uint64_t>(std::random_device()())
+				 << 32) ^
+				std::random_device()()) {}
+
+		// Forbid copy/move.
+		RateLimiter(RateLimiter const &) = delete;
+		RateLimiter &operator=(RateLimiter const &) = delete;
+		RateLimiter(RateLimiter &&) = delete;
+		RateLimiter &operator=(RateLimiter &&) = delete;
+
+		// Number of peers which may be tracked at once.
+		std::size_t capacity() const noexcept {
+			return this->entries.size();
+		}
+
+		// Returns true if the peer has been admitted
+		// `threshold` times within the sliding window.
+		// Otherwise, admits the peer and returns false.
+		bool shouldReject(
+			Key const &key,
+			Clock::time_point now = Clock::now()) {
+			// Window indices start at 1 so that 0 marks unused
+			// entries.
+			std::int64_t const windowIdx{
+				now.time_since_epoch() / this->window + 1};
+			double const overlap{
+				1 -
+				static_cast<double>(
+					(now.time_since_epoch() % this->window).count()) /
+					static_cast<double>(this->window.count())};
+
+			std::size_t const setIdx{
+				this->hash(key) % this->cSets};
+			Entry *const set{
+				&this->entries[setIdx * RateLimiter::SET_SIZE]};
+			std::lock_guard lck(
+				this->stripes[setIdx % this->cStripes].mtx);
+
+			// Find the entry for key, or the free or least
+			// active entry to replace.
+			Entry *entry{nullptr}, *victim{nullptr};
+			double victimEstimate{0};
+			for (std::size_t idx{0}; idx < RateLimiter::SET_SIZE;
+					 idx++) {
+				RateLimiter::advance(set[idx], windowIdx);
+				double const estimate{
+					RateLimiter::estimate(set[idx], overlap)};
+				if (set[idx].windowIdx != 0 && set[idx].key == key) {
+					entry = &set[idx];
+					break;
+				}
+				if (victim == nullptr || estimate < victimEstimate) {
+					victim = &set[idx];
+					victimEstimate = estimate;
+				}
+			}
+			if (entry == nullptr) {
+				entry = victim;
+				*entry = {key, windowIdx, 0, 0};
+			}
+
+			if (
+				RateLimiter::estimate(*entry, overlap) >=
+				static_cast<double>(this->threshold)) {
+				return true;
+			}
+			entry->cCurrent++;
+			return false;
+		}
+		bool shouldReject(
+			AddressInfo const &addressInfo,
+			Clock::time_point now = Clock::now()) {
+			return this->shouldReject(
+				RateLimiter::keyOf(addressInfo), now);
+		}
+
+		private:
+		// Rolls an entry's counts forward to windowIdx. Entries
+		// with both windows passed become free, with zero
+		// counts.
+		static void advance(
+			Entry &entry,
+			std::int64_t windowIdx) noexcept {
+			if (
+				entry.windowIdx == 0 ||
+				entry.windowIdx == windowIdx) {
+				return;
+			}
+			entry.cPrevious = entry.windowIdx + 1 == windowIdx
+				? entry.cCurrent
+				: 0;
+			entry.cCurrent = 0;
+			entry.windowIdx = entry.cPrevious == 0 ? 0 : windowIdx;
+		}
+
+		// Admissions within the sliding window, given the
+		// fraction of the previous window which overlaps it.
+		static double estimate(
+			Entry const &entry,
+			double overlap) noexcept {
+			return entry.cCurrent + entry.cPrevious * overlap;
+		}
+
+		std::uint64_t hash(Key const &key) const noexcept {
+			std::uint64_t halves[2];
+			std::memcpy(halves, key.data(), sizeof(halves));
+			return RateLimiter::mix(
+				RateLimiter::mix(halves[0] ^ this->seed) ^
+				halves[1]);
+		}
+
+		// splitmix64 finalizer.
+		static std::uint64_t mix(std::uint64_t x) noexcept {
+			x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+			return x ^ (x >> 31);
+		}
+	};
+}
@@ -0,0 +1,577 @@
+// Reactor multiplexes readiness of many non-blocking
+// Sockets onto a single event loop.
+#pragma once
+
+#include "../error/consume_throwable.hpp"
+#include "../platform.hpp"
+#include "../time/timeout.hpp"
+#include "../time/timer_wheel.hpp"
+#include "exception.hpp"
+#include "native_socket.hpp"
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#ifdef RAIN_PLATFORM_LINUX
+	#include <sys/epoll.h>
+	#include <sys/eventfd.h>
+#endif
+
+namespace Rain::Networking {
+	// Reactor multiplexes readiness of many non-blocking
+	// Sockets onto a single event loop, which is run by `run`
+	// on a thread of the caller's choosing.
+	//
+	// Interest is one-shot: the first time an armed Socket
+	// becomes ready, its Registration (and ownership of it)
+	// is handed back to the caller, which must re-arm it to
+	// be notified again. Registrations which are not ready
+	// before their timeout are destroyed by the Reactor.
+	//
+	// Coroutines may instead await readiness with `ready`,
+	// and are resumed on the event loop.
+	//
+	// Timeouts are kept on a Time::TimerWheel, which the
+	// event loop advances each time it wakes. Reactors may
+	// share a TimerWheel, whose timers then fire on whichever
+	// of their event loops wakes first. Other timers, such as
+	// deadlines on Workers, may be scheduled with `schedule`.
+	//
+	// On Linux, readiness is tracked with epoll. Elsewhere,
+	// the Reactor falls back to poll over all armed Sockets
+	// on every iteration, which is O(N).
+	//
+	// Reactor is thread-safe.
+	class Reactor {
+		public:
+		// Readiness of interest to a Registration.
+		enum class Interest { READ, WRITE };
+
+		// A single interest on a NativeSocket. The NativeSocket
+		// must remain open for the lifetime of the
+		// Registration, and is usually owned by the subclass.
+		class Registration {
+			friend Reactor;
+
+			private:
+			NativeSocket const nativeSocket;
+			Interest const interest;
+
+			// Whether nativeSocket has been added to the epoll
+			// interest list already, in which case re-arming only
+			// modifies it.
+			bool added;
+
+			public:
+			Registration(
+				NativeSocket nativeSocket,
+				Interest interest = Interest::READ) noexcept :
+				nativeSocket(nativeSocket),
+				interest(interest),
+				added(false) {}
+			virtual ~Registration() = default;
+
+			// Forbid copy/move.
+			Registration(Registration const &) = delete;
+			Registration &operator=(Registration const &) = delete;
+			Registration(Registration &&) = delete;
+			Registration &operator=(Registration &&) = delete;
+
+			private:
+			// Called on the event loop thread when the
+			// NativeSocket becomes ready (or hangs up), with
+			// ownership of this Registration. Should return
+			// quickly, and should not throw.
+			virtual void onReady(
+				std::unique_ptr<Registration> &&self) = 0;
+		};
+
+		private:
+		// Maximum number of events handled per loop iteration.
+		static std::size_t const EVENTS_PER_WAIT{256};
+
+#ifndef RAIN_PLATFORM_LINUX
+		// Without a wake-up mechanism, the poll fallback must
+		// periodically pick up newly armed Registrations.
+		static std::chrono::steady_clock::
+			duration constexpr POLL_FALLBACK_TICK{
+				std::chrono::milliseconds(50)};
+#endif
+
+		// The event loop exits once this becomes readable.
+		NativeSocket const interrupter;
+
+		// TimerWheel for timeouts, owned if not shared.
+		std::unique_ptr<Time::TimerWheel> const ownTimerWheel;
+		Time::TimerWheel &timerWheel;
+
+		// An armed Registration, and its timeout on the
+		// TimerWheel. Arms are numbered, so that a timeout
+		// which fires after its Registration is re-armed at the
+		// same address is ignored.
+		struct Armed {
+			std::unique_ptr<Registration> registration;
+			std::uint64_t arm;
+			Time::TimerWheel::Id timer;
+		};
+
+		// Locked by mtx.
+		std::unordered_map<Registration *, Armed> armed;
+		std::uint64_t cArms{0};
+		bool stopped;
+
+		// The event loop wakes by this Timeout, if not sooner.
+		Time::Timeout waitTimeout;
+		mutable std::mutex mtx;
+
+#ifdef RAIN_PLATFORM_LINUX
+		// The eventfd wakes the event loop when a timer is
+		// scheduled before waitTimeout.
+		int epollFd, wakeFd;
+#endif
+
+		public:
+		// Timeouts are kept on timerWheel if given, which must
+		// outlive the Reactor, and on a TimerWheel owned by the
+		// Reactor otherwise.
+		Reactor(
+			NativeSocket interrupter,
+			Time::TimerWheel *timerWheel = nullptr) :
+			interrupter(interrupter),
+			ownTimerWheel(
+				timerWheel == nullptr ? new Time::TimerWheel
+															: nullptr),
+			timerWheel(
+				timerWheel == nullptr ? *this->ownTimerWheel
+															: *timerWheel),
+			stopped(false) {
+#ifdef RAIN_PLATFORM_LINUX
+			this->epollFd = validateSystemCall(
+				epoll_create1(EPOLL_CLOEXEC));
+			this->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+			if (this->wakeFd == -1) {
+				::close(this->epollFd);
+				throw Exception(getSystemError());
+			}
+
+			// The interrupter and wakeFd are level-triggered and
+			// identified by nullptr and this, respectively.
+			epoll_event event{};
+			event.events = EPOLLIN;
+			event.data.ptr = nullptr;
+			int interrupterResult{epoll_ctl(
+				this->epollFd,
+				EPOLL_CTL_ADD,
+				this->interrupter,
+				&event)};
+			event.data.ptr = this;
+			if (
+				interrupterResult == -1 ||
+				epoll_ctl(
+					this->epollFd,
+					EPOLL_CTL_ADD,
+					this->wakeFd,
+					&event) == -1) {
+				Error error{getSystemError()};
+				::close(this->wakeFd);
+				::close(this->epollFd);
+				throw Exception(error);
+			}
+#endif
+		}
+		~Reactor() {
+			// Registrations still armed are destroyed (and their
+			// Sockets closed) here as well, once their timeouts
+			// are cancelled. Coroutines resumed by their
+			// destruction may no longer arm.
+			decltype(this->armed) armed;
+			{
+				std::lock_guard lck(this->mtx);
+				this->stopped = true;
+				armed.swap(this->armed);
+			}
+			for (auto &entry : armed) {
+				this->timerWheel.cancel(entry.second.timer);
+			}
+			armed.clear();
+#ifdef RAIN_PLATFORM_LINUX
+			::close(this->wakeFd);
+			::close(this->epollFd);
+#endif
+		}
+
+		// Forbid copy/move.
+		Reactor(Reactor const &) = delete;
+		Reactor &operator=(Reactor const &) = delete;
+		Reactor(Reactor &&) = delete;
+		Reactor &operator=(Reactor &&) = delete;
+
+		// Number of Registrations currently armed.
+		std::size_t size() const noexcept {
+			std::lock_guard lck(this->mtx);
+			return this->armed.size();
+		}
+
+		// Transfers ownership of a Registration to the Reactor
+		// until its NativeSocket becomes ready, or until the
+		// timeout, at which point it is destroyed. If the
+		// Reactor has stopped, the Registration is destroyed
+		// immediately.
+		void arm(
+			std::unique_ptr<Registration> &&registration,
+			Time::Timeout timeout = {}) {
+			std::unique_lock lck(this->mtx);
+			if (this->stopped) {
+				lck.unlock();
+				registration.reset();
+				return;
+			}
+
+			Registration *key{registration.get()};
+			std::uint64_t const arm{++this->cArms};
+			Armed &armed{this->armed[key]};
+			armed.registration = std::move(registration);
+			armed.arm = arm;
+
+#ifdef RAIN_PLATFORM_LINUX
+			// Entries must be in `armed` before epoll may report
+			// them, but the event loop cannot look them up until
+			// mtx is released.
+			//
+			// A NativeSocket may already have been added by an
+			// earlier Registration which became ready, as with
+			// those of `ready`.
+			epoll_event event{};
+			event.events = EPOLLONESHOT |
+				(key->interest == Interest::READ
+						? EPOLLIN | EPOLLRDHUP
+						: EPOLLOUT);
+			event.data.ptr = key;
+			int result{epoll_ctl(
+				this->epollFd,
+				key->added ? EPOLL_CTL_MOD : EPOLL_CTL_ADD,
+				key->nativeSocket,
+				&event)};
+			if (result == -1 && !key->added && errno == EEXIST) {
+				result = epoll_ctl(
+					this->epollFd,
+					EPOLL_CTL_MOD,
+					key->nativeSocket,
+					&event);
+			}
+			if (result == -1) {
+				Error error{getSystemError()};
+				std::unique_ptr<Registration> failed{
+					std::move(armed.registration)};
+				this->armed.erase(key);
+				lck.unlock();
+				throw Exception(error);
+			}
+			key->added = true;
+#endif
+
+			// The timeout is scheduled once the arm can no longer
+			// fail, so that it is never cancelled with mtx held.
+			armed.timer =
+				this->scheduleLocked(timeout, [this, key, arm]() {
+					this->expire(key, arm);
+				});
+		}
+
+		// Schedules callback on the TimerWheel, to be run on an
+		// event loop once timeout passes, unless cancelled
+		// first. Callbacks should return quickly.
+		Time::TimerWheel::Id schedule(
+			Time::Timeout timeout,
+			Time::TimerWheel::Callback &&callback) {
+			std::lock_guard lck(this->mtx);
+			return this->scheduleLocked(
+				timeout, std::move(callback));
+		}
+
+		// Cancels a timer from `schedule`, and waits for its
+		// callback if it is running. Returns true if it had yet
+		// to fire.
+		bool cancel(Time::TimerWheel::Id id) {
+			return this->timerWheel.cancel(id);
+		}
+
+		// Awaitable returned by `ready`.
+		class Ready {
+			friend Reactor;
+
+			private:
+			// Resumes the awaiting coroutine on destruction,
+			// whether the NativeSocket became ready, timed out,
+			// or the Reactor stopped.
+			class ResumeRegistration : public Registration {
+				private:
+				Ready &ready;
+
+				public:
+				ResumeRegistration(Ready &ready) noexcept :
+					Registration(ready.nativeSocket, ready.interest),
+					ready(ready) {}
+				virtual ~ResumeRegistration() {
+					if (
+						this->ready.state.exchange(State::RESUMED) ==
+						State::SUSPENDED) {
+						this->ready.handle.resume();
+					}
+				}
+
+				private:
+				virtual void onReady(
+					std::unique_ptr<Registration> &&self) override {
+					this->ready.isReady = true;
+					self.reset();
+				}
+			};
+
+			// The Registration may be destroyed on another thread
+			// before `await_suspend` returns, in which case the
+			// coroutine continues without suspending.
+			enum class State { SUSPENDING, SUSPENDED, RESUMED };
+
+			Reactor &reactor;
+			NativeSocket const nativeSocket;
+			Interest const interest;
+			Time::Timeout const timeout;
+			std::coroutine_handle<> handle;
+			bool isReady{false};
+			std::atomic<State> state{State::SUSPENDING};
+
+			Ready(
+				Reactor &reactor,
+				NativeSocket nativeSocket,
+				Interest interest,
+				Time::Timeout timeout) noexcept :
+				reactor(reactor),
+				nativeSocket(nativeSocket),
+				interest(interest),
+				timeout(timeout) {}
+
+			public:
+			bool await_ready() const noexcept { return false; }
+			bool await_suspend(std::coroutine_handle<> handle) {
+				this->handle = handle;
+				this->reactor.arm(
+					std::unique_ptr<Registration>(
+						new ResumeRegistration(*this)),
+					this->timeout);
+				State expected{State::SUSPENDING};
+				return this->state.compare_exchange_strong(
+					expected, State::SUSPENDED);
+			}
+			bool await_resume() const noexcept {
+				return this->isReady;
+			}
+		};
+
+		// Suspends the awaiting coroutine until nativeSocket is
+		// ready for interest, and resumes it on the event loop.
+		// Resumes with true if ready, and false on timeout or
+		// once the Reactor stops.
+		Ready ready(
+			NativeSocket nativeSocket,
+			Interest interest,
+			Time::Timeout timeout = {}) noexcept {
+			return {*this, nativeSocket, interest, timeout};
+		}
+
+		// Runs the event loop until the interrupter becomes
+		// readable. All armed Registrations are destroyed
+		// before returning, and any later arms destroy their
+		// Registrations immediately.
+		void run() {
+			std::vector<std::unique_ptr<Registration>> ready,
+				expired;
+			std::vector<Time::TimerWheel::Id> timers;
+			bool interrupted{false};
+
+#ifdef RAIN_PLATFORM_LINUX
+			std::vector<epoll_event> events(
+				Reactor::EVENTS_PER_WAIT);
+#else
+			std::vector<pollfd> fds;
+			std::vector<Registration *> polled;
+#endif
+
+			while (!interrupted) {
+				// Timers scheduled from here on wake the event loop
+				// if they are due before waitTimeout.
+				Time::Timeout timeout;
+				{
+					std::lock_guard lck(this->mtx);
+					this->waitTimeout = this->timerWheel.nextTimeout();
+					timeout = this->waitTimeout;
+#ifndef RAIN_PLATFORM_LINUX
+					fds.clear();
+					polled.clear();
+					fds.push_back({this->interrupter, POLLRDNORM, 0});
+					polled.push_back(nullptr);
+					for (auto const &entry : this->armed) {
+						fds.push_back(
+							{entry.first->nativeSocket,
+								entry.first->interest == Interest::READ
+									? POLLRDNORM
+									: POLLWRNORM,
+								0});
+						polled.push_back(entry.first);
+					}
+#endif
+				}
+
+#ifdef RAIN_PLATFORM_LINUX
+				int cEvents{epoll_wait(
+					this->epollFd,
+					events.data(),
+					static_cast<int>(events.size()),
+					timeout.asInt())};
+				if (cEvents == -1) {
+					if (errno == EINTR) {
+						continue;
+					}
+					throw Exception(getSystemError());
+				}
+#else
+				timeout = std::min(
+					timeout,
+					Time::Timeout(Reactor::POLL_FALLBACK_TICK));
+	#ifdef RAIN_PLATFORM_WINDOWS
+				int cEvents{WSAPoll(
+	#else
+				int cEvents{::poll(
+	#endif
+					fds.data(),
+					static_cast<unsigned long>(fds.size()),
+					timeout.asInt())};
+				if (cEvents == NATIVE_SOCKET_ERROR) {
+					throw Exception(getSystemError());
+				}
+#endif
+
+				{
+					std::lock_guard lck(this->mtx);
+
+					// Take ownership of ready Registrations.
+					auto const take = [this, &ready, &timers](
+															Registration *key) {
+						auto it{this->armed.find(key)};
+						if (it == this->armed.end()) {
+							return;
+						}
+						ready.push_back(
+							std::move(it->second.registration));
+						timers.push_back(it->second.timer);
+						this->armed.erase(it);
+					};
+#ifdef RAIN_PLATFORM_LINUX
+					for (int idx{0}; idx < cEvents; idx++) {
+						if (events[idx].data.ptr == nullptr) {
+							interrupted = true;
+						} else if (events[idx].data.ptr == this) {
+							eventfd_t value;
+							eventfd_read(this->wakeFd, &value);
+						} else {
+							take(static_cast<Registration *>(
+								events[idx].data.ptr));
+						}
+					}
+#else
+					for (
+						std::size_t idx{0};
+						cEvents > 0 && idx < fds.size();
+						idx++) {
+						if (fds[idx].revents == 0) {
+							continue;
+						}
+						if (polled[idx] == nullptr) {
+							interrupted = true;
+						} else {
+							take(polled[idx]);
+						}
+					}
+#endif
+
+					if (interrupted) {
+						this->stopped = true;
+						for (auto &entry : this->armed) {
+							expired.push_back(
+								std::move(entry.second.registration));
+							timers.push_back(entry.second.timer);
+						}
+						this->armed.clear();
+					}
+				}
+
+				// Timeouts are cancelled, expired Registrations
+				// destroyed, and ready ones handed off outside of
+				// the lock, since timeouts take the lock, and the
+				// rest may be expensive or re-arm.
+				for (Time::TimerWheel::Id timer : timers) {
+					this->timerWheel.cancel(timer);
+				}
+				timers.clear();
+				expired.clear();
+				this->timerWheel.advance();
+				for (auto &registration : ready) {
+					Registration *key{registration.get()};
+					Rain::Error::consumeThrowable(
+						[key, &registration]() {
+							key->onReady(std::move(registration));
+						},
+						std::source_location::current())();
+				}
+				ready.clear();
+			}
+		}
+
+		private:
+		// Must hold mtx.
+		Time::TimerWheel::Id scheduleLocked(
+			Time::Timeout timeout,
+			Time::TimerWheel::Callback &&callback) {
+			Time::TimerWheel::Id const id{
+				this->timerWheel.schedule(
+					timeout, std::move(callback))};
+			if (timeout < this->waitTimeout) {
+				this->waitTimeout = timeout;
+#ifdef RAIN_PLATFORM_LINUX
+				// Failure here only delays the timer until the next
+				// event.
+				eventfd_write(this->wakeFd, 1);
+#endif
+			}
+			return id;
+		}
+
+		// Destroys a Registration whose timeout has fired, if
+		// it is still armed from the same arm.
+		void expire(Registration *key, std::uint64_t arm) {
+			std::unique_ptr<Registration> expired;
+			std::lock_guard lck(this->mtx);
+			auto it{this->armed.find(key)};
+			if (it == this->armed.end() || it->second.arm != arm) {
+				return;
+			}
+			expired = std::move(it->second.registration);
+			this->armed.erase(it);
+
+#ifdef RAIN_PLATFORM_LINUX
+			// The NativeSocket may outlive the Registration, and
+			// must not report it once destroyed.
+			epoll_ctl(
+				this->epollFd,
+				EPOLL_CTL_DEL,
+				key->nativeSocket,
+				nullptr);
+#endif
+		}
+	};
+}
@@ -2,6 +2,8 @@
 #pragma once
 
 #include "req_res/client.hpp"
+#include "req_res/client_pool.hpp"
+#include "req_res/co_worker.hpp"
 #include "req_res/message.hpp"
 #include "req_res/request.hpp"
 #include "req_res/response.hpp"
@@ -0,0 +1,313 @@
+// Thread-safe pool of idle keep-alive R/R Clients, keyed by
+// Host.
+#pragma once
+
+#include "client.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Rain::Networking::ReqRes {
+	// Thread-safe pool of idle keep-alive R/R Clients, keyed
+	// by Host. Reusing a Client skips both the lookup and the
+	// connect round-trip of a new one.
+	//
+	// Clients are leased with `acquire`, and returned to the
+	// pool when their Lease is destroyed, unless they are no
+	// longer good, or hold unread bytes. A Client which must
+	// not be reused (e.g. after a `Connection: close`) should
+	// be `discard`ed.
+	//
+	// Idle Clients are closed after idleTimeout, lazily on
+	// later calls, or eagerly with `prune`. Before reuse,
+	// Clients are polled once without waiting, and closed if
+	// the peer has hung up or sent unsolicited bytes. A peer
+	// may still close a Client between the poll and the next
+	// send, so callers should retry requests once on
+	// `Lease::isReused` Clients, if the request is
+	// idempotent.
+	//
+	// At most maxPerHost Clients, leased or idle, are open to
+	// each Host. `acquire` blocks until one is returned once
+	// the cap is reached.
+	//
+	// The pool must outlive its Leases.
+	template<typename Client>
+	class ClientPool {
+		public:
+		// A Client leased from the pool, returned to it on
+		// destruction.
+		class Lease {
+			friend ClientPool;
+
+			private:
+			ClientPool *pool;
+			std::string key;
+			std::unique_ptr<Client> client;
+			bool reused;
+
+			Lease(
+				ClientPool *pool,
+				std::string const &key,
+				std::unique_ptr<Client> client,
+				bool reused) :
+				pool(pool),
+				key(key),
+				client(std::move(client)),
+				reused(reused) {}
+
+			public:
+			~Lease() { this->release(); }
+
+			// Move-only.
+			Lease(Lease const &) = delete;
+			Lease &operator=(Lease const &) = delete;
+			Lease(Lease &&) = default;
+			Lease &operator=(Lease &&other) {
+				this->release();
+				this->pool = other.pool;
+				this->key = std::move(other.key);
+				this->client = std::move(other.client);
+				this->reused = other.reused;
+				return *this;
+			}
+
+			Client &operator*() const { return *this->client; }
+			Client *operator->() const {
+				return this->client.get();
+			}
+
+			// Whether the Client was idle in the pool, rather
+			// than newly connected.
+			bool isReused() const noexcept { return this->reused; }
+
+			// Returns the Client to the pool early. The Lease is
+			// empty afterwards.
+			void release() {
+				if (this->client != nullptr) {
+					this->pool->release(
+						this->key, std::move(this->client));
+				}
+			}
+
+			// Closes the Client instead of returning it to the
+			// pool. The Lease is empty afterwards.
+			void discard() {
+				if (this->client != nullptr) {
+					this->client.reset();
+					this->pool->release(this->key, nullptr);
+				}
+			}
+		};
+
+		private:
+		using Clock = std::chrono::steady_clock;
+
+		struct IdleClient {
+			std::unique_ptr<Client> client;
+			Clock::time_point timeIdle;
+		};
+
+		// Clients of a single Host. Idle Clients are ordered
+		// by the time they became idle.
+		struct HostClients {
+			std::deque<IdleClient> idle;
+			std::size_t cOpen;
+		};
+
+		std::size_t const maxPerHost;
+		Clock::duration const idleTimeout;
+
+		// Entries are never erased, so that references to them
+		// remain valid while mtx is released.
+		std::unordered_map<std::string, HostClients> hosts;
+		std::mutex mtx;
+
+		// Signalled when a Client is returned or closed.
+		std::condition_variable ev;
+
+		public:
+		ClientPool(
+			std::size_t maxPerHost = 16,
+			Clock::duration idleTimeout = 10s) :
+			maxPerHost(maxPerHost),
+			idleTimeout(idleTimeout) {}
+		virtual ~ClientPool() = default;
+
+		// Forbid copy/move.
+		ClientPool(ClientPool const &) = delete;
+		ClientPool &operator=(ClientPool const &) = delete;
+		ClientPool(ClientPool &&) = delete;
+		ClientPool &operator=(ClientPool &&) = delete;
+
+		// Leases the most recently idle healthy Client to host,
+		// or connects a new one within timeout. Throws on
+		// connect failure, or if the cap is reached and no
+		// Client is returned within timeout.
+		Lease acquire(
+			Host const &host,
+			Time::Timeout timeout = 15s) {
+			std::string const key{ClientPool::keyOf(host)};
+
+			// Expired Clients are closed without the lock.
+			std::vector<std::unique_ptr<Client>> closed;
+			std::unique_lock lck(this->mtx);
+			HostClients &hostClients{this->hosts[key]};
+			while (true) {
+				this->prune(hostClients, closed);
+				if (!hostClients.idle.empty()) {
+					// Reusing the most recently idle Client lets
+					// surplus Clients expire.
+					std::unique_ptr<Client> client{
+						std::move(hostClients.idle.back().client)};
+					hostClients.idle.pop_back();
+
+					// Health checks and closes are system calls, and
+					// made without the lock.
+					lck.unlock();
+					closed.clear();
+					if (ClientPool::isHealthy(*client)) {
+						return {this, key, std::move(client), true};
+					}
+					client.reset();
+					lck.lock();
+					hostClients.cOpen--;
+					this->ev.notify_all();
+					continue;
+				}
+				if (hostClients.cOpen < this->maxPerHost) {
+					break;
+				}
+
+				// A Client may be returned while expired Clients
+				// are closed, so the state is checked again before
+				// waiting.
+				if (!closed.empty()) {
+					lck.unlock();
+					closed.clear();
+					lck.lock();
+					continue;
+				}
+				if (timeout.isInfinite()) {
+					this->ev.wait(lck);
+				} else if (
+					this->ev.wait_until(
+						lck, timeout.asTimepoint()) ==
+					std::cv_status::timeout) {
+					throw Exception(Error::TIMED_OUT);
+				}
+			}
+
+			// Reserve a slot for the new Client while connecting
+			// without the lock.
+			hostClients.cOpen++;
+			lck.unlock();
+			closed.clear();
+			try {
+				return {
+					this, key, this->makeClient(host, timeout), false};
+			} catch (...) {
+				lck.lock();
+				hostClients.cOpen--;
+				this->ev.notify_all();
+				throw;
+			}
+		}
+
+		// Closes all Clients idle for idleTimeout.
+		void prune() {
+			std::vector<std::unique_ptr<Client>> closed;
+			std::lock_guard lck(this->mtx);
+			for (auto &[key, hostClients] : this->hosts) {
+				this->prune(hostClients, closed);
+			}
+		}
+
+		// Number of idle Clients across all Hosts.
+		std::size_t idle() {
+			std::lock_guard lck(this->mtx);
+			std::size_t cIdle{0};
+			for (auto const &[key, hostClients] : this->hosts) {
+				cIdle += hostClients.idle.size();
+			}
+			return cIdle;
+		}
+
+		protected:
+		// Connects a new Client. Override for Clients which
+		// need other constructor arguments.
+		virtual std::unique_ptr<Client> makeClient(
+			Host const &host,
+			Time::Timeout timeout) {
+			return std::make_unique<Client>(host, timeout);
+		}
+
+		private:
+		// Nodes are case-insensitive.
+		static std::string keyOf(Host const &host) {
+			Host hostLower{host};
+			String::toLower(hostLower.node);
+			return hostLower.asStr();
+		}
+
+		// A Client may be reused if its streams are good, it
+		// holds no unread bytes which would be mistaken for
+		// the next response, and its peer has not hung up.
+		static bool isHealthy(Client &client) {
+			try {
+				return client.good() &&
+					client.rdbuf()->in_avail() == 0 &&
+					!client.isReadPending();
+			} catch (...) {
+				return false;
+			}
+		}
+
+		// Moves Clients idle for idleTimeout to closed, to be
+		// closed once mtx is released, and wakes those waiting
+		// for the slots they free.
+		void prune(
+			HostClients &hostClients,
+			std::vector<std::unique_ptr<Client>> &closed) {
+			auto const now{Clock::now()};
+			while (
+				!hostClients.idle.empty() &&
+				now - hostClients.idle.front().timeIdle >=
+					this->idleTimeout) {
+				closed.push_back(
+					std::move(hostClients.idle.front().client));
+				hostClients.idle.pop_front();
+				hostClients.cOpen--;
+				this->ev.notify_all();
+			}
+		}
+
+		// Returns a Client from a Lease. nullptr if the Client
+		// was discarded.
+		void release(
+			std::string const &key,
+			std::unique_ptr<Client> client) {
+			if (
+				client != nullptr &&
+				(!client->good() ||
+					client->rdbuf()->in_avail() != 0)) {
+				client.reset();
+			}
+			std::lock_guard lck(this->mtx);
+			HostClients &hostClients{this->hosts[key]};
+			if (client == nullptr) {
+				hostClients.cOpen--;
+			} else {
+				hostClients.idle.push_back(
+					{std::move(client), Clock::now()});
+			}
+			this->ev.notify_all();
+		}
+	};
+}
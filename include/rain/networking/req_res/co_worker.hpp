@@ -0,0 +1,214 @@
+// Coroutine Worker specialization for R/R protocol Sockets.
+#pragma once
+
+#include "worker.hpp"
+
+#include <optional>
+#include <string_view>
+
+namespace Rain::Networking::ReqRes {
+	// Coroutine variant of the R/R Worker, whose requests are
+	// handled by the coroutine onCoRequest, so that handlers
+	// may await other Sockets in straight-line code.
+	//
+	// In reactor mode, each request is awaited on the Reactor
+	// of the Worker without holding a thread, until its head
+	// is buffered (see isRequestBuffered). It is then
+	// received and handled on the event loop, so handlers
+	// should await, rather than block on, anything slow.
+	// Responses are sent synchronously, which only blocks
+	// once the kernel send buffer is full.
+	//
+	// Only the head is awaited. The rest of a request, such
+	// as a body not buffered with its head, is received
+	// synchronously, which blocks the event loop and every
+	// Worker on it until it arrives or the recv timeout
+	// passes. Protocols whose requests carry large bodies
+	// should have isRequestBuffered wait for them too, or
+	// run in thread mode.
+	//
+	// onWorkIdle is called before each wait for a request.
+	// The idle timeout bounds each wait for a request, and
+	// for each further part of its head. Head and request
+	// deadlines begin with the first byte of a request, as
+	// with the R/R Worker, but the head deadline is enforced
+	// by the wait itself.
+	//
+	// In thread mode, CoWorkers run as R/R Workers do, and
+	// awaits on their own Socket block.
+	template<
+		typename RequestMessageSpec,
+		typename ResponseMessageSpec>
+	class CoWorkerSocketSpecInterface :
+		virtual public WorkerSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec> {
+		private:
+		// Types from a dependent superclass are not
+		// automatically injected.
+		using typename WorkerSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec>::Deadline;
+
+		protected:
+		// As with onRequest, but may await. Return false to
+		// listen to the next request, and true to close the
+		// connection.
+		virtual Task<bool> onCoRequest(
+			RequestMessageSpec &req) = 0;
+
+		private:
+		// Only used if the Server does not run onCoWork.
+		virtual bool onRequest(
+			RequestMessageSpec &req) final override {
+			return this->onCoRequest(req).get();
+		}
+
+		virtual Task<> onCoWork() final override {
+			try {
+				if (this->onInitialResponse()) {
+					co_return;
+				}
+			} catch (...) {
+				co_return;
+			}
+
+			auto time{
+				this->onWorkMetrics()
+					? std::chrono::steady_clock::now()
+					: std::chrono::steady_clock::time_point{}};
+			while (this->good()) {
+				bool toClose;
+				try {
+					toClose = co_await this->coRecvAndRespond(time);
+				} catch (...) {
+					Rain::Error::consumeThrowable(
+						[this]() { this->onRequestException(); },
+						std::source_location::current())();
+					break;
+				}
+				if (toClose) {
+					break;
+				}
+			}
+		}
+
+		// As with recvAndRespond, but awaits the request, and
+		// returns true to close once the connection is idle or
+		// closed.
+		Task<bool> coRecvAndRespond(
+			std::chrono::steady_clock::time_point &time) {
+			Tcp::PeekableStreamBuf *peekable{
+				dynamic_cast<Tcp::PeekableStreamBuf *>(
+					this->rdbuf())};
+			Reactor *reactor{this->reactor()};
+			std::optional<Deadline> requestDeadline;
+			std::optional<Time::Timeout> headDeadline;
+
+			// Without a peekable buffer, the request is received
+			// once readable, and waits for the rest.
+			if (peekable == nullptr) {
+				if (reactor != nullptr) {
+					this->onWorkIdle();
+				}
+				if (
+					reactor != nullptr &&
+					!co_await reactor->ready(
+						this->nativeSocket(),
+						Reactor::Interest::READ,
+						this->onWorkIdleTimeout())) {
+					co_return true;
+				}
+			}
+			while (
+				peekable != nullptr && !peekable->isFull() &&
+				(peekable->peek().empty() ||
+					!this->isRequestBuffered(peekable->peek()))) {
+				if (
+					!peekable->peek().empty() &&
+					!requestDeadline.has_value()) {
+					requestDeadline.emplace(
+						*this, this->onWorkRequestTimeout());
+					if (this->onWorkHeadTimeout() != 0ms) {
+						headDeadline = this->onWorkHeadTimeout();
+					}
+				}
+
+				// Without a Reactor, recvMore waits instead.
+				if (reactor != nullptr && peekable->peek().empty()) {
+					this->onWorkIdle();
+				}
+				if (
+					reactor != nullptr &&
+					!co_await reactor->ready(
+						this->nativeSocket(),
+						Reactor::Interest::READ,
+						headDeadline.value_or(
+							this->onWorkIdleTimeout()))) {
+					co_return true;
+				}
+				if (!peekable->recvMore()) {
+					co_return true;
+				}
+			}
+			if (!requestDeadline.has_value()) {
+				requestDeadline.emplace(
+					*this, this->onWorkRequestTimeout());
+			}
+
+			RequestMessageSpec req;
+			this->recv(req);
+			bool const isTimed{this->onWorkMetrics()};
+			std::chrono::steady_clock::time_point timeReceived;
+			if (isTimed) {
+				timeReceived = std::chrono::steady_clock::now();
+				this->recvMetric.record(timeReceived - time);
+			}
+			bool toClose{co_await this->onCoRequest(req)};
+			if (isTimed) {
+				time = std::chrono::steady_clock::now();
+				this->requestMetric.record(time - timeReceived);
+			}
+			co_return toClose;
+		}
+	};
+
+	// Coroutine Worker specialization for TCP protocol
+	// Sockets.
+	template<
+		typename RequestMessageSpec,
+		typename ResponseMessageSpec,
+		typename Socket>
+	class CoWorkerSocketSpec :
+		public Socket,
+		virtual public CoWorkerSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec> {
+		using Socket::Socket;
+	};
+
+	// Shorthand, as with Worker.
+	template<
+		typename RequestMessageSpec,
+		typename ResponseMessageSpec,
+		typename SocketFamilyInterface = Ipv4FamilyInterface,
+		template<typename> class... SocketOptions>
+	class CoWorker :
+		public CoWorkerSocketSpec<
+			RequestMessageSpec,
+			ResponseMessageSpec,
+			ConnectedSocketSpec<
+				NamedSocketSpec<SocketSpec<Tcp::Worker<
+					SocketFamilyInterface,
+					SocketOptions...>>>>> {
+		public:
+		using CoWorkerSocketSpec = CoWorkerSocketSpec<
+			RequestMessageSpec,
+			ResponseMessageSpec,
+			ConnectedSocketSpec<
+				NamedSocketSpec<SocketSpec<Tcp::Worker<
+					SocketFamilyInterface,
+					SocketOptions...>>>>>;
+		using CoWorkerSocketSpec::CoWorkerSocketSpec;
+	};
+}
@@ -1,13 +1,34 @@
 // Worker specialization for R/R protocol Sockets.
 #pragma once
 
+#include "../../metrics.hpp"
 #include "../tcp/worker.hpp"
 #include "socket.hpp"
 
+#include <string_view>
+
 namespace Rain::Networking::ReqRes {
 	class WorkerSocketSpecInterfaceInterface :
 		virtual public ConnectedSocketSpecInterface,
-		virtual public Tcp::WorkerSocketSpecInterface {};
+		virtual public Tcp::WorkerSocketSpecInterface {
+		public:
+		// Metrics across all R/R Workers. Receiving includes
+		// waiting for the request, and responding includes
+		// sending the response.
+		//
+		// These take clock reads on every request, and so are
+		// only recorded by Workers which opt in with
+		// onWorkMetrics.
+		static inline Metrics::Histogram recvMetric{
+			"rain_reqres_recv_seconds",
+			"Time to receive requests, including waiting."},
+			requestMetric{
+				"rain_reqres_request_seconds",
+				"Time from receiving a request until responded."},
+			sendMetric{
+				"rain_reqres_send_seconds",
+				"Time to send responses."};
+	};
 
 	// Worker specialization for TCP protocol Sockets.
 	//
@@ -37,7 +58,14 @@ namespace Rain::Networking::ReqRes {
 		// requests are changed by the send action (e.g.
 		// ephemeral HTTP bodies).
 		virtual void send(ResponseMessageSpec &res) {
+			if (!this->onWorkMetrics()) {
+				res.sendWith(*this);
+				return;
+			}
+			auto const timeBegin{std::chrono::steady_clock::now()};
 			res.sendWith(*this);
+			this->sendMetric.record(
+				std::chrono::steady_clock::now() - timeBegin);
 		}
 		virtual RequestMessageSpec &recv(
 			RequestMessageSpec &req) {
@@ -90,14 +118,17 @@ namespace Rain::Networking::ReqRes {
 				return;
 			}
 
+			auto time{
+				this->onWorkMetrics()
+					? std::chrono::steady_clock::now()
+					: std::chrono::steady_clock::time_point{}};
+			std::size_t cHeld{0};
 			while (this->good()) {
 				// onRequest returns false to keep the connection
 				// open, and true to abort it. Graceful closes
 				// should be handled in onRequest.
 				try {
-					RequestMessageSpec req;
-					this->recv(req);
-					if (this->onRequest(req)) {
+					if (this->recvAndRespond(time, cHeld)) {
 						break;
 					}
 				} catch (...) {
@@ -109,6 +140,115 @@ namespace Rain::Networking::ReqRes {
 			}
 		}
 
+		// Reactor mode processes the same R/R cycle as onWork,
+		// but only for as long as requests are already
+		// buffered, before returning the thread.
+		virtual bool onWorkBegin() final override {
+			try {
+				return this->onInitialResponse();
+			} catch (...) {
+				return true;
+			}
+		}
+		virtual bool onWorkReady() final override {
+			auto time{
+				this->onWorkMetrics()
+					? std::chrono::steady_clock::now()
+					: std::chrono::steady_clock::time_point{}};
+			std::size_t cHeld{0};
+			do {
+				try {
+					if (this->recvAndRespond(time, cHeld)) {
+						return true;
+					}
+				} catch (...) {
+					Rain::Error::consumeThrowable(
+						[this]() { this->onRequestException(); },
+						std::source_location::current())();
+					return true;
+				}
+			} while (this->good() && this->rdbuf()->in_avail() > 0);
+			return !this->good();
+		}
+
+		// A single R/R cycle, timed from `time`, which is then
+		// set to the end of the cycle, so that consecutive
+		// cycles share a clock read. Untimed unless
+		// onWorkMetrics. Returns the result of onRequest, and
+		// throws if recv throws.
+		//
+		// If the next request is already buffered behind this
+		// one (HTTP/1.1 pipelining, say), the response is held,
+		// and sent together with the response to the last such
+		// request, so that a batch of pipelined requests is
+		// answered in one send. cHeld counts the responses held
+		// so far, up to onWorkPipelineDepth.
+		bool recvAndRespond(
+			std::chrono::steady_clock::time_point &time,
+			std::size_t &cHeld) {
+			// Deadlines begin once the request begins, so that
+			// waiting for it is governed by the idle timeout.
+			std::chrono::milliseconds const headTimeout{
+				this->onWorkHeadTimeout()},
+				requestTimeout{this->onWorkRequestTimeout()};
+			if (headTimeout != 0ms || requestTimeout != 0ms) {
+				this->peek();
+			}
+			Deadline const requestDeadline(*this, requestTimeout);
+
+			RequestMessageSpec req;
+			{
+				Deadline const headDeadline(*this, headTimeout);
+				this->recv(req);
+			}
+			bool const isTimed{this->onWorkMetrics()};
+			std::chrono::steady_clock::time_point timeReceived;
+			if (isTimed) {
+				timeReceived = std::chrono::steady_clock::now();
+				this->recvMetric.record(timeReceived - time);
+			}
+
+			// The response is corked while the request is
+			// handled only if bytes past its head are already
+			// buffered, so that other responses are sent without
+			// a copy. It is then only held if the next request is
+			// buffered once the handler has consumed this one, so
+			// that the rest of a body is not taken for it.
+			Tcp::PeekableStreamBuf *peekable{
+				dynamic_cast<Tcp::PeekableStreamBuf *>(
+					this->rdbuf())};
+			bool const mayHold{
+				peekable != nullptr &&
+				cHeld + 1 < this->onWorkPipelineDepth() &&
+				!peekable->peek().empty()};
+			this->cork(mayHold);
+			bool toClose;
+			try {
+				toClose = this->onRequest(req);
+			} catch (...) {
+				// Whatever was sent before the throw still goes out.
+				this->cork(false);
+				Rain::Error::consumeThrowable(
+					[this]() { this->flush(); })();
+				throw;
+			}
+			if (
+				mayHold && !toClose && !peekable->peek().empty() &&
+				this->isRequestBuffered(peekable->peek())) {
+				cHeld++;
+			} else {
+				this->cork(false);
+				this->flush();
+				cHeld = 0;
+			}
+			if (isTimed) {
+				time = std::chrono::steady_clock::now();
+				this->requestMetric.record(time - timeReceived);
+			}
+			return toClose;
+		}
+
+		protected:
 		// Inheriting classes should implement onCycle, which is
 		// responsible for sending back a response if necessary.
 		// Return false to listen to next request, true to
@@ -131,6 +271,23 @@ namespace Rain::Networking::ReqRes {
 		// Possibly send a response before the first request,
 		// after connecting. Return true to abort.
 		virtual bool onInitialResponse() { return false; }
+
+		// Whether buffered begins with the head of a request,
+		// which may then be received without waiting. By
+		// default, any bytes suffice, which suits requests
+		// that are received in one piece.
+		virtual bool isRequestBuffered(
+			std::string_view buffered) {
+			return !buffered.empty();
+		}
+
+		// Most responses to pipelined requests which are held
+		// to be sent together. One disables holding.
+		virtual std::size_t onWorkPipelineDepth() { return 16; }
+
+		// Whether to record recvMetric, requestMetric, and
+		// sendMetric. Off by default.
+		virtual bool onWorkMetrics() { return false; }
 	};
 
 	// Worker specialization for TCP protocol Sockets.
@@ -0,0 +1,955 @@
+// Asynchronous, caching DNS stub resolver.
+#pragma once
+
+#include "../algorithm/lru.hpp"
+#include "../error/consume_throwable.hpp"
+#include "../literal.hpp"
+#include "../string/string.hpp"
+#include "exception.hpp"
+#include "host.hpp"
+#include "resolve.hpp"
+#include "socket.hpp"
+#include "waker.hpp"
+
+#ifdef RAIN_PLATFORM_WINDOWS
+
+	// GetNetworkParams for system nameservers.
+	#pragma comment(lib, "Iphlpapi.lib")
+
+#endif
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Rain::Networking {
+	// Asynchronous, caching DNS stub resolver. Queries are
+	// sent to nameservers over UDP, and responses are
+	// received on a single thread per Resolver, so that
+	// lookups never block any thread but those which wait on
+	// their results.
+	//
+	// Answers are cached for their TTL, up to MAX_TTL, in an
+	// LRU cache. Negative answers (no such name, or no
+	// records of the type) are cached for the TTL of the SOA
+	// record given with them (RFC 2308), or NEGATIVE_TTL if
+	// there is none. Concurrent lookups of the same name and
+	// type share a single query.
+	//
+	// Each attempt of a query goes to the next nameserver in
+	// turn, from a fresh UDP Socket on an ephemeral port, so
+	// that spoofed responses must guess the port as well as
+	// the query ID (RFC 5452). A query fails after
+	// attemptsMax attempts time out or fail. Truncated
+	// responses are used as-is, without retrying over TCP.
+	// Names are queried as given, without search domains.
+	//
+	// Resolver is thread-safe.
+	class Resolver {
+		public:
+		enum class RecordType : std::uint16_t {
+			A = 1,
+			CNAME = 5,
+			SOA = 6,
+			MX = 15,
+			AAAA = 28
+		};
+
+		// A resource record of the queried type. For A and AAAA
+		// records, data holds the address in network byte
+		// order. For MX records, data holds the exchange name,
+		// and preference its preference.
+		struct Record {
+			std::uint16_t preference;
+			std::string data;
+		};
+		using Records = std::vector<Record>;
+
+		// Bounds on how long answers are cached.
+		static inline std::chrono::seconds const MAX_TTL{3600},
+			NEGATIVE_TTL{30};
+
+		private:
+		using Clock = std::chrono::steady_clock;
+
+		// Bounds how late a retry may be sent, and how long
+		// destruction may wait for the thread.
+		static inline std::chrono::milliseconds const
+			POLL_INTERVAL{50};
+
+		// UDP Socket which exposes its NativeSocket and poll.
+		template<typename SocketFamilyInterface>
+		class UdpSocket :
+			public Socket<
+				SocketFamilyInterface,
+				DGramTypeInterface,
+				UdpProtocolInterface> {
+			public:
+			using SocketInterface::PollFlag;
+			using SocketInterface::poll;
+			using Socket<
+				SocketFamilyInterface,
+				DGramTypeInterface,
+				UdpProtocolInterface>::nativeSocket;
+		};
+		using PollFlag =
+			UdpSocket<Ipv4FamilyInterface>::PollFlag;
+
+		// UDP Socket connected to a nameserver for one attempt
+		// of a query, so that the kernel drops datagrams from
+		// any other address.
+		struct Attempt {
+			std::unique_ptr<SocketInterface> socket;
+			NativeSocket nativeSocket;
+		};
+
+		// A query in flight, which all lookups of its name and
+		// type wait on.
+		struct Query {
+			std::string key, name;
+			RecordType type;
+			std::uint16_t id;
+			std::size_t cAttempts;
+			Clock::time_point timeRetry;
+
+			// Encoded once, and sent with each attempt. Earlier
+			// attempts still accept late responses.
+			std::string message;
+			std::vector<Attempt> attempts;
+
+			// Error to fail with once out of attempts.
+			Error error;
+			std::promise<Records> promise;
+			std::shared_future<Records> future;
+		};
+
+		struct CacheEntry {
+			Records records;
+			Clock::time_point timeExpiry;
+		};
+
+		std::vector<AddressInfo> const nameservers;
+		Clock::duration const attemptTimeout;
+		std::size_t const attemptsMax;
+
+		std::mutex mtx;
+		std::condition_variable ev;
+		bool stopping{false};
+		Algorithm::LruCache<std::string, CacheEntry> cache;
+
+		// Queries in flight by ID, and by name and type.
+		std::unordered_map<std::uint16_t, std::unique_ptr<Query>>
+			queries;
+		std::unordered_map<std::string, Query *> queriesByKey;
+		std::mt19937 generator{std::random_device{}()};
+
+		// Wakes the thread from poll, so that it watches the
+		// Sockets of new queries.
+		Waker waker;
+
+		// Started once all else is constructed.
+		std::thread thread;
+
+		public:
+		// nameservers must not be empty.
+		Resolver(
+			std::vector<AddressInfo> const &nameservers =
+				Resolver::systemNameservers(),
+			std::size_t cacheCapacity = 1_zu << 12,
+			Clock::duration attemptTimeout = 1s,
+			std::size_t attemptsMax = 3) :
+			nameservers(nameservers),
+			attemptTimeout(attemptTimeout),
+			attemptsMax(attemptsMax),
+			cache(cacheCapacity) {
+			this->thread = std::thread([this]() { this->run(); });
+		}
+
+		// Lookups still in flight fail with broken_promise.
+		~Resolver() {
+			{
+				std::lock_guard lck(this->mtx);
+				this->stopping = true;
+			}
+			this->ev.notify_one();
+			this->thread.join();
+		}
+
+		// Forbid copy/move.
+		Resolver(Resolver const &) = delete;
+		Resolver &operator=(Resolver const &) = delete;
+		Resolver(Resolver &&) = delete;
+		Resolver &operator=(Resolver &&) = delete;
+
+		// Process-wide Resolver, with the system nameservers.
+		static Resolver &global() {
+			static Resolver resolver;
+			return resolver;
+		}
+
+		// Records of type for name, from the cache if possible.
+		// Negative answers resolve to no records. Throws if the
+		// name cannot be queried, and the future throws if all
+		// attempts time out or fail.
+		std::shared_future<Records> query(
+			std::string const &name,
+			RecordType type) {
+			std::string const normalized{
+				Resolver::normalize(name)},
+				key{
+					std::to_string(static_cast<int>(type)) + ':' +
+					normalized},
+				message{
+					Resolver::encodeQuery(0, normalized, type)};
+			std::lock_guard lck(this->mtx);
+			auto const cacheIt{this->cache.find(key)};
+			if (
+				cacheIt != this->cache.end() &&
+				cacheIt->second.timeExpiry > Clock::now()) {
+				std::promise<Records> promise;
+				promise.set_value(cacheIt->second.records);
+				return promise.get_future().share();
+			}
+			auto const queryIt{this->queriesByKey.find(key)};
+			if (queryIt != this->queriesByKey.end()) {
+				return queryIt->second->future;
+			}
+
+			// IDs of queries in flight are unique, so that
+			// responses may be matched to them.
+			std::uint16_t id;
+			do {
+				id = static_cast<std::uint16_t>(this->generator());
+			} while (this->queries.contains(id));
+			std::unique_ptr<Query> query{new Query{
+				key,
+				normalized,
+				type,
+				id,
+				0,
+				{},
+				message,
+				{},
+				Error::TIMED_OUT,
+				{},
+				{}}};
+			query->message[0] = static_cast<char>(id >> 8);
+			query->message[1] = static_cast<char>(id & 0xff);
+			query->future = query->promise.get_future().share();
+			this->send(*query);
+			this->queriesByKey.emplace(key, query.get());
+			auto const future{query->future};
+			this->queries.emplace(id, std::move(query));
+			this->ev.notify_one();
+			this->waker.wake();
+			return future;
+		}
+
+		// Resolves A and AAAA records for host, concurrently,
+		// and waits on them. Empty and numeric nodes, and
+		// localhost, are instead resolved by getaddrinfo, which
+		// does not query nameservers for them. So are
+		// non-numeric services. Returns no addresses if the
+		// service is unknown, and throws if any query fails.
+		//
+		// AAAA records are ordered before A records. With
+		// family INET6 and flag V4MAPPED, A records are
+		// returned as IPv4-mapped IPv6 addresses if there are
+		// no AAAA records, or always with flag ALL. Other flags
+		// are ignored.
+		std::vector<AddressInfo> getAddressInfos(
+			Host const &host,
+			Family family = Family::UNSPEC,
+			Type type = Type::ANY,
+			Protocol protocol = Protocol::ANY,
+			AddressInfo::Flag flags = AddressInfo::Flag::V4MAPPED |
+				AddressInfo::Flag::ADDRCONFIG |
+				AddressInfo::Flag::ALL) {
+			if (
+				host.node.empty() ||
+				Resolver::isNumeric(host.node) ||
+				strcasecmp(host.node.c_str(), "localhost") == 0) {
+				return Networking::getAddressInfos(
+					host, family, type, protocol, flags);
+			}
+			std::optional<std::uint16_t> const port{
+				Resolver::portOf(host.service, type, protocol)};
+			if (!port.has_value()) {
+				return {};
+			}
+
+			bool const isMapped{
+				family == Family::INET6 &&
+				Resolver::hasFlag(
+					flags, AddressInfo::Flag::V4MAPPED)},
+				isAll{Resolver::hasFlag(
+					flags, AddressInfo::Flag::ALL)};
+			std::shared_future<Records> aaaa, a;
+			if (family != Family::INET) {
+				aaaa = this->query(host.node, RecordType::AAAA);
+			}
+			if (family != Family::INET6 || isMapped) {
+				a = this->query(host.node, RecordType::A);
+			}
+
+			std::vector<AddressInfo> addressInfos;
+			if (aaaa.valid()) {
+				for (Record const &record : aaaa.get()) {
+					addressInfos.push_back(Resolver::addressInfoOf(
+						record.data, *port, type, protocol, flags));
+				}
+			}
+			if (
+				a.valid() &&
+				(family != Family::INET6 || isAll ||
+					addressInfos.empty())) {
+				for (Record const &record : a.get()) {
+					addressInfos.push_back(Resolver::addressInfoOf(
+						family == Family::INET6
+							? std::string(10, '\0') + "\xff\xff" +
+								record.data
+							: record.data,
+						*port,
+						type,
+						protocol,
+						flags));
+				}
+			}
+			return addressInfos;
+		}
+
+		// MX records for host, in order of preference. Unlike
+		// the free function, a name which does not exist has no
+		// records, rather than throwing.
+		std::vector<std::pair<std::size_t, std::string>>
+			getMxRecords(Host const &host) {
+			// The future owns the records it returns.
+			std::shared_future<Records> const future{
+				this->query(host.node, RecordType::MX)};
+			std::vector<std::pair<std::size_t, std::string>>
+				mxRecords;
+			for (Record const &record : future.get()) {
+				mxRecords.emplace_back(
+					record.preference, record.data);
+			}
+			std::sort(mxRecords.begin(), mxRecords.end());
+			return mxRecords;
+		}
+
+		// Nameservers configured for the system, or 127.0.0.1
+		// if there are none.
+		static std::vector<AddressInfo> systemNameservers() {
+			std::vector<std::string> addresses;
+#ifdef RAIN_PLATFORM_WINDOWS
+			ULONG infoLen{0};
+			GetNetworkParams(nullptr, &infoLen);
+			std::vector<FIXED_INFO> info(
+				infoLen / sizeof(FIXED_INFO) + 1);
+			infoLen = static_cast<ULONG>(
+				info.size() * sizeof(FIXED_INFO));
+			if (GetNetworkParams(info.data(), &infoLen) == 0) {
+				for (IP_ADDR_STRING const *server{
+							 &info[0].DnsServerList};
+						 server != nullptr;
+						 server = server->Next) {
+					addresses.emplace_back(server->IpAddress.String);
+				}
+			}
+#else
+			std::ifstream file("/etc/resolv.conf");
+			std::string line;
+			while (std::getline(file, line)) {
+				std::istringstream stream(line);
+				std::string keyword, address;
+				if (
+					stream >> keyword >> address &&
+					keyword == "nameserver") {
+					addresses.push_back(address);
+				}
+			}
+#endif
+
+			std::vector<AddressInfo> nameservers;
+			for (std::string const &address : addresses) {
+				Rain::Error::consumeThrowable(
+					[&nameservers, &address]() {
+						for (AddressInfo const &addressInfo :
+								 Networking::getAddressInfos(
+									 {address, "53"},
+									 Family::UNSPEC,
+									 Type::DGRAM,
+									 Protocol::UDP,
+									 AddressInfo::Flag::NUMERICHOST)) {
+							nameservers.push_back(addressInfo);
+						}
+					})();
+			}
+			if (nameservers.empty()) {
+				nameservers = Networking::getAddressInfos(
+					{"127.0.0.1", "53"},
+					Family::INET,
+					Type::DGRAM,
+					Protocol::UDP,
+					AddressInfo::Flag::NUMERICHOST);
+			}
+			return nameservers;
+		}
+
+		private:
+		// Opens a UDP Socket on an ephemeral port, connected to
+		// a nameserver.
+		static Attempt connect(AddressInfo const &addressInfo) {
+			Attempt attempt;
+			if (addressInfo.address.ss_family == AF_INET6) {
+				auto socket{std::make_unique<
+					UdpSocket<Ipv6FamilyInterface>>()};
+				attempt.nativeSocket = socket->nativeSocket();
+				attempt.socket = std::move(socket);
+			} else {
+				auto socket{std::make_unique<
+					UdpSocket<Ipv4FamilyInterface>>()};
+				attempt.nativeSocket = socket->nativeSocket();
+				attempt.socket = std::move(socket);
+			}
+			validateSystemCall(::connect(
+				attempt.nativeSocket,
+				reinterpret_cast<sockaddr const *>(
+					&addressInfo.address),
+				static_cast<socklen_t>(addressInfo.addressLen)));
+			return attempt;
+		}
+
+		// Receives responses and retries queries until
+		// stopping.
+		void run() {
+			// Sockets of all attempts in flight, after the waker,
+			// and the ID of the query each belongs to. Only this
+			// thread erases queries, so these stay open while
+			// polled.
+			std::vector<NativeSocket> nativeSockets;
+			std::vector<std::uint16_t> ids;
+			std::vector<PollFlag> events;
+			std::string buffer(1_zu << 16, '\0');
+
+			while (true) {
+				{
+					std::unique_lock lck(this->mtx);
+					this->ev.wait(lck, [this]() {
+						return this->stopping || !this->queries.empty();
+					});
+					if (this->stopping) {
+						return;
+					}
+					nativeSockets.assign(
+						1, this->waker.nativeSocket());
+					ids.assign(1, 0);
+					for (auto const &[id, query] : this->queries) {
+						for (Attempt const &attempt : query->attempts) {
+							nativeSockets.push_back(attempt.nativeSocket);
+							ids.push_back(id);
+						}
+					}
+					events.assign(
+						nativeSockets.size(), PollFlag::READ_NORMAL);
+				}
+
+				// Failed polls (e.g. on signals) are retried.
+				std::vector<PollFlag> const polled{
+					Rain::Error::consumeThrowable([&]() {
+						return UdpSocket<Ipv4FamilyInterface>::poll(
+							nativeSockets, events, POLL_INTERVAL);
+					})()};
+
+				std::lock_guard lck(this->mtx);
+				for (std::size_t idx{0}; idx < polled.size();
+						 idx++) {
+					if (polled[idx] == PollFlag::NONE) {
+						continue;
+					}
+
+					// Errors, such as ICMP port unreachable, are
+					// consumed by recv, and retried as timeouts. A
+					// query may be resolved by an earlier Socket.
+					while (
+						idx == 0 || this->queries.contains(ids[idx])) {
+						auto const result{::recv(
+							nativeSockets[idx],
+							&buffer[0],
+#ifdef RAIN_PLATFORM_WINDOWS
+							static_cast<int>(buffer.length()),
+#else
+							buffer.length(),
+#endif
+							0)};
+						if (result == NATIVE_SOCKET_ERROR) {
+							break;
+						}
+						if (idx != 0) {
+							this->onResponse(
+								ids[idx],
+								{buffer.data(),
+									static_cast<std::size_t>(result)});
+						}
+					}
+				}
+
+				auto const now{Clock::now()};
+				std::vector<std::uint16_t> due;
+				for (auto const &[id, query] : this->queries) {
+					if (query->timeRetry <= now) {
+						due.push_back(id);
+					}
+				}
+				for (std::uint16_t id : due) {
+					Query &query{*this->queries.at(id)};
+					if (query.cAttempts >= this->attemptsMax) {
+						query.promise.set_exception(
+							std::make_exception_ptr(
+								Exception(query.error)));
+						this->erase(query);
+					} else {
+						this->send(query);
+					}
+				}
+			}
+		}
+
+		// Sends the next attempt of a query, to the next
+		// nameserver in turn, from a new Socket. Failed sends
+		// are retried as timeouts. Must hold mtx.
+		void send(Query &query) {
+			AddressInfo const &nameserver{
+				this->nameservers[query.cAttempts++ %
+					this->nameservers.size()]};
+			query.timeRetry = Clock::now() + this->attemptTimeout;
+			bool connected{false};
+			Rain::Error::consumeThrowable(
+				[&query, &nameserver, &connected]() {
+					query.attempts.push_back(
+						Resolver::connect(nameserver));
+					connected = true;
+				})();
+			if (!connected) {
+				return;
+			}
+			::send(
+				query.attempts.back().nativeSocket,
+				query.message.data(),
+#ifdef RAIN_PLATFORM_WINDOWS
+				static_cast<int>(query.message.length()),
+#else
+				query.message.length(),
+#endif
+				0);
+		}
+
+		// Resolves the query answered by a response received on
+		// a Socket of the query with queryId, if any. Malformed
+		// responses are ignored. Must hold mtx.
+		void onResponse(
+			std::uint16_t queryId,
+			std::string_view response) {
+			Reader reader{response};
+			std::uint16_t const id{reader.read16()},
+				flags{reader.read16()}, cQuestions{reader.read16()},
+				cAnswers{reader.read16()},
+				cAuthorities{reader.read16()};
+			reader.read16();
+			auto const queryIt{this->queries.find(id)};
+			if (
+				reader.failed || id != queryId ||
+				queryIt == this->queries.end() ||
+				(flags & 0x8000) == 0 || cQuestions != 1) {
+				return;
+			}
+			Query &query{*queryIt->second};
+
+			// The question must match, lest the response be for
+			// an earlier query with the same ID.
+			std::string const name{
+				Resolver::normalize(reader.readName())};
+			RecordType const type{
+				static_cast<RecordType>(reader.read16())};
+			reader.read16();
+			if (
+				reader.failed || name != query.name ||
+				type != query.type) {
+				return;
+			}
+
+			// Failures other than NXDOMAIN are retried with the
+			// next nameserver.
+			std::uint16_t const rCode(flags & 0x000f);
+			if (rCode != 0 && rCode != 3) {
+				query.error = Error::DNS_QUERY_FAILED;
+				query.timeRetry = Clock::now();
+				return;
+			}
+
+			Records records;
+			std::uint32_t ttl{
+				static_cast<std::uint32_t>(MAX_TTL.count())};
+			for (std::uint16_t idx{0}; idx < cAnswers; idx++) {
+				auto const record{reader.readRecord()};
+				if (reader.failed) {
+					return;
+				}
+				if (
+					record.type == query.type ||
+					record.type == RecordType::CNAME) {
+					ttl = std::min(ttl, record.ttl);
+				}
+				if (record.type != query.type) {
+					continue;
+				}
+				if (
+					(type == RecordType::A &&
+						record.data.size() == 4) ||
+					(type == RecordType::AAAA &&
+						record.data.size() == 16)) {
+					records.push_back({0, std::string(record.data)});
+				} else if (type == RecordType::MX) {
+					Reader rData{response, record.offset};
+					std::uint16_t const preference{rData.read16()};
+					std::string exchange{rData.readName()};
+					if (!rData.failed) {
+						records.push_back(
+							{preference, std::move(exchange)});
+					}
+				}
+			}
+
+			// Negative answers are cached for the lesser of the
+			// TTL and the minimum of the SOA in the authority
+			// section.
+			if (records.empty()) {
+				ttl =
+					static_cast<std::uint32_t>(NEGATIVE_TTL.count());
+				for (std::uint16_t idx{0}; idx < cAuthorities;
+						 idx++) {
+					auto const record{reader.readRecord()};
+					if (reader.failed) {
+						break;
+					}
+					if (record.type == RecordType::SOA) {
+						Reader rData{response, record.offset};
+						rData.readName();
+						rData.readName();
+						for (int jdx{0}; jdx < 4; jdx++) {
+							rData.read32();
+						}
+						std::uint32_t const minimum{rData.read32()};
+						if (!rData.failed) {
+							ttl = std::min(record.ttl, minimum);
+						}
+						break;
+					}
+				}
+			}
+
+			if (ttl > 0) {
+				this->cache.insertOrAssign(
+					query.key,
+					CacheEntry{
+						records,
+						Clock::now() +
+							std::chrono::seconds(std::min(
+								ttl,
+								static_cast<std::uint32_t>(
+									MAX_TTL.count())))});
+			}
+			query.promise.set_value(std::move(records));
+			this->erase(query);
+		}
+
+		// Forgets a resolved query. Must hold mtx.
+		void erase(Query &query) {
+			std::uint16_t const id{query.id};
+			this->queriesByKey.erase(query.key);
+			this->queries.erase(id);
+		}
+
+		// Reads big-endian integers, names, and resource
+		// records from a DNS message. Reads past the end set
+		// `failed`, and return zero values.
+		class Reader {
+			public:
+			struct Record {
+				RecordType type;
+				std::uint32_t ttl;
+				std::string_view data;
+
+				// Offset of data in the message, for names within
+				// it which may be compressed.
+				std::size_t offset;
+			};
+
+			std::string_view message;
+			std::size_t offset;
+			bool failed;
+
+			Reader(
+				std::string_view message,
+				std::size_t offset = 0) :
+				message(message),
+				offset(offset),
+				failed(false) {}
+
+			std::uint16_t read16() {
+				if (this->offset + 2 > this->message.size()) {
+					this->failed = true;
+					return 0;
+				}
+				std::uint16_t value(
+					static_cast<std::uint8_t>(
+						this->message[this->offset]) << 8 |
+					static_cast<std::uint8_t>(
+						this->message[this->offset + 1]));
+				this->offset += 2;
+				return value;
+			}
+			std::uint32_t read32() {
+				std::uint32_t high{this->read16()};
+				return high << 16 | this->read16();
+			}
+
+			// Reads a name in dotted form, following compression
+			// pointers. Pointers are followed a bounded number of
+			// times, so that loops terminate.
+			std::string readName() {
+				std::string name;
+				std::size_t offset{this->offset};
+				bool jumped{false};
+				for (std::size_t cJumps{0}; cJumps < 64;) {
+					if (offset >= this->message.size()) {
+						break;
+					}
+					std::uint8_t const length(
+						static_cast<std::uint8_t>(
+							this->message[offset]));
+					if ((length & 0xc0) == 0xc0) {
+						if (offset + 2 > this->message.size()) {
+							break;
+						}
+						if (!jumped) {
+							this->offset = offset + 2;
+						}
+						jumped = true;
+						cJumps++;
+						offset = static_cast<std::size_t>(length & 0x3f)
+								<< 8 |
+							static_cast<std::uint8_t>(
+								this->message[offset + 1]);
+						continue;
+					}
+					if (length == 0) {
+						if (!jumped) {
+							this->offset = offset + 1;
+						}
+						return name;
+					}
+					if (offset + 1 + length > this->message.size()) {
+						break;
+					}
+					if (!name.empty()) {
+						name.push_back('.');
+					}
+					name.append(
+						this->message.substr(offset + 1, length));
+					offset += 1 + length;
+				}
+				this->failed = true;
+				return {};
+			}
+
+			Record readRecord() {
+				this->readName();
+				RecordType const type{
+					static_cast<RecordType>(this->read16())};
+				this->read16();
+				std::uint32_t const ttl{this->read32()};
+				std::uint16_t const dataLen{this->read16()};
+				if (
+					this->failed ||
+					this->offset + dataLen > this->message.size()) {
+					this->failed = true;
+					return {};
+				}
+				Record record{
+					type,
+					ttl,
+					this->message.substr(this->offset, dataLen),
+					this->offset};
+				this->offset += dataLen;
+				return record;
+			}
+		};
+
+		// Header with one question and recursion desired,
+		// followed by the question. Throws if a label of name is
+		// empty or longer than 63 bytes, or name is longer than
+		// 253 bytes (RFC 1035 2.3.4).
+		static std::string encodeQuery(
+			std::uint16_t id,
+			std::string const &name,
+			RecordType type) {
+			std::string message{
+				static_cast<char>(id >> 8),
+				static_cast<char>(id & 0xff),
+				'\x01',
+				'\0',
+				'\0',
+				'\x01',
+				'\0',
+				'\0',
+				'\0',
+				'\0',
+				'\0',
+				'\0'};
+			if (name.length() > 253) {
+				throw Exception(Error::DNS_NAME_INVALID);
+			}
+			for (std::size_t begin{0}; begin < name.length();) {
+				std::size_t const end{
+					std::min(name.find('.', begin), name.length())};
+				if (end == begin || end - begin > 63) {
+					throw Exception(Error::DNS_NAME_INVALID);
+				}
+				message.push_back(static_cast<char>(end - begin));
+				message.append(name, begin, end - begin);
+				begin = end + 1;
+
+				// A dot may not end the name, since trailing dots
+				// are normalized away.
+				if (begin == name.length()) {
+					throw Exception(Error::DNS_NAME_INVALID);
+				}
+			}
+			message.push_back('\0');
+			std::uint16_t const qType{
+				static_cast<std::uint16_t>(type)};
+			message.push_back(static_cast<char>(qType >> 8));
+			message.push_back(static_cast<char>(qType & 0xff));
+
+			// Class IN.
+			message.append({'\0', '\x01'});
+			return message;
+		}
+
+		// Names are case-insensitive, and may be fully
+		// qualified.
+		static std::string normalize(std::string name) {
+			if (!name.empty() && name.back() == '.') {
+				name.pop_back();
+			}
+			return String::toLower(name);
+		}
+
+		// IPv6 addresses contain colons, which names may not.
+		static bool isNumeric(std::string const &node) {
+			in_addr address;
+			return node.find(':') != std::string::npos ||
+				inet_pton(AF_INET, node.c_str(), &address) == 1;
+		}
+
+		static bool hasFlag(
+			AddressInfo::Flag flags,
+			AddressInfo::Flag flag) {
+			return (static_cast<int>(flags) &
+							 static_cast<int>(flag)) != 0;
+		}
+
+		// Numeric services are parsed, and others are looked up
+		// with getaddrinfo, which does not query nameservers
+		// for them. Numeric services above 65535 are unknown.
+		static std::optional<std::uint16_t> portOf(
+			std::string const &service,
+			Type type,
+			Protocol protocol) {
+			if (
+				std::all_of(
+					service.begin(), service.end(), [](char c) {
+						return c >= '0' && c <= '9';
+					})) {
+				std::uint32_t port{0};
+				if (
+					!service.empty() &&
+					(std::from_chars(
+						 service.data(),
+						 service.data() + service.size(),
+						 port)
+							 .ec != std::errc() ||
+						port > 65535)) {
+					return {};
+				}
+				return static_cast<std::uint16_t>(port);
+			}
+			auto const addressInfos{Networking::getAddressInfos(
+				{"", service},
+				Family::INET,
+				type,
+				protocol,
+				AddressInfo::Flag::PASSIVE)};
+			if (addressInfos.empty()) {
+				return {};
+			}
+			sockaddr_in addressIn;
+			std::memcpy(
+				&addressIn,
+				&addressInfos[0].address,
+				sizeof(addressIn));
+			return ntohs(addressIn.sin_port);
+		}
+
+		// address is 4 bytes for IPv4, or 16 for IPv6, in
+		// network byte order.
+		static AddressInfo addressInfoOf(
+			std::string const &address,
+			std::uint16_t port,
+			Type type,
+			Protocol protocol,
+			AddressInfo::Flag flags) {
+			AddressInfo addressInfo{
+				flags, Family::INET, type, protocol, {}, {}, 0};
+			if (address.length() == 4) {
+				sockaddr_in addressIn{};
+				addressIn.sin_family = AF_INET;
+				addressIn.sin_port = htons(port);
+				std::memcpy(&addressIn.sin_addr, address.data(), 4);
+				std::memcpy(
+					&addressInfo.address,
+					&addressIn,
+					sizeof(addressIn));
+				addressInfo.addressLen = sizeof(addressIn);
+			} else {
+				addressInfo.family = Family::INET6;
+				sockaddr_in6 addressIn6{};
+				addressIn6.sin6_family = AF_INET6;
+				addressIn6.sin6_port = htons(port);
+				std::memcpy(
+					&addressIn6.sin6_addr, address.data(), 16);
+				std::memcpy(
+					&addressInfo.address,
+					&addressIn6,
+					sizeof(addressIn6));
+				addressInfo.addressLen = sizeof(addressIn6);
+			}
+			return addressInfo;
+		}
+	};
+}
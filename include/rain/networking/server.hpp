@@ -4,13 +4,55 @@
 
 #include "../error/consume_throwable.hpp"
 #include "../literal.hpp"
+#include "../metrics.hpp"
 #include "../multithreading/thread_pool.hpp"
 #include "../time/timeout.hpp"
+#include "buffer_pool.hpp"
 #include "client.hpp"
+#include "rate_limiter.hpp"
+#include "reactor.hpp"
 #include "socket.hpp"
+#include "socket_option.hpp"
 #include "worker.hpp"
 
 namespace Rain::Networking {
+	// Options which determine how a Server dispatches its
+	// Workers, passed as the first argument of the Server
+	// curry constructor.
+	struct ServeOptions {
+		// If non-zero, the Server runs in reactor mode with
+		// this many event loops, which own readiness for all
+		// idle Workers. A Worker only takes a pool thread once
+		// its Socket is readable, and returns it once it has
+		// no more buffered input (see WorkerSocketSpecInterface
+		// for the hooks involved). Coroutine Workers run on the
+		// event loops instead, once begun.
+		//
+		// If zero, each Worker holds a pool thread for its
+		// entire lifetime.
+		std::size_t reactors{0};
+
+		// If greater than one, the Server opens this many
+		// listening Sockets on the same address, each with its
+		// own accept loop, so that the kernel may spread
+		// incoming connections across them. The Server Socket
+		// must then set ReusePortSocketOption.
+		std::size_t shards{1};
+
+		// If set, Workers accepted on each shard run on a
+		// ThreadPool owned by that shard, instead of on the
+		// Server ThreadPool shared with the accept loops.
+		bool shardThreadPools{false};
+
+		// Size classes of the BufferPool owned by the Server,
+		// from which Workers acquire their stream buffers.
+		// Buffers begin at the smallest class which fits, and
+		// may grow up to the largest while throughput stays
+		// high.
+		std::size_t minBufferLen{1_zu << 12},
+			maxBufferLen{1_zu << 18};
+	};
+
 	// InterfaceInterfaces hold commonalities behind templated
 	// Interfaces as well as introduce otherwise dependent
 	// names.
@@ -69,6 +111,25 @@ namespace Rain::Networking {
 		public:
 		virtual std::size_t workers() = 0;
 		virtual std::size_t threads() = 0;
+
+		// Metrics across all Servers. Accept latency is the
+		// time from accept until the Worker begins work, which
+		// includes queueing for a thread.
+		static inline Metrics::Counter acceptedMetric{
+			"rain_server_accepted_total",
+			"Connections accepted by Servers."},
+			rejectedMetric{
+				"rain_server_rejected_total",
+				"Connections rejected by rate limiting."},
+			workersStartedMetric{
+				"rain_server_workers_started_total",
+				"Workers which began work."},
+			workersStoppedMetric{
+				"rain_server_workers_stopped_total",
+				"Workers which finished work."};
+		static inline Metrics::Histogram acceptLatencyMetric{
+			"rain_server_accept_latency_seconds",
+			"Time from accept until a Worker begins work."};
 	};
 
 	template<typename WorkerSocketSpec>
@@ -107,6 +168,87 @@ namespace Rain::Networking {
 		// ThreadPool (infinite capacity).
 		Multithreading::ThreadPool threadPool;
 
+		ServeOptions const serveOptions;
+
+		// Listening Sockets for all shards but the first, which
+		// is this Server itself. These are constructed like the
+		// Server Socket, and thus share its socket options.
+		class ShardSocket : public Socket {
+			public:
+			using Socket::nativeSocket;
+		};
+		std::vector<std::unique_ptr<ShardSocket>> shardSockets;
+
+		// Worker ThreadPools, one per shard, with
+		// ServeOptions::shardThreadPools.
+		std::vector<std::unique_ptr<Multithreading::ThreadPool>>
+			shardThreadPools;
+
+		// Number of live Workers in reactor mode, whether idle
+		// or running. Must outlive reactors.
+		std::atomic_size_t cReactorWorkers{0};
+
+		// Idle timeouts and Worker Deadlines across all
+		// Reactors. Must outlive reactors and timerReactor.
+		Time::TimerWheel timerWheel;
+
+		// Buffers for all Workers. Must outlive reactors.
+		BufferPool _bufferPool{
+			this->serveOptions.minBufferLen,
+			this->serveOptions.maxBufferLen};
+
+		// In thread mode, Worker Deadlines are fired by this
+		// event loop, which is only started once a Worker
+		// enables them, and watches no Sockets. It runs on its
+		// own thread, so that it starts and keeps running even
+		// when threadPool is saturated.
+		std::unique_ptr<Reactor> timerReactor;
+		std::once_flag timerReactorFlag;
+		std::thread timerReactorThread;
+
+		// Event loops in reactor mode, each run as a task in
+		// threadPool. Workers are assigned to them round-robin.
+		std::vector<std::unique_ptr<Reactor>> reactors;
+		std::atomic_size_t nextReactor{0};
+
+		// Owns a Worker while it is idle in a Reactor, or while
+		// it is running on a pool thread in reactor mode.
+		class WorkerRegistration : public Reactor::Registration {
+			public:
+			ServerSocketSpec *const server;
+			Reactor &reactor;
+			Multithreading::ThreadPool &threadPool;
+			std::unique_ptr<WorkerSocketSpec> const worker;
+
+			WorkerRegistration(
+				ServerSocketSpec *server,
+				Reactor &reactor,
+				Multithreading::ThreadPool &threadPool,
+				NativeSocket nativeSocket,
+				std::unique_ptr<WorkerSocketSpec> &&worker) :
+				Registration(nativeSocket),
+				server(server),
+				reactor(reactor),
+				threadPool(threadPool),
+				worker(std::move(worker)) {
+				this->server->cReactorWorkers++;
+			}
+			virtual ~WorkerRegistration() {
+				this->server->workersStoppedMetric.add();
+				this->server->cReactorWorkers--;
+			}
+
+			private:
+			virtual void onReady(
+				std::unique_ptr<Reactor::Registration> &&self)
+				override {
+				this->server->onWorkerReady(
+					std::unique_ptr<WorkerRegistration>(
+						static_cast<WorkerRegistration *>(
+							self.release())));
+			}
+		};
+
 		// Socket pair created for interrupts.
 		std::pair<
 			std::unique_ptr<Client<
@@ -124,6 +266,33 @@ namespace Rain::Networking {
 			validateSystemCall(
 				::listen(this->nativeSocket(), backlog));
 
+			// Remaining shards bind to the address this Server
+			// has just bound to, which also resolves any
+			// ephemeral port.
+			if (this->serveOptions.shards > 1) {
+				AddressInfo const addressInfo{this->name()};
+				for (std::size_t idx{1};
+						 idx < this->serveOptions.shards;
+						 idx++) {
+					this->shardSockets.emplace_back(new ShardSocket);
+					ServerSocketSpecInterfaceInterface::bind(
+						this->shardSockets.back()->nativeSocket(),
+						addressInfo);
+					validateSystemCall(::listen(
+						this->shardSockets.back()->nativeSocket(),
+						backlog));
+				}
+			}
+			if (this->serveOptions.shardThreadPools) {
+				for (
+					std::size_t idx{0};
+					idx < std::max(1_zu, this->serveOptions.shards);
+					idx++) {
+					this->shardThreadPools.emplace_back(
+						new Multithreading::ThreadPool);
+				}
+			}
+
 			// Connect the interrupter pair.
 			{
 				NamedSocketSpec<Networking::Socket<
@@ -169,123 +338,334 @@ namespace Rain::Networking {
 			// poll with the second with READ_NORMAL, and
 			// interrupt by sending on the first.
 
-			// Begin accepting on this server. The server thread
-			// must be extremely resilient to exceptions.
+			// Event loops in reactor mode stop on the same
+			// interrupt as everything else.
+			for (std::size_t idx{0};
+					 idx < this->serveOptions.reactors;
+					 idx++) {
+				this->reactors.emplace_back(new Reactor(
+					this->interrupter.second->nativeSocket(),
+					&this->timerWheel));
+			}
+			for (auto &reactor : this->reactors) {
+				this->threadPool.queueTask(
+					[&reactor]() { reactor->run(); });
+			}
+
+			// Begin accepting on this server and its shards.
 			this->threadPool.queueTask([this]() {
-				while (true) {
-					// If poll throws, it is unlikely the server can
-					// be restarted anyway.
-					auto flag = SocketInterface::poll(
-						{this, this->interrupter.second.get()},
-						{PollFlag::READ_NORMAL, PollFlag::READ_NORMAL},
-						{})[0];
-					if (flag != PollFlag::READ_NORMAL) {
-						break;
-					}
+				this->accept(
+					this->nativeSocket(), this->workerThreadPool(0));
+			});
+			for (
+				std::size_t idx{0}; idx < this->shardSockets.size();
+				idx++) {
+				this->threadPool.queueTask([this, idx]() {
+					this->accept(
+						this->shardSockets[idx]->nativeSocket(),
+						this->workerThreadPool(idx + 1));
+				});
+			}
+		}
 
-					NativeSocket nativeSocket{validateSystemCall(
-						::accept(
-							this->nativeSocket(), nullptr, nullptr))};
+		// ThreadPool which runs Workers accepted on a shard.
+		Multithreading::ThreadPool &workerThreadPool(
+			std::size_t shard) {
+			return this->shardThreadPools.empty()
+				? this->threadPool
+				: *this->shardThreadPools[shard];
+		}
 
-					// Worker must be constructed prior to starting
-					// its task, lest the Server deconstruction cause
-					// the makeWorker virtual to be unregistered from
-					// its subclass and the thread to call the base
-					// pure virtual makeWorker.
+		// Accept loop for a single listening Socket, which runs
+		// until interrupted. The accept thread must be extremely
+		// resilient to exceptions.
+		void accept(
+			NativeSocket listener,
+			Multithreading::ThreadPool &workerThreadPool) {
+			while (true) {
+				// If poll throws, it is unlikely the server can be
+				// restarted anyway.
+				auto flag = SocketInterface::poll(
+					std::vector<NativeSocket>{
+						listener,
+						this->interrupter.second->nativeSocket()},
+					{PollFlag::READ_NORMAL, PollFlag::READ_NORMAL},
+					{})[0];
+				if (flag != PollFlag::READ_NORMAL) {
+					break;
+				}
 
-					// std::function Task cannot store move-captures
-					// on unique_ptr.
-					try {
-						this->threadPool.queueTask(
-							Rain::Error::consumeThrowable(
-								[this, nativeSocket]() {
-									// If Worker construction fails, just
-									// consume and ignore the exception. This
-									// should be unlikely.
-									//
-									// This may fail on some platforms if
-									// socket options are set and the client
-									// disconnects almost immediately,
-									// invalidating the file descriptor. Then,
-									// socket options constructors will fail
-									// on the invalid file descriptor.
-									auto worker = this->makeWorker(
-										nativeSocket,
-										this->interrupter.second.get());
-
-									// Rate limit based on peer hostname.
-									if (!this->shouldRejectPeerHost(
-												worker.peerHost())) {
-										// Failures in onWork should be logged.
-										Rain::Error::consumeThrowable(
-											[&worker]() {
-												// Cast to WorkerSocketSpecInterface
-												// to trigger friend permissions.
-												static_cast<
-													WorkerSocketSpecInterface &>(
-													worker)
-													.onWork();
-											},
-											std::source_location::current())();
-									}
-								}));
-					} catch (std::exception const &exception) {
-						std::cout << exception.what();
-
-						// Set maxThreads here so that we don’t exceed
-						// system maximum.
-						// TODO: Is there a better way to determine if
-						// we’ve hit the system maximum on threads?
-						this->threadPool.setMaxThreads(
-							this->threadPool.getCThreads());
+				// Another shard on the same address may have taken
+				// the connection first, on platforms which wake all
+				// of them.
+				NativeSocket nativeSocket{
+					::accept(listener, nullptr, nullptr)};
+				if (nativeSocket == NATIVE_SOCKET_INVALID) {
+					if (getSystemError() == Error::WOULD_BLOCK) {
+						continue;
 					}
+					throw Exception(getSystemError());
+				}
+				this->acceptedMetric.add();
+				auto const timeAccepted{
+					std::chrono::steady_clock::now()};
+
+				// Worker must be constructed prior to starting its
+				// task, lest the Server deconstruction cause the
+				// makeWorker virtual to be unregistered from its
+				// subclass and the thread to call the base pure
+				// virtual makeWorker.
+				try {
+					workerThreadPool.queueTask(
+						Rain::Error::consumeThrowable(
+							[this,
+								nativeSocket,
+								&workerThreadPool,
+								timeAccepted]() {
+								this->work(
+									nativeSocket,
+									workerThreadPool,
+									timeAccepted);
+							}));
+				} catch (std::exception const &exception) {
+					std::cout << exception.what();
+
+					// Set maxThreads here so that we don’t exceed
+					// system maximum.
+					// TODO: Is there a better way to determine if
+					// we’ve hit the system maximum on threads?
+					workerThreadPool.setMaxThreads(
+						workerThreadPool.getCThreads());
+				}
+			}
+		}
+
+		// Runs a newly accepted Worker, on a thread of
+		// workerThreadPool.
+		void work(
+			NativeSocket nativeSocket,
+			Multithreading::ThreadPool &workerThreadPool,
+			std::chrono::steady_clock::time_point timeAccepted) {
+			// If Worker construction fails, just consume and
+			// ignore the exception. This should be unlikely.
+			//
+			// This may fail on some platforms if socket options
+			// are set and the client disconnects almost
+			// immediately, invalidating the file descriptor.
+			// Then, socket options constructors will fail on the
+			// invalid file descriptor.
+			if (!this->reactors.empty()) {
+				// Guaranteed copy elision constructs the Worker in
+				// place on the heap.
+				std::unique_ptr<WorkerSocketSpec> worker(
+					new WorkerSocketSpec(this->makeWorker(
+						nativeSocket, this->interrupter.second.get())));
+				if (!this->beginWork(*worker, timeAccepted)) {
+					return;
+				}
+
+				Reactor &reactor{*this->reactors
+						[this->nextReactor++ % this->reactors.size()]};
+				static_cast<WorkerSocketSpecInterface &>(*worker)
+					._reactor = &reactor;
+				static_cast<WorkerSocketSpecInterface &>(*worker)
+					._timerReactor = &reactor;
+				static_cast<WorkerSocketSpecInterface &>(*worker)
+					._bufferPool = &this->_bufferPool;
+				static_cast<WorkerSocketSpecInterface &>(*worker)
+					._threadPool = &workerThreadPool;
+
+				Task<> task{
+					static_cast<WorkerSocketSpecInterface &>(*worker)
+						.onCoWork()};
+				if (task) {
+					this->cReactorWorkers++;
+					ServerSocketSpec::coWork(
+						this, std::move(worker), std::move(task))
+						.detach();
+					return;
 				}
+
+				bool done{true};
+				Rain::Error::consumeThrowable(
+					[&worker, &done]() {
+						done = static_cast<WorkerSocketSpecInterface &>(
+							*worker)
+										 .onWorkBegin();
+					},
+					std::source_location::current())();
+				if (done) {
+					this->workersStoppedMetric.add();
+					return;
+				}
+
+				this->idle(std::unique_ptr<WorkerRegistration>(
+					new WorkerRegistration(
+						this,
+						reactor,
+						workerThreadPool,
+						nativeSocket,
+						std::move(worker))));
+				return;
+			}
+
+			auto worker = this->makeWorker(
+				nativeSocket, this->interrupter.second.get());
+
+			if (this->beginWork(worker, timeAccepted)) {
+				static_cast<WorkerSocketSpecInterface &>(worker)
+					._bufferPool = &this->_bufferPool;
+				static_cast<WorkerSocketSpecInterface &>(worker)
+					._threadPool = &workerThreadPool;
+				this->startTimerReactor(worker);
+
+				// Failures in onWork should be logged.
+				Rain::Error::consumeThrowable(
+					[&worker]() {
+						// Cast to WorkerSocketSpecInterface to trigger
+						// friend permissions.
+						WorkerSocketSpecInterface &interface{worker};
+						Task<> task{interface.onCoWork()};
+						if (task) {
+							std::move(task).get();
+						} else {
+							interface.onWork();
+						}
+					},
+					std::source_location::current())();
+				this->workersStoppedMetric.add();
+			}
+		}
+
+		// Owns a coroutine Worker in reactor mode until its
+		// Task completes, on whichever thread that may be.
+		static Task<> coWork(
+			ServerSocketSpec *server,
+			std::unique_ptr<WorkerSocketSpec> worker,
+			Task<> task) {
+			std::exception_ptr exception;
+			try {
+				co_await std::move(task);
+			} catch (...) {
+				exception = std::current_exception();
+			}
+
+			// Failures should be logged, as with onWork.
+			if (exception) {
+				Rain::Error::consumeThrowable(
+					[&exception]() {
+						std::rethrow_exception(exception);
+					},
+					std::source_location::current())();
+			}
+			worker.reset();
+			server->workersStoppedMetric.add();
+			server->cReactorWorkers--;
+		}
+
+		// In thread mode, starts timerReactor on the first
+		// Worker with Deadlines, and provides it to the Worker
+		// for its Deadlines only. Nothing is awaited on it, so
+		// that it only ever runs timers.
+		void startTimerReactor(WorkerSocketSpec &worker) {
+			WorkerSocketSpecInterface &interface{worker};
+			if (
+				interface.onWorkHeadTimeout() == 0ms &&
+				interface.onWorkRequestTimeout() == 0ms) {
+				return;
+			}
+			std::call_once(this->timerReactorFlag, [this]() {
+				this->timerReactor.reset(new Reactor(
+					this->interrupter.second->nativeSocket(),
+					&this->timerWheel));
+				this->timerReactorThread = std::thread(
+					[this]() { this->timerReactor->run(); });
 			});
+			interface._timerReactor = this->timerReactor.get();
+		}
+
+		// Rate limits based on peer address, and counts the
+		// Worker as started if it is not rejected. Returns
+		// false if rejected.
+		bool beginWork(
+			WorkerSocketSpec &worker,
+			std::chrono::steady_clock::time_point timeAccepted) {
+			if (this->shouldRejectPeer(worker.peerName())) {
+				this->rejectedMetric.add();
+				return false;
+			}
+			this->workersStartedMetric.add();
+			this->acceptLatencyMetric.record(
+				std::chrono::steady_clock::now() - timeAccepted);
+			return true;
+		}
+
+		// Hands an idle Worker to its Reactor until it is
+		// readable again.
+		void idle(
+			std::unique_ptr<WorkerRegistration> &&registration) {
+			WorkerSocketSpecInterface &interface{
+				*registration->worker};
+			interface.onWorkIdle();
+			std::chrono::milliseconds idleTimeout{
+				interface.onWorkIdleTimeout()};
+			registration->reactor.arm(
+				std::move(registration), idleTimeout);
+		}
+
+		// Called by a Reactor on its event loop thread once an
+		// idle Worker is readable.
+		void onWorkerReady(
+			std::unique_ptr<WorkerRegistration> &&registration) {
+			Multithreading::ThreadPool &workerThreadPool{
+				registration->threadPool};
+			try {
+				workerThreadPool.queueTask(
+					[this, registration = std::move(registration)]()
+						mutable {
+						bool done{true};
+						Rain::Error::consumeThrowable(
+							[&registration, &done]() {
+								done =
+									static_cast<WorkerSocketSpecInterface &>(
+										*registration->worker)
+										.onWorkReady();
+							},
+							std::source_location::current())();
+						if (!done) {
+							Rain::Error::consumeThrowable(
+								[this, &registration]() {
+									this->idle(std::move(registration));
+								},
+								std::source_location::current())();
+						}
+					});
+			} catch (std::exception const &exception) {
+				// If the Task was not queued, the Worker is
+				// destroyed along with it.
+				std::cout << exception.what();
+				workerThreadPool.setMaxThreads(
+					workerThreadPool.getCThreads());
+			}
 		}
 
 		// Host rate limit sliding window size.
 		static std::chrono::steady_clock::
 			duration constexpr RATE_LIMIT_WINDOW_SIZE{60s};
 		static std::size_t const RATE_LIMIT_THRESHOLD{60};
-		// Maps a peer node to a pair (mutex, queue of times)
-		// where the queue contains all times the peer has
-		// connected within the sliding window, sorted in
-		// ascending order. The mutex is used to guarantee
-		// thread-safety on the queue.
-		// TODO: This map expands over the lifetime of the
-		// server and is not cleaned up.
-		std::unordered_map<
-			std::string,
-			std::pair<
-				std::mutex,
-				std::queue<std::chrono::time_point<
-					std::chrono::steady_clock>>>>
-			peerConnections;
-
-		// Implements sliding window rate limiting based on host
-		// node (IP).
-		virtual bool shouldRejectPeerHost(
-			Host const &peerHost) {
-			auto &peerConnection =
-				this->peerConnections[peerHost.node];
-			std::lock_guard peerConnectionLck(
-				peerConnection.first);
-			auto const now = std::chrono::steady_clock::now();
-			while (
-				!peerConnection.second.empty() &&
-				peerConnection.second.front() <=
-					now - RATE_LIMIT_WINDOW_SIZE) {
-				peerConnection.second.pop();
-			}
 
-			if (
-				peerConnection.second.size() >=
-				RATE_LIMIT_THRESHOLD) {
-				return true;
-			} else {
-				peerConnection.second.push(now);
-				return false;
-			}
+		// Connections admitted per peer address within the
+		// sliding window. Fixed in size, so that distinct peers
+		// do not grow it over the lifetime of the server.
+		RateLimiter rateLimiter{
+			RATE_LIMIT_THRESHOLD,
+			RATE_LIMIT_WINDOW_SIZE};
+
+		// Implements sliding window rate limiting based on the
+		// peer's binary address (IP).
+		virtual bool shouldRejectPeer(
+			AddressInfo const &peerName) {
+			return this->rateLimiter.shouldReject(peerName);
 		}
 
 		protected:
@@ -299,26 +679,36 @@ namespace Rain::Networking {
 			// deconstructed.
 			this->interrupter.first->send("\0", 1);
 			this->threadPool.blockForTasks();
+
+			// Accept loops and Reactors have exited, so no more
+			// Workers will be queued on shard ThreadPools.
+			for (auto &shardThreadPool : this->shardThreadPools) {
+				shardThreadPool->blockForTasks();
+			}
+
+			// Workers which may cancel Deadlines have exited.
+			if (this->timerReactorThread.joinable()) {
+				this->timerReactorThread.join();
+			}
 		}
 
-		public:
-		// On construction, Servers bind and listen and accept,
-		// asynchronously.
-		ServerSocketSpec(
+		// Code-sharing: bind and serve with the arguments of
+		// any constructor.
+		void bindAndServe(
 			AddressInfo const &addressInfo,
 			int backlog = LISTEN_BACKLOG_DEFAULT) {
 			ServerSocketSpecInterfaceInterface::bind(
 				this->nativeSocket(), addressInfo);
 			this->serve(backlog);
 		}
-		ServerSocketSpec(
+		void bindAndServe(
 			std::vector<AddressInfo> const &addressInfos,
 			int backlog = LISTEN_BACKLOG_DEFAULT) {
 			ServerSocketSpecInterfaceInterface::bind(
 				this->nativeSocket(), addressInfos);
 			this->serve(backlog);
 		}
-		ServerSocketSpec(
+		void bindAndServe(
 			Host const &host,
 			int backlog = LISTEN_BACKLOG_DEFAULT,
 			AddressInfo::Flag flags =
@@ -335,17 +725,83 @@ namespace Rain::Networking {
 				flags);
 			this->serve(backlog);
 		}
+
+		public:
+		// On construction, Servers bind and listen and accept,
+		// asynchronously.
+		ServerSocketSpec(
+			AddressInfo const &addressInfo,
+			int backlog = LISTEN_BACKLOG_DEFAULT) {
+			this->bindAndServe(addressInfo, backlog);
+		}
+		ServerSocketSpec(
+			std::vector<AddressInfo> const &addressInfos,
+			int backlog = LISTEN_BACKLOG_DEFAULT) {
+			this->bindAndServe(addressInfos, backlog);
+		}
+		ServerSocketSpec(
+			Host const &host,
+			int backlog = LISTEN_BACKLOG_DEFAULT,
+			AddressInfo::Flag flags =
+				AddressInfo::Flag::V4MAPPED |
+				AddressInfo::Flag::ADDRCONFIG |
+				AddressInfo::Flag::ALL |
+				AddressInfo::Flag::PASSIVE) {
+			this->bindAndServe(host, backlog, flags);
+		}
+
+		// Curry constructor sets ServeOptions, and forwards the
+		// remaining arguments as for any other constructor.
+		ServerSocketSpec(
+			ServeOptions const &serveOptions,
+			auto &&...args) :
+			serveOptions(serveOptions) {
+			// Sharding is checked before anything is bound.
+			if constexpr (!std::is_base_of_v<
+											ReusePortSocketOptionInterface,
+											Socket>) {
+				if (this->serveOptions.shards > 1) {
+					throw Exception(Error::REUSE_PORT_REQUIRED);
+				}
+			}
+			this->bindAndServe(
+				std::forward<decltype(args)>(args)...);
+		}
 		virtual ~ServerSocketSpec() {
 			// Most-derived class must call this->destruct().
 			// TODO: This is an anti-pattern.
 		}
 
 		// Queries.
+		//
+		// In reactor mode, idle Workers are counted as well,
+		// even though they do not hold a thread. Threads
+		// include those of any shard ThreadPools.
 		virtual std::size_t workers() override {
-			return this->threadPool.getCTasks() - 1;
+			if (!this->reactors.empty()) {
+				return this->cReactorWorkers;
+			}
+
+			// Discount accept loops, one per shard.
+			std::size_t cTasks{this->threadPool.getCTasks() - 1 -
+				this->shardSockets.size()};
+			for (auto &shardThreadPool : this->shardThreadPools) {
+				cTasks += shardThreadPool->getCTasks();
+			}
+			return cTasks;
 		}
 		virtual std::size_t threads() override {
-			return this->threadPool.getCThreads();
+			std::size_t cThreads{this->threadPool.getCThreads()};
+			for (auto &shardThreadPool : this->shardThreadPools) {
+				cThreads += shardThreadPool->getCThreads();
+			}
+			return cThreads;
+		}
+
+		// Pool of Worker buffers, whose hits and misses
+		// report how often buffers are reused.
+		BufferPool &bufferPool() noexcept {
+			return this->_bufferPool;
 		}
 	};
 
@@ -10,6 +10,7 @@
 #include "../algorithm/algorithm.hpp"
 #include "../error/consume_throwable.hpp"
 #include "../functional.hpp"
+#include "../metrics.hpp"
 #include "../time/time.hpp"
 #include "../time/timeout.hpp"
 #include "exception.hpp"
@@ -19,7 +20,20 @@
 #include "specification.hpp"
 #include "wsa.hpp"
 
+#include <atomic>
 #include <memory>
+#include <span>
+#include <string_view>
+#include <utility>
+
+#ifdef RAIN_PLATFORM_LINUX
+	#include <signal.h>
+	#include <sys/sendfile.h>
+#elif defined(RAIN_PLATFORM_MACOS)
+	#include <sys/uio.h>
+#elif defined(RAIN_PLATFORM_WINDOWS)
+	#include <io.h>
+#endif
 
 namespace Rain::Networking {
 	// Basic managed RAII Socket type, encapsulating a
@@ -86,6 +100,13 @@ namespace Rain::Networking {
 				this->nativeSocket(), FIONBIO, &ioctlOpt));
 		}
 
+		// Optimistic Sockets attempt send and recv before
+		// polling, and only poll if they would block. Set with
+		// OptimisticSocketOption.
+		virtual bool isOptimistic() const noexcept {
+			return false;
+		}
+
 		// poll is enabled on all non-blocking sockets, and this
 		// encapsulates the events which may be returned/passed
 		// into poll.
@@ -366,6 +387,34 @@ namespace Rain::Networking {
 		using NamedSocketSpecInterface =
 			NamedSocketSpecInterface;
 
+		// Counts, across all Sockets, sends and recvs which were
+		// attempted before polling, and either completed
+		// (hits), or would have blocked and fell back to
+		// polling (misses).
+		class OptimisticCounters {
+			public:
+			std::atomic_size_t sendHits, sendMisses, recvHits,
+				recvMisses;
+		};
+		static inline OptimisticCounters optimisticCounters;
+
+		// Polls without waiting whether the Socket may be read,
+		// has been hung up by its peer, or has an error. Idle
+		// connections should have none of these before reuse.
+		bool isReadPending() {
+			return this->poll(PollFlag::READ_NORMAL, 0s) !=
+				PollFlag::NONE;
+		}
+
+		// Bytes sent and received across all connected
+		// Sockets.
+		static inline Metrics::Counter sentBytesMetric{
+			"rain_socket_sent_bytes_total",
+			"Bytes sent by connected Sockets."},
+			receivedBytesMetric{
+				"rain_socket_received_bytes_total",
+				"Bytes received by connected Sockets."};
+
 		// Throws if peer aborts. Returns 0 on timeout. Sends as
 		// many bytes as possible before timeout.
 		std::size_t send(
@@ -374,31 +423,47 @@ namespace Rain::Networking {
 			Time::Timeout timeout = 15s) {
 			std::size_t bytesSent{0};
 
+			// Optimistic Sockets skip the first poll. Any later
+			// send is only attempted once polled, since the
+			// previous send filled the kernel buffer.
+			bool isOptimistic{this->isOptimistic()};
 			while (bytesSent < bufferLen) {
 				// Poll until timeout or writeable so that send
 				// doesn't block.
 				if (
+					!isOptimistic &&
 					(this->poll(PollFlag::WRITE_NORMAL, timeout) &
 						PollFlag::WRITE_NORMAL) == PollFlag::NONE) {
-					return bytesSent;
+					break;
 				}
 
-				bytesSent += validateSystemCall(
-					::send(
-						this->nativeSocket(),
+				auto result{::send(
+					this->nativeSocket(),
 #ifdef RAIN_PLATFORM_WINDOWS
-						buffer,
-						static_cast<int>(bufferLen),
-						0));
+					buffer + bytesSent,
+					static_cast<int>(bufferLen - bytesSent),
+					0)};
 #else
-						reinterpret_cast<const void *>(buffer),
-						bufferLen,
-						// IMPORTANT! sending to a disconnected client
-						// on POSIX may generate SIGPIPE.
-						MSG_NOSIGNAL));
+					reinterpret_cast<const void *>(buffer + bytesSent),
+					bufferLen - bytesSent,
+					// IMPORTANT! sending to a disconnected client on
+					// POSIX may generate SIGPIPE.
+					MSG_NOSIGNAL)};
 #endif
+				if (isOptimistic) {
+					isOptimistic = false;
+					if (
+						result == NATIVE_SOCKET_ERROR &&
+						getSystemError() == Error::WOULD_BLOCK) {
+						this->optimisticCounters.sendMisses++;
+						continue;
+					}
+					this->optimisticCounters.sendHits++;
+				}
+				bytesSent += validateSystemCall(result);
 			}
-			return bytesSent; // Should equal bufferLen.
+			this->sentBytesMetric.add(bytesSent);
+			return bytesSent; // Should equal bufferLen on success.
 		}
 		std::size_t send(
 			std::string const &buffer,
@@ -407,6 +472,231 @@ namespace Rain::Networking {
 				&buffer[0], buffer.length(), timeout);
 		}
 
+		// Sends buffers in order, as with a single buffer,
+		// gathering up to MAX_SEND_BUFFERS of them per system
+		// call. Returns the number of bytes sent.
+		//
+		// As on optimistic Sockets, sending is attempted before
+		// polling, regardless of isOptimistic, since a
+		// non-blocking send fails immediately if it would block.
+		// Typically, this sends everything in one system call.
+		static std::size_t const MAX_SEND_BUFFERS{16};
+		std::size_t send(
+			std::span<std::string_view const> buffers,
+			Time::Timeout timeout = 15s) {
+			std::size_t bytesSent{0}, idx{0}, offset{0};
+
+			// Only the first attempt is counted as a hit or miss.
+			bool isFirst{true};
+			while (idx < buffers.size()) {
+				if (offset == buffers[idx].size()) {
+					idx++;
+					offset = 0;
+					continue;
+				}
+
+#ifdef RAIN_PLATFORM_WINDOWS
+				WSABUF vectors[MAX_SEND_BUFFERS];
+#else
+				iovec vectors[MAX_SEND_BUFFERS];
+#endif
+				std::size_t cVectors{0};
+				for (std::size_t jdx{idx}; jdx < buffers.size() &&
+						 cVectors < MAX_SEND_BUFFERS;
+						 jdx++) {
+					std::string_view buffer{buffers[jdx].substr(
+						jdx == idx ? offset : 0)};
+					if (buffer.empty()) {
+						continue;
+					}
+#ifdef RAIN_PLATFORM_WINDOWS
+					vectors[cVectors++] = {
+						static_cast<ULONG>(buffer.size()),
+						const_cast<char *>(buffer.data())};
+#else
+					vectors[cVectors++] = {
+						const_cast<char *>(buffer.data()),
+						buffer.size()};
+#endif
+				}
+
+#ifdef RAIN_PLATFORM_WINDOWS
+				DWORD cSent{0};
+				bool isSent{
+					WSASend(
+						this->nativeSocket(),
+						vectors,
+						static_cast<DWORD>(cVectors),
+						&cSent,
+						0,
+						nullptr,
+						nullptr) == 0};
+				std::size_t result{cSent};
+#else
+				msghdr message{};
+				message.msg_iov = vectors;
+				message.msg_iovlen = cVectors;
+				ssize_t cSent{sendmsg(
+					this->nativeSocket(), &message, MSG_NOSIGNAL)};
+				bool isSent{cSent != -1};
+				std::size_t result{
+					isSent ? static_cast<std::size_t>(cSent) : 0};
+#endif
+				if (!isSent) {
+					if (getSystemError() != Error::WOULD_BLOCK) {
+						throw Exception(getSystemError());
+					}
+					if (std::exchange(isFirst, false)) {
+						this->optimisticCounters.sendMisses++;
+					}
+					if (
+						(this->poll(PollFlag::WRITE_NORMAL, timeout) &
+							PollFlag::WRITE_NORMAL) == PollFlag::NONE) {
+						break;
+					}
+					continue;
+				}
+
+				// Advance past the sent bytes.
+				if (std::exchange(isFirst, false)) {
+					this->optimisticCounters.sendHits++;
+				}
+				bytesSent += result;
+				while (result > 0) {
+					std::size_t cBuffer{std::min(
+						result, buffers[idx].size() - offset)};
+					offset += cBuffer;
+					result -= cBuffer;
+					if (offset == buffers[idx].size()) {
+						idx++;
+						offset = 0;
+					}
+				}
+			}
+			this->sentBytesMetric.add(bytesSent);
+			return bytesSent;
+		}
+
+		// Sends length bytes of a file (a CRT file descriptor on
+		// Windows) from offset. Throws if peer aborts. Returns
+		// the number of bytes sent before timeout, end of file,
+		// or a read error.
+		//
+		// Uses sendfile(2) on Linux and MacOS, so that the file
+		// is not copied through user space. Otherwise, the file
+		// is read and sent in chunks.
+		std::size_t sendFile(
+			int file,
+			std::size_t offset,
+			std::size_t length,
+			Time::Timeout timeout = 15s) {
+#ifdef RAIN_PLATFORM_MACOS
+			// As with MSG_NOSIGNAL for send.
+			int const noSigPipe{1};
+			setsockopt(
+				this->nativeSocket(),
+				SOL_SOCKET,
+				SO_NOSIGPIPE,
+				&noSigPipe,
+				sizeof(noSigPipe));
+#endif
+
+			std::size_t bytesSent{0};
+			while (bytesSent < length) {
+				if (
+					(this->poll(PollFlag::WRITE_NORMAL, timeout) &
+						PollFlag::WRITE_NORMAL) == PollFlag::NONE) {
+					break;
+				}
+
+#ifdef RAIN_PLATFORM_LINUX
+				// sendfile cannot suppress SIGPIPE as send does, so
+				// SIGPIPE is blocked on this thread during the call,
+				// and consumed if raised.
+				sigset_t sigPipe, sigPrevious;
+				sigemptyset(&sigPipe);
+				sigaddset(&sigPipe, SIGPIPE);
+				pthread_sigmask(SIG_BLOCK, &sigPipe, &sigPrevious);
+				off_t fileOffset{
+					static_cast<off_t>(offset + bytesSent)};
+				ssize_t result{sendfile(
+					this->nativeSocket(),
+					file,
+					&fileOffset,
+					length - bytesSent)};
+				int error{errno};
+				if (result == -1 && error == EPIPE) {
+					timespec const zero{0, 0};
+					sigtimedwait(&sigPipe, nullptr, &zero);
+				}
+				pthread_sigmask(SIG_SETMASK, &sigPrevious, nullptr);
+				errno = error;
+				if (result == -1 && errno == EAGAIN) {
+					continue;
+				}
+				validateSystemCall(static_cast<int>(result));
+				if (result == 0) {
+					// End of file.
+					break;
+				}
+				bytesSent += static_cast<std::size_t>(result);
+				this->sentBytesMetric.add(
+					static_cast<std::size_t>(result));
+#elif defined(RAIN_PLATFORM_MACOS)
+				off_t cSent{static_cast<off_t>(length - bytesSent)};
+				int result{sendfile(
+					file,
+					this->nativeSocket(),
+					static_cast<off_t>(offset + bytesSent),
+					&cSent,
+					nullptr,
+					0)};
+				bytesSent += static_cast<std::size_t>(cSent);
+				this->sentBytesMetric.add(
+					static_cast<std::size_t>(cSent));
+				if (result == -1 && errno == EAGAIN) {
+					continue;
+				}
+				validateSystemCall(result);
+				if (cSent == 0) {
+					// End of file.
+					break;
+				}
+#else
+				char buffer[1_zu << 14];
+				std::size_t toRead{
+					std::min(sizeof(buffer), length - bytesSent)};
+	#ifdef RAIN_PLATFORM_WINDOWS
+				long long cRead{-1};
+				if (
+					_lseeki64(
+						file,
+						static_cast<long long>(offset + bytesSent),
+						SEEK_SET) != -1) {
+					cRead = _read(
+						file, buffer, static_cast<unsigned int>(toRead));
+				}
+	#else
+				ssize_t cRead{pread(
+					file,
+					buffer,
+					toRead,
+					static_cast<off_t>(offset + bytesSent))};
+	#endif
+				if (cRead <= 0) {
+					break;
+				}
+				std::size_t result{this->send(
+					buffer, static_cast<std::size_t>(cRead), timeout)};
+				bytesSent += result;
+				if (result < static_cast<std::size_t>(cRead)) {
+					break;
+				}
+#endif
+			}
+			return bytesSent;
+		}
+
 		// Throws if peer aborts. Returns 0 on graceful close OR
 		// timeout. Check for either case by checking if the
 		// timeout has passed.
@@ -414,16 +704,8 @@ namespace Rain::Networking {
 			char *buffer,
 			std::size_t bufferLen,
 			Time::Timeout timeout = 15s) {
-			// Poll until timeout or readable so that recv doesn't
-			// block.
-			if (
-				(this->poll(PollFlag::READ_NORMAL, timeout) &
-					PollFlag::READ_NORMAL) == PollFlag::NONE) {
-				return 0;
-			}
-
-			return validateSystemCall(
-				::recv(
+			auto const recvNow = [this, buffer, bufferLen]() {
+				return ::recv(
 					this->nativeSocket(),
 #ifdef RAIN_PLATFORM_WINDOWS
 					buffer,
@@ -432,7 +714,36 @@ namespace Rain::Networking {
 					reinterpret_cast<void *>(buffer),
 					bufferLen,
 #endif
-					0));
+					0);
+			};
+
+			// Optimistic Sockets only poll if recv would block.
+			if (this->isOptimistic()) {
+				auto result{recvNow()};
+				if (
+					result != NATIVE_SOCKET_ERROR ||
+					getSystemError() != Error::WOULD_BLOCK) {
+					this->optimisticCounters.recvHits++;
+					std::size_t cReceived{static_cast<std::size_t>(
+						validateSystemCall(result))};
+					this->receivedBytesMetric.add(cReceived);
+					return cReceived;
+				}
+				this->optimisticCounters.recvMisses++;
+			}
+
+			// Poll until timeout or readable so that recv doesn't
+			// block.
+			if (
+				(this->poll(PollFlag::READ_NORMAL, timeout) &
+					PollFlag::READ_NORMAL) == PollFlag::NONE) {
+				return 0;
+			}
+
+			std::size_t cReceived{static_cast<std::size_t>(
+				validateSystemCall(recvNow()))};
+			this->receivedBytesMetric.add(cReceived);
+			return cReceived;
 		}
 		std::size_t recv(
 			std::string &buffer,
@@ -486,6 +797,7 @@ namespace Rain::Networking {
 					shutdownRead();
 					break;
 				case ShutdownOpt::WRITE:
+					this->onShutdownWrite();
 					shutdownWrite();
 					break;
 				case ShutdownOpt::BOTH:
@@ -500,6 +812,7 @@ namespace Rain::Networking {
 					break;
 				case ShutdownOpt::GRACEFUL:
 				default:
+					this->onShutdownWrite();
 					shutdownWrite();
 
 					// At this point, it is plausible the peer has
@@ -536,6 +849,11 @@ namespace Rain::Networking {
 		Host peerHost() const {
 			return getNumericHost(this->peerName());
 		}
+
+		protected:
+		// Called before WRITE and GRACEFUL shutdowns, so that
+		// any bytes held back by subclasses may be sent first.
+		virtual void onShutdownWrite() {}
 	};
 
 	// No-op.
@@ -176,6 +176,69 @@ namespace Rain::Networking {
 		virtual void alreadyReuseAddressSocketOption() final {}
 	};
 
+	class ReusePortSocketOptionInterface :
+		virtual public SocketOptionInterface {};
+
+#ifndef RAIN_PLATFORM_WINDOWS
+	// Allows multiple Sockets to bind to the same address, as
+	// long as all of them set this option before bind. This
+	// is required by sharded Servers (see
+	// ServeOptions::shards).
+	//
+	// On Linux, the kernel balances incoming connections
+	// across all listening Sockets bound this way. Other
+	// platforms may deliver all connections to only one of
+	// them. SO_REUSEPORT is unavailable on Windows.
+	template<typename Socket>
+	class ReusePortSocketOption :
+		public Socket,
+		virtual public ReusePortSocketOptionInterface {
+		using Socket::Socket;
+
+		private:
+		class _ReusePortSocketOption {
+			public:
+			_ReusePortSocketOption(ReusePortSocketOption *that) {
+				SocketOptionInterface::setOption(
+					that->nativeSocket(),
+					SOL_SOCKET,
+					SO_REUSEPORT,
+					int{1});
+			}
+		};
+		_ReusePortSocketOption _reusePortSocketOption =
+			_ReusePortSocketOption(this);
+
+		virtual void alreadyReusePortSocketOption() final {}
+	};
+#endif
+
+	class OptimisticSocketOptionInterface :
+		virtual public SocketOptionInterface {};
+
+	// send and recv are attempted before polling, and only
+	// poll (with the same timeout, and on Workers, the Server
+	// interrupter) if they would block. This saves a poll per
+	// operation on busy Sockets, at the cost of a failed
+	// system call on idle ones. Hits are counted in
+	// ConnectedSocketSpecInterface::optimisticCounters.
+	//
+	// Since the interrupter is only polled on a miss, Workers
+	// on Sockets which are never idle notice Server
+	// destruction only once they are.
+	template<typename Socket>
+	class OptimisticSocketOption :
+		public Socket,
+		virtual public OptimisticSocketOptionInterface {
+		using Socket::Socket;
+
+		protected:
+		virtual bool isOptimistic()
+			const noexcept final override {
+			return true;
+		}
+	};
+
 	// TODO: SO_BINDTODEVICE and equivalent bind() on Windows.
 	// <https://stackoverflow.com/questions/33917575>.
 }
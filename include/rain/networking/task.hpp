@@ -0,0 +1,193 @@
+// Lazily-started coroutine type, for awaitable Socket
+// operations and coroutine Workers.
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <semaphore>
+#include <utility>
+
+namespace Rain::Networking {
+	template<typename Result>
+	class Task;
+
+	// Code-sharing between Task promises.
+	class TaskPromiseBase {
+		template<typename>
+		friend class Task;
+
+		private:
+		// Resumed once the Task completes, if it was awaited.
+		std::coroutine_handle<> continuation;
+		std::exception_ptr exception;
+
+		// Detached Tasks destroy themselves once they complete,
+		// and Tasks run by `get` release done.
+		bool detached{false};
+		std::binary_semaphore *done{nullptr};
+
+		class FinalAwaiter {
+			public:
+			bool await_ready() const noexcept { return false; }
+			template<typename Promise>
+			std::coroutine_handle<> await_suspend(
+				std::coroutine_handle<Promise> handle) noexcept {
+				TaskPromiseBase &promise{handle.promise()};
+				if (promise.continuation) {
+					return promise.continuation;
+				}
+				if (promise.detached) {
+					handle.destroy();
+				} else if (promise.done != nullptr) {
+					// The frame may be destroyed as soon as done is
+					// released.
+					promise.done->release();
+				}
+				return std::noop_coroutine();
+			}
+			void await_resume() const noexcept {}
+		};
+
+		protected:
+		void rethrow() const {
+			if (this->exception) {
+				std::rethrow_exception(this->exception);
+			}
+		}
+
+		public:
+		std::suspend_always initial_suspend() const noexcept {
+			return {};
+		}
+		FinalAwaiter final_suspend() const noexcept {
+			return {};
+		}
+		void unhandled_exception() noexcept {
+			this->exception = std::current_exception();
+		}
+	};
+
+	template<typename Result>
+	class TaskPromise : public TaskPromiseBase {
+		private:
+		std::optional<Result> value;
+
+		public:
+		void return_value(Result value) {
+			this->value.emplace(std::move(value));
+		}
+		Result result() {
+			this->rethrow();
+			return std::move(*this->value);
+		}
+	};
+	template<>
+	class TaskPromise<void> : public TaskPromiseBase {
+		public:
+		void return_void() const noexcept {}
+		void result() const { this->rethrow(); }
+	};
+
+	// Lazily-started coroutine which produces a Result, or
+	// throws.
+	//
+	// A Task begins once it is awaited, and resumes its
+	// awaiter by symmetric transfer on whichever thread it
+	// completes, so that chains of Tasks do not grow the
+	// stack. Top-level Tasks are instead begun with `get`,
+	// which blocks until the Task completes, or `detach`,
+	// which leaves it to run, and destroy itself, on its own.
+	//
+	// Default-constructed Tasks are empty, and may not be
+	// awaited nor begun.
+	template<typename Result = void>
+	class Task {
+		public:
+		class promise_type : public TaskPromise<Result> {
+			public:
+			Task get_return_object() noexcept {
+				return Task(
+					std::coroutine_handle<promise_type>::from_promise(
+						*this));
+			}
+		};
+
+		private:
+		std::coroutine_handle<promise_type> handle;
+
+		Task(
+			std::coroutine_handle<promise_type> handle) noexcept :
+			handle(handle) {}
+
+		public:
+		Task() noexcept = default;
+		Task(Task const &) = delete;
+		Task &operator=(Task const &) = delete;
+		Task(Task &&other) noexcept :
+			handle(std::exchange(other.handle, {})) {}
+		Task &operator=(Task &&other) noexcept {
+			if (this != &other) {
+				if (this->handle) {
+					this->handle.destroy();
+				}
+				this->handle = std::exchange(other.handle, {});
+			}
+			return *this;
+		}
+		~Task() {
+			if (this->handle) {
+				this->handle.destroy();
+			}
+		}
+
+		explicit operator bool() const noexcept {
+			return static_cast<bool>(this->handle);
+		}
+
+		auto operator co_await() && noexcept {
+			class Awaiter {
+				private:
+				std::coroutine_handle<promise_type> handle;
+
+				public:
+				Awaiter(std::coroutine_handle<promise_type>
+									handle) noexcept :
+					handle(handle) {}
+
+				bool await_ready() const noexcept {
+					return this->handle.done();
+				}
+				std::coroutine_handle<> await_suspend(
+					std::coroutine_handle<> continuation) noexcept {
+					this->handle.promise().continuation = continuation;
+					return this->handle;
+				}
+				Result await_resume() {
+					return this->handle.promise().result();
+				}
+			};
+			return Awaiter(this->handle);
+		}
+
+		// Runs the Task until it completes, blocking the
+		// calling thread if it suspends, and returns its
+		// result.
+		Result get() && {
+			std::binary_semaphore done{0};
+			this->handle.promise().done = &done;
+			this->handle.resume();
+			done.acquire();
+			return this->handle.promise().result();
+		}
+
+		// Begins the Task, and releases it to destroy itself
+		// once it completes. Exceptions from detached Tasks are
+		// discarded.
+		void detach() && {
+			auto handle{std::exchange(this->handle, {})};
+			handle.promise().detached = true;
+			handle.resume();
+		}
+	};
+}
@@ -8,9 +8,16 @@
 #pragma once
 
 #include "../../literal.hpp"
+#include "../buffer_pool.hpp"
 #include "../socket.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <iostream>
+#include <span>
+#include <string_view>
+#include <vector>
 
 namespace Rain::Networking::Tcp {
 	// TCP Sockets have the additional requirement that they
@@ -41,6 +48,66 @@ namespace Rain::Networking::Tcp {
 		using Socket::Socket;
 	};
 
+	// std::streambuf whose receive buffer may be read in
+	// place, so that protocol layers may parse received bytes
+	// without copying them out first.
+	class PeekableStreamBuf : public std::streambuf {
+		public:
+		// Bytes received but not yet consumed. Valid until the
+		// next call to any other method.
+		std::string_view peek() const noexcept {
+			return {
+				this->gptr(),
+				static_cast<std::size_t>(
+					this->egptr() - this->gptr())};
+		}
+
+		// Consumes bytes from the front of `peek`.
+		void consume(std::size_t count) noexcept {
+			this->gbump(static_cast<int>(count));
+		}
+
+		// Whether `peek` fills the receive buffer, in which
+		// case no more may be received until some are consumed.
+		virtual bool isFull() const noexcept = 0;
+
+		// Receives more bytes after those already in `peek`,
+		// moving them to the front of the buffer if necessary.
+		// Returns false if nothing was received, on timeout or
+		// close, or if the buffer is full.
+		virtual bool recvMore() = 0;
+	};
+
+	// Implemented by streambufs which can send a file
+	// directly to their Socket, without copying it through
+	// user space.
+	class FileSenderInterface {
+		public:
+		virtual ~FileSenderInterface() = default;
+
+		// Flushes any buffered bytes, then sends length bytes
+		// of the file (a CRT file descriptor on Windows) from
+		// offset. Returns the number of bytes sent, which is
+		// less than length on timeout or error.
+		virtual std::size_t sendFile(
+			int file,
+			std::size_t offset,
+			std::size_t length) = 0;
+	};
+
+	// Implemented by streambufs which can send buffers
+	// together with their own buffered bytes, without copying
+	// them into the send buffer first.
+	class VectoredSenderInterface {
+		public:
+		virtual ~VectoredSenderInterface() = default;
+
+		// Sends any buffered bytes, followed by buffers.
+		// Returns false on timeout or error.
+		virtual bool send(
+			std::span<std::string_view const> buffers) = 0;
+	};
+
 	// ConnectedSocket(Interface) in TCP protocol layer must
 	// provide subclassing for std::iostream.
 	class ConnectedSocketSpecInterface :
@@ -61,6 +128,23 @@ namespace Rain::Networking::Tcp {
 		// allow for easy virtual inheritance.
 		ConnectedSocketSpecInterface() :
 			std::iostream(nullptr) {}
+
+		// Pool from which the streambuf acquires its buffers.
+		virtual BufferPool &bufferPool() {
+			return BufferPool::global();
+		}
+
+		// Returns empty stream buffers to the pool, to be
+		// acquired anew once next needed. Buffers which hold
+		// unsent or unconsumed bytes are kept.
+		virtual void releaseBuffers() = 0;
+
+		// While corked, flushes and vectored sends hold bytes
+		// in the send buffer until it is full, so that several
+		// messages may be sent together. Uncorking does not
+		// send held bytes; the next flush, a recv which may
+		// block, or a WRITE or GRACEFUL shutdown, does.
+		virtual void cork(bool toCork = true) = 0;
 	};
 
 	// Must instantiate a valid std::iostream and underlying
@@ -73,6 +157,13 @@ namespace Rain::Networking::Tcp {
 	// per timeout period, send is not considered to have
 	// timed out. Thus, flush may consume upwards of
 	// (SEND_TIMEOUT_MS) * (SEND_BUFFER_LEN) time.
+	//
+	// Stream buffers are acquired from bufferPool on first
+	// use, at least SEND_BUFFER_LEN and RECV_BUFFER_LEN long.
+	// They grow to the next size class of the pool while
+	// throughput stays high: the send buffer once it fills
+	// twice without an explicit flush in between, and the
+	// receive buffer once a recv fills it.
 	template<typename Socket>
 	class ConnectedSocketSpec :
 		public Socket,
@@ -92,7 +183,10 @@ namespace Rain::Networking::Tcp {
 		private:
 		// A custom subclass of std::streambuf as underlying the
 		// std::iostream.
-		class TcpStreamBuf : public std::streambuf {
+		class TcpStreamBuf :
+			public PeekableStreamBuf,
+			public FileSenderInterface,
+			public VectoredSenderInterface {
 			private:
 			std::size_t const SEND_BUFFER_LEN, RECV_BUFFER_LEN;
 			long long const SEND_TIMEOUT_MS, RECV_TIMEOUT_MS;
@@ -101,9 +195,17 @@ namespace Rain::Networking::Tcp {
 			ConnectedSocketSpecInterface *socket;
 
 			// Internal buffer to prevent delegating to kernel
-			// send/recv too often. sendBuffer is actually 1
-			// larger than specified to allow for easy overflow.
-			char *sendBuffer, *recvBuffer;
+			// send/recv too often. The final character of
+			// sendBuffer is reserved to allow for easy overflow.
+			BufferPool::Buffer sendBuffer, recvBuffer;
+
+			// Overflows since the last explicit flush, and
+			// whether the last recv filled the receive buffer,
+			// which decide when the buffers grow.
+			std::size_t cOverflows{0};
+			bool isRecvFilled{false};
+
+			bool isCorked{false};
 
 			public:
 			TcpStreamBuf(
@@ -117,19 +219,10 @@ namespace Rain::Networking::Tcp {
 				SEND_TIMEOUT_MS{SEND_TIMEOUT_MS},
 				RECV_TIMEOUT_MS{RECV_TIMEOUT_MS},
 				socket(socket) {
-				this->sendBuffer =
-					new char[this->SEND_BUFFER_LEN + 1];
-				this->recvBuffer = new char[this->RECV_BUFFER_LEN];
-
-				// Set internal pointers corresponding to empty
-				// buffers.
-				this->setg(
-					this->recvBuffer,
-					this->recvBuffer,
-					this->recvBuffer);
-				this->setp(
-					this->sendBuffer,
-					this->sendBuffer + this->SEND_BUFFER_LEN);
+				// Set internal pointers corresponding to no
+				// buffers, until they are first used.
+				this->setg(nullptr, nullptr, nullptr);
+				this->setp(nullptr, nullptr);
 			}
 
 			// Disable copy construct/assignment and move
@@ -140,10 +233,22 @@ namespace Rain::Networking::Tcp {
 			TcpStreamBuf(TcpStreamBuf &&) = delete;
 			TcpStreamBuf &operator=(TcpStreamBuf &&) = delete;
 
-			// Free stack memory on destruct.
-			~TcpStreamBuf() {
-				delete[] this->sendBuffer;
-				delete[] this->recvBuffer;
+			void cork(bool toCork) noexcept {
+				this->isCorked = toCork;
+			}
+
+			// Returns empty buffers to the pool.
+			void release() noexcept {
+				if (this->pptr() == this->pbase()) {
+					this->sendBuffer.reset();
+					this->setp(nullptr, nullptr);
+					this->cOverflows = 0;
+				}
+				if (this->gptr() == this->egptr()) {
+					this->recvBuffer.reset();
+					this->setg(nullptr, nullptr, nullptr);
+					this->isRecvFilled = false;
+				}
 			}
 
 			protected:
@@ -153,15 +258,38 @@ namespace Rain::Networking::Tcp {
 				int_type ch = traits_type::eof()) override {
 				if (!traits_type::eq_int_type(
 							ch, traits_type::eof())) {
+					if (!this->sendBuffer) {
+						this->sendBuffer =
+							this->socket->bufferPool().acquire(
+								this->SEND_BUFFER_LEN + 1);
+						this->resetSendArea();
+						*this->pptr() = ch;
+						this->pbump(1);
+						return ch;
+					}
+
 					// Push ch to the send buffer (final character in
 					// sendBuffer is reserved by us).
 					*this->pptr() = ch;
 					this->pbump(1);
 
 					// Flush and empty the send buffer.
-					if (this->sync() == -1) {
+					if (this->flush() == -1) {
 						return traits_type::eof();
 					}
+
+					// Consecutive overflows grow the buffer, which is
+					// empty after the flush.
+					this->cOverflows++;
+					if (
+						this->cOverflows >= 2 &&
+						this->canGrow(this->sendBuffer)) {
+						this->cOverflows = 0;
+						this->sendBuffer =
+							this->socket->bufferPool().acquire(
+								this->sendBuffer.size() * 2);
+						this->resetSendArea();
+					}
 				}
 
 				return ch;
@@ -172,12 +300,30 @@ namespace Rain::Networking::Tcp {
 			virtual int_type underflow() override {
 				// Only refill buffer if it has been exhausted.
 				if (this->gptr() == this->egptr()) {
-					std::size_t result{0};
+					this->flushHeld();
+					// The buffer is empty, and may be replaced
+					// without copying.
+					if (!this->recvBuffer) {
+						this->recvBuffer =
+							this->socket->bufferPool().acquire(
+								this->RECV_BUFFER_LEN);
+					} else if (
+						this->isRecvFilled &&
+						this->canGrow(this->recvBuffer)) {
+						this->recvBuffer =
+							this->socket->bufferPool().acquire(
+								this->recvBuffer.size() * 2);
+					}
+					this->setg(
+						this->recvBuffer.data(),
+						this->recvBuffer.data(),
+						this->recvBuffer.data());
 
+					std::size_t result{0};
 					try {
 						result = this->socket->recv(
-							this->recvBuffer,
-							this->RECV_BUFFER_LEN,
+							this->recvBuffer.data(),
+							this->recvBuffer.size(),
 							std::chrono::milliseconds(
 								this->RECV_TIMEOUT_MS));
 					} catch (...) {
@@ -186,6 +332,8 @@ namespace Rain::Networking::Tcp {
 						// instead.
 					}
 
+					this->isRecvFilled =
+						result == this->recvBuffer.size();
 					if (result == 0) {
 						// The invariant this->gptr() == this->egptr()
 						// is maintained.
@@ -193,24 +341,175 @@ namespace Rain::Networking::Tcp {
 					}
 
 					this->setg(
-						this->recvBuffer,
-						this->recvBuffer,
-						this->recvBuffer + result);
+						this->recvBuffer.data(),
+						this->recvBuffer.data(),
+						this->recvBuffer.data() + result);
 				}
 
 				return traits_type::to_int_type(*this->gptr());
 			}
 
+			public:
+			// Full only once the buffer can grow no further.
+			virtual bool isFull() const noexcept override {
+				return static_cast<std::size_t>(
+								 this->egptr() - this->gptr()) ==
+					this->recvBuffer.size() &&
+					!this->canGrow(this->recvBuffer);
+			}
+			virtual bool recvMore() override {
+				std::size_t cBuffered{static_cast<std::size_t>(
+					this->egptr() - this->gptr())};
+				if (!this->recvBuffer) {
+					this->recvBuffer =
+						this->socket->bufferPool().acquire(
+							this->RECV_BUFFER_LEN);
+				} else if (
+					cBuffered == this->recvBuffer.size() &&
+					this->canGrow(this->recvBuffer)) {
+					// Full buffers grow, keeping their bytes.
+					BufferPool::Buffer buffer{
+						this->socket->bufferPool().acquire(
+							this->recvBuffer.size() * 2)};
+					std::memcpy(
+						buffer.data(), this->gptr(), cBuffered);
+					this->recvBuffer = std::move(buffer);
+				} else if (this->gptr() != this->recvBuffer.data()) {
+					std::memmove(
+						this->recvBuffer.data(), this->gptr(), cBuffered);
+				}
+				this->setg(
+					this->recvBuffer.data(),
+					this->recvBuffer.data(),
+					this->recvBuffer.data() + cBuffered);
+				if (cBuffered == this->recvBuffer.size()) {
+					return false;
+				}
+
+				this->flushHeld();
+
+				std::size_t result{0};
+				try {
+					result = this->socket->recv(
+						this->recvBuffer.data() + cBuffered,
+						this->recvBuffer.size() - cBuffered,
+						std::chrono::milliseconds(
+							this->RECV_TIMEOUT_MS));
+				} catch (...) {
+					// As with underflow, recv throws are consumed.
+				}
+				this->setg(
+					this->recvBuffer.data(),
+					this->recvBuffer.data(),
+					this->recvBuffer.data() + cBuffered + result);
+				return result != 0;
+			}
+
+			// As with sync, the timeout is per-progress.
+			virtual std::size_t sendFile(
+				int file,
+				std::size_t offset,
+				std::size_t length) override {
+				if (this->flush() == -1) {
+					return 0;
+				}
+				std::size_t bytesSent{0};
+				try {
+					while (bytesSent < length) {
+						std::size_t result{this->socket->sendFile(
+							file,
+							offset + bytesSent,
+							length - bytesSent,
+							std::chrono::milliseconds(
+								this->SEND_TIMEOUT_MS))};
+						if (result == 0) {
+							break;
+						}
+						bytesSent += result;
+					}
+				} catch (...) {
+					// As with sync, send throws are consumed.
+				}
+				return bytesSent;
+			}
+
+			// Buffered bytes and buffers are typically sent in one
+			// system call.
+			virtual bool send(
+				std::span<std::string_view const> buffers) override {
+				// Corked buffers are held if they fit.
+				if (this->isCorked) {
+					if (!this->sendBuffer) {
+						this->sendBuffer =
+							this->socket->bufferPool().acquire(
+								this->SEND_BUFFER_LEN + 1);
+						this->resetSendArea();
+					}
+					std::size_t cBytes{0};
+					for (std::string_view const &buffer : buffers) {
+						cBytes += buffer.size();
+					}
+					if (
+						cBytes <= static_cast<std::size_t>(
+											this->epptr() - this->pptr())) {
+						for (std::string_view const &buffer : buffers) {
+							std::copy(
+								buffer.begin(), buffer.end(), this->pptr());
+							this->pbump(static_cast<int>(buffer.size()));
+						}
+						return true;
+					}
+				}
+
+				std::string_view buffered{
+					this->pbase(),
+					static_cast<std::size_t>(
+						this->pptr() - this->pbase())};
+				bool isSent;
+				if (
+					buffers.size() <
+					ConnectedSocketSpecInterface::MAX_SEND_BUFFERS) {
+					std::array<
+						std::string_view,
+						ConnectedSocketSpecInterface::MAX_SEND_BUFFERS>
+						all;
+					all[0] = buffered;
+					std::copy(
+						buffers.begin(), buffers.end(), all.begin() + 1);
+					isSent = this->sendAll(
+						{all.data(), buffers.size() + 1});
+				} else {
+					std::vector<std::string_view> all{
+						buffers.begin(), buffers.end()};
+					isSent = this->flush() != -1 && this->sendAll(all);
+				}
+				if (isSent) {
+					this->resetSendArea();
+				}
+				return isSent;
+			}
+
+			protected:
 			// Write available buffer to the socket.
 			virtual int sync() override {
-				// Send available buffer.
+				// Corked flushes wait for the buffer to fill.
+				if (this->isCorked) {
+					return 0;
+				}
+				this->cOverflows = 0;
+				return this->flush();
+			}
+
+			private:
+			// Sends and empties the send buffer.
+			int flush() {
 				try {
 					std::size_t bytesSent{0},
 						bytesTotal{static_cast<std::size_t>(
 							this->pptr() - this->pbase())};
 					while (bytesSent < bytesTotal) {
 						auto result = this->socket->send(
-							this->sendBuffer + bytesSent,
+							this->pbase() + bytesSent,
 							bytesTotal - bytesSent,
 							std::chrono::milliseconds(
 								this->SEND_TIMEOUT_MS));
@@ -226,12 +525,68 @@ namespace Rain::Networking::Tcp {
 				}
 
 				// Mark the send buffer as empty.
-				this->setp(
-					this->sendBuffer,
-					this->sendBuffer + this->SEND_BUFFER_LEN);
+				this->resetSendArea();
 
 				return 0;
 			}
+
+			// Sends bytes held while corked before a recv which
+			// may block, as the peer may be waiting on them.
+			void flushHeld() {
+				if (
+					this->isCorked && this->pptr() != this->pbase()) {
+					this->flush();
+				}
+			}
+
+			// Empties the send area of sendBuffer.
+			void resetSendArea() noexcept {
+				if (!this->sendBuffer) {
+					this->setp(nullptr, nullptr);
+					return;
+				}
+				this->setp(
+					this->sendBuffer.data(),
+					this->sendBuffer.data() + this->sendBuffer.size() -
+						1);
+			}
+
+			// Whether buffer may grow to a larger size class.
+			bool canGrow(
+				BufferPool::Buffer const &buffer) const noexcept {
+				return buffer.size() <
+					this->socket->bufferPool().maxLength();
+			}
+
+			// Sends buffers, dropping them as they are sent. As
+			// with sync, the timeout is per-progress.
+			bool sendAll(std::span<std::string_view> buffers) {
+				try {
+					while (true) {
+						while (!buffers.empty() && buffers[0].empty()) {
+							buffers = buffers.subspan(1);
+						}
+						if (buffers.empty()) {
+							return true;
+						}
+						std::size_t result{this->socket->send(
+							std::span<std::string_view const>(buffers),
+							std::chrono::milliseconds(
+								this->SEND_TIMEOUT_MS))};
+						if (result == 0) {
+							return false;
+						}
+						for (std::size_t idx{0}; result > 0; idx++) {
+							std::size_t cSent{
+								std::min(result, buffers[idx].size())};
+							buffers[idx].remove_prefix(cSent);
+							result -= cSent;
+						}
+					}
+				} catch (...) {
+					return false;
+				}
+			}
 		};
 
 		// Internally holds the stream buffer.
@@ -254,7 +609,20 @@ namespace Rain::Networking::Tcp {
 		// Syntax necessary to differentiate from function.
 		_ConnectedSocketSpec _connectedSocketSpec{this};
 
+		// Held bytes are sent before shutting down writes.
+		virtual void onShutdownWrite() override {
+			this->tcpStreamBuf.cork(false);
+			this->tcpStreamBuf.pubsync();
+		}
+
 		public:
+		virtual void releaseBuffers() override {
+			this->tcpStreamBuf.release();
+		}
+		virtual void cork(bool toCork = true) override {
+			this->tcpStreamBuf.cork(toCork);
+		}
+
 		// Curry constructor to set timeout values.
 		//
 		// Using a curry constructor requires a non-deducing (no
@@ -12,7 +12,21 @@ namespace Rain::Networking::Tcp {
 
 	class WorkerSocketSpecInterface :
 		virtual public WorkerSocketSpecInterfaceInterface,
-		virtual public Networking::WorkerSocketSpecInterface {};
+		virtual public Networking::WorkerSocketSpecInterface {
+		public:
+		// Workers share the BufferPool of their Server.
+		virtual BufferPool &bufferPool() override {
+			BufferPool *bufferPool{this->serverBufferPool()};
+			return bufferPool == nullptr ? BufferPool::global()
+																	 : *bufferPool;
+		}
+
+		protected:
+		// Idle Workers hold no buffers.
+		virtual void onWorkIdle() override {
+			this->releaseBuffers();
+		}
+	};
 
 	// Worker specialization for TCP protocol Sockets.
 	template<typename Socket>
@@ -20,6 +34,15 @@ namespace Rain::Networking::Tcp {
 		public Socket,
 		virtual public WorkerSocketSpecInterface {
 		using Socket::Socket;
+
+		private:
+		// Idle Workers in reactor mode time out just as their
+		// recv would.
+		virtual std::chrono::milliseconds
+			onWorkIdleTimeout() override {
+			return std::chrono::milliseconds(
+				this->RECV_TIMEOUT_MS);
+		}
 	};
 
 	// Shorthand, but importantly names *SocketSpec, which is
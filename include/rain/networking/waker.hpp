@@ -0,0 +1,66 @@
+// Socket which wakes a thread polling on it from any other
+// thread.
+#pragma once
+
+#include "exception.hpp"
+#include "resolve.hpp"
+#include "socket.hpp"
+
+namespace Rain::Networking {
+	// UDP Socket bound to loopback and connected to itself.
+	// Each wake sends it a datagram, so that it is readable
+	// until drained, and may be polled alongside other
+	// Sockets.
+	class Waker :
+		public Socket<
+			Ipv4FamilyInterface,
+			DGramTypeInterface,
+			UdpProtocolInterface> {
+		public:
+		using Socket<
+			Ipv4FamilyInterface,
+			DGramTypeInterface,
+			UdpProtocolInterface>::nativeSocket;
+
+		Waker() {
+			AddressInfo addressInfo{
+				getAddressInfos(
+					{"127.0.0.1", "0"},
+					Family::INET,
+					Type::DGRAM,
+					Protocol::UDP,
+					AddressInfo::Flag::NUMERICHOST)
+					.at(0)};
+			validateSystemCall(::bind(
+				this->nativeSocket(),
+				reinterpret_cast<sockaddr const *>(
+					&addressInfo.address),
+				static_cast<socklen_t>(addressInfo.addressLen)));
+			socklen_t addressLen{
+				static_cast<socklen_t>(sizeof(addressInfo.address))};
+			validateSystemCall(getsockname(
+				this->nativeSocket(),
+				reinterpret_cast<sockaddr *>(&addressInfo.address),
+				&addressLen));
+			validateSystemCall(::connect(
+				this->nativeSocket(),
+				reinterpret_cast<sockaddr const *>(
+					&addressInfo.address),
+				addressLen));
+		}
+
+		// Thread-safe. Wakes which fail to send are dropped,
+		// which only happens once many are pending.
+		void wake() noexcept {
+			::send(this->nativeSocket(), "\0", 1, 0);
+		}
+
+		// Consumes pending wakes, without blocking.
+		void drain() noexcept {
+			char buffer;
+			while (::recv(this->nativeSocket(), &buffer, 1, 0) !=
+				NATIVE_SOCKET_ERROR) {
+			}
+		}
+	};
+}
@@ -0,0 +1,11 @@
+// Includes all /websocket headers.
+#pragma once
+
+#include "websocket/client.hpp"
+#include "websocket/close_code.hpp"
+#include "websocket/frame.hpp"
+#include "websocket/message.hpp"
+#include "websocket/opcode.hpp"
+#include "websocket/per_message_deflate.hpp"
+#include "websocket/socket.hpp"
+#include "websocket/worker.hpp"
@@ -0,0 +1,165 @@
+// WebSocket Client, which upgrades from HTTP.
+#pragma once
+
+#include "../../data/sha_1.hpp"
+#include "../../error/exception.hpp"
+#include "../../string/base_64.hpp"
+#include "../http/client.hpp"
+#include "socket.hpp"
+
+#include <random>
+
+namespace Rain::Networking::WebSocket {
+	class ClientSocketSpecInterfaceInterface :
+		virtual public Http::ClientSocketSpecInterfaceInterface,
+		virtual public WebSocket::ConnectedSocketSpecInterface {
+		public:
+		enum class Error { HANDSHAKE_FAILED = 1 };
+		class ErrorCategory : public std::error_category {
+			public:
+			char const *name() const noexcept {
+				return "Rain::Networking::WebSocket::Client";
+			}
+			std::string message(int error) const noexcept {
+				switch (static_cast<Error>(error)) {
+					case Error::HANDSHAKE_FAILED:
+						return "WebSocket handshake failed.";
+					default:
+						return "Generic.";
+				}
+			}
+		};
+		using Exception =
+			Rain::Error::Exception<Error, ErrorCategory>;
+	};
+
+	template<
+		typename RequestMessageSpec,
+		typename ResponseMessageSpec>
+	class ClientSocketSpecInterface :
+		virtual public ClientSocketSpecInterfaceInterface,
+		virtual public Http::ClientSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec> {
+		public:
+		using Http::ClientSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec>::send;
+		using Http::ClientSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec>::recv;
+		using WebSocket::ConnectedSocketSpecInterface::send;
+		using WebSocket::ConnectedSocketSpecInterface::recv;
+	};
+
+	// WebSocket Client (RFC 6455), which speaks HTTP until
+	// `upgrade`, and then sends and receives Messages.
+	template<
+		typename RequestMessageSpec,
+		typename ResponseMessageSpec,
+		typename Socket>
+	class ClientSocketSpec :
+		public Socket,
+		virtual public ClientSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec> {
+		using Socket::Socket;
+
+		public:
+		using ClientSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec>::send;
+		using ClientSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec>::recv;
+
+		// Performs the opening handshake for target on host,
+		// offering permessage-deflate if toDeflate. Throws if
+		// the server does not switch protocols.
+		void upgrade(
+			std::string const &host,
+			std::string const &target = "/",
+			bool toDeflate = false) {
+			thread_local std::mt19937 generator{
+				std::random_device()()};
+			std::string nonce(16, '\0');
+			for (char &byte : nonce) {
+				byte = static_cast<char>(generator());
+			}
+			std::string const key{String::Base64::encode(nonce)};
+
+			RequestMessageSpec req{
+				Http::Method::GET,
+				target,
+				{{{"Host", host},
+					{"Upgrade", "websocket"},
+					{"Connection", "Upgrade"},
+					{"Sec-WebSocket-Key", key},
+					{"Sec-WebSocket-Version", "13"}}}};
+			if (toDeflate) {
+				req.headers["Sec-WebSocket-Extensions"] =
+					PerMessageDeflate::offer();
+			}
+			this->send(req);
+
+			ResponseMessageSpec res;
+			this->recv(res);
+			auto const acceptIt{
+				res.headers.find("Sec-WebSocket-Accept")};
+			if (
+				res.statusCode !=
+					Http::StatusCode::SWITCHING_PROTOCOLS ||
+				acceptIt == res.headers.end() ||
+				acceptIt->second !=
+					String::Base64::encode(Data::Sha1::digest(
+						key + std::string(HANDSHAKE_GUID)))) {
+				throw typename ClientSocketSpec::Exception(
+					ClientSocketSpec::Error::HANDSHAKE_FAILED);
+			}
+			auto const extensionsIt{
+				res.headers.find("Sec-WebSocket-Extensions")};
+			if (extensionsIt != res.headers.end()) {
+				this->perMessageDeflate =
+					PerMessageDeflate::confirm(extensionsIt->second);
+				if (
+					!toDeflate || this->perMessageDeflate == nullptr) {
+					throw typename ClientSocketSpec::Exception(
+						ClientSocketSpec::Error::HANDSHAKE_FAILED);
+				}
+			}
+		}
+
+		private:
+		virtual bool isMasking() override { return true; }
+	};
+
+	// Shorthand, but importantly names *SocketSpec, which is
+	// consistent across each layer, and overwritten by the
+	// next protocol layer, useful for deducing types on the
+	// previous layer (e.g. for TLS).
+	template<
+		typename RequestMessageSpec = Http::Request,
+		typename ResponseMessageSpec = Http::Response,
+		typename SocketFamilyInterface = Ipv4FamilyInterface,
+		template<typename> class... SocketOptions>
+	class Client :
+		public ClientSocketSpec<
+			RequestMessageSpec,
+			ResponseMessageSpec,
+			Http::Client<
+				RequestMessageSpec,
+				ResponseMessageSpec,
+				SocketFamilyInterface,
+				SocketOptions...>> {
+		public:
+		using ClientSocketSpec = ClientSocketSpec<
+			RequestMessageSpec,
+			ResponseMessageSpec,
+			Http::Client<
+				RequestMessageSpec,
+				ResponseMessageSpec,
+				SocketFamilyInterface,
+				SocketOptions...>>;
+		using ClientSocketSpec::ClientSocketSpec;
+	};
+}
@@ -0,0 +1,33 @@
+// WebSocket close status codes.
+#pragma once
+
+#include <cstdint>
+
+namespace Rain::Networking::WebSocket {
+	// Status codes of close frames (RFC 6455 7.4.1).
+	// NO_STATUS and ABNORMAL are never sent.
+	enum class CloseCode : std::uint16_t {
+		NORMAL = 1000,
+		GOING_AWAY = 1001,
+		PROTOCOL_ERROR = 1002,
+		UNSUPPORTED_DATA = 1003,
+		NO_STATUS = 1005,
+		ABNORMAL = 1006,
+		INVALID_PAYLOAD = 1007,
+		POLICY_VIOLATION = 1008,
+		MESSAGE_TOO_BIG = 1009,
+		MANDATORY_EXTENSION = 1010,
+		INTERNAL_ERROR = 1011
+	};
+
+	// Whether code may be sent in a close frame: those
+	// defined above, other than NO_STATUS and ABNORMAL, and
+	// those reserved for libraries and applications.
+	inline bool isValid(CloseCode code) noexcept {
+		std::uint16_t const value{
+			static_cast<std::uint16_t>(code)};
+		return (value >= 1000 && value <= 1003) ||
+			(value >= 1007 && value <= 1011) ||
+			(value >= 3000 && value <= 4999);
+	}
+}
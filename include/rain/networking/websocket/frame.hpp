@@ -0,0 +1,165 @@
+// Zero-copy parsing and serialization of WebSocket frame
+// heads, and payload masking.
+#pragma once
+
+#include "../../literal.hpp"
+#include "opcode.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+#endif
+
+namespace Rain::Networking::WebSocket {
+	// Head of a frame (RFC 6455 5.2), which precedes its
+	// payload.
+	class FrameHead {
+		public:
+		// Longest head: two bytes, an eight-byte payload
+		// length, and a masking key.
+		static std::size_t const MAX_LEN{14};
+
+		// Returned by parse for malformed heads.
+		static std::size_t const MALFORMED{SIZE_MAX};
+
+		bool fin{true}, rsv1{false};
+		Opcode opcode{Opcode::TEXT};
+		bool isMasked{false};
+		std::array<char, 4> maskingKey{};
+		std::uint64_t payloadLen{0};
+
+		// Parses a head from the front of buffered, in place.
+		// Returns its length, zero if buffered does not yet
+		// hold all of it, or MALFORMED if RSV2 or RSV3 are set,
+		// the opcode is reserved, a control frame is fragmented
+		// or longer than 125 bytes, or the payload length is
+		// over 2^63.
+		std::size_t parse(std::string_view buffered) noexcept {
+			if (buffered.size() < 2) {
+				return 0;
+			}
+			auto const first{
+				static_cast<unsigned char>(buffered[0])},
+				second{static_cast<unsigned char>(buffered[1])};
+			this->fin = (first & 0x80) != 0;
+			this->rsv1 = (first & 0x40) != 0;
+			this->opcode = static_cast<Opcode>(first & 0x0f);
+			this->isMasked = (second & 0x80) != 0;
+			this->payloadLen = second & 0x7f;
+			std::uint8_t const opcode{
+				static_cast<std::uint8_t>(this->opcode)};
+			if (
+				(first & 0x30) != 0 ||
+				(opcode > 0x2 && opcode < 0x8) || opcode > 0xa ||
+				(isControl(this->opcode) &&
+					(!this->fin || this->payloadLen > 125))) {
+				return MALFORMED;
+			}
+
+			std::size_t const cLenBytes{
+				this->payloadLen == 126       ? 2_zu
+					: this->payloadLen == 127 ? 8_zu
+																		: 0_zu},
+				len{2 + cLenBytes + (this->isMasked ? 4 : 0)};
+			if (buffered.size() < len) {
+				return 0;
+			}
+			if (cLenBytes != 0) {
+				this->payloadLen = 0;
+				for (std::size_t idx{0}; idx < cLenBytes; idx++) {
+					this->payloadLen = this->payloadLen << 8 |
+						static_cast<unsigned char>(buffered[2 + idx]);
+				}
+				if (this->payloadLen >> 63 != 0) {
+					return MALFORMED;
+				}
+			}
+			if (this->isMasked) {
+				std::memcpy(
+					this->maskingKey.data(),
+					buffered.data() + 2 + cLenBytes,
+					4);
+			}
+			return len;
+		}
+
+		// Serializes into buffer, which must hold MAX_LEN
+		// bytes, with the shortest payload length. Returns the
+		// length serialized.
+		std::size_t serialize(char *buffer) const noexcept {
+			buffer[0] = static_cast<char>(
+				(this->fin ? 0x80 : 0) | (this->rsv1 ? 0x40 : 0) |
+				static_cast<std::uint8_t>(this->opcode));
+			char const maskBit{
+				static_cast<char>(this->isMasked ? 0x80 : 0)};
+			std::size_t len{2};
+			if (this->payloadLen < 126) {
+				buffer[1] = static_cast<char>(
+					maskBit | static_cast<char>(this->payloadLen));
+			} else {
+				std::size_t const cLenBytes{
+					this->payloadLen <= 0xffff ? 2_zu : 8_zu};
+				buffer[1] = static_cast<char>(
+					maskBit | (cLenBytes == 2 ? 126 : 127));
+				for (std::size_t idx{0}; idx < cLenBytes; idx++) {
+					buffer[len++] = static_cast<char>(
+						this->payloadLen >> ((cLenBytes - 1 - idx) * 8));
+				}
+			}
+			if (this->isMasked) {
+				std::memcpy(
+					buffer + len, this->maskingKey.data(), 4);
+				len += 4;
+			}
+			return len;
+		}
+	};
+
+	// XORs len bytes of from with maskingKey, beginning at
+	// offset into the key, into to, which may be from.
+	// Masking and unmasking are the same. Bytes are masked
+	// 16 at a time with SSE2 where available, and 8 at a time
+	// otherwise.
+	inline void mask(
+		char *to,
+		char const *from,
+		std::size_t len,
+		std::array<char, 4> const &maskingKey,
+		std::size_t offset = 0) noexcept {
+		// The key, repeated from offset.
+		char pattern[16];
+		for (std::size_t idx{0}; idx < 16; idx++) {
+			pattern[idx] = maskingKey[(offset + idx) % 4];
+		}
+
+		std::size_t idx{0};
+#if defined(__SSE2__) || defined(_M_X64)
+		__m128i const patternWide{_mm_loadu_si128(
+			reinterpret_cast<__m128i const *>(pattern))};
+		for (; len - idx >= 16; idx += 16) {
+			_mm_storeu_si128(
+				reinterpret_cast<__m128i *>(to + idx),
+				_mm_xor_si128(
+					_mm_loadu_si128(
+						reinterpret_cast<__m128i const *>(from + idx)),
+					patternWide));
+		}
+#endif
+		std::uint64_t patternWord;
+		std::memcpy(&patternWord, pattern, 8);
+		for (; len - idx >= 8; idx += 8) {
+			std::uint64_t word;
+			std::memcpy(&word, from + idx, 8);
+			word ^= patternWord;
+			std::memcpy(to + idx, &word, 8);
+		}
+		for (; idx < len; idx++) {
+			to[idx] =
+				static_cast<char>(from[idx] ^ pattern[idx % 4]);
+		}
+	}
+}
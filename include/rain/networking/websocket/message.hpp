@@ -0,0 +1,22 @@
+// WebSocket messages.
+#pragma once
+
+#include "opcode.hpp"
+
+#include <string>
+
+namespace Rain::Networking::WebSocket {
+	// A data message, which may be sent or received in one or
+	// more frames. Payloads of TEXT messages are UTF-8.
+	class Message {
+		public:
+		Opcode opcode;
+		std::string payload;
+
+		explicit Message(
+			std::string payload = {},
+			Opcode opcode = Opcode::TEXT) :
+			opcode(opcode),
+			payload(std::move(payload)) {}
+	};
+}
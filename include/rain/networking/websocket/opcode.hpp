@@ -0,0 +1,21 @@
+// WebSocket frame opcodes.
+#pragma once
+
+#include <cstdint>
+
+namespace Rain::Networking::WebSocket {
+	// Opcodes of frames (RFC 6455 5.2). Opcodes from CLOSE
+	// are control frames, which may not be fragmented.
+	enum class Opcode : std::uint8_t {
+		CONTINUATION = 0x0,
+		TEXT = 0x1,
+		BINARY = 0x2,
+		CLOSE = 0x8,
+		PING = 0x9,
+		PONG = 0xa
+	};
+
+	inline bool isControl(Opcode opcode) noexcept {
+		return static_cast<std::uint8_t>(opcode) >= 0x8;
+	}
+}
@@ -0,0 +1,216 @@
+// The permessage-deflate WebSocket extension.
+#pragma once
+
+#include "../../data/deflate.hpp"
+#include "../../string/string.hpp"
+
+#include <charconv>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace Rain::Networking::WebSocket {
+	// permessage-deflate (RFC 7692), which compresses the
+	// payload of each message with DEFLATE, marked by RSV1 on
+	// its first frame.
+	//
+	// Sent messages are always compressed without context
+	// takeover, so that each may be decompressed alone.
+	// Received messages may use context takeover, unless
+	// no_context_takeover was negotiated for the peer.
+	class PerMessageDeflate {
+		private:
+		Data::Deflate::Compressor compressor;
+		Data::Deflate::Decompressor decompressor;
+
+		// Whether the peer compresses without context
+		// takeover, in which case the window is not kept.
+		bool const isPeerResetting;
+
+		public:
+		PerMessageDeflate(
+			std::size_t windowBits,
+			bool isPeerResetting) :
+			compressor(windowBits),
+			isPeerResetting(isPeerResetting) {}
+
+		// Accepts the first offer in a Sec-WebSocket-Extensions
+		// request header which is supported, and sets response
+		// to the extension to respond with. Returns nullptr if
+		// none is supported.
+		static std::unique_ptr<PerMessageDeflate> accept(
+			std::string_view offers,
+			std::string &response) {
+			while (!offers.empty()) {
+				std::size_t const comma{offers.find(',')};
+				std::string_view offer{offers.substr(
+					0, std::min(comma, offers.size()))};
+				offers.remove_prefix(
+					comma == std::string_view::npos ? offers.size()
+																					: comma + 1);
+
+				std::size_t windowBits{15};
+				bool isSupported{true}, isServerResetting{false},
+					isClientResetting{false};
+				std::string_view const name{
+					PerMessageDeflate::nextParameter(offer)};
+				if (name != "permessage-deflate") {
+					continue;
+				}
+				while (!offer.empty() && isSupported) {
+					std::string_view parameter{
+						PerMessageDeflate::nextParameter(offer)};
+					std::size_t const equals{parameter.find('=')};
+					std::string_view const key{String::trimWhitespace(
+						parameter.substr(
+							0, std::min(equals, parameter.size())))},
+						value{
+							equals == std::string_view::npos
+								? std::string_view()
+								: PerMessageDeflate::unquote(
+										parameter.substr(equals + 1))};
+					if (key == "server_no_context_takeover") {
+						isServerResetting = true;
+					} else if (key == "client_no_context_takeover") {
+						isClientResetting = true;
+					} else if (key == "server_max_window_bits") {
+						isSupported =
+							PerMessageDeflate::parseWindowBits(
+								value, windowBits);
+					} else if (key != "client_max_window_bits") {
+						// client_max_window_bits needs no response,
+						// since the window of the Decompressor is
+						// not limited.
+						isSupported = false;
+					}
+				}
+				if (!isSupported) {
+					continue;
+				}
+
+				response = "permessage-deflate";
+				if (isServerResetting) {
+					response += "; server_no_context_takeover";
+				}
+				if (isClientResetting) {
+					response += "; client_no_context_takeover";
+				}
+				if (windowBits != 15) {
+					response +=
+						"; server_max_window_bits=" +
+						std::to_string(windowBits);
+				}
+				return std::make_unique<PerMessageDeflate>(
+					windowBits, isClientResetting);
+			}
+			return nullptr;
+		}
+
+		// Offer for a Sec-WebSocket-Extensions request header.
+		static std::string offer() {
+			return "permessage-deflate; "
+						 "client_no_context_takeover";
+		}
+
+		// From the Sec-WebSocket-Extensions response header to
+		// offer, or nullptr if it was declined.
+		static std::unique_ptr<PerMessageDeflate> confirm(
+			std::string_view response) {
+			std::size_t windowBits{15};
+			bool isServerResetting{false};
+			if (
+				PerMessageDeflate::nextParameter(response) !=
+				"permessage-deflate") {
+				return nullptr;
+			}
+			while (!response.empty()) {
+				std::string_view parameter{
+					PerMessageDeflate::nextParameter(response)};
+				std::size_t const equals{parameter.find('=')};
+				std::string_view const key{String::trimWhitespace(
+					parameter.substr(
+						0, std::min(equals, parameter.size())))};
+				if (key == "server_no_context_takeover") {
+					isServerResetting = true;
+				} else if (
+					key == "client_max_window_bits" &&
+					equals != std::string_view::npos) {
+					PerMessageDeflate::parseWindowBits(
+						PerMessageDeflate::unquote(
+							parameter.substr(equals + 1)),
+						windowBits);
+				}
+			}
+			return std::make_unique<PerMessageDeflate>(
+				windowBits, isServerResetting);
+		}
+
+		// Compresses a payload, appending to out.
+		void compress(std::string_view in, std::string &out) {
+			this->compressor.compress(in, out);
+
+			// The trailing empty block is implied.
+			out.resize(out.size() - 4);
+		}
+
+		// Decompresses a payload, appending to out. in is
+		// modified. Returns false if it is malformed, or
+		// longer than maxLen.
+		bool decompress(
+			std::string &in,
+			std::string &out,
+			std::size_t maxLen) {
+			if (this->isPeerResetting) {
+				this->decompressor.reset();
+			}
+			in.append("\x00\x00\xff\xff", 4);
+			if (!this->decompressor.decompress(in, out, maxLen)) {
+				this->decompressor.reset();
+				return false;
+			}
+			return true;
+		}
+
+		private:
+		// Removes and returns the next `;`-separated parameter,
+		// trimmed.
+		static std::string_view nextParameter(
+			std::string_view &parameters) {
+			std::size_t const semicolon{parameters.find(';')};
+			std::string_view const parameter{
+				String::trimWhitespace(parameters.substr(
+					0, std::min(semicolon, parameters.size())))};
+			parameters.remove_prefix(
+				semicolon == std::string_view::npos
+					? parameters.size()
+					: semicolon + 1);
+			return parameter;
+		}
+
+		static std::string_view unquote(std::string_view value) {
+			value = String::trimWhitespace(value);
+			if (
+				value.size() >= 2 && value.front() == '"' &&
+				value.back() == '"') {
+				value = value.substr(1, value.size() - 2);
+			}
+			return value;
+		}
+
+		// Window bits from 8 to 15.
+		static bool parseWindowBits(
+			std::string_view value,
+			std::size_t &windowBits) {
+			std::size_t bits;
+			if (
+				std::from_chars(
+					value.data(), value.data() + value.size(), bits)
+						.ptr != value.data() + value.size() ||
+				value.empty() || bits < 8 || bits > 15) {
+				return false;
+			}
+			windowBits = bits;
+			return true;
+		}
+	};
+}
@@ -0,0 +1,471 @@
+// WebSocket frame engine, shared by Workers and Clients
+// once the connection is upgraded.
+#pragma once
+
+#include "../../error/consume_throwable.hpp"
+#include "../../literal.hpp"
+#include "../../string/string.hpp"
+#include "../tcp/socket.hpp"
+#include "close_code.hpp"
+#include "frame.hpp"
+#include "message.hpp"
+#include "per_message_deflate.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace Rain::Networking::WebSocket {
+	// GUID appended to Sec-WebSocket-Key before hashing, for
+	// Sec-WebSocket-Accept.
+	inline std::string_view const HANDSHAKE_GUID{
+		"258EAFA5-E914-47DA-95CA-C5AB0DC85B11"};
+
+	// Sends and receives messages as frames (RFC 6455 5) on
+	// an upgraded connection.
+	//
+	// Frame heads are parsed in place in the receive buffer,
+	// and payloads are unmasked as they are copied out of it,
+	// so that each received byte is copied once. Unmasked
+	// payloads are sent directly from the message, in one
+	// vectored send with their head.
+	//
+	// Control frames received between the fragments of a
+	// message are answered as they arrive. Sockets are not
+	// thread-safe; messages should be sent from the thread
+	// which receives them.
+	class ConnectedSocketSpecInterface :
+		virtual public Tcp::ConnectedSocketSpecInterface {
+		public:
+		using Tcp::ConnectedSocketSpecInterface::send;
+		using Tcp::ConnectedSocketSpecInterface::recv;
+
+		// Longest message received, after decompression.
+		// Longer messages close the connection with
+		// MESSAGE_TOO_BIG.
+		std::size_t maxMessageLen{1_zu << 24};
+
+		// Longer messages are sent in fragments of this length.
+		std::size_t fragmentLen{1_zu << 16};
+
+		// Shorter messages are not compressed, even with
+		// permessage-deflate.
+		std::size_t compressMinLen{1_zu << 6};
+
+		protected:
+		// Negotiated in the handshake, else nullptr.
+		std::unique_ptr<PerMessageDeflate> perMessageDeflate;
+
+		// Once a close frame is sent, no more may be sent.
+		bool isCloseSent{false};
+
+		private:
+		// Reused across messages.
+		std::string maskedBuffer, inflatedBuffer;
+
+		// Clients mask sent frames, and Workers do not.
+		virtual bool isMasking() = 0;
+
+		public:
+		// Sends a data message, fragmented by fragmentLen, and
+		// compressed if permessage-deflate was negotiated and
+		// it is at least compressMinLen long. Sets badbit on
+		// failure.
+		void send(Message const &message) {
+			std::string_view payload{message.payload};
+			bool const isCompressed{
+				this->perMessageDeflate != nullptr &&
+				payload.size() >= this->compressMinLen};
+			if (isCompressed) {
+				this->inflatedBuffer.clear();
+				this->perMessageDeflate->compress(
+					payload, this->inflatedBuffer);
+				payload = this->inflatedBuffer;
+			}
+
+			Opcode opcode{message.opcode};
+			bool rsv1{isCompressed};
+			do {
+				std::string_view const fragment{
+					payload.substr(0, this->fragmentLen)};
+				payload.remove_prefix(fragment.size());
+				this->sendFrame(
+					payload.empty(), rsv1, opcode, fragment);
+				opcode = Opcode::CONTINUATION;
+				rsv1 = false;
+			} while (!payload.empty() && this->good());
+		}
+
+		// Receives the next data message, answering control
+		// frames as they arrive. Returns false once the
+		// connection is closed by either end, or on a
+		// malformed frame or timeout, after which a close frame
+		// has been sent if possible, and the Socket should be
+		// shut down.
+		bool recv(Message &message) {
+			message.payload.clear();
+			bool isContinuing{false}, isCompressed{false};
+			while (true) {
+				FrameHead head;
+				if (!this->recvHead(head)) {
+					return this->fail(CloseCode::PROTOCOL_ERROR);
+				}
+				if (
+					head.isMasked == this->isMasking() ||
+					(head.rsv1 &&
+						(this->perMessageDeflate == nullptr ||
+							head.opcode == Opcode::CONTINUATION ||
+							isControl(head.opcode)))) {
+					return this->fail(CloseCode::PROTOCOL_ERROR);
+				}
+
+				if (isControl(head.opcode)) {
+					char payload[125];
+					std::size_t const len{
+						static_cast<std::size_t>(head.payloadLen)};
+					if (!this->recvPayload(head, payload)) {
+						return this->fail(CloseCode::ABNORMAL);
+					}
+					if (head.opcode == Opcode::PING) {
+						this->sendFrame(
+							true, false, Opcode::PONG, {payload, len});
+					} else if (head.opcode == Opcode::CLOSE) {
+						return this->onCloseFrame({payload, len});
+					}
+					continue;
+				}
+
+				if (
+					(head.opcode == Opcode::CONTINUATION) !=
+					isContinuing) {
+					return this->fail(CloseCode::PROTOCOL_ERROR);
+				}
+				if (!isContinuing) {
+					message.opcode = head.opcode;
+					isCompressed = head.rsv1;
+					isContinuing = true;
+				}
+				if (
+					head.payloadLen >
+					this->maxMessageLen - message.payload.size()) {
+					return this->fail(CloseCode::MESSAGE_TOO_BIG);
+				}
+				std::size_t const begin{message.payload.size()};
+				message.payload.resize(
+					begin + static_cast<std::size_t>(head.payloadLen));
+				if (!this->recvPayload(
+							head, message.payload.data() + begin)) {
+					return this->fail(CloseCode::ABNORMAL);
+				}
+				if (head.fin) {
+					break;
+				}
+			}
+
+			if (isCompressed) {
+				this->inflatedBuffer.clear();
+				if (!this->perMessageDeflate->decompress(
+							message.payload,
+							this->inflatedBuffer,
+							this->maxMessageLen)) {
+					return this->fail(CloseCode::INVALID_PAYLOAD);
+				}
+				message.payload.swap(this->inflatedBuffer);
+			}
+			if (
+				message.opcode == Opcode::TEXT &&
+				!ConnectedSocketSpecInterface::isUtf8(
+					message.payload)) {
+				return this->fail(CloseCode::INVALID_PAYLOAD);
+			}
+			return true;
+		}
+
+		// Sends a ping, whose pong is consumed by recv.
+		void ping(std::string_view payload = {}) {
+			this->sendFrame(
+				true, false, Opcode::PING, payload.substr(0, 125));
+		}
+
+		// Sends a close frame, once. recv then returns false
+		// once the peer responds in kind.
+		void close(
+			CloseCode code = CloseCode::NORMAL,
+			std::string_view reason = {}) {
+			if (this->isCloseSent) {
+				return;
+			}
+			std::uint16_t const value{
+				static_cast<std::uint16_t>(code)};
+			char payload[125]{
+				static_cast<char>(value >> 8),
+				static_cast<char>(value)};
+			reason = reason.substr(0, 123);
+			reason.copy(payload + 2, reason.size());
+			this->sendFrame(
+				true,
+				false,
+				Opcode::CLOSE,
+				{payload, reason.size() + 2});
+			this->isCloseSent = true;
+		}
+
+		protected:
+		// Whether a comma-separated header contains token,
+		// case-insensitively.
+		static bool hasToken(
+			std::string_view list,
+			std::string_view token) {
+			while (!list.empty()) {
+				std::size_t const comma{list.find(',')};
+				std::string_view const item{String::trimWhitespace(
+					list.substr(0, std::min(comma, list.size())))};
+				if (std::equal(
+							item.begin(),
+							item.end(),
+							token.begin(),
+							token.end(),
+							[](char left, char right) {
+								return std::tolower(left) ==
+									std::tolower(right);
+							})) {
+					return true;
+				}
+				list.remove_prefix(
+					comma == std::string_view::npos ? list.size()
+																					: comma + 1);
+			}
+			return false;
+		}
+
+		private:
+		void sendFrame(
+			bool fin,
+			bool rsv1,
+			Opcode opcode,
+			std::string_view payload) {
+			if (this->isCloseSent) {
+				return;
+			}
+			FrameHead head{
+				fin,
+				rsv1,
+				opcode,
+				this->isMasking(),
+				{},
+				payload.size()};
+			if (head.isMasked) {
+				thread_local std::mt19937 generator{
+					std::random_device()()};
+				std::uint32_t const key{
+					static_cast<std::uint32_t>(generator())};
+				std::memcpy(head.maskingKey.data(), &key, 4);
+				this->maskedBuffer.resize(payload.size());
+				mask(
+					this->maskedBuffer.data(),
+					payload.data(),
+					payload.size(),
+					head.maskingKey);
+				payload = this->maskedBuffer;
+			}
+			char headBuffer[FrameHead::MAX_LEN];
+			std::string_view const buffers[]{
+				{headBuffer, head.serialize(headBuffer)}, payload};
+
+			Tcp::VectoredSenderInterface *vectoredSender{
+				dynamic_cast<Tcp::VectoredSenderInterface *>(
+					this->rdbuf())};
+			if (vectoredSender != nullptr) {
+				if (!vectoredSender->send(buffers)) {
+					this->setstate(std::ios::badbit);
+				}
+				return;
+			}
+			for (std::string_view buffer : buffers) {
+				this->write(
+					buffer.data(),
+					static_cast<std::streamsize>(buffer.size()));
+			}
+			this->flush();
+		}
+
+		// Parses the next head in place in the receive buffer
+		// if possible. Returns false on timeout, close, or a
+		// malformed head.
+		bool recvHead(FrameHead &head) {
+			Tcp::PeekableStreamBuf *peekable{
+				dynamic_cast<Tcp::PeekableStreamBuf *>(
+					this->rdbuf())};
+			if (peekable != nullptr) {
+				while (true) {
+					std::size_t const len{
+						head.parse(peekable->peek())};
+					if (len == FrameHead::MALFORMED) {
+						return false;
+					} else if (len != 0) {
+						peekable->consume(len);
+						return true;
+					} else if (!peekable->recvMore()) {
+						return false;
+					}
+				}
+			}
+
+			// Otherwise, the length of the head is known from its
+			// first two bytes.
+			char buffer[FrameHead::MAX_LEN];
+			if (!this->read(buffer, 2)) {
+				return false;
+			}
+			std::size_t const lenCode{
+				static_cast<std::size_t>(buffer[1] & 0x7f)},
+				len{
+					2_zu +
+					(lenCode == 126       ? 2_zu
+						 : lenCode == 127 ? 8_zu
+															: 0_zu) +
+					((buffer[1] & 0x80) != 0 ? 4_zu : 0_zu)};
+			return this->read(buffer + 2, len - 2) &&
+				head.parse({buffer, len}) == len;
+		}
+
+		// Receives and unmasks the payload of head into to.
+		bool recvPayload(FrameHead const &head, char *to) {
+			std::size_t const len{
+				static_cast<std::size_t>(head.payloadLen)};
+			Tcp::PeekableStreamBuf *peekable{
+				dynamic_cast<Tcp::PeekableStreamBuf *>(
+					this->rdbuf())};
+			if (peekable == nullptr) {
+				if (!this->read(
+							to, static_cast<std::streamsize>(len))) {
+					return false;
+				}
+				if (head.isMasked) {
+					mask(to, to, len, head.maskingKey);
+				}
+				return true;
+			}
+
+			for (std::size_t offset{0}; offset < len;) {
+				std::string_view buffered{peekable->peek()};
+				if (buffered.empty()) {
+					if (!peekable->recvMore()) {
+						return false;
+					}
+					continue;
+				}
+				buffered = buffered.substr(0, len - offset);
+				if (head.isMasked) {
+					mask(
+						to + offset,
+						buffered.data(),
+						buffered.size(),
+						head.maskingKey,
+						offset);
+				} else {
+					std::memcpy(
+						to + offset, buffered.data(), buffered.size());
+				}
+				peekable->consume(buffered.size());
+				offset += buffered.size();
+			}
+			return true;
+		}
+
+		// Responds to a close frame from the peer, echoing its
+		// code, and returns false.
+		bool onCloseFrame(std::string_view payload) {
+			CloseCode code{CloseCode::NORMAL};
+			if (payload.size() == 1) {
+				code = CloseCode::PROTOCOL_ERROR;
+			} else if (payload.size() >= 2) {
+				code = static_cast<CloseCode>(
+					static_cast<unsigned char>(payload[0]) << 8 |
+					static_cast<unsigned char>(payload[1]));
+				if (!isValid(code)) {
+					code = CloseCode::PROTOCOL_ERROR;
+				} else if (!ConnectedSocketSpecInterface::isUtf8(
+										 payload.substr(2))) {
+					code = CloseCode::INVALID_PAYLOAD;
+				}
+			}
+			Rain::Error::consumeThrowable(
+				[this, code]() { this->close(code); })();
+			return false;
+		}
+
+		// Sends a close frame with code, if possible, and
+		// returns false.
+		bool fail(CloseCode code) {
+			if (code != CloseCode::ABNORMAL && this->good()) {
+				Rain::Error::consumeThrowable(
+					[this, code]() { this->close(code); })();
+			}
+			return false;
+		}
+
+		// Whether str is well-formed UTF-8, without overlong
+		// encodings or surrogates. Runs of ASCII are skipped a
+		// word at a time.
+		static bool isUtf8(std::string_view str) noexcept {
+			std::size_t idx{0};
+			while (idx < str.size()) {
+				std::uint64_t word;
+				if (idx + 8 <= str.size()) {
+					std::memcpy(&word, str.data() + idx, 8);
+					if ((word & 0x8080808080808080) == 0) {
+						idx += 8;
+						continue;
+					}
+				}
+				unsigned char const byte{
+					static_cast<unsigned char>(str[idx])};
+				if (byte < 0x80) {
+					idx++;
+					continue;
+				}
+				std::size_t len;
+				std::uint32_t codePoint, min;
+				if ((byte & 0xe0) == 0xc0) {
+					len = 2;
+					codePoint = byte & 0x1f;
+					min = 0x80;
+				} else if ((byte & 0xf0) == 0xe0) {
+					len = 3;
+					codePoint = byte & 0x0f;
+					min = 0x800;
+				} else if ((byte & 0xf8) == 0xf0) {
+					len = 4;
+					codePoint = byte & 0x07;
+					min = 0x10000;
+				} else {
+					return false;
+				}
+				if (str.size() - idx < len) {
+					return false;
+				}
+				for (std::size_t offset{1}; offset < len; offset++) {
+					unsigned char const next{
+						static_cast<unsigned char>(str[idx + offset])};
+					if ((next & 0xc0) != 0x80) {
+						return false;
+					}
+					codePoint = codePoint << 6 | (next & 0x3f);
+				}
+				if (
+					codePoint < min || codePoint > 0x10ffff ||
+					(codePoint >= 0xd800 && codePoint <= 0xdfff)) {
+					return false;
+				}
+				idx += len;
+			}
+			return true;
+		}
+	};
+}
@@ -0,0 +1,248 @@
+// WebSocket Worker, which upgrades from HTTP.
+#pragma once
+
+#include "../../data/sha_1.hpp"
+#include "../../string/base_64.hpp"
+#include "../http/worker.hpp"
+#include "socket.hpp"
+
+namespace Rain::Networking::WebSocket {
+	template<
+		typename RequestMessageSpec,
+		typename ResponseMessageSpec>
+	class WorkerSocketSpecInterface :
+		virtual public Http::WorkerSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec>,
+		virtual public WebSocket::ConnectedSocketSpecInterface {
+		public:
+		using Http::WorkerSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec>::send;
+		using Http::WorkerSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec>::recv;
+		using WebSocket::ConnectedSocketSpecInterface::send;
+		using WebSocket::ConnectedSocketSpecInterface::recv;
+
+		protected:
+		// Idle duration after which upgraded connections are
+		// pinged, to keep them and any intermediaries alive.
+		virtual std::chrono::milliseconds
+			onWebSocketPingInterval() {
+			return this->onWorkIdleTimeout() / 2;
+		}
+
+		// Waits until a frame begins to arrive, pinging the
+		// peer after onWebSocketPingInterval of silence.
+		// Returns false, after sending a close frame, if the
+		// peer stays silent for onWorkIdleTimeout, or the
+		// Server is interrupted.
+		bool awaitFrame() {
+			Tcp::PeekableStreamBuf *peekable{
+				dynamic_cast<Tcp::PeekableStreamBuf *>(
+					this->rdbuf())};
+			if (peekable == nullptr || !peekable->peek().empty()) {
+				return true;
+			}
+			auto const timeBegin{std::chrono::steady_clock::now()};
+			auto const timePing{
+				timeBegin + this->onWebSocketPingInterval()},
+				timeClose{timeBegin + this->onWorkIdleTimeout()};
+			bool isPinged{false};
+			while (true) {
+				auto const timeUntil{
+					isPinged ? timeClose : timePing};
+				PollFlag const revents{this->poll(
+					PollFlag::READ_NORMAL, Time::Timeout(timeUntil))};
+				if (revents != PollFlag::NONE) {
+					return true;
+				}
+				if (std::chrono::steady_clock::now() < timeUntil) {
+					// Interrupted by the Server.
+					break;
+				}
+				if (isPinged) {
+					break;
+				}
+				this->ping();
+				isPinged = true;
+				if (!this->good()) {
+					return false;
+				}
+			}
+			this->close(CloseCode::GOING_AWAY);
+			return false;
+		}
+
+		private:
+		virtual bool isMasking() override { return false; }
+	};
+
+	// WebSocket Worker (RFC 6455), which serves HTTP until a
+	// filter returns `upgrade`, after which onMessage is
+	// called with each message received on the connection.
+	//
+	// Upgraded connections hold their thread until closed,
+	// in reactor mode as well. They are pinged once idle for
+	// onWebSocketPingInterval, and closed once idle for
+	// onWorkIdleTimeout. onWorkRequestTimeout, if set, bounds
+	// the whole of the upgraded connection.
+	template<
+		typename RequestMessageSpec,
+		typename ResponseMessageSpec,
+		typename Socket>
+	class WorkerSocketSpec :
+		public Socket,
+		virtual public WorkerSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec> {
+		using Socket::Socket;
+
+		public:
+		using WorkerSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec>::send;
+		using WorkerSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec>::recv;
+
+		protected:
+		using typename Http::WorkerSocketSpecInterface<
+			RequestMessageSpec,
+			ResponseMessageSpec>::ResponseAction;
+
+		// Responds to a handshake request with 101 (Switching
+		// Protocols), negotiating permessage-deflate if
+		// toDeflate and the client offers it. Malformed
+		// handshakes are responded to with 400 (Bad Request),
+		// or 426 (Upgrade Required) for other versions.
+		ResponseAction upgrade(
+			RequestMessageSpec &req,
+			bool toDeflate = false) {
+			auto const headerHasToken{[&req](
+																	std::string const &key,
+																	std::string_view token) {
+				auto const [begin, end]{
+					req.headers.equal_range(key)};
+				for (auto it{begin}; it != end; it++) {
+					if (WorkerSocketSpec::hasToken(
+								it->second, token)) {
+						return true;
+					}
+				}
+				return false;
+			}};
+			if (
+				req.method != Http::Method::GET ||
+				req.version != Http::Version::_1_1 ||
+				!headerHasToken("Upgrade", "websocket") ||
+				!headerHasToken("Connection", "upgrade")) {
+				return {
+					ResponseMessageSpec{Http::StatusCode::BAD_REQUEST},
+					true};
+			}
+			if (!headerHasToken("Sec-WebSocket-Version", "13")) {
+				return {
+					ResponseMessageSpec{
+						Http::StatusCode::UPGRADE_REQUIRED,
+						{{{"Sec-WebSocket-Version", "13"}}}},
+					true};
+			}
+			auto const keyIt{
+				req.headers.find("Sec-WebSocket-Key")};
+			if (
+				keyIt == req.headers.end() ||
+				keyIt->second.size() != 24 ||
+				String::Base64::decode(keyIt->second).size() != 16) {
+				return {
+					ResponseMessageSpec{Http::StatusCode::BAD_REQUEST},
+					true};
+			}
+
+			ResponseMessageSpec res{
+				Http::StatusCode::SWITCHING_PROTOCOLS,
+				{{{"Upgrade", "websocket"},
+					{"Connection", "Upgrade"},
+					{"Sec-WebSocket-Accept",
+						String::Base64::encode(Data::Sha1::digest(
+							keyIt->second +
+							std::string(HANDSHAKE_GUID)))}}}};
+			auto const extensionsIt{
+				req.headers.find("Sec-WebSocket-Extensions")};
+			if (toDeflate && extensionsIt != req.headers.end()) {
+				std::string extensions;
+				this->perMessageDeflate = PerMessageDeflate::accept(
+					extensionsIt->second, extensions);
+				if (this->perMessageDeflate != nullptr) {
+					res.headers["Sec-WebSocket-Extensions"] =
+						extensions;
+				}
+			}
+			return {std::move(res)};
+		}
+
+		// Called with each message received once upgraded.
+		// Throwing closes the connection with INTERNAL_ERROR.
+		virtual void onMessage(Message &message) = 0;
+
+		private:
+		// Receives and handles messages until the connection
+		// is closed.
+		virtual bool onUpgrade(
+			RequestMessageSpec &req) override {
+			// The HTTP/2 connection preface is not spoken here.
+			if (req.method == Http::Method::PRI) {
+				return true;
+			}
+
+			Rain::Error::consumeThrowable([this]() {
+				// The 101 may have been held behind another request.
+				this->cork(false);
+				this->flush();
+
+				Message message;
+				while (this->awaitFrame() && this->recv(message)) {
+					try {
+						this->onMessage(message);
+					} catch (...) {
+						this->close(CloseCode::INTERNAL_ERROR);
+						throw;
+					}
+				}
+				this->shutdown();
+			})();
+			return true;
+		}
+	};
+
+	// Shorthand, but importantly names *SocketSpec, which is
+	// consistent across each layer, and overwritten by the
+	// next protocol layer, useful for deducing types on the
+	// previous layer (e.g. for TLS).
+	template<
+		typename RequestMessageSpec = Http::Request,
+		typename ResponseMessageSpec = Http::Response,
+		typename SocketFamilyInterface = Ipv4FamilyInterface,
+		template<typename> class... SocketOptions>
+	class Worker :
+		public WorkerSocketSpec<
+			RequestMessageSpec,
+			ResponseMessageSpec,
+			Http::Worker<
+				RequestMessageSpec,
+				ResponseMessageSpec,
+				SocketFamilyInterface,
+				SocketOptions...>> {
+		public:
+		using WorkerSocketSpec = WorkerSocketSpec<
+			RequestMessageSpec,
+			ResponseMessageSpec,
+			Http::Worker<
+				RequestMessageSpec,
+				ResponseMessageSpec,
+				SocketFamilyInterface,
+				SocketOptions...>>;
+		using WorkerSocketSpec::WorkerSocketSpec;
+	};
+}
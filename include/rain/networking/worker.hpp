@@ -3,7 +3,11 @@
 // requirements only satisfiable by ServerSocket(Interface).
 #pragma once
 
+#include "../multithreading/thread_pool.hpp"
+#include "buffer_pool.hpp"
+#include "reactor.hpp"
 #include "socket.hpp"
+#include "task.hpp"
 
 namespace Rain::Networking {
 	class WorkerSocketSpecInterfaceInterface :
@@ -16,11 +20,61 @@ namespace Rain::Networking {
 		friend class ServerSocketSpec;
 
 		private:
-		// Provides access to interrupter socket.
+		// Reactor which owns the Worker in reactor mode, set by
+		// the Server before work begins. Null in thread mode.
+		Reactor *_reactor{nullptr};
+
+		// Reactor on which Deadlines are scheduled: _reactor in
+		// reactor mode, and the timer Reactor of the Server in
+		// thread mode, once Deadlines are enabled. Deadlines do
+		// nothing without one.
+		Reactor *_timerReactor{nullptr};
+
+		// BufferPool of the Server, set before work begins.
+		BufferPool *_bufferPool{nullptr};
+
+		// ThreadPool on which the Server runs the Worker, set
+		// before work begins.
+		Multithreading::ThreadPool *_threadPool{nullptr};
+
+		virtual void onWork() {}
+
+		// In reactor mode (see ServeOptions), Workers do not
+		// hold a thread while idle. Instead, onWorkBegin is
+		// called once after the Worker is constructed, and
+		// onWorkReady is called on a pool thread each time the
+		// Socket becomes readable. Both return false to keep
+		// the Worker waiting for the next readiness, and true
+		// once it is done.
+		//
+		// By default, a Worker runs onWork to completion on its
+		// first readiness.
+		virtual bool onWorkBegin() { return false; }
+		virtual bool onWorkReady() {
+			this->onWork();
+			return true;
+		}
+
+		// Coroutine Workers return their work as a Task, which
+		// is used in place of all of the above. In reactor
+		// mode, the Server begins the Task once the Worker is
+		// constructed, and it then owns the Worker until the
+		// Task completes; the Task should await readiness on
+		// `reactor` so that it is resumed on its event loop. In
+		// thread mode, the Task is run to completion on the
+		// Worker thread.
+		//
+		// Other Workers return an empty Task.
+		virtual Task<> onCoWork() { return {}; }
+
+		protected:
+		// Provides access to interrupter socket, which is
+		// readable once the Server is interrupted.
 		virtual SocketInterface *interrupter() = 0;
 
 		// Override the base SocketInterface poll with a
 		// two-Socket poll to listen to interrupts from Server.
+		// Returns NONE early once interrupted.
 		virtual PollFlag poll(
 			PollFlag event,
 			Time::Timeout timeout = 15s) override {
@@ -30,7 +84,90 @@ namespace Rain::Networking {
 				timeout)[0];
 		}
 
-		virtual void onWork() {}
+		// Reactor assigned to the Worker by the Server, in
+		// reactor mode, on which the Worker may await. nullptr
+		// in thread mode, where awaits should block instead.
+		Reactor *reactor() const noexcept {
+			return this->_reactor;
+		}
+
+		// BufferPool owned by the Server, from which protocol
+		// layers may acquire their buffers. May be nullptr.
+		BufferPool *serverBufferPool() const noexcept {
+			return this->_bufferPool;
+		}
+
+		// ThreadPool on which the Server runs the Worker, to
+		// which protocol layers may hand work of their own. May
+		// be nullptr.
+		Multithreading::ThreadPool *serverThreadPool()
+			const noexcept {
+			return this->_threadPool;
+		}
+
+		// Called before the Worker waits for its Socket to be
+		// readable while idle in reactor mode, so that it may
+		// release anything it does not need until then.
+		// Coroutine Workers should call it themselves before
+		// awaiting a request.
+		virtual void onWorkIdle() {}
+
+		// In reactor mode, Workers which are not readable
+		// within this duration after a call to onWorkBegin or
+		// onWorkReady are destroyed.
+		virtual std::chrono::milliseconds onWorkIdleTimeout() {
+			return 15s;
+		}
+
+		// Deadlines for protocol layers, after the first byte
+		// of a request is received, by which its head must be
+		// received, and by which it must be responded to.
+		// Workers which miss them are shut down. Zero disables
+		// the deadline.
+		virtual std::chrono::milliseconds onWorkHeadTimeout() {
+			return 0ms;
+		}
+		virtual std::chrono::milliseconds onWorkRequestTimeout() {
+			return 0ms;
+		}
+
+		// Shuts down the Worker in both directions if it is
+		// still alive by its timeout, so that any operation
+		// blocked on it fails. The timer is cancelled on
+		// destruction.
+		//
+		// Deadlines are kept on the TimerWheel of the Server,
+		// and do not hold a thread.
+		class Deadline {
+			private:
+			Reactor *const reactor;
+			Time::TimerWheel::Id const timer;
+
+			public:
+			Deadline(
+				WorkerSocketSpecInterface &worker,
+				std::chrono::milliseconds timeout) :
+				reactor(worker._timerReactor),
+				timer(
+					this->reactor == nullptr || timeout == 0ms
+						? 0
+						: this->reactor->schedule(timeout, [&worker]() {
+								Rain::Error::consumeThrowable([&worker]() {
+									worker.shutdown(ShutdownOpt::BOTH);
+								})();
+							})) {}
+			~Deadline() {
+				if (this->reactor != nullptr) {
+					this->reactor->cancel(this->timer);
+				}
+			}
+
+			// Forbid copy/move.
+			Deadline(Deadline const &) = delete;
+			Deadline &operator=(Deadline const &) = delete;
+			Deadline(Deadline &&) = delete;
+			Deadline &operator=(Deadline &&) = delete;
+		};
 	};
 	// Socket specialization: the templated Worker interface,
 	// and its protocol implementation with the basic Socket.
@@ -50,6 +187,7 @@ namespace Rain::Networking {
 		// Interrupt socket from the server.
 		SocketInterface *_interrupter;
 
+		protected:
 		virtual SocketInterface *interrupter() override {
 			return this->_interrupter;
 		}
@@ -27,6 +27,7 @@
 #include <locale>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <unordered_set>
 
 namespace Rain {
@@ -81,6 +82,22 @@ namespace Rain::String {
 		return str;
 	}
 
+	// Trim whitespace characters from both sides of a
+	// std::string_view, without copying.
+	inline std::string_view trimWhitespace(
+		std::string_view str) {
+		auto const isSpace = [](unsigned char c) {
+			return std::isspace(static_cast<int>(c)) != 0;
+		};
+		while (!str.empty() && isSpace(str.front())) {
+			str.remove_prefix(1);
+		}
+		while (!str.empty() && isSpace(str.back())) {
+			str.remove_suffix(1);
+		}
+		return str;
+	}
+
 	// For C-Strings, instead of trimming whitespace, these
 	// utilities find the first/last non-whitespace character
 	// in the string.
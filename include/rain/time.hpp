@@ -3,3 +3,4 @@
 
 #include "time/time.hpp"
 #include "time/timeout.hpp"
+#include "time/timer_wheel.hpp"
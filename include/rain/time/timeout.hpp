@@ -58,16 +58,23 @@ namespace Rain::Time {
 		// POSIX functions treat -1 as infinite timeout, 0 as an
 		// immediate timeout, and otherwise the int as a
 		// duration in ms until timeout.
+		//
+		// The clock is read only once, lest a timeout which
+		// passes in between be returned as -1. Durations are
+		// rounded up, so that callers do not spin on 0 until the
+		// timeout.
 		int asInt() const noexcept {
 			if (this->isInfinite()) {
 				return -1;
-			} else if (this->isPassed()) {
+			}
+			auto const duration{this->asDuration()};
+			if (duration <= duration.zero()) {
 				return 0;
-			} else {
-				return static_cast<int>(std::chrono::duration_cast<
-					std::chrono::milliseconds>(this->asDuration())
-						.count());
 			}
+			return static_cast<int>(
+				std::chrono::ceil<std::chrono::milliseconds>(
+					duration)
+					.count());
 		}
 
 		// Conversion operators.
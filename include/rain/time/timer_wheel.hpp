@@ -0,0 +1,376 @@
+// Hierarchical timer wheel, with O(1) schedule and cancel.
+#pragma once
+
+#include "../error/consume_throwable.hpp"
+#include "../functional/move_only_function.hpp"
+#include "timeout.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <source_location>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Rain::Time {
+	// Hierarchical timer wheel (Varghese & Lauck), with O(1)
+	// schedule and cancel.
+	//
+	// Time is divided into ticks of a fixed resolution.
+	// Timers due within SLOTS ticks are kept in the slot of
+	// their tick on the first level. Timers due later are
+	// kept on higher levels, whose slots span SLOTS times as
+	// many ticks as those of the level below, and are
+	// redistributed (cascaded) to lower levels once the
+	// wheel reaches their slot. Timers beyond the last level
+	// are kept in its furthest slot until they are in range.
+	//
+	// The wheel does not keep time by itself. Event loops
+	// wait until `nextTimeout`, then call `advance` to fire
+	// all due timers on the calling thread. A wheel may be
+	// shared across many event loops, each of which calls
+	// `advance` as it wakes; each timer fires on exactly one
+	// of them. Timers fire no earlier than their timeout,
+	// and no later than the next `advance` after it.
+	//
+	// TimerWheel is thread-safe.
+	class TimerWheel {
+		public:
+		using Callback = Functional::MoveOnlyFunction<void()>;
+
+		// Identifies a scheduled timer. 0 is never a valid Id.
+		using Id = std::uint64_t;
+
+		static std::size_t const SLOT_BITS{6},
+			SLOTS{std::size_t(1) << SLOT_BITS}, LEVELS{4};
+
+		private:
+		using Clock = std::chrono::steady_clock;
+
+		static inline std::uint32_t const NIL{UINT32_MAX};
+
+		// Timers are kept in a slab, and linked into the list
+		// of their slot by index, so that neither schedule nor
+		// cancel allocates once the slab has grown to fit.
+		// Free timers are linked into a free list by next.
+		struct Timer {
+			Callback callback;
+			std::uint64_t tick;
+
+			// Incremented each time the Timer is freed, so that
+			// stale Ids do not cancel its next use.
+			std::uint32_t generation{1};
+			std::uint32_t prev, next;
+
+			// Slot holding the Timer, or NIL if it is free.
+			std::uint32_t slot;
+		};
+
+		Clock::duration const resolution;
+		Clock::time_point const timeBegin;
+
+		std::vector<Timer> timers;
+		std::uint32_t freeHead{NIL};
+
+		// Heads of the list in each slot, level by level, and
+		// a bitmap per level of which slots are not empty.
+		std::array<std::uint32_t, LEVELS * SLOTS> heads;
+		std::array<std::uint64_t, LEVELS> occupied{};
+
+		// All timers due at or before tick have fired.
+		std::uint64_t tick{0};
+		std::size_t cScheduled{0};
+
+		// Timers whose callbacks are about to run or running,
+		// and the threads running them.
+		std::vector<std::pair<Id, std::thread::id>> firing;
+
+		std::mutex mtx;
+
+		// Signalled when a callback returns.
+		std::condition_variable ev;
+
+		public:
+		TimerWheel(
+			Clock::duration resolution =
+				std::chrono::milliseconds(1)) :
+			resolution(resolution),
+			timeBegin(Clock::now()) {
+			this->heads.fill(NIL);
+		}
+
+		// Forbid copy/move.
+		TimerWheel(TimerWheel const &) = delete;
+		TimerWheel &operator=(TimerWheel const &) = delete;
+		TimerWheel(TimerWheel &&) = delete;
+		TimerWheel &operator=(TimerWheel &&) = delete;
+
+		// Number of timers which have yet to fire.
+		std::size_t size() {
+			std::lock_guard lck(this->mtx);
+			return this->cScheduled;
+		}
+
+		// Schedules callback to run on the next `advance` once
+		// timeout passes. Timeouts which have passed fire on
+		// the next `advance`. Infinite timeouts never fire, and
+		// are not scheduled; they return 0.
+		Id schedule(Timeout timeout, Callback &&callback) {
+			if (timeout.isInfinite()) {
+				return 0;
+			}
+			std::lock_guard lck(this->mtx);
+			std::uint32_t idx;
+			if (this->freeHead != NIL) {
+				idx = this->freeHead;
+				this->freeHead = this->timers[idx].next;
+			} else {
+				idx =
+					static_cast<std::uint32_t>(this->timers.size());
+				this->timers.emplace_back();
+			}
+			Timer &timer{this->timers[idx]};
+			timer.callback = std::move(callback);
+			timer.tick = std::max(
+				this->tickOf(timeout.asTimepoint()), this->tick + 1);
+			this->link(idx);
+			this->cScheduled++;
+			return static_cast<Id>(timer.generation) << 32 | idx;
+		}
+
+		// Cancels a timer. Returns true if it had yet to fire.
+		//
+		// If its callback is running on another thread, waits
+		// for the callback to return, so that anything it uses
+		// may be released once cancel returns. Callbacks may
+		// cancel themselves, which does not wait. Thus,
+		// callbacks must not take locks held by callers of
+		// cancel.
+		bool cancel(Id id) {
+			if (id == 0) {
+				return false;
+			}
+			std::uint32_t const idx{
+				static_cast<std::uint32_t>(id & UINT32_MAX)},
+				generation{static_cast<std::uint32_t>(id >> 32)};
+			Callback callback;
+			std::unique_lock lck(this->mtx);
+			if (
+				idx < this->timers.size() &&
+				this->timers[idx].generation == generation &&
+				this->timers[idx].slot != NIL) {
+				this->unlink(idx);
+				callback = this->release(idx);
+
+				// The callback is destroyed without the lock.
+				lck.unlock();
+				return true;
+			}
+			this->ev.wait(lck, [this, id]() {
+				return std::none_of(
+					this->firing.begin(),
+					this->firing.end(),
+					[id](auto const &entry) {
+						return entry.first == id &&
+							entry.second != std::this_thread::get_id();
+					});
+			});
+			return false;
+		}
+
+		// Time at which `advance` must next be called, which
+		// may be earlier than the next timer. Infinite if there
+		// are no timers.
+		Timeout nextTimeout() {
+			std::lock_guard lck(this->mtx);
+			std::uint64_t const next{this->nextTick()};
+			if (next == UINT64_MAX) {
+				return {};
+			}
+			return this->timeOf(next);
+		}
+
+		// Fires all due timers, on the calling thread. Callbacks
+		// run without the lock, and may schedule and cancel
+		// timers. Returns the number of timers fired.
+		std::size_t advance() {
+			std::vector<std::pair<Id, Callback>> due;
+			{
+				std::lock_guard lck(this->mtx);
+				std::uint64_t const target{
+					static_cast<std::uint64_t>(
+						std::max(
+							Clock::duration::zero(),
+							Clock::now() - this->timeBegin) /
+						this->resolution)};
+
+				// Ticks between those with timers or cascades are
+				// skipped, since nothing happens on them.
+				while (this->tick < target) {
+					this->tick = std::min(target, this->nextTick());
+					this->cascade();
+					std::uint32_t const slot(this->tick & (SLOTS - 1));
+					while (this->heads[slot] != NIL) {
+						std::uint32_t const idx{this->heads[slot]};
+						this->unlink(idx);
+						Id const id{
+							static_cast<Id>(this->timers[idx].generation)
+								<< 32 |
+							idx};
+						due.emplace_back(id, this->release(idx));
+						this->firing.emplace_back(
+							id, std::this_thread::get_id());
+					}
+				}
+			}
+
+			for (auto &[id, callback] : due) {
+				Rain::Error::consumeThrowable(
+					[&callback]() { callback(); },
+					std::source_location::current())();
+				{
+					std::lock_guard lck(this->mtx);
+					this->firing.erase(std::find_if(
+						this->firing.begin(),
+						this->firing.end(),
+						[id](auto const &entry) {
+							return entry.first == id &&
+								entry.second == std::this_thread::get_id();
+						}));
+				}
+				this->ev.notify_all();
+			}
+			return due.size();
+		}
+
+		private:
+		Clock::time_point timeOf(std::uint64_t tick) const {
+			return this->timeBegin +
+				this->resolution * static_cast<Clock::rep>(tick);
+		}
+
+		// First tick at or after timePoint.
+		std::uint64_t tickOf(Clock::time_point timePoint) const {
+			if (timePoint <= this->timeBegin) {
+				return 0;
+			}
+			return static_cast<std::uint64_t>(
+				(timePoint - this->timeBegin + this->resolution -
+					Clock::duration(1)) /
+				this->resolution);
+		}
+
+		// Earliest tick after tick with a timer on the first
+		// level, or a cascade of a non-empty slot on a higher
+		// level. Slots on each level hold timers due within
+		// SLOTS of its current slot, so the bitmap is searched
+		// from the slot after the current one. Must hold mtx.
+		std::uint64_t nextTick() const {
+			std::uint64_t next{UINT64_MAX};
+			for (std::size_t level{0}; level < LEVELS; level++) {
+				if (this->occupied[level] == 0) {
+					continue;
+				}
+				std::uint64_t const current{
+					this->tick >> (SLOT_BITS * level)};
+				int const offset{std::countr_zero(std::rotr(
+					this->occupied[level],
+					static_cast<int>((current + 1) & (SLOTS - 1))))};
+				next = std::min(
+					next,
+					(current + 1 + offset) << (SLOT_BITS * level));
+			}
+			return next;
+		}
+
+		// On ticks which begin a slot on a higher level, moves
+		// the timers in that slot to lower levels. Must hold
+		// mtx.
+		void cascade() {
+			for (std::size_t level{1}; level < LEVELS; level++) {
+				std::uint64_t const mask{
+					(std::uint64_t(1) << (SLOT_BITS * level)) - 1};
+				if ((this->tick & mask) != 0) {
+					return;
+				}
+				std::uint32_t const slot{static_cast<std::uint32_t>(
+					level * SLOTS +
+					((this->tick >> (SLOT_BITS * level)) &
+						(SLOTS - 1)))};
+				std::uint32_t idx{this->heads[slot]};
+				this->heads[slot] = NIL;
+				this->occupied[level] &=
+					~(std::uint64_t(1) << (slot & (SLOTS - 1)));
+				while (idx != NIL) {
+					std::uint32_t const next{this->timers[idx].next};
+					this->link(idx);
+					idx = next;
+				}
+			}
+		}
+
+		// Links a timer into the slot for its tick, on the
+		// lowest level which spans it. Must hold mtx.
+		void link(std::uint32_t idx) {
+			Timer &timer{this->timers[idx]};
+			std::uint64_t const delta{std::min(
+				timer.tick - this->tick,
+				(std::uint64_t(1) << (SLOT_BITS * LEVELS)) - 1)};
+			std::size_t level{0};
+			while (delta >> (SLOT_BITS * (level + 1)) != 0) {
+				level++;
+			}
+			std::uint64_t const slotInLevel{
+				((this->tick + delta) >> (SLOT_BITS * level)) &
+				(SLOTS - 1)};
+			std::uint32_t const slot{static_cast<std::uint32_t>(
+				level * SLOTS + slotInLevel)};
+			timer.slot = slot;
+			timer.prev = NIL;
+			timer.next = this->heads[slot];
+			if (timer.next != NIL) {
+				this->timers[timer.next].prev = idx;
+			}
+			this->heads[slot] = idx;
+			this->occupied[level] |= std::uint64_t(1)
+				<< slotInLevel;
+		}
+
+		// Must hold mtx.
+		void unlink(std::uint32_t idx) {
+			Timer &timer{this->timers[idx]};
+			if (timer.prev != NIL) {
+				this->timers[timer.prev].next = timer.next;
+			} else {
+				this->heads[timer.slot] = timer.next;
+				if (timer.next == NIL) {
+					this->occupied[timer.slot / SLOTS] &= ~(
+						std::uint64_t(1) << (timer.slot & (SLOTS - 1)));
+				}
+			}
+			if (timer.next != NIL) {
+				this->timers[timer.next].prev = timer.prev;
+			}
+		}
+
+		// Frees an unlinked timer, and returns its callback.
+		// Must hold mtx.
+		Callback release(std::uint32_t idx) {
+			Timer &timer{this->timers[idx]};
+			Callback callback{std::move(timer.callback)};
+			timer.slot = NIL;
+			if (++timer.generation == 0) {
+				timer.generation = 1;
+			}
+			timer.next = this->freeHead;
+			this->freeHead = idx;
+			this->cScheduled--;
+			return callback;
+		}
+	};
+}
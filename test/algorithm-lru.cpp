@@ -95,5 +95,25 @@ int main() {
 		}
 	}
 
+	// Erase and evict, for caches bounded by other than
+	// count.
+	{
+		Rain::Algorithm::LruCache<int, int> cache(SIZE_MAX);
+		for (int idx{0}; idx < 4; idx++) {
+			cache.insertOrAssign(idx, idx * 10);
+		}
+		releaseAssert(cache.erase(1));
+		releaseAssert(!cache.erase(1));
+		releaseAssert(cache.find(1) == cache.end());
+		releaseAssert(cache.size() == 3);
+
+		// 0 is least-recently-used, until found.
+		cache.find(0);
+		releaseAssert(cache.evict() == 20);
+		releaseAssert(cache.evict() == 30);
+		releaseAssert(cache.evict() == 0);
+		releaseAssert(cache.empty());
+	}
+
 	return 0;
 }
@@ -0,0 +1,132 @@
+// Tests Data::Deflate.
+#include <rain.hpp>
+
+using Rain::Error::releaseAssert;
+using namespace Rain::Literal;
+using namespace Rain::Data::Deflate;
+using namespace std::literals;
+
+// Compresses and decompresses in, and returns the length
+// compressed.
+std::size_t roundTrip(std::string const &in) {
+	Compressor compressor;
+	Decompressor decompressor;
+	std::string compressed, decompressed;
+	compressor.compress(in, compressed);
+	releaseAssert(compressed.ends_with("\x00\x00\xff\xff"s));
+	releaseAssert(
+		decompressor.decompress(compressed, decompressed));
+	releaseAssert(decompressed == in);
+	return compressed.size();
+}
+
+int main() {
+	std::string const text{
+		"abracadabra abracadabra, the rain in spain stays "
+		"mainly in the plain; the rain in spain"};
+
+	// Blocks from zlib: fixed, stored, and dynamic, each
+	// sync flushed.
+	{
+		Decompressor decompressor;
+		std::string out;
+		releaseAssert(decompressor.decompress(
+			"\x4a\x4c\x2a\x4a\x4c\x4e\x4c\x49\x04\x52\x0a\x89\x08"
+			"\xb6\x8e\x42\x49\x46\xaa\x42\x51\x62\x66\x9e\x02\x10"
+			"\x15\x17\x80\x18\xc5\x25\x89\x95\xc5\x0a\xb9\x40\x66"
+			"\x4e\x25\x48\x14\xa4\xa2\x20\x07\xc8\xb5\xc6\x54\x0c"
+			"\x00\x00\x00\xff\xff"s,
+			out));
+		releaseAssert(out == text);
+
+		// Later calls may refer to the output of earlier ones.
+		out.clear();
+		releaseAssert(decompressor.decompress(
+			"\x4a\xa4\x8d\xb1\x00\x00\x00\x00\xff\xff"s, out));
+		releaseAssert(out == text);
+		Decompressor fresh;
+		releaseAssert(!fresh.decompress(
+			"\x4a\xa4\x8d\xb1\x00\x00\x00\x00\xff\xff"s, out));
+
+		out.clear();
+		decompressor.reset();
+		releaseAssert(decompressor.decompress(
+			"\x00\x06\x00\xf9\xff\x73\x74\x6f\x72\x65\x64\x00\x00"
+			"\x00\xff\xff"s,
+			out));
+		releaseAssert(out == "stored");
+
+		out.clear();
+		releaseAssert(decompressor.decompress(
+			"\x1c\xc7\x41\x11\x00\x20\x00\xc3\x30\x2b\xb3\xd6\x16"
+			"\xff\x1a\xe0\xc8\x2f\x8c\x42\x39\x90\x63\x18\x5f\x7a"
+			"\xe4\x25\x26\x17\x00\x00\xff\xff"s,
+			out));
+		releaseAssert(
+			out == "a accabbadaacb a abcaaaaaacbbdbacaaca ba");
+	}
+
+	// Malformed blocks, and output over maxLen, fail.
+	{
+		Decompressor decompressor;
+		std::string out;
+		releaseAssert(
+			!decompressor.decompress("\xff\xff"s, out));
+		decompressor.reset();
+		releaseAssert(!decompressor.decompress(
+			"\x01\x06\x00\x00\x00stored"s, out));
+
+		Compressor compressor;
+		std::string compressed;
+		compressor.compress(
+			std::string(1_zu << 16, 'a'), compressed);
+		decompressor.reset();
+		releaseAssert(
+			!decompressor.decompress(compressed, out, 1_zu << 15));
+	}
+
+	// Round trips, across repetitive and random inputs.
+	{
+		releaseAssert(roundTrip("") == 5);
+		roundTrip("a");
+		roundTrip(text);
+		std::size_t const repetitiveLen{
+			roundTrip(std::string(1_zu << 17, 'a'))};
+		std::cout << "Repetitive: " << repetitiveLen << " bytes."
+							<< std::endl;
+		releaseAssert(repetitiveLen < (1_zu << 17) / 64);
+
+		std::string textual;
+		for (std::size_t idx{0}; textual.size() < 1_zu << 17;
+				 idx++) {
+			textual += text.substr(idx % text.size()) +
+				std::to_string(idx);
+		}
+		std::size_t const textualLen{roundTrip(textual)};
+		std::cout << "Textual: " << textualLen << " bytes."
+							<< std::endl;
+		releaseAssert(textualLen < textual.size() / 2);
+
+		std::mt19937_64 generator(0);
+		std::string random(1_zu << 17, '\0');
+		for (char &byte : random) {
+			byte = static_cast<char>(generator());
+		}
+		roundTrip(random);
+	}
+
+	// Compressors are independent across calls, but
+	// Decompressors may keep their window.
+	{
+		Compressor compressor(10);
+		Decompressor decompressor(10);
+		for (std::size_t idx{0}; idx < 4; idx++) {
+			std::string compressed, out;
+			compressor.compress(text, compressed);
+			releaseAssert(
+				decompressor.decompress(compressed, out));
+			releaseAssert(out == text);
+		}
+	}
+	return 0;
+}
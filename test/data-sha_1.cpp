@@ -0,0 +1,39 @@
+// Tests Data::Sha1.
+#include <rain.hpp>
+
+using Rain::Error::releaseAssert;
+
+// Hex of the digest of in.
+std::string hexDigest(std::string_view in) {
+	std::string digest{Rain::Data::Sha1::digest(in)}, hex;
+	for (char byte : digest) {
+		hex += "0123456789abcdef"[(byte >> 4) & 0xf];
+		hex += "0123456789abcdef"[byte & 0xf];
+	}
+	return hex;
+}
+
+int main() {
+	// Vectors from RFC 3174 and FIPS 180-2, across one and
+	// two final blocks.
+	releaseAssert(
+		hexDigest("") ==
+		"da39a3ee5e6b4b0d3255bfef95601890afd80709");
+	releaseAssert(
+		hexDigest("abc") ==
+		"a9993e364706816aba3e25717850c26c9cd0d89d");
+	releaseAssert(
+		hexDigest("abcdbcdecdefdefgefghfghighijhijkijkljklmklm"
+							"nlmnomnopnopq") ==
+		"84983e441c3bd26ebaae4aa1f95129e5e54670f1");
+	releaseAssert(
+		hexDigest(std::string(1000000, 'a')) ==
+		"34aa973cd4c4daa4f61eeb2bdbad27316534016f");
+
+	// The WebSocket handshake example of RFC 6455.
+	releaseAssert(
+		Rain::String::Base64::encode(Rain::Data::Sha1::digest(
+			"dGhlIHNhbXBsZSBub25jZQ==258EAFA5-E914-47DA-95CA-"
+			"C5AB0DC85B11")) == "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=");
+	return 0;
+}
@@ -0,0 +1,115 @@
+// Tests Rain::Metrics.
+#include <rain.hpp>
+
+using Rain::Error::releaseAssert;
+using namespace Rain::Literal;
+
+int main() {
+	// Counters merge stripes across threads.
+	{
+		Rain::Metrics::Registry registry;
+		Rain::Metrics::Counter counter(
+			"test_counter_total", "Test counter.", registry);
+		std::vector<std::thread> threads;
+		for (int idx{0}; idx < 32; idx++) {
+			threads.emplace_back([&counter]() {
+				for (int jdx{0}; jdx < 10000; jdx++) {
+					counter.add();
+				}
+			});
+		}
+		for (auto &thread : threads) {
+			thread.join();
+		}
+		counter.add(5);
+		std::cout << "Counter: " << counter.value() << "."
+							<< std::endl;
+		releaseAssert(counter.value() == 320005);
+		releaseAssert(
+			registry.expose() ==
+			"# HELP test_counter_total Test counter.\n"
+			"# TYPE test_counter_total counter\n"
+			"test_counter_total 320005\n");
+	}
+
+	// Histogram buckets are exact for small values, and
+	// within 1/SUB_BUCKETS above.
+	{
+		using Histogram = Rain::Metrics::Histogram;
+		for (std::uint64_t value :
+				 {0_zu, 1_zu, 7_zu, 8_zu, 9_zu, 1000_zu,
+					1_zu << 40}) {
+			std::size_t idx{Histogram::bucketOf(value)};
+			std::uint64_t upper{Histogram::upperOf(idx)};
+			releaseAssert(value < upper);
+			releaseAssert(
+				upper - value <=
+				std::max(1_zu, value / Histogram::SUB_BUCKETS));
+			releaseAssert(
+				idx == 0 || Histogram::upperOf(idx - 1) <= value);
+		}
+		releaseAssert(
+			Histogram::bucketOf(UINT64_MAX) ==
+			Histogram::BUCKETS - 1);
+	}
+
+	// Quantiles and exposition.
+	{
+		Rain::Metrics::Registry registry;
+		Rain::Metrics::Histogram histogram(
+			"test_seconds", "Test histogram.", registry);
+		for (int idx{1}; idx <= 1000; idx++) {
+			histogram.record(std::chrono::microseconds(idx));
+		}
+		auto const snapshot{histogram.snapshot()};
+		std::cout << "p50: " << snapshot.quantile(0.5)
+							<< "ns, p99: " << snapshot.quantile(0.99)
+							<< "ns." << std::endl;
+		releaseAssert(snapshot.count == 1000);
+		releaseAssert(snapshot.sum == 500500000);
+		releaseAssert(
+			snapshot.quantile(0.5) >= 500000 &&
+			snapshot.quantile(0.5) <= 500000 * 9 / 8);
+		releaseAssert(
+			snapshot.quantile(0.99) >= 990000 &&
+			snapshot.quantile(0.99) <= 990000 * 9 / 8);
+
+		// 1us to 1000us lie below the buckets at 2^10ns and
+		// 2^20ns.
+		std::string const exposed{registry.expose()};
+		std::cout << exposed;
+		releaseAssert(
+			exposed.find(
+				"test_seconds_bucket{le=\"1.024e-06\"} 1\n") !=
+			std::string::npos);
+		releaseAssert(
+			exposed.find(
+				"test_seconds_bucket{le=\"0.00104858\"} 1000\n") !=
+			std::string::npos);
+		releaseAssert(
+			exposed.find("test_seconds_bucket{le=\"+Inf\"} 1000\n"
+									 "test_seconds_sum 0.5005\n"
+									 "test_seconds_count 1000\n") !=
+			std::string::npos);
+	}
+
+	// Registries expose by name, and forget destroyed
+	// Metrics.
+	{
+		Rain::Metrics::Registry registry;
+		Rain::Metrics::Counter b("b_total", "B.", registry);
+		{
+			Rain::Metrics::Counter a("a_total", "A.", registry),
+				c("c_total", "C.", registry);
+			std::string const exposed{registry.expose()};
+			releaseAssert(
+				exposed.find("a_total") < exposed.find("b_total") &&
+				exposed.find("b_total") < exposed.find("c_total"));
+		}
+		releaseAssert(
+			registry.expose().find("a_total") ==
+			std::string::npos);
+	}
+
+	return 0;
+}
@@ -120,13 +120,153 @@ int main() {
 		releaseAssert(counter == 4050);
 	}
 
+	// Tasks queued from within tasks are pushed onto the
+	// queueing thread's own deque, and stolen by the others.
+	{
+		Rain::Multithreading::ThreadPool threadPool(4);
+		std::atomic_size_t nestedCounter{0};
+		for (std::size_t i{0}; i < 16; i++) {
+			threadPool.queueTask([&threadPool, &nestedCounter]() {
+				for (std::size_t j{0}; j < 1000; j++) {
+					threadPool.queueTask(
+						[&nestedCounter]() { nestedCounter++; });
+				}
+			});
+		}
+		threadPool.blockForTasks();
+		std::cout << "Nested batch complete, counter = "
+							<< nestedCounter << "." << std::endl
+							<< std::endl;
+		releaseAssert(nestedCounter == 16000);
+		releaseAssert(threadPool.getCTasks() == 0);
+	}
+
+	// Tasks may hold move-only captures.
+	{
+		Rain::Multithreading::ThreadPool threadPool;
+		std::atomic_size_t movedCounter{0};
+		for (std::size_t i{0}; i < 25; i++) {
+			std::unique_ptr<std::size_t> increment(
+				new std::size_t(i));
+			threadPool.queueTask(
+				[&movedCounter, increment = std::move(increment)]() {
+					movedCounter += *increment;
+				});
+		}
+		threadPool.blockForTasks();
+		releaseAssert(movedCounter == 300);
+	}
+
+	// submit returns futures for results and exceptions.
+	{
+		Rain::Multithreading::ThreadPool threadPool(4);
+		std::vector<std::future<std::size_t>> futures;
+		for (std::size_t i{0}; i < 25; i++) {
+			futures.push_back(
+				threadPool.submit([i]() { return i * i; }));
+		}
+		std::size_t sum{0};
+		for (auto &future : futures) {
+			sum += future.get();
+		}
+		releaseAssert(sum == 4900);
+
+		auto thrown{threadPool.submit([]() -> int {
+			throw std::runtime_error("Submitted.");
+		})};
+		bool caught{false};
+		try {
+			thrown.get();
+		} catch (std::runtime_error const &) {
+			caught = true;
+		}
+		releaseAssert(caught);
+	}
+
+	// TaskGroups on a shared ThreadPool wait only on their
+	// own tasks, and rethrow their exceptions.
+	{
+		Rain::Multithreading::ThreadPool threadPool(4);
+		Rain::Multithreading::ThreadPool::TaskGroup slowGroup(
+			threadPool),
+			fastGroup(threadPool);
+		std::atomic_size_t fastCounter{0};
+		slowGroup.queueTask(
+			[]() { std::this_thread::sleep_for(1s); });
+		for (std::size_t i{0}; i < 16; i++) {
+			fastGroup.queueTask([&fastCounter]() {
+				std::this_thread::sleep_for(10ms);
+				fastCounter++;
+			});
+		}
+		auto timeBegin{std::chrono::steady_clock::now()};
+		fastGroup.wait();
+		releaseAssert(fastCounter == 16);
+		releaseAssert(
+			std::chrono::steady_clock::now() - timeBegin < 500ms);
+		releaseAssert(slowGroup.getCTasks() == 1);
+
+		fastGroup.queueTask(
+			[]() { throw std::runtime_error("Grouped."); });
+		bool caught{false};
+		try {
+			fastGroup.wait();
+		} catch (std::runtime_error const &) {
+			caught = true;
+		}
+		releaseAssert(caught);
+		releaseAssert(!slowGroup.wait(2s));
+	}
+
+	// parallelFor and parallelReduce, nested, on a ThreadPool
+	// with fewer threads than chunks.
+	{
+		Rain::Multithreading::ThreadPool threadPool(2);
+		std::vector<std::size_t> squares(10000);
+		threadPool.parallelFor(
+			std::size_t(0), squares.size(), [&](std::size_t i) {
+				squares[i] = i * i;
+			});
+		releaseAssert(squares[9999] == 9999 * 9999);
+
+		std::size_t sum{threadPool.parallelReduce(
+			std::size_t(0),
+			squares.size(),
+			std::size_t(0),
+			[&](std::size_t i) { return squares[i]; },
+			std::plus<std::size_t>(),
+			100)};
+		releaseAssert(sum == 333283335000);
+
+		std::atomic_size_t nestedCounter{0};
+		threadPool.parallelFor(
+			0,
+			16,
+			[&](int) {
+				threadPool.parallelFor(
+					0, 100, [&](int) { nestedCounter++; }, 10);
+			},
+			1);
+		releaseAssert(nestedCounter == 1600);
+
+		std::string concatenated{threadPool.parallelReduce(
+			0,
+			26,
+			std::string(),
+			[](int i) { return std::string(1, char('a' + i)); },
+			std::plus<std::string>(),
+			3)};
+		releaseAssert(
+			concatenated == "abcdefghijklmnopqrstuvwxyz");
+	}
+
 	// Tasks which throw exceptions should be reported but not
 	// crash.
-	Rain::Multithreading::ThreadPool::Task throwingTask([]() {
+	auto throwingTask = []() {
 		std::this_thread::sleep_for(50ms);
 		throw std::runtime_error(
 			"*fanfare* You've been pranked!\n");
-	});
+	};
 
 	{
 		Rain::Multithreading::ThreadPool threadPool(2);
@@ -0,0 +1,162 @@
+// Tests Networking::BufferPool, and its use by Servers.
+#include <rain.hpp>
+
+using Rain::Error::releaseAssert;
+using namespace Rain::Literal;
+using namespace Rain::Networking;
+
+std::string const LARGE_BODY(1_zu << 20, 'a');
+
+class MyWorker : public Http::Worker<> {
+	using Worker::Worker;
+
+	ResponseAction reqHello(Request &, std::smatch const &) {
+		return {{StatusCode::OK, {}, "hello"}};
+	}
+	ResponseAction reqLarge(Request &, std::smatch const &) {
+		return {{StatusCode::OK, {}, LARGE_BODY}};
+	}
+
+	virtual Filters const &filters() override {
+		static Filters const filters{
+			{".*", "/hello", {Method::GET}, &MyWorker::reqHello},
+			{".*", "/large", {Method::GET}, &MyWorker::reqLarge}};
+		return filters;
+	}
+};
+
+class MyServer : public Http::Server<MyWorker> {
+	using Server::Server;
+
+	virtual MyWorker makeWorker(
+		NativeSocket nativeSocket,
+		SocketInterface *interrupter) override {
+		return {nativeSocket, interrupter};
+	}
+
+	public:
+	~MyServer() { this->destruct(); }
+};
+
+int main() {
+	// Buffers are rounded up to size classes, and reused
+	// once returned.
+	{
+		BufferPool pool(1_zu << 12, 1_zu << 14, 1_zu << 14);
+		releaseAssert(pool.minLength() == 1_zu << 12);
+		releaseAssert(pool.maxLength() == 1_zu << 14);
+		{
+			auto buffer{pool.acquire(1)};
+			releaseAssert(static_cast<bool>(buffer));
+			releaseAssert(buffer.size() == 1_zu << 12);
+			releaseAssert(pool.acquire(5000).size() == 1_zu << 13);
+		}
+		releaseAssert(pool.hits() == 0 && pool.misses() == 2);
+		{
+			auto buffer{pool.acquire(1_zu << 12)};
+			releaseAssert(pool.hits() == 1);
+			auto moved{std::move(buffer)};
+			releaseAssert(!buffer && moved.size() == 1_zu << 12);
+			moved.reset();
+			releaseAssert(!moved);
+			pool.acquire(1);
+			releaseAssert(pool.hits() == 2);
+		}
+
+		// Each class keeps at most maxIdleBytes idle.
+		{
+			std::vector<BufferPool::Buffer> buffers;
+			for (std::size_t idx{0}; idx < 2; idx++) {
+				buffers.push_back(pool.acquire(1_zu << 14));
+			}
+		}
+		pool.acquire(1_zu << 14);
+		auto const cMisses{pool.misses()};
+		{
+			auto first{pool.acquire(1_zu << 14)},
+				second{pool.acquire(1_zu << 14)};
+		}
+		releaseAssert(pool.misses() == cMisses + 1);
+
+		// Buffers longer than maxLength are not pooled.
+		auto const cHits{pool.hits()};
+		releaseAssert(
+			pool.acquire((1_zu << 14) + 1).size() ==
+			(1_zu << 14) + 1);
+		releaseAssert(
+			pool.hits() == cHits && pool.misses() == cMisses + 1);
+	}
+
+	// Idle Workers in reactor mode return their buffers, so
+	// that a keep-alive connection mostly reuses them.
+	{
+		MyServer server(
+			ServeOptions{
+				.reactors = 1,
+				.minBufferLen = 1_zu << 12,
+				.maxBufferLen = 1_zu << 16},
+			":0");
+		releaseAssert(
+			server.bufferPool().maxLength() == 1_zu << 16);
+		Http::Client<> client(
+			Host{"localhost", server.host().service});
+		std::size_t const C_REQUESTS{16};
+		for (std::size_t idx{0}; idx < C_REQUESTS; idx++) {
+			client.send({Http::Method::GET, "/hello"});
+			Http::Response res{client.recv()};
+			std::string body{
+				std::istreambuf_iterator<char>(res.body), {}};
+			releaseAssert(body == "hello");
+			std::this_thread::sleep_for(10ms);
+		}
+		std::cout << "Hello: " << server.bufferPool().hits()
+							<< " hits, " << server.bufferPool().misses()
+							<< " misses." << std::endl;
+		releaseAssert(
+			server.bufferPool().hits() + 1 >= C_REQUESTS);
+		releaseAssert(server.bufferPool().misses() == 1);
+
+		// Large bodies pass through the buffers.
+		{
+			client.send({Http::Method::GET, "/large"});
+			Http::Response res{client.recv()};
+			std::string body{
+				std::istreambuf_iterator<char>(res.body), {}};
+			releaseAssert(body == LARGE_BODY);
+		}
+
+		// Large heads grow the receive buffer beyond the
+		// smallest class, rather than filling it.
+		Http::Request req{Http::Method::GET, "/hello"};
+		req.headers["X-Large"] = std::string(1_zu << 13, 'a');
+		auto const cMisses{server.bufferPool().misses()};
+		client.send(req);
+		Http::Response res{client.recv()};
+		std::string body{
+			std::istreambuf_iterator<char>(res.body), {}};
+		releaseAssert(body == "hello");
+		std::cout << "Large: " << server.bufferPool().hits()
+							<< " hits, " << server.bufferPool().misses()
+							<< " misses." << std::endl;
+		releaseAssert(server.bufferPool().misses() > cMisses);
+	}
+
+	// Workers in thread mode return their buffers once
+	// done, for the next Worker.
+	{
+		MyServer server(":0");
+		Host const host{"localhost", server.host().service};
+		for (std::size_t idx{0}; idx < 4; idx++) {
+			Http::Client<> client(host);
+			client.send({Http::Method::GET, "/hello"});
+			Http::Response res{client.recv()};
+			std::string body{
+				std::istreambuf_iterator<char>(res.body), {}};
+			releaseAssert(body == "hello");
+		}
+		std::this_thread::sleep_for(100ms);
+		releaseAssert(server.bufferPool().hits() > 0);
+	}
+
+	return 0;
+}
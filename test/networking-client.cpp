@@ -3,10 +3,132 @@
 #include <rain.hpp>
 
 using Rain::Error::releaseAssert;
+using namespace Rain::Literal;
+using namespace Rain::Networking;
+
+class MyWorker :
+	public Worker<
+		Ipv4FamilyInterface,
+		StreamTypeInterface,
+		TcpProtocolInterface,
+		NoLingerSocketOption> {
+	using Worker::Worker;
+
+	// Holds the connection until the Client closes it.
+	virtual void onWork() override {
+		std::string buffer(1, '\0');
+		Rain::Error::consumeThrowable(
+			[this, &buffer]() { this->recv(buffer); })();
+	}
+};
+
+class MyServer :
+	public Server<
+		MyWorker,
+		Ipv4FamilyInterface,
+		StreamTypeInterface,
+		TcpProtocolInterface,
+		NoLingerSocketOption> {
+	using Server::Server;
+
+	virtual MyWorker makeWorker(
+		NativeSocket nativeSocket,
+		SocketInterface *interrupter) override {
+		return {nativeSocket, interrupter};
+	}
+
+	public:
+	~MyServer() { this->destruct(); }
+};
+
+using MyClient = Client<
+	Ipv4FamilyInterface,
+	StreamTypeInterface,
+	TcpProtocolInterface,
+	NoLingerSocketOption>;
+
+AddressInfo localAddressInfo(std::string const &service) {
+	return getAddressInfos(
+		{"127.0.0.1", service},
+		Family::INET,
+		Type::STREAM,
+		Protocol::TCP,
+		AddressInfo::Flag::NUMERICHOST)
+		.at(0);
+}
 
 int main() {
-	using namespace Rain::Literal;
-	using namespace Rain::Networking;
+	MyServer server(":0");
+	std::string refusedService;
+	{
+		MyServer refusedServer(":0");
+		refusedService = refusedServer.host().service;
+	}
+
+	// Failed attempts begin the next attempt immediately,
+	// without waiting for the attempt delay.
+	{
+		auto timeBegin = std::chrono::steady_clock::now();
+		MyClient client(std::vector<AddressInfo>{
+			localAddressInfo(refusedService),
+			localAddressInfo(refusedService),
+			localAddressInfo(server.host().service)});
+		auto timeElapsed =
+			std::chrono::steady_clock::now() - timeBegin;
+		std::cout << "Connected to " << client.peerHost()
+							<< " in " << timeElapsed << "." << std::endl;
+		releaseAssert(
+			client.peerHost().service == server.host().service);
+		releaseAssert(
+			timeElapsed <
+			ClientSocketSpecInterface::CONNECTION_ATTEMPT_DELAY);
+	}
+
+	// Attempts to unresponsive addresses are raced with
+	// later attempts after the attempt delay.
+	{
+		auto timeBegin = std::chrono::steady_clock::now();
+		MyClient client(std::vector<AddressInfo>{
+			localAddressInfo(refusedService),
+			getAddressInfos(
+				{"10.255.255.1", "80"},
+				Family::INET,
+				Type::STREAM,
+				Protocol::TCP,
+				AddressInfo::Flag::NUMERICHOST)
+				.at(0),
+			localAddressInfo(server.host().service)});
+		auto timeElapsed =
+			std::chrono::steady_clock::now() - timeBegin;
+		std::cout << "Connected to " << client.peerHost()
+							<< " in " << timeElapsed << "." << std::endl;
+		releaseAssert(
+			client.peerHost().service == server.host().service);
+		releaseAssert(timeElapsed < 1s);
+	}
+
+	// Connect fails once all attempts fail, before the
+	// timeout.
+	{
+		auto timeBegin = std::chrono::steady_clock::now();
+		bool failed{false};
+		try {
+			MyClient client(
+				std::vector<AddressInfo>{
+					localAddressInfo(refusedService),
+					localAddressInfo(refusedService)},
+				5s);
+		} catch (Exception const &) {
+			failed = true;
+		}
+		auto timeElapsed =
+			std::chrono::steady_clock::now() - timeBegin;
+		std::cout << "Failed in " << timeElapsed << "."
+							<< std::endl
+							<< std::endl;
+		releaseAssert(failed);
+		releaseAssert(timeElapsed < 1s);
+	}
 
 	{
 		auto timeBegin = std::chrono::steady_clock::now();
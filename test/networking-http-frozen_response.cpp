@@ -0,0 +1,221 @@
+// Tests Networking::Http::FrozenResponse, and its use by
+// Workers.
+#include <rain.hpp>
+
+using Rain::Error::releaseAssert;
+using namespace Rain::Literal;
+using namespace Rain::Networking;
+
+// Calls to the handler, which are not repeated by freezing.
+std::atomic_size_t cFrozen{0};
+
+class MyWorker : public Http::Worker<> {
+	using Worker::Worker;
+
+	ResponseAction reqFrozen(Request &, std::smatch const &) {
+		static Http::FrozenResponse const frozen{[]() {
+			cFrozen++;
+			return Http::FrozenResponse{Http::Response{
+				Http::StatusCode::OK,
+				{{{"Content-Type", "text/plain"}}},
+				"frozen"}};
+		}()};
+		return {frozen};
+	}
+	ResponseAction reqClose(Request &, std::smatch const &) {
+		static Http::FrozenResponse const frozen{
+			Http::Response{Http::StatusCode::OK, {}, "close"}};
+		return {frozen, true};
+	}
+
+	virtual Filters const &filters() override {
+		static Filters const filters{
+			{".*",
+				"/frozen",
+				{Http::Method::GET, Http::Method::HEAD},
+				&MyWorker::reqFrozen},
+			{".*",
+				"/close",
+				{Http::Method::GET},
+				&MyWorker::reqClose}};
+		return filters;
+	}
+};
+
+class MyServer : public Http::Server<MyWorker> {
+	using Server::Server;
+
+	virtual MyWorker makeWorker(
+		NativeSocket nativeSocket,
+		SocketInterface *interrupter) override {
+		return {nativeSocket, interrupter};
+	}
+
+	public:
+	~MyServer() { this->destruct(); }
+};
+
+// Joins buffers into the bytes they send.
+std::string join(std::span<std::string_view const> buffers) {
+	std::string bytes;
+	for (std::string_view buffer : buffers) {
+		bytes += buffer;
+	}
+	return bytes;
+}
+
+int main() {
+	// Frozen responses are serialized once, with the Date
+	// patched in when sent.
+	{
+		Http::FrozenResponse const empty;
+		releaseAssert(!empty);
+
+		Http::Response res{
+			Http::StatusCode::OK,
+			{{{"Server", "rain"}}},
+			"hello world"};
+		Http::FrozenResponse const frozen{res}, copy{frozen};
+		releaseAssert(static_cast<bool>(frozen));
+		releaseAssert(
+			frozen.bytes().data() == copy.bytes().data());
+		releaseAssert(frozen.body() == "hello world");
+
+		std::string const bytes{join(frozen.buffers())};
+		releaseAssert(bytes.size() == frozen.bytes().size());
+		std::stringstream stream(bytes);
+		Http::Response sent;
+		sent.recvWith(stream);
+		releaseAssert(sent.statusCode == Http::StatusCode::OK);
+		releaseAssert(sent.headers["Server"] == "rain");
+		releaseAssert(
+			std::string(
+				std::istreambuf_iterator<char>(sent.body), {}) ==
+			"hello world");
+		auto date{sent.headers.date()};
+		releaseAssert(date.has_value());
+		releaseAssert(
+			std::chrono::abs(
+				date->time - Http::Header::HttpDate::now().time) <=
+			2s);
+
+		// Without the body, for HEAD requests.
+		std::string const head{join(frozen.buffers(false))};
+		releaseAssert(
+			head.size() + frozen.body().size() == bytes.size());
+		releaseAssert(head.ends_with("\r\n\r\n"));
+	}
+
+	// Only the Date is patched, even if another header holds
+	// the placeholder date.
+	{
+		Http::Response res{Http::StatusCode::OK, {}, "expired"};
+		res.headers.expires({});
+		res.headers.date({});
+		Http::FrozenResponse const frozen{res};
+		std::stringstream stream(join(frozen.buffers()));
+		Http::Response sent;
+		sent.recvWith(stream);
+		releaseAssert(
+			sent.headers.expires()->time ==
+			Http::Header::HttpDate().time);
+		releaseAssert(
+			std::chrono::abs(
+				sent.headers.date()->time -
+				Http::Header::HttpDate::now().time) <= 2s);
+		releaseAssert(sent.headers.count("Date") == 1);
+
+		Http::Response legacy{Http::StatusCode::OK, {}, "0.9"};
+		legacy.version = Http::Version::_0_9;
+		bool isThrown{false};
+		try {
+			Http::FrozenResponse{legacy};
+		} catch (Http::Response::Exception const &exception) {
+			isThrown = exception.getError() ==
+				Http::Response::Error::HTTP_VERSION_NOT_SUPPORTED;
+		}
+		releaseAssert(isThrown);
+	}
+
+	// Bodies of indeterminate length are frozen whole, with
+	// their Content-Length, rather than in chunks.
+	{
+		Http::Response res{
+			Http::StatusCode::OK,
+			{},
+			Http::ProducerStreamBuf(
+				[idx = 0](std::ostream &stream) mutable {
+					stream << "abc";
+					return ++idx < 2;
+				})};
+		Http::FrozenResponse const frozen{res};
+		releaseAssert(frozen.body() == "abcabc");
+		std::stringstream stream(join(frozen.buffers()));
+		Http::Response sent;
+		sent.recvWith(stream);
+		releaseAssert(sent.headers.contentLength() == 6);
+		releaseAssert(
+			sent.headers.find("Transfer-Encoding") ==
+			sent.headers.end());
+
+		Http::Response chunked{
+			Http::StatusCode::OK,
+			{{{"Transfer-Encoding", "chunked"}}},
+			"abc"};
+		bool isThrown{false};
+		try {
+			Http::FrozenResponse{chunked};
+		} catch (Http::Response::Exception const &exception) {
+			isThrown = exception.getError() ==
+				Http::Response::Error::MALFORMED_BODY;
+		}
+		releaseAssert(isThrown);
+	}
+
+	MyServer server(":0");
+	Http::Client<> client(
+		Host{"localhost", server.host().service});
+
+	// The same frozen response is sent to each request.
+	for (std::size_t idx{0}; idx < 3; idx++) {
+		client.send({Http::Method::GET, "/frozen"});
+		Http::Response res{client.recv()};
+		releaseAssert(res.statusCode == Http::StatusCode::OK);
+		releaseAssert(
+			res.headers["Content-Type"] == "text/plain");
+		releaseAssert(res.headers.date().has_value());
+		releaseAssert(
+			std::string(
+				std::istreambuf_iterator<char>(res.body), {}) ==
+			"frozen");
+	}
+	releaseAssert(cFrozen == 1);
+
+	// HEAD requests are sent the head only, and the
+	// connection is kept alive until a frozen response which
+	// closes it.
+	{
+		Client<
+			Ipv4FamilyInterface,
+			StreamTypeInterface,
+			TcpProtocolInterface>
+			rawClient(Host{"localhost", server.host().service});
+		rawClient.send(
+			"HEAD /frozen HTTP/1.1\r\n\r\n"
+			"GET /close HTTP/1.1\r\n\r\n"s);
+		std::string response, buffer;
+		buffer.reserve(1_zu << 12);
+		while (rawClient.recv(buffer, 1s) > 0) {
+			response += buffer;
+		}
+		releaseAssert(
+			response.find("Content-Length: 6\r\n") !=
+			std::string::npos);
+		releaseAssert(
+			response.find("frozen") == std::string::npos);
+		releaseAssert(
+			response.find("HTTP/1.1 200", 1) != std::string::npos);
+		releaseAssert(response.ends_with("\r\n\r\nclose"));
+	}
+	return 0;
+}
@@ -58,5 +58,99 @@ int main() {
 			Header::TransferEncoding::CHUNKED);
 	}
 
+	// Range wrap/unwrap and resolution.
+	{
+		Headers headers;
+		releaseAssert(!headers.range());
+		headers.range({2, 5});
+		releaseAssert(headers["Range"] == "bytes=2-5");
+
+		std::size_t offset, length;
+		releaseAssert(
+			headers.range()->resolve(10, offset, length));
+		releaseAssert(offset == 2 && length == 4);
+		releaseAssert(
+			headers.range()->resolve(4, offset, length));
+		releaseAssert(offset == 2 && length == 2);
+		releaseAssert(
+			!headers.range()->resolve(2, offset, length));
+
+		headers["Range"] = "bytes=-3";
+		releaseAssert(
+			headers.range()->resolve(10, offset, length));
+		releaseAssert(offset == 7 && length == 3);
+		headers["Range"] = "bytes=4-";
+		releaseAssert(
+			headers.range()->resolve(10, offset, length));
+		releaseAssert(offset == 4 && length == 6);
+
+		for (char const *unsupported :
+				 {"bytes=0-1,3-4",
+					 "bytes=-",
+					 "bytes=a-5",
+					 "items=0-1"}) {
+			headers["Range"] = unsupported;
+			releaseAssert(!headers.range());
+		}
+	}
+
+	// HTTP-dates in each of their formats, sent as
+	// IMF-fixdate.
+	{
+		Headers headers;
+		releaseAssert(!headers.date());
+		for (char const *date :
+				 {"Sun, 06 Nov 1994 08:49:37 GMT",
+					 "Sunday, 06-Nov-94 08:49:37 GMT",
+					 "Sun Nov  6 08:49:37 1994"}) {
+			headers["Date"] = date;
+			releaseAssert(
+				static_cast<std::string>(*headers.date()) ==
+				"Sun, 06 Nov 1994 08:49:37 GMT");
+		}
+		headers.lastModified(
+			Header::HttpDate(std::chrono::sys_days(
+				std::chrono::year(2000) / 2 / 29)));
+		releaseAssert(
+			headers["Last-Modified"] ==
+			"Tue, 29 Feb 2000 00:00:00 GMT");
+		releaseAssert(*headers.date() < *headers.lastModified());
+		for (char const *malformed :
+				 {"Sun, 06 Nov 1994 08:49:37 UTC",
+					 "Sun, 31 Feb 1994 08:49:37 GMT",
+					 "Sun, 06 Nov 1994 24:00:00 GMT",
+					 "Sun, 06 Nov 1994 08:49 GMT",
+					 "yesterday"}) {
+			headers["Expires"] = malformed;
+			releaseAssert(!headers.expires());
+		}
+	}
+
+	// Cache-Control directives, case-insensitive and with
+	// optionally quoted arguments.
+	{
+		Headers headers;
+		releaseAssert(!headers.cacheControl().maxAge);
+		headers["Cache-Control"] =
+			"Public, max-age=60, s-maxage=\"120\", x-ext=\"a\"";
+		Header::CacheControl cacheControl{
+			headers.cacheControl()};
+		releaseAssert(
+			cacheControl.isPublic && !cacheControl.noStore);
+		releaseAssert(cacheControl.maxAge == 60_zu);
+		releaseAssert(cacheControl.sMaxAge == 120_zu);
+
+		headers["Cache-Control"] = "no-store, max-age=soon";
+		releaseAssert(headers.cacheControl().noStore);
+		releaseAssert(!headers.cacheControl().maxAge);
+
+		cacheControl = {};
+		cacheControl.isPrivate = true;
+		cacheControl.maxAge = 0;
+		headers.cacheControl(cacheControl);
+		releaseAssert(
+			headers["Cache-Control"] == "private, max-age=0");
+	}
+
 	return 0;
 }
@@ -6,6 +6,7 @@ using Rain::Error::releaseAssert;
 int main() {
 	using namespace Rain::Literal;
 	using namespace Rain::Networking::Http;
+	using namespace std::literals;
 
 	// List-initializing a Request with some default arguments
 	// and a body.
@@ -72,5 +73,45 @@ int main() {
 		releaseAssert(timeElapsed < 0.1s);
 	}
 
+	// Chunk sizes are hexadecimal, and bodies whose chunks
+	// are malformed end early as malformed, with the stream
+	// left where they failed.
+	{
+		std::string const part(0x1a, 'x');
+		std::stringstream stream(
+			"POST / HTTP/1.1\r\n"
+			"Transfer-Encoding: chunked\r\n\r\n"
+			"1a\r\n" +
+			part + "\r\nA;ext=1\r\n" + part.substr(0, 0xa) +
+			"\r\n0\r\nRows: 2\r\n\r\nnext");
+		Request req;
+		stream >> req;
+		std::string body{
+			std::istreambuf_iterator<char>(req.body), {}};
+		releaseAssert(body == part + part.substr(0, 0xa));
+		releaseAssert(!req.isBodyMalformed());
+		releaseAssert(req.trailers["Rows"] == "2");
+		std::string rest{
+			std::istreambuf_iterator<char>(stream), {}};
+		releaseAssert(rest == "next");
+	}
+	for (std::string const &chunks :
+			 {"5\r\nhello\r\nzz\r\nnext"s,
+				 "5\r\nhelloXX\r\n0\r\n\r\nnext"s,
+				 "10000000000000000\r\nhello\r\n0\r\n\r\n"s,
+				 "-5\r\nhello\r\n0\r\n\r\n"s,
+				 "5\r\nhel"s}) {
+		std::stringstream stream(
+			"POST / HTTP/1.1\r\n"
+			"Transfer-Encoding: chunked\r\n\r\n" +
+			chunks);
+		Request req;
+		stream >> req;
+		std::string body{
+			std::istreambuf_iterator<char>(req.body), {}};
+		releaseAssert(req.isBodyMalformed());
+		releaseAssert(body.size() <= 5);
+	}
+
 	return 0;
 }
@@ -0,0 +1,187 @@
+// Tests Networking::Http::RequestParser.
+#include <rain.hpp>
+
+using Rain::Error::releaseAssert;
+
+// In-memory stand-in for the receive buffer of a Tcp Socket,
+// which receives up to chunkLen bytes at a time.
+class ChunkedStreamBuf :
+	public Rain::Networking::Tcp::PeekableStreamBuf {
+	private:
+	std::string const source;
+	std::size_t const chunkLen;
+	std::size_t offset{0};
+	std::string buffer;
+
+	public:
+	ChunkedStreamBuf(
+		std::string const &source,
+		std::size_t chunkLen,
+		std::size_t bufferLen) :
+		source(source),
+		chunkLen(chunkLen),
+		buffer(bufferLen, '\0') {
+		this->setg(
+			&this->buffer[0], &this->buffer[0], &this->buffer[0]);
+	}
+
+	virtual bool isFull() const noexcept override {
+		return this->peek().size() == this->buffer.size();
+	}
+	virtual bool recvMore() override {
+		std::size_t cBuffered{this->peek().size()};
+		std::memmove(&this->buffer[0], this->gptr(), cBuffered);
+		std::size_t result{std::min(
+			{this->chunkLen,
+				this->buffer.size() - cBuffered,
+				this->source.size() - this->offset})};
+		this->source.copy(
+			&this->buffer[cBuffered], result, this->offset);
+		this->offset += result;
+		this->setg(
+			&this->buffer[0],
+			&this->buffer[0],
+			&this->buffer[0] + cBuffered + result);
+		return result != 0;
+	}
+
+	protected:
+	virtual int_type underflow() override {
+		if (this->gptr() == this->egptr() && !this->recvMore()) {
+			return traits_type::eof();
+		}
+		return traits_type::to_int_type(*this->gptr());
+	}
+};
+
+int main() {
+	using namespace Rain::Literal;
+	using namespace Rain::Networking::Http;
+
+	std::string const requestStr{
+		"\r\nGET /some/long/target/which/spans/chunks?query=1 "
+		"HTTP/1.1\r\nHost: google.com\r\nUser-Agent:   rain  "
+		"\r\nAccept:*/*\r\nX-Empty:\r\nContent-Length: "
+		"5\r\n\r\nhello"};
+
+	// Parsing a head one byte at a time produces the same
+	// result as parsing it at once.
+	for (std::size_t step : {1_zu, 7_zu, requestStr.size()}) {
+		RequestParser parser;
+		std::size_t length{0};
+		bool complete{false};
+		while (!complete) {
+			length = std::min(requestStr.size(), length + step);
+			complete =
+				parser.parse(std::string_view(requestStr).substr(
+					0, length));
+			releaseAssert(complete || length < requestStr.size());
+		}
+		releaseAssert(parser.method() == "GET");
+		releaseAssert(
+			parser.target() ==
+			"/some/long/target/which/spans/chunks?query=1");
+		releaseAssert(parser.version() == "HTTP/1.1");
+		releaseAssert(parser.cHeaders() == 5);
+		releaseAssert(parser.header(0).first == "Host");
+		releaseAssert(parser.header(0).second == "google.com");
+		releaseAssert(parser.header(1).second == "rain");
+		releaseAssert(parser.header(2).second == "*/*");
+		releaseAssert(parser.header(3).first == "X-Empty");
+		releaseAssert(parser.header(3).second.empty());
+		releaseAssert(
+			requestStr.substr(parser.size()) == "hello");
+	}
+
+	// The buffer may move between calls.
+	{
+		RequestParser parser;
+		std::string buffer{"POST / HTTP/1.0\nA: "};
+		releaseAssert(!parser.parse(buffer));
+		buffer += std::string(1000, 'b') + "\n\n";
+		buffer.shrink_to_fit();
+		releaseAssert(parser.parse(buffer));
+		releaseAssert(parser.method() == "POST");
+		releaseAssert(parser.header(0).second.size() == 1000);
+		releaseAssert(parser.size() == buffer.size());
+	}
+
+	// HTTP/0.9 has no headers.
+	{
+		RequestParser parser;
+		releaseAssert(parser.parse("GET /index.html\r\n"));
+		releaseAssert(parser.target() == "/index.html");
+		releaseAssert(parser.version().empty());
+		releaseAssert(parser.cHeaders() == 0);
+	}
+
+	// Malformed heads throw.
+	auto const parseError = [](std::string const &head) {
+		RequestParser parser;
+		try {
+			parser.parse(head);
+		} catch (RequestParser::Exception const &exception) {
+			return exception.getError();
+		}
+		return RequestParser::Error{};
+	};
+	releaseAssert(
+		parseError("GET\r\n") ==
+		RequestParser::Error::MALFORMED_REQUEST_LINE);
+	releaseAssert(
+		parseError("GET  HTTP/1.1\r\n") ==
+		RequestParser::Error::MALFORMED_REQUEST_LINE);
+	releaseAssert(
+		parseError("GET / HTTP/1.1\r\nHost\r\n\r\n") ==
+		RequestParser::Error::NO_COLON_DELIMITER);
+	releaseAssert(
+		parseError("GET / HTTP/1.1\r\nHost: a\rb\r\n\r\n") ==
+		RequestParser::Error::BARE_CARRIAGE_RETURN);
+	{
+		std::string head{"GET / HTTP/1.1\r\n"};
+		for (std::size_t i{0}; i <= RequestParser::MAX_HEADERS;
+				 i++) {
+			head += "A: b\r\n";
+		}
+		releaseAssert(
+			parseError(head) ==
+			RequestParser::Error::TOO_MANY_HEADERS);
+	}
+	releaseAssert(
+		parseError(
+			"GET / HTTP/1.1\r\nA: " +
+			std::string(RequestParser::MAX_HEAD_SIZE, 'b')) ==
+		RequestParser::Error::HEAD_OVERFLOW);
+
+	// Requests are received in place from a peekable
+	// streambuf, and through a copy once the head outgrows
+	// its buffer. Pipelined requests are left intact.
+	for (std::size_t bufferLen : {1_zu << 10, 64_zu}) {
+		ChunkedStreamBuf streamBuf(
+			requestStr + requestStr, 13, bufferLen);
+		std::istream stream(&streamBuf);
+		for (std::size_t i{0}; i < 2; i++) {
+			Request req;
+			stream >> req;
+			releaseAssert(req.method == Method::GET);
+			releaseAssert(req.version == Version::_1_1);
+			releaseAssert(req.headers.size() == 5);
+			releaseAssert(req.headers["user-agent"] == "rain");
+			std::string body(5, '\0');
+			req.body.read(&body[0], 5);
+			releaseAssert(body == "hello");
+		}
+	}
+
+	// Lines longer than the copy's line buffer.
+	{
+		std::stringstream stream(
+			"GET / HTTP/1.1\r\nLong: " + std::string(3000, 'a') +
+			"\r\n\r\n");
+		Request req;
+		stream >> req;
+		releaseAssert(req.headers["Long"].size() == 3000);
+	}
+
+	return 0;
+}
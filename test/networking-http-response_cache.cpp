@@ -0,0 +1,218 @@
+// Tests Networking::Http::ResponseCache, and its use by
+// Workers.
+#include <rain.hpp>
+
+using Rain::Error::releaseAssert;
+using namespace Rain::Literal;
+using namespace Rain::Networking;
+
+// Calls to each handler.
+std::atomic_size_t cCached{0}, cShort{0}, cVary{0},
+	cNoStore{0};
+
+Http::ResponseCache responseCache(1_zu << 20);
+
+class MyWorker : public Http::Worker<> {
+	using Worker::Worker;
+
+	ResponseAction reqCached(Request &, std::smatch const &) {
+		cCached++;
+		return {
+			{StatusCode::OK,
+				{{{"Cache-Control", "public, max-age=60"},
+					{"ETag", "\"v1\""},
+					{"Last-Modified",
+						"Sun, 06 Nov 1994 08:49:37 GMT"}}},
+				"cached " + std::to_string(cCached)}};
+	}
+	ResponseAction reqShort(Request &, std::smatch const &) {
+		cShort++;
+		return {
+			{StatusCode::OK,
+				{{{"Cache-Control", "max-age=1"}}},
+				"short " + std::to_string(cShort)}};
+	}
+	ResponseAction reqVary(Request &req, std::smatch const &) {
+		cVary++;
+		return {
+			{StatusCode::OK,
+				{{{"Cache-Control", "max-age=60"},
+					{"Vary", "Accept-Language"}}},
+				req.headers["Accept-Language"]}};
+	}
+	ResponseAction reqNoStore(
+		Request &,
+		std::smatch const &) {
+		cNoStore++;
+		return {
+			{StatusCode::OK,
+				{{{"Cache-Control", "no-store"}}},
+				"no-store"}};
+	}
+
+	virtual Filters const &filters() override {
+		static Filters const filters{
+			{".*", "/cached", {Method::GET}, &MyWorker::reqCached},
+			{".*", "/short", {Method::GET}, &MyWorker::reqShort},
+			{".*", "/vary", {Method::GET}, &MyWorker::reqVary},
+			{".*",
+				"/no-store",
+				{Method::GET},
+				&MyWorker::reqNoStore}};
+		return filters;
+	}
+
+	virtual Http::ResponseCache *responseCache() override {
+		return &::responseCache;
+	}
+};
+
+class MyServer : public Http::Server<MyWorker> {
+	using Server::Server;
+
+	virtual MyWorker makeWorker(
+		NativeSocket nativeSocket,
+		SocketInterface *interrupter) override {
+		return {nativeSocket, interrupter};
+	}
+
+	public:
+	~MyServer() { this->destruct(); }
+};
+
+// Sends a GET request with headers, and receives the
+// response and its body.
+std::pair<Http::Response, std::string> get(
+	Http::Client<> &client,
+	std::string const &target,
+	Http::Headers &&headers = {}) {
+	client.send(
+		{Http::Method::GET, target, std::move(headers)});
+	Http::Response res{client.recv()};
+	std::string body{
+		std::istreambuf_iterator<char>(res.body), {}};
+	return {std::move(res), std::move(body)};
+}
+
+int main() {
+	// Responses are stored up to the capacity in bytes,
+	// evicting the least-recently-used.
+	{
+		Http::ResponseCache cache(1_zu << 12, 1_zu << 11);
+		releaseAssert(cache.capacity() == 1_zu << 12);
+		Http::Headers headers;
+		for (std::size_t idx{0}; idx < 4; idx++) {
+			Http::Response res{
+				Http::StatusCode::OK,
+				{{{"Cache-Control", "max-age=60"}}},
+				std::string(1000, 'a')};
+			releaseAssert(
+				cache.insert(std::to_string(idx), headers, res) !=
+				nullptr);
+		}
+		releaseAssert(cache.size() <= cache.capacity());
+		releaseAssert(cache.find("0", headers) == nullptr);
+		releaseAssert(cache.find("3", headers) != nullptr);
+
+		// Responses without freshness are not stored, and are
+		// left to be sent.
+		Http::Response res{Http::StatusCode::OK, {}, "fresh"};
+		releaseAssert(
+			cache.insert("4", headers, res) == nullptr);
+		releaseAssert(res.body.inAvail() == 5);
+
+		// Responses over maxEntryLen are serialized, but not
+		// stored.
+		Http::Response large{
+			Http::StatusCode::OK,
+			{{{"Cache-Control", "max-age=60"}}},
+			std::string(1_zu << 11, 'a')};
+		auto entry{cache.insert("5", headers, large)};
+		releaseAssert(entry != nullptr);
+		releaseAssert(entry->body().size() == 1_zu << 11);
+		releaseAssert(cache.find("5", headers) == nullptr);
+	}
+
+	MyServer server(":0");
+	Http::Client<> client(
+		Host{"localhost", server.host().service});
+
+	// Fresh responses are sent from the cache, with their
+	// Age.
+	for (std::size_t idx{0}; idx < 2; idx++) {
+		auto [res, body]{get(client, "/cached")};
+		releaseAssert(body == "cached 1");
+		releaseAssert(res.headers["ETag"] == "\"v1\"");
+		releaseAssert(
+			res.headers.find("Age") != res.headers.end());
+	}
+	releaseAssert(cCached == 1);
+
+	// Conditional requests are answered with 304.
+	for (auto &&headers :
+			 {Http::Headers{
+					{{"If-None-Match", "\"v0\", W/\"v1\""}}},
+				 Http::Headers{{{"If-None-Match", "*"}}},
+				 Http::Headers{
+					 {{"If-Modified-Since",
+						 "Sun, 06 Nov 1994 08:49:37 GMT"}}}}) {
+		auto [res, body]{
+			get(client, "/cached", Http::Headers(headers))};
+		releaseAssert(
+			res.statusCode == Http::StatusCode::NOT_MODIFIED);
+		releaseAssert(body.empty());
+		releaseAssert(res.headers["ETag"] == "\"v1\"");
+	}
+	for (auto &&headers :
+			 {Http::Headers{{{"If-None-Match", "\"v0\""}}},
+				 Http::Headers{
+					 {{"If-Modified-Since",
+						 "Sat, 05 Nov 1994 08:49:37 GMT"}}}}) {
+		auto [res, body]{
+			get(client, "/cached", Http::Headers(headers))};
+		releaseAssert(res.statusCode == Http::StatusCode::OK);
+		releaseAssert(body == "cached 1");
+	}
+	releaseAssert(cCached == 1);
+
+	// Requests which bypass the cache, or ask for a new
+	// response, are handled anew.
+	releaseAssert(
+		get(client, "/cached", {{{"Cache-Control", "no-cache"}}})
+			.second == "cached 2");
+	releaseAssert(get(client, "/cached").second == "cached 2");
+	releaseAssert(
+		get(client, "/cached", {{{"Authorization", "Basic a"}}})
+			.second == "cached 3");
+
+	// Stale responses are handled anew.
+	{
+		releaseAssert(get(client, "/short").second == "short 1");
+		releaseAssert(get(client, "/short").second == "short 1");
+		std::this_thread::sleep_for(1100ms);
+		releaseAssert(get(client, "/short").second == "short 2");
+	}
+
+	// Variants are stored by their Vary headers.
+	for (std::size_t idx{0}; idx < 2; idx++) {
+		for (char const *language : {"en", "fr"}) {
+			releaseAssert(
+				get(client,
+					"/vary",
+					{{{"Accept-Language", language}}})
+					.second == language);
+		}
+	}
+	releaseAssert(cVary == 2);
+
+	// Responses which may not be stored are not.
+	get(client, "/no-store");
+	get(client, "/no-store");
+	releaseAssert(cNoStore == 2);
+
+	std::cout << "Hits: " << responseCache.hits()
+						<< ", misses: " << responseCache.misses() << "."
+						<< std::endl;
+	releaseAssert(responseCache.hits() > 0);
+	return 0;
+}
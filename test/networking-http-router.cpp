@@ -0,0 +1,157 @@
+// Tests Networking::Http::Router.
+#include <rain.hpp>
+
+using Rain::Error::releaseAssert;
+using Rain::Networking::Http::Router;
+
+// Values of patterns matching path, in increasing order.
+std::vector<std::size_t> matchAll(
+	Router const &router,
+	std::string_view path) {
+	std::vector<std::size_t> values;
+	router.match(
+		path, [&values](std::size_t value, auto const &) {
+			values.push_back(value);
+		});
+	std::sort(values.begin(), values.end());
+	return values;
+}
+
+int main() {
+	// Literals, parameters, and wildcards.
+	{
+		Router router;
+		router.insert("/", 0);
+		router.insert("/users", 1);
+		router.insert("/users/:id", 2);
+		router.insert("/users/:id/posts/:post", 3);
+		router.insert("/users/me", 4);
+		router.insert("/static/*path", 5);
+		router.insert("/use", 6);
+
+		releaseAssert(
+			matchAll(router, "/") == std::vector<std::size_t>{0});
+		releaseAssert(
+			matchAll(router, "/users") ==
+			std::vector<std::size_t>{1});
+		releaseAssert(
+			matchAll(router, "/use") ==
+			std::vector<std::size_t>{6});
+		releaseAssert(
+			matchAll(router, "/users/me") ==
+			std::vector<std::size_t>({2, 4}));
+		releaseAssert(matchAll(router, "/users/").empty());
+		releaseAssert(
+			matchAll(router, "/users/42/posts").empty());
+		releaseAssert(matchAll(router, "/nope").empty());
+		releaseAssert(
+			matchAll(router, "/static/") ==
+			std::vector<std::size_t>{5});
+
+		router.match(
+			"/users/42/posts/7",
+			[](std::size_t value, Router::Match const &match) {
+				releaseAssert(value == 3);
+				releaseAssert(match.cParameters == 2);
+				releaseAssert(match["id"] == "42");
+				releaseAssert(match["post"] == "7");
+				releaseAssert(match["none"].empty());
+			});
+		router.match(
+			"/static/css/a.css",
+			[](std::size_t value, Router::Match const &match) {
+				releaseAssert(value == 5);
+				releaseAssert(match["path"] == "css/a.css");
+			});
+	}
+
+	// Literal paths do not interpret `:` or `*`.
+	{
+		Router router;
+		router.insertLiteral("/a:b", false, 0);
+		router.insertLiteral("/files/", true, 1);
+		releaseAssert(
+			matchAll(router, "/a:b") ==
+			std::vector<std::size_t>{0});
+		releaseAssert(matchAll(router, "/a:c").empty());
+		releaseAssert(
+			matchAll(router, "/files/x/y?z") ==
+			std::vector<std::size_t>{1});
+		releaseAssert(matchAll(router, "/files").empty());
+	}
+
+	// Malformed patterns.
+	{
+		Router router;
+		try {
+			router.insert("/users/:/posts", 0);
+			releaseAssert(false);
+		} catch (Router::Exception const &exception) {
+			releaseAssert(
+				exception.getError() ==
+				Router::Error::EMPTY_PARAMETER_NAME);
+		}
+		try {
+			router.insert("/static/*path/more", 0);
+			releaseAssert(false);
+		} catch (Router::Exception const &exception) {
+			releaseAssert(
+				exception.getError() ==
+				Router::Error::WILDCARD_NOT_LAST);
+		}
+	}
+
+	// Patterns with too many parameters leave the Router
+	// unchanged.
+	{
+		Router router;
+		std::string pattern;
+		for (std::size_t idx{0}; idx <= Router::MAX_PARAMETERS;
+				 idx++) {
+			pattern += "/:p" + std::to_string(idx);
+		}
+		try {
+			router.insert(pattern, 0);
+			releaseAssert(false);
+		} catch (Router::Exception const &exception) {
+			releaseAssert(
+				exception.getError() ==
+				Router::Error::TOO_MANY_PARAMETERS);
+		}
+		router.insert("/:a/*rest", 1);
+		std::string path;
+		for (std::size_t idx{0}; idx <= Router::MAX_PARAMETERS;
+				 idx++) {
+			path += "/" + std::to_string(idx);
+		}
+		releaseAssert(
+			matchAll(router, path) == std::vector<std::size_t>{1});
+	}
+
+	// Literal regular expressions.
+	{
+		std::vector<std::string> literals;
+		bool isPrefix;
+		releaseAssert(Router::literalsOfRegex(
+			"/echo/?", literals, isPrefix));
+		releaseAssert(
+			literals ==
+			std::vector<std::string>({"/echo", "/echo/"}));
+		releaseAssert(!isPrefix);
+
+		literals.clear();
+		releaseAssert(Router::literalsOfRegex(
+			"/a\\.b.*", literals, isPrefix));
+		releaseAssert(
+			literals == std::vector<std::string>{"/a.b"});
+		releaseAssert(isPrefix);
+
+		literals.clear();
+		releaseAssert(!Router::literalsOfRegex(
+			"/digits/([0-9]+)", literals, isPrefix));
+		releaseAssert(
+			!Router::literalsOfRegex("/\\d", literals, isPrefix));
+	}
+
+	return 0;
+}
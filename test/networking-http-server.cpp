@@ -5,6 +5,21 @@ using Rain::Error::releaseAssert;
 using namespace Rain::Literal;
 using namespace Rain::Networking;
 
+// Served by the /file filter.
+std::filesystem::path const FILE_PATH{
+	std::filesystem::temp_directory_path() /
+	"rain-networking-http-server.txt"};
+std::string const FILE_CONTENT{"0123456789abcdefghij"};
+
+// Rows streamed by the /report filter.
+std::size_t const REPORT_ROWS{1000};
+
+// Set once the client has received the first part of
+// /slow, which its producer waits on for the second.
+std::mutex slowMtx;
+std::condition_variable slowEv;
+bool isSlowReleased{false};
+
 // Custom Request/Response output to cout when received
 // via pp-chain.
 class MyRequest : public Http::Request {
@@ -61,13 +76,58 @@ class MyWorker :
 		std::stringstream stream;
 		stream << req.body;
 
+		// Trailers of a chunked body are echoed as headers.
+		Headers headers{
+			{{"Your-Method", req.method},
+				{"Response-Test-Header", "test"}}};
+		for (auto const &trailer : req.trailers) {
+			headers[trailer.first] = trailer.second;
+		}
 		return {
 			{StatusCode::OK,
-				{{{"Your-Method", req.method},
-					{"Response-Test-Header", "test"}}},
+				std::move(headers),
 				stream.str(),
 				"reason"}};
 	}
+	// Streams a report of many rows, each produced only as
+	// it is sent.
+	ResponseAction reqReport(
+		Request &,
+		std::smatch const &) {
+		Response res{
+			StatusCode::OK,
+			{},
+			Http::ProducerStreamBuf(
+				[idx = 0_zu](std::ostream &stream) mutable {
+					stream << "row " << idx << '\n';
+					return ++idx < REPORT_ROWS;
+				})};
+		res.trailers["Rows"] = std::to_string(REPORT_ROWS);
+		res.chunkLen = 1_zu << 10;
+		return {std::move(res)};
+	}
+	// Produces its second part only once the first has been
+	// received.
+	ResponseAction reqSlow(Request &, std::smatch const &) {
+		return {
+			{StatusCode::OK,
+				{},
+				Http::ProducerStreamBuf(
+					[idx = 0](std::ostream &stream) mutable {
+						if (idx++ == 0) {
+							stream << "first";
+							return true;
+						}
+						std::unique_lock<std::mutex> slowLck(slowMtx);
+						stream << (slowEv.wait_for(
+													slowLck,
+													5s,
+													[]() { return isSlowReleased; })
+												? "second"
+												: "timed out");
+						return false;
+					})}};
+	}
 	ResponseAction reqPlay(
 		Request &req,
 		std::smatch const &) {
@@ -79,10 +139,28 @@ class MyWorker :
 					"\nHello world!"s,
 				"bruh"}};
 	}
+	ResponseAction reqUser(
+		Request &,
+		Http::Router::Match const &match) {
+		return {
+			{StatusCode::OK,
+				{{{"User-Id", std::string(match["id"])},
+					{"Rest", std::string(match["rest"])}}}}};
+	}
+	ResponseAction reqFile(Request &req, std::smatch const &) {
+		return {
+			{req.headers.range(), Http::FileStreamBuf(FILE_PATH)}};
+	}
+	ResponseAction reqDigits(
+		Request &,
+		std::smatch const &match) {
+		return {
+			{StatusCode::OK, {{{"Digits", match[1].str()}}}}};
+	}
 
-	virtual std::vector<RequestFilter> const &
-		filters() override {
-		static std::vector<RequestFilter> const filters{
+	protected:
+	virtual Filters const &filters() override {
+		static Filters const filters{
 			{".*",
 				"/simple/?",
 				{Method::GET},
@@ -94,10 +172,29 @@ class MyWorker :
 			{".*",
 				"/play.*",
 				{Method::GET, Method::POST},
-				&MyWorker::reqPlay}};
+				&MyWorker::reqPlay},
+			{".*",
+				"/users/:id/*rest"s,
+				{Method::GET},
+				&MyWorker::reqUser},
+			{".*", "/file", {Method::GET}, &MyWorker::reqFile},
+			{".*",
+				"/report",
+				{Method::GET},
+				&MyWorker::reqReport},
+			{".*", "/slow", {Method::GET}, &MyWorker::reqSlow},
+			{"(localhost)?:[0-9]*",
+				"/digits/([0-9]+)",
+				{Method::GET},
+				&MyWorker::reqDigits},
+			MyWorker::metricsFilter()};
 		return filters;
 	}
 
+	private:
+	// Record per-request metrics, which are served below.
+	virtual bool onWorkMetrics() override { return true; }
+
 	// Override send pp-chain to add server signature.
 	virtual void send(Http::Response &res) override {
 		res.headers.server("MyServer");
@@ -124,6 +221,118 @@ class MyServer :
 	~MyServer() { this->destruct(); }
 };
 
+// Worker whose request heads must be received within 100ms
+// of their first byte, however slowly they trickle in.
+class DeadlineWorker : public MyWorker {
+	public:
+	using MyWorker::MyWorker;
+
+	private:
+	virtual std::chrono::milliseconds onWorkHeadTimeout()
+		override {
+		return 100ms;
+	}
+	virtual std::chrono::milliseconds onWorkRequestTimeout()
+		override {
+		return 200ms;
+	}
+};
+
+class DeadlineServer :
+	public Http::Server<
+		DeadlineWorker,
+		Ipv6FamilyInterface,
+		DualStackSocketOption,
+		NoLingerSocketOption> {
+	using Server::Server;
+
+	private:
+	virtual DeadlineWorker makeWorker(
+		NativeSocket nativeSocket,
+		SocketInterface *interrupter) override {
+		return {nativeSocket, interrupter};
+	}
+
+	public:
+	~DeadlineServer() { this->destruct(); }
+};
+
+// Worker whose filters begin with a copy of the first
+// filter of MyWorker, but are otherwise fewer.
+class SubsetWorker : public MyWorker {
+	public:
+	using MyWorker::MyWorker;
+
+	private:
+	virtual Filters const &filters() override {
+		static Filters const filters{
+			MyWorker::filters().list().front(),
+			MyWorker::filters().list().back()};
+		return filters;
+	}
+};
+
+class SubsetServer :
+	public Http::Server<
+		SubsetWorker,
+		Ipv6FamilyInterface,
+		DualStackSocketOption,
+		NoLingerSocketOption> {
+	using Server::Server;
+
+	private:
+	virtual SubsetWorker makeWorker(
+		NativeSocket nativeSocket,
+		SocketInterface *interrupter) override {
+		return {nativeSocket, interrupter};
+	}
+
+	public:
+	~SubsetServer() { this->destruct(); }
+};
+
+// Worker whose filters are its own, and alternate between
+// all and only the first filter of MyWorker across
+// Workers.
+class MemberWorker : public MyWorker {
+	public:
+	MemberWorker(auto &&...args) :
+		MyWorker(std::forward<decltype(args)>(args)...),
+		ownFilters(
+			MemberWorker::cWorkers++ % 2 == 0
+				? MyWorker::filters().list()
+				: std::vector<RequestFilter>{
+						MyWorker::filters().list().front()}) {}
+
+	private:
+	static inline std::atomic_size_t cWorkers{0};
+
+	Filters ownFilters;
+
+	virtual Filters const &filters() override {
+		return this->ownFilters;
+	}
+};
+
+class MemberServer :
+	public Http::Server<
+		MemberWorker,
+		Ipv6FamilyInterface,
+		DualStackSocketOption,
+		NoLingerSocketOption> {
+	using Server::Server;
+
+	private:
+	virtual MemberWorker makeWorker(
+		NativeSocket nativeSocket,
+		SocketInterface *interrupter) override {
+		return {nativeSocket, interrupter};
+	}
+
+	public:
+	~MemberServer() { this->destruct(); }
+};
+
 class MyClient :
 	public Http::Client<
 		Http::Request,
@@ -143,6 +352,10 @@ class MyClient :
 };
 
 int main() {
+	{
+		std::ofstream file(FILE_PATH, std::ios::binary);
+		file << FILE_CONTENT;
+	}
 
 	{
 		MyServer server(":0");
@@ -182,6 +395,108 @@ int main() {
 			client.shutdown();
 		}
 
+		// Routed filters, by pattern and by regex.
+		{
+			MyClient client(
+				Host{"localhost", server.host().service});
+			{
+				client.send(
+					{Http::Method::GET, "/users/42/posts/7?q=1"s});
+				auto res = client.recv();
+				releaseAssert(
+					res.statusCode == Http::StatusCode::OK);
+				releaseAssert(res.headers["User-Id"] == "42");
+				releaseAssert(res.headers["Rest"] == "posts/7");
+			}
+			{
+				client.send({Http::Method::POST, "/users/42/"s});
+				auto res = client.recv();
+				releaseAssert(
+					res.statusCode == Http::StatusCode::NOT_FOUND);
+			}
+			{
+				client.send({Http::Method::GET, "/digits/123"s});
+				auto res = client.recv();
+				releaseAssert(
+					res.statusCode == Http::StatusCode::OK);
+				releaseAssert(res.headers["Digits"] == "123");
+			}
+			{
+				client.send({Http::Method::GET, "/digits/12a"s});
+				auto res = client.recv();
+				releaseAssert(
+					res.statusCode == Http::StatusCode::NOT_FOUND);
+			}
+			client.shutdown();
+		}
+
+		// Metrics of earlier requests are served in Prometheus
+		// text format.
+		{
+			MyClient client(
+				Host{"localhost", server.host().service});
+			client.send({Http::Method::GET, "/metrics"s});
+			auto res = client.recv();
+			std::stringstream stream;
+			stream << res.body;
+			std::string const metrics{stream.str()};
+			releaseAssert(res.statusCode == Http::StatusCode::OK);
+			releaseAssert(
+				metrics.find(
+					"# TYPE rain_server_accepted_total counter\n") !=
+				std::string::npos);
+			releaseAssert(
+				metrics.find("rain_reqres_request_seconds_count ") !=
+				std::string::npos);
+			releaseAssert(
+				metrics.find(
+					"rain_reqres_request_seconds_count 0\n") ==
+				std::string::npos);
+			client.shutdown();
+		}
+
+		// Files are sent whole, or by byte range.
+		{
+			MyClient client(
+				Host{"localhost", server.host().service});
+			std::pair<std::string, std::string> const cases[]{
+				{"", FILE_CONTENT},
+				{"bytes=2-5", "2345"},
+				{"bytes=15-", "fghij"},
+				{"bytes=-3", "hij"},
+				{"bytes=18-100", "ij"},
+				{"bytes=0-1,4-5", FILE_CONTENT}};
+			for (auto const &[range, expected] : cases) {
+				Http::Request req{Http::Method::GET, "/file"s};
+				if (!range.empty()) {
+					req.headers["Range"] = range;
+				}
+				client.send(req);
+				auto res = client.recv();
+				std::stringstream stream;
+				stream << res.body;
+				releaseAssert(stream.str() == expected);
+				releaseAssert(
+					res.statusCode ==
+					(expected == FILE_CONTENT
+							? Http::StatusCode::OK
+							: Http::StatusCode::PARTIAL_CONTENT));
+			}
+			{
+				client.send(
+					{Http::Method::GET,
+						"/file"s,
+						{{{"Range", "bytes=20-"}}}});
+				auto res = client.recv();
+				releaseAssert(
+					res.statusCode ==
+					Http::StatusCode::REQUESTED_RANGE_NOT_SATISFIABLE);
+				releaseAssert(
+					res.headers["Content-Range"] == "bytes */20");
+			}
+			client.shutdown();
+		}
+
 		// Server and client ignore 0.9 headers and server
 		// ignores body.
 		{
@@ -247,6 +562,159 @@ int main() {
 				releaseAssert(stream.str() == body);
 				releaseAssert(res.headers["your-method"] == "POST");
 			}
+
+			// Chunk sizes are hexadecimal, with optional
+			// extensions, and the last chunk may be followed by
+			// trailers.
+			{
+				client.send(
+					{Http::Method::POST,
+						"/echo",
+						{{{"Transfer-Encoding", "chunked"}}},
+						"5;name=value\r\nhello\r\n"
+						"B ; a ;b=\"c\"\r\n worldworld\r\n"
+						"0\r\nChecksum: abc \r\nRows: 2\r\n\r\n"});
+				auto res = client.recv();
+				std::stringstream stream;
+				stream << res.body;
+				releaseAssert(stream.str() == "hello worldworld");
+				releaseAssert(res.headers["Checksum"] == "abc");
+				releaseAssert(res.headers["Rows"] == "2");
+			}
+
+			// Multi-digit sizes would be misread as decimal.
+			{
+				std::string const part(0x1a, 'x');
+				client.send(
+					{Http::Method::POST,
+						"/echo",
+						{{{"Transfer-Encoding", "chunked"}}},
+						"1a\r\n" + part + "\r\n10\r\n" +
+							part.substr(0, 0x10) + "\r\n0\r\n\r\n"});
+				auto res = client.recv();
+				std::stringstream stream;
+				stream << res.body;
+				releaseAssert(
+					stream.str() == part + part.substr(0, 0x10));
+			}
+
+			// Requests of indeterminate length are sent chunked,
+			// and are followed by the next on the connection.
+			{
+				Http::Request req{
+					Http::Method::POST,
+					"/echo",
+					{},
+					Http::ProducerStreamBuf(
+						[idx = 0](std::ostream &stream) mutable {
+							stream << "part" << idx;
+							return ++idx < 3;
+						})};
+				req.trailers["Checksum"] = "def";
+				client.send(req);
+				releaseAssert(
+					req.headers.transferEncoding() ==
+					std::vector<Http::Header::TransferEncoding>{
+						Http::Header::TransferEncoding::CHUNKED});
+				auto res = client.recv();
+				std::stringstream stream;
+				stream << res.body;
+				releaseAssert(stream.str() == "part0part1part2");
+				releaseAssert(res.headers["Checksum"] == "def");
+			}
+			{
+				client.send({Http::Method::GET, "/simple"});
+				auto res = client.recv();
+				releaseAssert(
+					res.statusCode == Http::StatusCode::OK);
+			}
+
+			// Produced responses are streamed in chunks, with
+			// trailers.
+			{
+				client.send({Http::Method::GET, "/report"});
+				auto res = client.recv();
+				releaseAssert(
+					res.headers.find("Content-Length") ==
+					res.headers.end());
+				std::string line;
+				std::size_t cRows{0};
+				while (std::getline(res.body, line)) {
+					releaseAssert(
+						line == "row " + std::to_string(cRows));
+					cRows++;
+				}
+				releaseAssert(cRows == REPORT_ROWS);
+				releaseAssert(res.trailers["Rows"] == "1000");
+			}
+
+			// Each call of the producer is sent as it returns,
+			// before the next is made.
+			{
+				client.send({Http::Method::GET, "/slow"});
+				auto res = client.recv();
+				char first[5];
+				releaseAssert(
+					res.body.read(first, sizeof(first)) &&
+					std::string_view(first, sizeof(first)) ==
+						"first");
+				{
+					std::lock_guard<std::mutex> slowLckGuard(slowMtx);
+					isSlowReleased = true;
+				}
+				slowEv.notify_all();
+				std::stringstream stream;
+				stream << res.body;
+				releaseAssert(stream.str() == "second");
+			}
+
+			// Before HTTP/1.1, they are instead delimited by
+			// closing the connection.
+			{
+				Client<
+					Ipv4FamilyInterface,
+					StreamTypeInterface,
+					TcpProtocolInterface>
+					rawClient(
+						Host{"localhost", server.host().service});
+				rawClient.send("GET /report HTTP/1.0\r\n\r\n"s);
+				std::string response, buffer;
+				buffer.reserve(1_zu << 12);
+				while (rawClient.recv(buffer, 1s) > 0) {
+					response += buffer;
+				}
+				releaseAssert(
+					response.find("Transfer-Encoding") ==
+					std::string::npos);
+				releaseAssert(response.ends_with("row 999\n"));
+			}
+
+			// Malformed chunks fail the request and close the
+			// connection, so that what follows them is never
+			// taken for the next request.
+			{
+				Client<
+					Ipv4FamilyInterface,
+					StreamTypeInterface,
+					TcpProtocolInterface>
+					rawClient(
+						Host{"localhost", server.host().service});
+				rawClient.send(
+					"POST /echo HTTP/1.1\r\n"
+					"Transfer-Encoding: chunked\r\n\r\n"
+					"5\r\nhello\r\nzz\r\n"
+					"GET /simple HTTP/1.1\r\n\r\n"s);
+				std::string response, buffer;
+				buffer.reserve(1_zu << 12);
+				while (rawClient.recv(buffer, 1s) > 0) {
+					response += buffer;
+				}
+				releaseAssert(
+					response.starts_with("HTTP/1.1 400"));
+				releaseAssert(
+					response.find("HTTP/1.1", 1) ==
+					std::string::npos);
+			}
 		}
 
 		// Idling over 300ms will close connection.
@@ -264,5 +732,232 @@ int main() {
 		}
 	}
 
+	// Reactor mode serves keep-alive connections without
+	// holding a thread for each idle connection.
+	{
+		MyServer server(ServeOptions{.reactors = 2}, ":0");
+		std::cout << "Serving on " << server.host()
+							<< " with 2 reactors." << std::endl;
+
+		std::vector<std::unique_ptr<MyClient>> clients;
+		for (std::size_t i{0}; i < 16; i++) {
+			clients.emplace_back(
+				new MyClient(Host{"localhost", server.host().service}));
+			clients.back()->send({Http::Method::GET, "/simple"s});
+			auto res = clients.back()->recv();
+			releaseAssert(res.statusCode == Http::StatusCode::OK);
+		}
+
+		// Each connection is still alive, and can be reused.
+		std::this_thread::sleep_for(50ms);
+		std::cout << "Server workers: " << server.workers()
+							<< ", threads: " << server.threads()
+							<< std::endl;
+		releaseAssert(server.workers() == 16);
+		releaseAssert(server.threads() < 16);
+		for (auto &client : clients) {
+			client->send(
+				{Http::Method::POST, "/echo", {}, "hello"});
+			auto res = client->recv();
+			std::stringstream stream;
+			stream << res.body;
+			releaseAssert(stream.str() == "hello");
+		}
+
+		// Idle connections are closed by the reactor after the
+		// Worker recv timeout.
+		std::this_thread::sleep_for(400ms);
+		releaseAssert(server.workers() == 0);
+		clients.front()->send({Http::Method::GET, "/"s});
+		clients.front()->recv();
+		releaseAssert(!clients.front()->good());
+	}
+
+	// Heads which trickle in are cut off by the head
+	// deadline, even though each byte arrives within the recv
+	// timeout, in both thread and reactor mode.
+	for (auto const &serveOptions :
+			 {ServeOptions{}, ServeOptions{.reactors = 1}}) {
+		DeadlineServer server(serveOptions, ":0");
+		std::cout << "Serving on " << server.host()
+							<< " with deadlines and "
+							<< serveOptions.reactors << " reactors."
+							<< std::endl;
+
+		// Requests within their deadlines are unaffected.
+		{
+			MyClient client(
+				Host{"localhost", server.host().service});
+			for (std::size_t idx{0}; idx < 2; idx++) {
+				client.send({Http::Method::GET, "/simple"s});
+				auto res = client.recv();
+				releaseAssert(
+					res.statusCode == Http::StatusCode::OK);
+			}
+		}
+
+		Client<
+			Ipv4FamilyInterface,
+			StreamTypeInterface,
+			TcpProtocolInterface>
+			client(Host{"localhost", server.host().service});
+		client.send("GET /simple HTTP/1.1\r\nX-Slow: "s);
+		auto const timeBegin{std::chrono::steady_clock::now()};
+		bool closed{false};
+		while (
+			!closed &&
+			std::chrono::steady_clock::now() - timeBegin < 1s) {
+			char buffer;
+			Rain::Time::Timeout timeout{50ms};
+			try {
+				client.send("a"s);
+				closed = client.recv(&buffer, 1, timeout) == 0 &&
+					!timeout.isPassed();
+			} catch (...) {
+				closed = true;
+			}
+		}
+		auto const timeElapsed{
+			std::chrono::steady_clock::now() - timeBegin};
+		std::cout << "Closed after " << timeElapsed << "."
+							<< std::endl;
+		releaseAssert(closed);
+		releaseAssert(timeElapsed >= 90ms);
+		releaseAssert(timeElapsed < 250ms);
+	}
+
+	// Pipelined requests are answered in order, and their
+	// responses sent together, in both thread and reactor
+	// mode. The last request closes the connection, which
+	// still sends held responses.
+	for (auto const &serveOptions :
+			 {ServeOptions{}, ServeOptions{.reactors = 1}}) {
+		MyServer server(serveOptions, ":0");
+		std::cout << "Serving on " << server.host()
+							<< " for pipelining with "
+							<< serveOptions.reactors << " reactors."
+							<< std::endl;
+
+		Client<
+			Ipv4FamilyInterface,
+			StreamTypeInterface,
+			TcpProtocolInterface>
+			client(Host{"localhost", server.host().service});
+		std::size_t const C_REQUESTS{8};
+		std::string requests;
+		for (std::size_t idx{0}; idx < C_REQUESTS; idx++) {
+			requests += "GET /users/" + std::to_string(idx) +
+				"/x HTTP/1.1\r\nHost: localhost\r\n\r\n";
+		}
+		requests += "GET /simple HTTP/1.0\r\n\r\n";
+		client.send(requests);
+
+		// All responses arrive in the first recv.
+		std::string response, buffer;
+		buffer.reserve(1_zu << 16);
+		releaseAssert(client.recv(buffer, 1s) > 0);
+		response = buffer;
+		std::size_t position{0}, cResponses{0};
+		for (std::size_t idx{0}; idx < C_REQUESTS; idx++) {
+			position = response.find(
+				"User-Id: " + std::to_string(idx) + "\r\n", position);
+			releaseAssert(position != std::string::npos);
+		}
+		for (position = 0;
+				 (position = response.find("HTTP/1.", position)) !=
+				 std::string::npos;
+				 position++) {
+			cResponses++;
+		}
+		releaseAssert(cResponses == C_REQUESTS + 1);
+	}
+
+	// A body which reads as a request head is not taken for a
+	// pipelined request, so that its response is not held,
+	// in both thread and reactor mode.
+	for (auto const &serveOptions :
+			 {ServeOptions{}, ServeOptions{.reactors = 1}}) {
+		MyServer server(serveOptions, ":0");
+		Client<
+			Ipv4FamilyInterface,
+			StreamTypeInterface,
+			TcpProtocolInterface>
+			client(Host{"localhost", server.host().service});
+		std::string const body{"GET / HTTP/1.1\r\n\r\n"};
+		auto const timeBegin{std::chrono::steady_clock::now()};
+		client.send(
+			"POST /echo HTTP/1.1\r\nHost: localhost\r\n"
+			"Content-Length: " +
+			std::to_string(body.length()) + "\r\n\r\n" + body);
+		std::string response, buffer;
+		buffer.reserve(1_zu << 12);
+		while (!response.ends_with(body) &&
+			client.recv(buffer, 1s) > 0) {
+			response += buffer;
+		}
+		auto const timeElapsed{
+			std::chrono::steady_clock::now() - timeBegin};
+		std::cout << "Responded to a request-like body in "
+							<< timeElapsed << "." << std::endl;
+		releaseAssert(response.starts_with("HTTP/1.1 200"));
+		releaseAssert(response.ends_with(body));
+		releaseAssert(timeElapsed < 100ms);
+	}
+
+	// Filter vectors sharing copies of the same filter are
+	// routed separately.
+	{
+		SubsetServer server(":0");
+		MyClient client(
+			Host{"localhost", server.host().service});
+		client.send({Http::Method::GET, "/simple"s});
+		releaseAssert(
+			client.recv().statusCode == Http::StatusCode::OK);
+		client.send({Http::Method::GET, "/metrics"s});
+		auto res{client.recv()};
+		releaseAssert(res.statusCode == Http::StatusCode::OK);
+		std::stringstream body;
+		body << res.body;
+		client.send({Http::Method::GET, "/play"s});
+		releaseAssert(
+			client.recv().statusCode ==
+			Http::StatusCode::NOT_FOUND);
+
+		// Static Filters are compiled once, and not again for
+		// each accepted Worker.
+		auto &compiledMetric{Http::
+				WorkerSocketSpecInterfaceInterface::
+					routesCompiledMetric};
+		std::uint64_t const cCompiled{compiledMetric.value()};
+		for (std::size_t idx{0}; idx < 8; idx++) {
+			MyClient other(
+				Host{"localhost", server.host().service});
+			other.send({Http::Method::GET, "/simple"s});
+			releaseAssert(
+				other.recv().statusCode == Http::StatusCode::OK);
+		}
+		releaseAssert(compiledMetric.value() == cCompiled);
+	}
+
+	// Filters owned by each Worker are routed by that
+	// Worker, even once Filters of another Worker which has
+	// since closed had the same address.
+	{
+		MemberServer server(":0");
+		for (std::size_t idx{0}; idx < 8; idx++) {
+			MyClient client(
+				Host{"localhost", server.host().service});
+			client.send({Http::Method::GET, "/simple"s});
+			releaseAssert(
+				client.recv().statusCode == Http::StatusCode::OK);
+			client.send({Http::Method::GET, "/play"s});
+			releaseAssert(
+				client.recv().statusCode ==
+				(idx % 2 == 0 ? Http::StatusCode::OK
+											: Http::StatusCode::NOT_FOUND));
+		}
+	}
+
+	std::filesystem::remove(FILE_PATH);
 	return 0;
 }
@@ -0,0 +1,226 @@
+// Tests Networking::Http2::Hpack.
+#include <rain.hpp>
+
+using Rain::Error::releaseAssert;
+using namespace Rain::Literal;
+using namespace Rain::Networking::Http2::Hpack;
+using namespace std::literals;
+
+// Decodes a hex string, as printed in RFC 7541 Appendix C.
+std::string unhex(std::string_view hex) {
+	std::string bytes;
+	for (std::size_t idx{0}; idx < hex.size(); idx += 2) {
+		bytes.push_back(static_cast<char>(
+			std::stoi(std::string(hex.substr(idx, 2)), 0, 16)));
+	}
+	return bytes;
+}
+
+int main() {
+	// Huffman codes of RFC 7541 C.4.1, and round trips of
+	// every symbol.
+	{
+		std::string encoded;
+		Huffman::encode(encoded, "www.example.com");
+		releaseAssert(
+			encoded == unhex("f1e3c2e5f23a6ba0ab90f4ff"));
+		releaseAssert(
+			Huffman::encodedLen("www.example.com") == 12);
+		std::string decoded;
+		releaseAssert(Huffman::decode(decoded, encoded));
+		releaseAssert(decoded == "www.example.com");
+
+		std::string all;
+		for (std::size_t symbol{0}; symbol < 256; symbol++) {
+			all.push_back(static_cast<char>(symbol));
+			all.push_back(static_cast<char>(255 - symbol));
+		}
+		encoded.clear();
+		Huffman::encode(encoded, all);
+		releaseAssert(
+			encoded.size() == Huffman::encodedLen(all));
+		decoded.clear();
+		releaseAssert(Huffman::decode(decoded, encoded));
+		releaseAssert(decoded == all);
+
+		// Padding longer than 7 bits, or not of EOS, and EOS.
+		decoded.clear();
+		releaseAssert(!Huffman::decode(decoded, "\xff"sv));
+		releaseAssert(!Huffman::decode(decoded, "\x1f\x00"sv));
+		releaseAssert(
+			!Huffman::decode(decoded, "\xff\xff\xff\xff"sv));
+	}
+
+	// Requests of RFC 7541 C.4, sharing a dynamic table.
+	{
+		Decoder decoder;
+		std::vector<Field> fields;
+		decoder.decode(
+			unhex("828684418cf1e3c2e5f23a6ba0ab90f4ff"), fields);
+		releaseAssert(
+			fields ==
+			std::vector<Field>{
+				{":method", "GET"},
+				{":scheme", "http"},
+				{":path", "/"},
+				{":authority", "www.example.com"}});
+
+		fields.clear();
+		decoder.decode(
+			unhex("828684be5886a8eb10649cbf"), fields);
+		releaseAssert(fields.size() == 5);
+		releaseAssert(
+			fields[3] == Field{":authority", "www.example.com"});
+		releaseAssert(
+			fields[4] == Field{"cache-control", "no-cache"});
+
+		fields.clear();
+		decoder.decode(
+			unhex(
+				"828785bf408825a849e95ba97d7f89"
+				"25a849e95bb8e8b4bf"),
+			fields);
+		releaseAssert(fields.size() == 5);
+		releaseAssert(fields[1] == Field{":scheme", "https"});
+		releaseAssert(
+			fields[2] == Field{":path", "/index.html"});
+		releaseAssert(
+			fields[3] == Field{":authority", "www.example.com"});
+		releaseAssert(
+			fields[4] == Field{"custom-key", "custom-value"});
+	}
+
+	// Responses of RFC 7541 C.6, whose dynamic table of 256
+	// bytes evicts entries.
+	{
+		Decoder decoder(256);
+		std::vector<Field> fields;
+		decoder.decode(
+			unhex(
+				"488264025885aec3771a4b6196d07abe941054d4"
+				"44a8200595040b8166e082a62d1bff6e919d29ad"
+				"171863c78f0b97c8e9ae82ae43d3"),
+			fields);
+		releaseAssert(fields.size() == 4);
+		releaseAssert(fields[0] == Field{":status", "302"});
+		releaseAssert(
+			fields[3] ==
+			Field{"location", "https://www.example.com"});
+
+		fields.clear();
+		decoder.decode(unhex("4883640effc1c0bf"), fields);
+		releaseAssert(fields.size() == 4);
+		releaseAssert(fields[0] == Field{":status", "307"});
+		releaseAssert(
+			fields[2] ==
+			Field{"date", "Mon, 21 Oct 2013 20:13:21 GMT"});
+
+		fields.clear();
+		decoder.decode(
+			unhex(
+				"88c16196d07abe941054d444a8200595040b8166"
+				"e084a62d1bffc05a839bd9ab77ad94e7821dd7f2"
+				"e6c7b335dfdfcd5b3960d5af27087f3672c1ab27"
+				"0fb5291f9587316065c003ed4ee5b1063d5007"),
+			fields);
+		releaseAssert(fields.size() == 6);
+		releaseAssert(fields[0] == Field{":status", "200"});
+		releaseAssert(
+			fields[4] == Field{"content-encoding", "gzip"});
+		releaseAssert(
+			fields[5] ==
+			Field{
+				"set-cookie",
+				"foo=ASDJKHQKBZXOQWEOPIUAXQWEOIU; max-age=3600; "
+				"version=1"});
+	}
+
+	// Malformed blocks, table sizes past the maximum, and
+	// lists too long throw.
+	for (std::string_view block :
+			 {"\x80"sv,
+				 "\xbf"sv,
+				 "\x40\x85"sv,
+				 "\x3f\xe2\x1f"sv}) {
+		Decoder decoder;
+		std::vector<Field> fields;
+		bool isThrown{false};
+		try {
+			decoder.decode(block, fields);
+		} catch (Decoder::Exception const &) {
+			isThrown = true;
+		}
+		releaseAssert(isThrown);
+	}
+	{
+		Decoder decoder;
+		decoder.maxListSize = 64;
+		Encoder encoder;
+		std::string block;
+		encoder.encode(block, "x-long", std::string(64, 'x'));
+		std::vector<Field> fields;
+		bool isThrown{false};
+		try {
+			decoder.decode(block, fields);
+		} catch (Decoder::Exception const &exception) {
+			isThrown = exception.getError() ==
+				Decoder::Error::LIST_TOO_LONG;
+		}
+		releaseAssert(isThrown);
+	}
+
+	// Encoders index static fields, and fields repeated
+	// across blocks, with names lowercased.
+	{
+		Encoder encoder;
+		Decoder decoder;
+		std::string block;
+		encoder.encode(block, ":method", "GET");
+		releaseAssert(block == "\x82"sv);
+
+		std::vector<Field> fields;
+		for (std::size_t idx{0}; idx < 3; idx++) {
+			block.clear();
+			encoder.encode(block, "Content-Type", "text/html");
+			encoder.encode(block, "x-request", "repeated value");
+			releaseAssert(
+				idx == 0 ? block.size() > 2 : block.size() == 2);
+			fields.clear();
+			decoder.decode(block, fields);
+			releaseAssert(
+				fields ==
+				std::vector<Field>{
+					{"content-type", "text/html"},
+					{"x-request", "repeated value"}});
+		}
+	}
+
+	// Random blocks round trip, across table resizes and
+	// evictions.
+	{
+		std::mt19937_64 generator(0);
+		Encoder encoder(256);
+		Decoder decoder(256);
+		for (std::size_t iteration{0}; iteration < 4096;
+				 iteration++) {
+			if (generator() % 64 == 0) {
+				encoder.resize(generator() % 320);
+			}
+			std::vector<Field> fields;
+			std::string block;
+			for (std::size_t idx{generator() % 8}; idx > 0;
+					 idx--) {
+				fields.emplace_back(
+					"x-" + std::to_string(generator() % 16),
+					std::string(generator() % 48, 'a' + idx));
+				encoder.encode(
+					block, fields.back().first, fields.back().second);
+			}
+			std::vector<Field> decoded;
+			decoder.decode(block, decoded);
+			releaseAssert(decoded == fields);
+		}
+	}
+
+	return 0;
+}
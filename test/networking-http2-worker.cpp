@@ -0,0 +1,376 @@
+// Tests Networking::Http2::Worker and Client.
+#include <rain.hpp>
+
+using Rain::Error::releaseAssert;
+using namespace Rain::Literal;
+using namespace Rain::Networking;
+using namespace std::literals;
+
+// Set once /release is routed, which /held waits on.
+std::mutex releaseMtx;
+std::condition_variable releaseEv;
+bool isReleased{false};
+
+class MyWorker : public Http2::Worker<> {
+	public:
+	MyWorker(
+		NativeSocket nativeSocket,
+		SocketInterface *interrupter) :
+		Worker(nativeSocket, interrupter) {
+		this->maxBodyLen = 1_zu << 22;
+	}
+
+	private:
+	ResponseAction reqHello(
+		Request &req,
+		std::smatch const &) {
+		return {Response{
+			Http::StatusCode::OK,
+			{},
+			req.target + " " + std::string(req.version)}};
+	}
+	ResponseAction reqBig(Request &, std::smatch const &) {
+		std::string body(1_zu << 22, '\0');
+		for (std::size_t idx{0}; idx < body.size(); idx++) {
+			body[idx] = static_cast<char>(idx % 251);
+		}
+		return {Response{Http::StatusCode::OK, {}, body}};
+	}
+	ResponseAction reqEcho(Request &req, std::smatch const &) {
+		return {Response{
+			Http::StatusCode::OK,
+			{},
+			std::string(
+				std::istreambuf_iterator<char>(req.body),
+				std::istreambuf_iterator<char>())}};
+	}
+
+	ResponseAction reqHeld(Request &, std::smatch const &) {
+		std::unique_lock<std::mutex> releaseLck(releaseMtx);
+		bool const released{releaseEv.wait_for(
+			releaseLck, 5s, []() { return isReleased; })};
+		return {Response{
+			Http::StatusCode::OK,
+			{},
+			released ? "released" : "timed out"}};
+	}
+	ResponseAction reqRelease(Request &, std::smatch const &) {
+		{
+			std::lock_guard<std::mutex> releaseLckGuard(
+				releaseMtx);
+			isReleased = true;
+		}
+		releaseEv.notify_all();
+		return {Response{Http::StatusCode::OK, {}, "release"}};
+	}
+
+	virtual Filters const &filters() override {
+		static Filters const filters{
+			{".*",
+				"/hello.*",
+				{Http::Method::GET, Http::Method::HEAD},
+				&MyWorker::reqHello},
+			{".*", "/big", {Http::Method::GET}, &MyWorker::reqBig},
+			{".*",
+				"/echo",
+				{Http::Method::POST},
+				&MyWorker::reqEcho},
+			{".*", "/held", {Http::Method::GET}, &MyWorker::reqHeld},
+			{".*",
+				"/release",
+				{Http::Method::GET},
+				&MyWorker::reqRelease}};
+		return filters;
+	}
+};
+
+class MyServer : public Http::Server<MyWorker> {
+	using Server::Server;
+
+	virtual MyWorker makeWorker(
+		NativeSocket nativeSocket,
+		SocketInterface *interrupter) override {
+		return {nativeSocket, interrupter};
+	}
+
+	public:
+	~MyServer() { this->destruct(); }
+};
+
+std::string bodyOf(Http::Response &res) {
+	return {
+		std::istreambuf_iterator<char>(res.body),
+		std::istreambuf_iterator<char>()};
+}
+
+int main() {
+	MyServer server(":0");
+	Host const host{"localhost", server.host().service};
+
+	// Requests beyond SETTINGS_MAX_CONCURRENT_STREAMS wait
+	// for streams, and responses are received in order.
+	{
+		Http2::Client<> client(host);
+		for (std::size_t idx{0}; idx < 600; idx++) {
+			client.send(
+				{Http::Method::GET,
+					"/hello/" + std::to_string(idx),
+					{{{"Host", "localhost"}}}});
+		}
+		for (std::size_t idx{0}; idx < 600; idx++) {
+			Http::Response res{client.recv()};
+			releaseAssert(res.statusCode == Http::StatusCode::OK);
+			releaseAssert(res.version == Http::Version::_2_0);
+			releaseAssert(
+				bodyOf(res) ==
+				"/hello/" + std::to_string(idx) + " 2.0");
+		}
+	}
+
+	// Bodies larger than flow control windows, in either
+	// direction, interleaved across streams.
+	{
+		Http2::Client<> client(host);
+		std::mt19937_64 generator(0);
+		std::string random(1_zu << 21, '\0');
+		for (char &byte : random) {
+			byte = static_cast<char>(generator());
+		}
+		for (std::size_t idx{0}; idx < 4; idx++) {
+			client.send({Http::Method::GET, "/big"});
+			client.send({Http::Method::POST, "/echo", {}, random});
+		}
+		for (std::size_t idx{0}; idx < 4; idx++) {
+			Http::Response res{client.recv()};
+			std::string const body{bodyOf(res)};
+			releaseAssert(body.size() == 1_zu << 22);
+			for (std::size_t jdx{0}; jdx < body.size(); jdx++) {
+				releaseAssert(
+					body[jdx] == static_cast<char>(jdx % 251));
+			}
+			Http::Response echoed{client.recv()};
+			releaseAssert(bodyOf(echoed) == random);
+		}
+	}
+
+	// Filters of streams run at once, so that a held stream
+	// does not hold those behind it.
+	for (ServeOptions const &serveOptions :
+			 {ServeOptions{}, ServeOptions{.reactors = 1}}) {
+		MyServer heldServer(serveOptions, ":0");
+		isReleased = false;
+		Http2::Client<> client(
+			Host{"localhost", heldServer.host().service});
+		client.send({Http::Method::GET, "/held"});
+		client.send({Http::Method::GET, "/release"});
+		Http::Response held{client.recv()};
+		releaseAssert(bodyOf(held) == "released");
+		Http::Response release{client.recv()};
+		releaseAssert(bodyOf(release) == "release");
+	}
+
+	// HEAD, unrouted, and too long requests.
+	{
+		Http2::Client<> client(host);
+		client.send({Http::Method::HEAD, "/hello"});
+		client.send({Http::Method::GET, "/missing"});
+		client.send(
+			{Http::Method::POST,
+				"/echo",
+				{},
+				std::string((1_zu << 22) + 1, 'x')});
+		client.send({Http::Method::GET, "/hello"});
+
+		Http::Response res{client.recv()};
+		releaseAssert(res.statusCode == Http::StatusCode::OK);
+		releaseAssert(res.headers.contentLength() == 10);
+		releaseAssert(bodyOf(res).empty());
+		releaseAssert(
+			client.recv().statusCode ==
+			Http::StatusCode::NOT_FOUND);
+		releaseAssert(
+			client.recv().statusCode ==
+			Http::StatusCode::REQUEST_ENTITY_TOO_LARGE);
+		Http::Response last{client.recv()};
+		releaseAssert(bodyOf(last) == "/hello 2.0");
+	}
+
+	// HTTP/1.1 is still served, and upgrades to h2c, which
+	// answers the upgrading request on stream 1.
+	{
+		Http::Client<> client(host);
+		client.send({Http::Method::GET, "/hello"});
+		Http::Response res{client.recv()};
+		releaseAssert(bodyOf(res) == "/hello 1.1");
+	}
+	{
+		Client<
+			Ipv4FamilyInterface,
+			StreamTypeInterface,
+			TcpProtocolInterface>
+			rawClient(host);
+		rawClient.send(
+			"GET /hello HTTP/1.1\r\n"
+			"Host: localhost\r\n"
+			"Connection: Upgrade, HTTP2-Settings\r\n"
+			"Upgrade: h2c\r\n"
+			"HTTP2-Settings: AAMAAABkAAQAAP__\r\n"
+			"\r\n");
+		// The preface, with empty SETTINGS.
+		rawClient.send(
+			std::string(Http2::PREFACE) +
+			std::string("\0\0\0\x04\0\0\0\0\0"sv));
+		std::string response, buffer;
+		buffer.reserve(1_zu << 12);
+		while (rawClient.recv(buffer, 1s) > 0) {
+			response += buffer;
+		}
+		releaseAssert(response.starts_with(
+			"HTTP/1.1 101 Switching Protocols"));
+		std::size_t idx{response.find("\r\n\r\n") + 4};
+
+		// The server's SETTINGS, then HEADERS and DATA.
+		Http2::Hpack::Decoder decoder;
+		std::vector<Http2::Hpack::Field> fields;
+		std::string data;
+		std::string_view const frames{response};
+		Http2::FrameHead head;
+		while (head.parse(frames.substr(idx))) {
+			std::string_view const payload{frames.substr(
+				idx + Http2::FrameHead::LEN, head.length)};
+			idx += Http2::FrameHead::LEN + head.length;
+			if (head.streamId != 1) {
+				continue;
+			}
+			if (head.type == Http2::FrameType::HEADERS) {
+				decoder.decode(payload, fields);
+			} else if (head.type == Http2::FrameType::DATA) {
+				data += payload;
+			}
+		}
+		releaseAssert(
+			!fields.empty() &&
+			fields.front() ==
+				Http2::Hpack::Field{":status", "200"});
+		releaseAssert(data == "/hello 2.0");
+	}
+
+	// HEADERS on a closed stream, here one skipped by a
+	// later stream, are refused with STREAM_CLOSED.
+	{
+		Client<
+			Ipv4FamilyInterface,
+			StreamTypeInterface,
+			TcpProtocolInterface>
+			rawClient(host);
+		Http2::Hpack::Encoder encoder;
+		auto const headers{[&encoder](std::uint32_t streamId) {
+			std::string block;
+			encoder.encode(block, ":method", "GET");
+			encoder.encode(block, ":scheme", "http");
+			encoder.encode(block, ":path", "/hello");
+			std::string frame(Http2::FrameHead::LEN, '\0');
+			Http2::FrameHead{
+				static_cast<std::uint32_t>(block.size()),
+				Http2::FrameType::HEADERS,
+				Http2::FrameHead::END_STREAM |
+					Http2::FrameHead::END_HEADERS,
+				streamId}
+				.serialize(frame.data());
+			return frame + block;
+		}};
+		rawClient.send(
+			std::string(Http2::PREFACE) +
+			std::string("\0\0\0\x04\0\0\0\0\0"sv) + headers(3) +
+			headers(1));
+		std::string response, buffer;
+		buffer.reserve(1_zu << 12);
+		while (rawClient.recv(buffer, 1s) > 0) {
+			response += buffer;
+		}
+
+		bool isAnswered{false}, isRefused{false};
+		std::string_view const frames{response};
+		std::size_t idx{0};
+		Http2::FrameHead head;
+		while (head.parse(frames.substr(idx))) {
+			std::string_view const payload{frames.substr(
+				idx + Http2::FrameHead::LEN, head.length)};
+			idx += Http2::FrameHead::LEN + head.length;
+			isAnswered = isAnswered ||
+				(head.streamId == 3 &&
+					head.type == Http2::FrameType::HEADERS);
+			isRefused = isRefused ||
+				(head.streamId == 1 &&
+					head.type == Http2::FrameType::RST_STREAM &&
+					payload == "\0\0\0\x05"sv);
+		}
+		releaseAssert(isAnswered);
+		releaseAssert(isRefused);
+	}
+
+	// Streams reset while their filters run still count
+	// towards SETTINGS_MAX_CONCURRENT_STREAMS until the
+	// filters return, so that open-then-reset streams cannot
+	// queue unbounded work.
+	{
+		MyServer heldServer(":0");
+		isReleased = false;
+		Client<
+			Ipv4FamilyInterface,
+			StreamTypeInterface,
+			TcpProtocolInterface>
+			rawClient(Host{"localhost", heldServer.host().service});
+		Http2::Hpack::Encoder encoder;
+		std::string request{
+			std::string(Http2::PREFACE) +
+			std::string("\0\0\0\x04\0\0\0\0\0"sv)};
+		std::size_t const cStreams{300};
+		for (std::uint32_t id{1}; id < 2 * cStreams; id += 2) {
+			std::string block;
+			encoder.encode(block, ":method", "GET");
+			encoder.encode(block, ":scheme", "http");
+			encoder.encode(block, ":path", "/held");
+			std::string frame(Http2::FrameHead::LEN, '\0');
+			Http2::FrameHead{
+				static_cast<std::uint32_t>(block.size()),
+				Http2::FrameType::HEADERS,
+				Http2::FrameHead::END_STREAM |
+					Http2::FrameHead::END_HEADERS,
+				id}
+				.serialize(frame.data());
+			request += frame + block;
+			Http2::FrameHead{4, Http2::FrameType::RST_STREAM, 0, id}
+				.serialize(frame.data());
+			request += frame + std::string("\0\0\0\x08"sv);
+		}
+		rawClient.send(request);
+		std::string response, buffer;
+		buffer.reserve(1_zu << 12);
+		while (rawClient.recv(buffer, 1s) > 0) {
+			response += buffer;
+		}
+		{
+			std::lock_guard<std::mutex> releaseLckGuard(
+				releaseMtx);
+			isReleased = true;
+		}
+		releaseEv.notify_all();
+
+		std::size_t cRefused{0};
+		std::string_view const frames{response};
+		std::size_t idx{0};
+		Http2::FrameHead head;
+		while (head.parse(frames.substr(idx))) {
+			std::string_view const payload{frames.substr(
+				idx + Http2::FrameHead::LEN, head.length)};
+			idx += Http2::FrameHead::LEN + head.length;
+			cRefused += head.type == Http2::FrameType::RST_STREAM &&
+				payload == "\0\0\0\x07"sv;
+		}
+		// 256 is the default maxConcurrentStreams.
+		releaseAssert(cRefused == cStreams - 256);
+	}
+
+	return 0;
+}
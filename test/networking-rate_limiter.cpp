@@ -0,0 +1,131 @@
+// Tests Networking::RateLimiter.
+#include <rain.hpp>
+
+using Rain::Error::releaseAssert;
+using Rain::Networking::RateLimiter;
+using namespace Rain::Literal;
+
+// Key for the IPv4 address 10.x.y.z.
+RateLimiter::Key ipv4Key(std::uint32_t idx) {
+	sockaddr_storage address{};
+	sockaddr_in addressIn{};
+	addressIn.sin_family = AF_INET;
+	addressIn.sin_addr.s_addr = htonl((10u << 24) | idx);
+	std::memcpy(&address, &addressIn, sizeof(addressIn));
+	return RateLimiter::keyOf(address, sizeof(addressIn));
+}
+
+int main() {
+	auto const epoch{std::chrono::steady_clock::time_point(
+		std::chrono::hours(1))};
+
+	// IPv4 and IPv4-mapped IPv6 addresses share a key, and
+	// ports are ignored.
+	{
+		Rain::Networking::AddressInfo v4{
+			Rain::Networking::getAddressInfos(
+				{"127.0.0.1", "80"},
+				Rain::Networking::Family::INET,
+				Rain::Networking::Type::STREAM,
+				Rain::Networking::Protocol::TCP,
+				Rain::Networking::AddressInfo::Flag::NUMERICHOST)
+				.at(0)},
+			v6{Rain::Networking::getAddressInfos(
+				{"::ffff:127.0.0.1", "443"},
+				Rain::Networking::Family::INET6,
+				Rain::Networking::Type::STREAM,
+				Rain::Networking::Protocol::TCP,
+				Rain::Networking::AddressInfo::Flag::NUMERICHOST)
+					 .at(0)};
+		releaseAssert(
+			RateLimiter::keyOf(v4) == RateLimiter::keyOf(v6));
+		releaseAssert(RateLimiter::keyOf(v4) != ipv4Key(1));
+	}
+
+	// At most threshold admissions per window.
+	{
+		RateLimiter limiter(3, 60s);
+		for (int idx{0}; idx < 3; idx++) {
+			releaseAssert(
+				!limiter.shouldReject(ipv4Key(1), epoch));
+		}
+		releaseAssert(limiter.shouldReject(ipv4Key(1), epoch));
+		releaseAssert(limiter.shouldReject(ipv4Key(1), epoch));
+
+		// Other peers are unaffected.
+		releaseAssert(!limiter.shouldReject(ipv4Key(2), epoch));
+	}
+
+	// The previous window is weighted by its overlap with the
+	// sliding window, and forgotten after two windows.
+	{
+		RateLimiter limiter(4, 60s);
+		for (int idx{0}; idx < 4; idx++) {
+			releaseAssert(
+				!limiter.shouldReject(ipv4Key(1), epoch));
+		}
+
+		// Halfway through the next window, half of the previous
+		// admissions remain.
+		releaseAssert(
+			!limiter.shouldReject(ipv4Key(1), epoch + 90s));
+		releaseAssert(
+			!limiter.shouldReject(ipv4Key(1), epoch + 90s));
+		releaseAssert(
+			limiter.shouldReject(ipv4Key(1), epoch + 90s));
+
+		// Two windows later, the peer is forgotten.
+		for (int idx{0}; idx < 4; idx++) {
+			releaseAssert(
+				!limiter.shouldReject(ipv4Key(1), epoch + 181s));
+		}
+		releaseAssert(
+			limiter.shouldReject(ipv4Key(1), epoch + 181s));
+	}
+
+	// Memory is fixed under many distinct peers, and the
+	// most active peers survive eviction.
+	{
+		RateLimiter limiter(2, 60s, 1_zu << 10);
+		std::cout << "Capacity: " << limiter.capacity() << "."
+							<< std::endl;
+		releaseAssert(limiter.capacity() == 1_zu << 10);
+		releaseAssert(!limiter.shouldReject(ipv4Key(0), epoch));
+		releaseAssert(!limiter.shouldReject(ipv4Key(0), epoch));
+
+		auto const timeBegin{std::chrono::steady_clock::now()};
+		for (std::uint32_t idx{1}; idx <= 1000000; idx++) {
+			releaseAssert(
+				!limiter.shouldReject(ipv4Key(idx), epoch));
+		}
+		std::cout << "1000000 distinct peers: "
+							<< std::chrono::steady_clock::now() - timeBegin
+							<< "." << std::endl;
+		releaseAssert(limiter.shouldReject(ipv4Key(0), epoch));
+		releaseAssert(limiter.capacity() == 1_zu << 10);
+	}
+
+	// Concurrent checks on shared peers admit exactly
+	// threshold times each.
+	{
+		RateLimiter limiter(1000, 60s);
+		std::atomic_size_t cAdmitted{0};
+		std::vector<std::thread> threads;
+		for (int idx{0}; idx < 8; idx++) {
+			threads.emplace_back([&]() {
+				for (std::uint32_t peer{0}; peer < 4000; peer++) {
+					cAdmitted +=
+						!limiter.shouldReject(ipv4Key(peer % 4), epoch);
+				}
+			});
+		}
+		for (auto &thread : threads) {
+			thread.join();
+		}
+		std::cout << "Admitted: " << cAdmitted << "."
+							<< std::endl;
+		releaseAssert(cAdmitted == 4000);
+	}
+
+	return 0;
+}
@@ -0,0 +1,185 @@
+// Tests Networking::ReqRes::ClientPool.
+#include <rain.hpp>
+
+using Rain::Error::releaseAssert;
+using namespace Rain::Literal;
+using namespace Rain::Networking;
+
+class MyWorker :
+	public Http::Worker<
+		Http::Request,
+		Http::Response,
+		Ipv4FamilyInterface,
+		NoLingerSocketOption> {
+	public:
+	// Custom currying constructor to set send/recv timeout
+	// to 300ms.
+	MyWorker(auto &&...args) :
+		Worker(
+			1_zu << 10_zu,
+			1_zu << 10_zu,
+			300LL,
+			300LL,
+			std::forward<decltype(args)>(args)...) {}
+
+	private:
+	ResponseAction reqSimple(Request &, std::smatch const &) {
+		return {{StatusCode::OK}};
+	}
+
+	virtual Filters const &filters() override {
+		static Filters const filters{
+			{".*",
+				"/simple/?",
+				{Method::GET},
+				&MyWorker::reqSimple}};
+		return filters;
+	}
+};
+
+class MyServer :
+	public Http::Server<
+		MyWorker,
+		Ipv4FamilyInterface,
+		NoLingerSocketOption> {
+	using Server::Server;
+
+	private:
+	virtual MyWorker makeWorker(
+		NativeSocket nativeSocket,
+		SocketInterface *interrupter) override {
+		return {nativeSocket, interrupter};
+	}
+
+	public:
+	~MyServer() { this->destruct(); }
+};
+
+using MyClient = Http::Client<
+	Http::Request,
+	Http::Response,
+	Ipv4FamilyInterface,
+	NoLingerSocketOption>;
+using MyClientPool = ReqRes::ClientPool<MyClient>;
+
+// Sends GET /simple on a leased Client.
+void get(MyClientPool::Lease &client) {
+	client->send({Http::Method::GET, "/simple"s});
+	auto res = client->recv();
+	releaseAssert(res.statusCode == Http::StatusCode::OK);
+}
+
+int main() {
+	MyServer server(":0");
+	Host const host{"LocalHost", server.host().service};
+	std::cout << "Serving on " << server.host() << std::endl;
+
+	// Sequential requests reuse one connection, and nodes
+	// are case-insensitive.
+	{
+		MyClientPool pool(2, 10s);
+		for (std::size_t idx{0}; idx < 4; idx++) {
+			auto client{pool.acquire(
+				idx % 2 == 0 ? host
+										 : Host{"localhost", host.service})};
+			releaseAssert(client.isReused() == (idx != 0));
+			get(client);
+		}
+		std::this_thread::sleep_for(50ms);
+		releaseAssert(pool.idle() == 1);
+		releaseAssert(server.workers() == 1);
+	}
+
+	// Connections per host are capped, and acquire waits
+	// for one to be returned.
+	{
+		MyClientPool pool(2, 10s);
+		auto first{pool.acquire(host)},
+			second{pool.acquire(host)};
+		get(first);
+		get(second);
+		bool timedOut{false};
+		try {
+			pool.acquire(host, 100ms);
+		} catch (Exception const &) {
+			timedOut = true;
+		}
+		releaseAssert(timedOut);
+
+		std::thread releaser([&first]() {
+			std::this_thread::sleep_for(50ms);
+			first.release();
+		});
+		auto third{pool.acquire(host, 1s)};
+		releaser.join();
+		releaseAssert(third.isReused());
+		get(third);
+
+		// Discarded connections free their slot.
+		second.discard();
+		auto fourth{pool.acquire(host, 100ms)};
+		releaseAssert(!fourth.isReused());
+		get(fourth);
+	}
+
+	// Connections closed by the peer while idle are not
+	// reused.
+	{
+		MyClientPool pool(2, 10s);
+		{
+			auto client{pool.acquire(host)};
+			get(client);
+		}
+		releaseAssert(pool.idle() == 1);
+
+		// The Worker closes the connection after its 300ms
+		// recv timeout.
+		std::this_thread::sleep_for(400ms);
+		auto client{pool.acquire(host)};
+		releaseAssert(!client.isReused());
+		get(client);
+	}
+
+	// Idle connections are closed after the idle timeout.
+	{
+		MyClientPool pool(2, 100ms);
+		{
+			auto client{pool.acquire(host)};
+			get(client);
+		}
+		releaseAssert(pool.idle() == 1);
+		std::this_thread::sleep_for(150ms);
+		pool.prune();
+		releaseAssert(pool.idle() == 0);
+	}
+
+	// Concurrent requests share at most maxPerHost
+	// connections.
+	{
+		std::this_thread::sleep_for(50ms);
+		MyClientPool pool(2, 10s);
+		std::atomic_size_t cReused{0};
+		std::vector<std::thread> threads;
+		auto const timeBegin{std::chrono::steady_clock::now()};
+		for (std::size_t idx{0}; idx < 8; idx++) {
+			threads.emplace_back([&]() {
+				for (std::size_t jdx{0}; jdx < 25; jdx++) {
+					auto client{pool.acquire(host)};
+					cReused += client.isReused();
+					get(client);
+				}
+			});
+		}
+		for (auto &thread : threads) {
+			thread.join();
+		}
+		std::cout << "200 pooled requests: "
+							<< std::chrono::steady_clock::now() - timeBegin
+							<< ", " << cReused << " reused." << std::endl;
+		releaseAssert(cReused >= 198);
+		releaseAssert(pool.idle() <= 2);
+		releaseAssert(server.workers() <= 2);
+	}
+
+	return 0;
+}
@@ -0,0 +1,324 @@
+// Tests Networking::ReqRes::CoWorker, and awaitable Socket
+// operations on a Reactor.
+#include <rain.hpp>
+
+using Rain::Error::releaseAssert;
+using namespace Rain::Literal;
+using namespace Rain::Networking;
+
+using TcpClient = Client<
+	Ipv4FamilyInterface,
+	StreamTypeInterface,
+	TcpProtocolInterface>;
+using AwaitableTcpClient = AwaitableClient<TcpClient>;
+
+// Backend which takes 100ms to respond, and closes after.
+class BackendWorker :
+	public Http::Worker<
+		Http::Request,
+		Http::Response,
+		Ipv4FamilyInterface,
+		NoLingerSocketOption> {
+	public:
+	using Worker::Worker;
+
+	private:
+	ResponseAction reqSlow(Request &, std::smatch const &) {
+		std::this_thread::sleep_for(100ms);
+		return {{StatusCode::OK, {}, "slow"}, true};
+	}
+
+	virtual Filters const &filters() override {
+		static Filters const filters{
+			{".*",
+				"/slow",
+				{Method::GET},
+				&BackendWorker::reqSlow}};
+		return filters;
+	}
+};
+
+class BackendServer :
+	public Http::Server<
+		BackendWorker,
+		Ipv4FamilyInterface,
+		NoLingerSocketOption> {
+	using Server::Server;
+
+	private:
+	virtual BackendWorker makeWorker(
+		NativeSocket nativeSocket,
+		SocketInterface *interrupter) override {
+		return {nativeSocket, interrupter};
+	}
+
+	public:
+	~BackendServer() { this->destruct(); }
+};
+
+// Sends a bodiless HTTP/1.0 request, and awaits the
+// response until the server closes the connection.
+Task<std::string> fetch(
+	Reactor &reactor,
+	Host host,
+	std::string target) {
+	AwaitableTcpClient client;
+	co_await client.connect(
+		reactor,
+		getAddressInfos(
+			host,
+			client.family(),
+			client.type(),
+			client.protocol()));
+	co_await client.send(
+		reactor, "GET " + target + " HTTP/1.0\r\n\r\n");
+	std::string response, buffer;
+	buffer.reserve(1_zu << 10_zu);
+	while (co_await client.recv(reactor, buffer, 1s) > 0) {
+		response += buffer;
+	}
+	co_return response;
+}
+
+Host backendHost;
+
+// Threads on which proxied requests resumed.
+std::mutex proxiedMtx;
+std::set<std::thread::id> proxiedThreads;
+
+// Proxies /proxy to the backend, awaiting it on the Reactor
+// of the Worker, and otherwise responds immediately. Lingers
+// on close, so that responses are not reset.
+class MyWorker :
+	public ReqRes::CoWorker<
+		Http::Request,
+		Http::Response,
+		Ipv4FamilyInterface> {
+	public:
+	MyWorker(auto &&...args) :
+		CoWorker(
+			1_zu << 10_zu,
+			1_zu << 10_zu,
+			300LL,
+			300LL,
+			std::forward<decltype(args)>(args)...) {}
+
+	private:
+	virtual bool isRequestBuffered(
+		std::string_view buffered) override {
+		Http::RequestParser parser;
+		try {
+			return parser.parse(buffered);
+		} catch (...) {
+			// Malformed heads are left to recv to reject.
+			return true;
+		}
+	}
+
+	virtual Task<bool> onCoRequest(
+		Http::Request &req) override {
+		if (req.target != "/proxy") {
+			this->send({Http::StatusCode::OK, {}, "hello"});
+			co_return req.version < Http::Version::_1_1;
+		}
+		std::string response{co_await fetch(
+			*this->reactor(), backendHost, "/slow")};
+		releaseAssert(response.ends_with("slow"));
+		{
+			std::lock_guard lck(proxiedMtx);
+			proxiedThreads.insert(std::this_thread::get_id());
+		}
+		this->send({Http::StatusCode::OK, {}, "proxied"});
+		co_return true;
+	}
+};
+
+class MyServer :
+	public ReqRes::Server<MyWorker, Ipv4FamilyInterface> {
+	using Server::Server;
+
+	private:
+	virtual MyWorker makeWorker(
+		NativeSocket nativeSocket,
+		SocketInterface *interrupter) override {
+		return {nativeSocket, interrupter};
+	}
+
+	public:
+	~MyServer() { this->destruct(); }
+};
+
+// Worker with a request deadline, which in thread mode
+// must still not await on the timer Reactor of the Server.
+class DeadlineWorker : public MyWorker {
+	public:
+	using MyWorker::MyWorker;
+
+	private:
+	virtual std::chrono::milliseconds onWorkRequestTimeout()
+		override {
+		return 1s;
+	}
+
+	virtual Task<bool> onCoRequest(Http::Request &) override {
+		releaseAssert(this->reactor() == nullptr);
+		this->send({Http::StatusCode::OK, {}, "deadline"});
+		co_return true;
+	}
+};
+
+class DeadlineServer :
+	public ReqRes::Server<DeadlineWorker, Ipv4FamilyInterface> {
+	using Server::Server;
+
+	private:
+	virtual DeadlineWorker makeWorker(
+		NativeSocket nativeSocket,
+		SocketInterface *interrupter) override {
+		return {nativeSocket, interrupter};
+	}
+
+	public:
+	~DeadlineServer() { this->destruct(); }
+};
+
+// UDP Socket connected to itself on loopback, which stops
+// a Reactor once it sends to itself.
+class Interrupter :
+	public Socket<
+		Ipv4FamilyInterface,
+		DGramTypeInterface,
+		UdpProtocolInterface> {
+	public:
+	using Socket::nativeSocket;
+
+	Interrupter() {
+		sockaddr_in address{};
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		socklen_t addressLen{sizeof(address)};
+		validateSystemCall(::bind(
+			this->nativeSocket(),
+			reinterpret_cast<sockaddr *>(&address),
+			addressLen));
+		validateSystemCall(::getsockname(
+			this->nativeSocket(),
+			reinterpret_cast<sockaddr *>(&address),
+			&addressLen));
+		validateSystemCall(::connect(
+			this->nativeSocket(),
+			reinterpret_cast<sockaddr *>(&address),
+			addressLen));
+	}
+
+	void interrupt() {
+		validateSystemCall(
+			::send(this->nativeSocket(), "", 1, 0));
+	}
+};
+
+int main() {
+	BackendServer backend(":0");
+	backendHost = {"localhost", backend.host().service};
+	std::cout << "Backend on " << backend.host() << std::endl;
+
+	// Thread mode runs onCoRequest to completion on the
+	// Worker thread.
+	{
+		MyServer server(":0");
+		std::cout << "Serving on " << server.host()
+							<< " in thread mode." << std::endl;
+		TcpClient client(
+			Host{"localhost", server.host().service});
+		client.send("GET / HTTP/1.0\r\n\r\n"s);
+		std::string response, buffer;
+		while (client.recv(buffer) > 0) {
+			response += buffer;
+		}
+		releaseAssert(response.starts_with("HTTP/1.1 200"));
+		releaseAssert(response.ends_with("hello"));
+	}
+
+	// With Deadlines enabled, thread mode still receives
+	// heads which arrive in parts on the Worker thread.
+	{
+		DeadlineServer server(":0");
+		TcpClient client(
+			Host{"localhost", server.host().service});
+		client.send("GET / HTTP/1.1\r\n"s);
+		std::this_thread::sleep_for(50ms);
+		client.send("Host: localhost\r\n\r\n"s);
+		std::string response, buffer;
+		while (client.recv(buffer) > 0) {
+			response += buffer;
+		}
+		releaseAssert(response.starts_with("HTTP/1.1 200"));
+		releaseAssert(response.ends_with("deadline"));
+	}
+
+	MyServer server(ServeOptions{.reactors = 1}, ":0");
+	Host const host{"localhost", server.host().service};
+	std::cout << "Serving on " << server.host()
+						<< " with 1 reactor." << std::endl;
+
+	// Heads which arrive in parts are awaited until
+	// complete, then handled on the event loop.
+	{
+		TcpClient client(host);
+		client.send("GET / HTTP/1.1\r\n"s);
+		std::this_thread::sleep_for(50ms);
+		client.send("Host: localhost\r\n\r\n"s);
+		std::this_thread::sleep_for(50ms);
+		client.send("GET / HTTP/1.0\r\n\r\n"s);
+		std::string response, buffer;
+		while (client.recv(buffer) > 0) {
+			response += buffer;
+		}
+		releaseAssert(response.starts_with("HTTP/1.1 200"));
+		releaseAssert(
+			response.find("hello") != response.rfind("hello"));
+	}
+
+	// Many proxied requests await the slow backend at once,
+	// both on the Server and on a Reactor of their own,
+	// without a thread each. All of the requests resume on
+	// the one event loop of the Server.
+	{
+		Interrupter interrupter;
+		Reactor reactor(interrupter.nativeSocket());
+		std::thread loop([&reactor]() { reactor.run(); });
+
+		std::size_t const C_CLIENTS{16};
+		std::atomic_size_t cProxied{0};
+		auto const timeBegin{std::chrono::steady_clock::now()};
+		for (std::size_t idx{0}; idx < C_CLIENTS; idx++) {
+			[](Reactor &reactor,
+				 Host host,
+				 std::atomic_size_t &cProxied) -> Task<> {
+				std::string response{
+					co_await fetch(reactor, host, "/proxy")};
+				if (response.ends_with("proxied")) {
+					cProxied++;
+				}
+			}(reactor, host, cProxied)
+				.detach();
+		}
+		while (
+			cProxied < C_CLIENTS &&
+			std::chrono::steady_clock::now() - timeBegin < 5s) {
+			std::this_thread::sleep_for(10ms);
+		}
+		auto const timeElapsed{
+			std::chrono::steady_clock::now() - timeBegin};
+		std::cout << "Proxied " << cProxied << " in "
+							<< timeElapsed << "." << std::endl;
+		releaseAssert(cProxied == C_CLIENTS);
+		releaseAssert(timeElapsed < 1s);
+		releaseAssert(proxiedThreads.size() == 1);
+
+		interrupter.interrupt();
+		loop.join();
+	}
+
+	return 0;
+}
@@ -0,0 +1,391 @@
+// Tests Networking::Resolver against a stub nameserver on
+// loopback.
+#include <rain.hpp>
+
+using Rain::Error::releaseAssert;
+using namespace Rain::Literal;
+using namespace Rain::Networking;
+using RecordType = Resolver::RecordType;
+
+// Stub nameserver which answers queries from a fixed zone,
+// and counts the queries it receives by name and type, and
+// the source ports they come from by name.
+class StubNameserver :
+	public Socket<
+		Ipv4FamilyInterface,
+		DGramTypeInterface,
+		UdpProtocolInterface> {
+	private:
+	std::atomic_bool stopping{false};
+	std::mutex mtx;
+	std::map<std::pair<std::string, int>, std::size_t> counts;
+	std::map<std::string, std::set<std::uint16_t>> sourcePorts;
+	std::thread thread;
+
+	public:
+	AddressInfo addressInfo;
+
+	StubNameserver() {
+		addressInfo = getAddressInfos(
+			{"127.0.0.1", "0"},
+			Family::INET,
+			Type::DGRAM,
+			Protocol::UDP,
+			AddressInfo::Flag::NUMERICHOST)
+										.at(0);
+		validateSystemCall(::bind(
+			this->nativeSocket(),
+			reinterpret_cast<sockaddr const *>(
+				&addressInfo.address),
+			addressInfo.addressLen));
+		validateSystemCall(getsockname(
+			this->nativeSocket(),
+			reinterpret_cast<sockaddr *>(&addressInfo.address),
+			&addressInfo.addressLen));
+		this->thread = std::thread([this]() { this->run(); });
+	}
+	~StubNameserver() {
+		this->stopping = true;
+		this->thread.join();
+	}
+
+	std::size_t count(
+		std::string const &name,
+		RecordType type) {
+		std::lock_guard lck(this->mtx);
+		return this->counts[{name, static_cast<int>(type)}];
+	}
+	std::size_t cPorts(std::string const &name) {
+		std::lock_guard lck(this->mtx);
+		return this->sourcePorts[name].size();
+	}
+
+	private:
+	void run() {
+		std::string buffer(512, '\0');
+		while (!this->stopping) {
+			if (
+				this->poll(PollFlag::READ_NORMAL, 20ms) ==
+				PollFlag::NONE) {
+				continue;
+			}
+			sockaddr_storage peer;
+			socklen_t peerLen{sizeof(peer)};
+			auto result{recvfrom(
+				this->nativeSocket(),
+				&buffer[0],
+				buffer.size(),
+				0,
+				reinterpret_cast<sockaddr *>(&peer),
+				&peerLen)};
+			if (result < 12) {
+				continue;
+			}
+			std::string const query(buffer.data(), result);
+			std::string const response{this->respond(
+				query,
+				ntohs(reinterpret_cast<sockaddr_in *>(&peer)->sin_port))};
+			if (!response.empty()) {
+				sendto(
+					this->nativeSocket(),
+					response.data(),
+					response.size(),
+					0,
+					reinterpret_cast<sockaddr *>(&peer),
+					peerLen);
+			}
+		}
+	}
+
+	static std::string u16(int value) {
+		return {
+			static_cast<char>(value >> 8),
+			static_cast<char>(value & 0xff)};
+	}
+	static std::string u32(int value) {
+		return u16(value >> 16) + u16(value & 0xffff);
+	}
+
+	// Resource record owned by the queried name, via a
+	// pointer to the question.
+	static std::string record(
+		RecordType type,
+		int ttl,
+		std::string const &data) {
+		return "\xc0\x0c"s + u16(static_cast<int>(type)) +
+			u16(1) + u32(ttl) +
+			u16(static_cast<int>(data.size())) + data;
+	}
+
+	// Builds the response to a query, or returns empty to
+	// drop it.
+	std::string respond(
+		std::string const &query,
+		std::uint16_t sourcePort) {
+		std::string name;
+		std::size_t offset{12};
+		while (query[offset] != '\0') {
+			if (!name.empty()) {
+				name.push_back('.');
+			}
+			name.append(query, offset + 1, query[offset]);
+			offset += 1 + query[offset];
+		}
+		RecordType const type{static_cast<RecordType>(
+			static_cast<std::uint8_t>(query[offset + 1]) << 8 |
+			static_cast<std::uint8_t>(query[offset + 2]))};
+		std::string const question{
+			query.substr(12, offset + 5 - 12)};
+		std::size_t count;
+		{
+			std::lock_guard lck(this->mtx);
+			count = ++this->counts[{name, static_cast<int>(type)}];
+			this->sourcePorts[name].insert(sourcePort);
+		}
+
+		int rCode{0};
+		std::vector<std::string> answers, authorities;
+		if (name == "a.test" && type == RecordType::A) {
+			answers.push_back(
+				record(type, 1, "\x0a\x00\x00\x01"s));
+			answers.push_back(
+				record(type, 1, "\x0a\x00\x00\x02"s));
+		} else if (
+			name == "v6.test" && type == RecordType::AAAA) {
+			answers.push_back(
+				record(type, 60, std::string(15, '\0') + "\x01"));
+		} else if (name == "mx.test" && type == RecordType::MX) {
+			// The second exchange is compressed, with a pointer
+			// to mx.test in the question.
+			answers.push_back(record(
+				type, 60, u16(20) + "\x01" "b\x02mx\x04test\x00"s));
+			answers.push_back(
+				record(type, 60, u16(10) + "\x01" "a\xc0\x0c"s));
+		} else if (name == "missing.test") {
+			// NXDOMAIN, with an SOA of root names.
+			rCode = 3;
+			authorities.push_back(record(
+				RecordType::SOA,
+				60,
+				"\x00\x00"s + u32(1) + u32(1) + u32(1) + u32(1) +
+					u32(1)));
+		} else if (name == "slow.test") {
+			std::this_thread::sleep_for(200ms);
+			answers.push_back(
+				record(type, 60, "\x0a\x00\x00\x03"s));
+		} else if (name == "drop.test") {
+			if (count == 1) {
+				return {};
+			}
+			answers.push_back(
+				record(type, 60, "\x0a\x00\x00\x04"s));
+		} else if (name == "never.test") {
+			return {};
+		} else if (name == "fail.test") {
+			rCode = 2;
+		}
+
+		return query.substr(0, 2) + u16(0x8180 | rCode) +
+			u16(1) + u16(static_cast<int>(answers.size())) +
+			u16(static_cast<int>(authorities.size())) + u16(0) +
+			question +
+			std::accumulate(answers.begin(), answers.end(), ""s) +
+			std::accumulate(
+				authorities.begin(), authorities.end(), ""s);
+	}
+};
+
+int main() {
+	StubNameserver stub;
+	std::cout << "Stub nameserver on "
+						<< getNumericHost(stub.addressInfo) << "."
+						<< std::endl;
+
+	// Answers are cached for their TTL, and names are
+	// case-insensitive.
+	{
+		Resolver resolver({stub.addressInfo});
+		auto records{
+			resolver.query("a.test", RecordType::A).get()};
+		releaseAssert(records.size() == 2);
+		releaseAssert(records[0].data == "\x0a\x00\x00\x01"s);
+		releaseAssert(records[1].data == "\x0a\x00\x00\x02"s);
+
+		auto const timeBegin{std::chrono::steady_clock::now()};
+		records = resolver.query("A.Test.", RecordType::A).get();
+		std::cout << "Cached lookup: "
+							<< std::chrono::steady_clock::now() - timeBegin
+							<< "." << std::endl;
+		releaseAssert(records.size() == 2);
+		releaseAssert(
+			stub.count("a.test", RecordType::A) == 1);
+
+		std::this_thread::sleep_for(1100ms);
+		resolver.query("a.test", RecordType::A).get();
+		releaseAssert(
+			stub.count("a.test", RecordType::A) == 2);
+	}
+
+	// Addresses are returned with the service as the port,
+	// AAAA before A, with IPv4-mapped addresses for IPv6.
+	{
+		Resolver resolver({stub.addressInfo});
+		auto addressInfos{resolver.getAddressInfos(
+			{"v6.test:80"}, Family::UNSPEC, Type::STREAM)};
+		releaseAssert(addressInfos.size() == 1);
+		releaseAssert(
+			getNumericHost(addressInfos[0]) == Host{"::1", "80"});
+		releaseAssert(addressInfos[0].family == Family::INET6);
+		releaseAssert(addressInfos[0].type == Type::STREAM);
+
+		addressInfos = resolver.getAddressInfos(
+			{"a.test:443"}, Family::INET6);
+		releaseAssert(addressInfos.size() == 2);
+		releaseAssert(
+			getNumericHost(addressInfos[0]) ==
+			Host{"::ffff:10.0.0.1", "443"});
+
+		addressInfos =
+			resolver.getAddressInfos({"a.test:443"}, Family::INET);
+		releaseAssert(addressInfos.size() == 2);
+		releaseAssert(
+			getNumericHost(addressInfos[1]) ==
+			Host{"10.0.0.2", "443"});
+
+		// Numeric nodes and localhost are not queried.
+		releaseAssert(
+			getNumericHost(
+				resolver.getAddressInfos({"127.0.0.1:80"}).at(0)) ==
+			Host{"127.0.0.1", "80"});
+		releaseAssert(
+			!resolver.getAddressInfos({"localhost:80"}).empty());
+		releaseAssert(
+			stub.count("localhost", RecordType::A) == 0);
+
+		// Ports out of range are unknown services.
+		releaseAssert(
+			resolver.getAddressInfos({"a.test:70000"}).empty());
+		releaseAssert(
+			resolver.getAddressInfos({"a.test:99999999999"})
+				.empty());
+	}
+
+	// Names with empty or too long labels are not queried.
+	{
+		Resolver resolver({stub.addressInfo});
+		for (std::string const &name :
+				 {"a..test"s,
+					 ".a.test"s,
+					 "a.test.."s,
+					 std::string(64, 'a') + ".test",
+					 std::string(254, 'a')}) {
+			try {
+				resolver.query(name, RecordType::A);
+				releaseAssert(false);
+			} catch (Exception const &exception) {
+				releaseAssert(
+					exception.getError() == Error::DNS_NAME_INVALID);
+			}
+		}
+		std::string const longest{std::string(63, 'a') + ".test"};
+		releaseAssert(
+			resolver.query(longest, RecordType::A).get().empty());
+		releaseAssert(stub.count(longest, RecordType::A) == 1);
+	}
+
+	// MX records are sorted by preference, and exchanges may
+	// be compressed.
+	{
+		Resolver resolver({stub.addressInfo});
+		auto const mxRecords{resolver.getMxRecords({"mx.test"})};
+		releaseAssert(mxRecords.size() == 2);
+		releaseAssert(
+			mxRecords[0] == std::make_pair(10_zu, "a.mx.test"s));
+		releaseAssert(
+			mxRecords[1] == std::make_pair(20_zu, "b.mx.test"s));
+	}
+
+	// Negative answers are cached for the SOA minimum.
+	{
+		Resolver resolver({stub.addressInfo});
+		releaseAssert(
+			resolver.query("missing.test", RecordType::A)
+				.get()
+				.empty());
+		releaseAssert(
+			resolver
+				.getAddressInfos({"missing.test"}, Family::INET)
+				.empty());
+		releaseAssert(
+			stub.count("missing.test", RecordType::A) == 1);
+		std::this_thread::sleep_for(1100ms);
+		resolver.query("missing.test", RecordType::A).get();
+		releaseAssert(
+			stub.count("missing.test", RecordType::A) == 2);
+	}
+
+	// Concurrent lookups of a name share one query.
+	{
+		Resolver resolver({stub.addressInfo});
+		std::vector<std::thread> threads;
+		std::atomic_size_t cResolved{0};
+		for (std::size_t idx{0}; idx < 8; idx++) {
+			threads.emplace_back([&]() {
+				auto const records{
+					resolver.query("slow.test", RecordType::A).get()};
+				cResolved +=
+					records.size() == 1 &&
+					records[0].data == "\x0a\x00\x00\x03"s;
+			});
+		}
+		for (auto &thread : threads) {
+			thread.join();
+		}
+		releaseAssert(cResolved == 8);
+		releaseAssert(
+			stub.count("slow.test", RecordType::A) == 1);
+	}
+
+	// Timed out and failed attempts are retried, and queries
+	// fail once out of attempts.
+	{
+		Resolver resolver({stub.addressInfo}, 16, 100ms, 3);
+		releaseAssert(
+			resolver.query("drop.test", RecordType::A)
+				.get()
+				.size() == 1);
+		releaseAssert(
+			stub.count("drop.test", RecordType::A) == 2);
+
+		// Each attempt comes from a fresh source port.
+		releaseAssert(stub.cPorts("drop.test") == 2);
+
+		auto const timeBegin{std::chrono::steady_clock::now()};
+		try {
+			resolver.query("never.test", RecordType::A).get();
+			releaseAssert(false);
+		} catch (Exception const &exception) {
+			releaseAssert(
+				exception.getError() == Error::TIMED_OUT);
+		}
+		auto const timeElapsed{
+			std::chrono::steady_clock::now() - timeBegin};
+		std::cout << "Timed out after " << timeElapsed << "."
+							<< std::endl;
+		releaseAssert(timeElapsed >= 300ms && timeElapsed < 1s);
+		releaseAssert(
+			stub.count("never.test", RecordType::A) == 3);
+
+		try {
+			resolver.query("fail.test", RecordType::A).get();
+			releaseAssert(false);
+		} catch (Exception const &exception) {
+			releaseAssert(
+				exception.getError() == Error::DNS_QUERY_FAILED);
+		}
+		releaseAssert(
+			stub.count("fail.test", RecordType::A) == 3);
+	}
+
+	return 0;
+}
@@ -313,5 +313,143 @@ int main() {
 		releaseAssert(server.workersDestructed() == 3);
 	}
 
+	// Optimistic Workers recv and send before polling, and
+	// still poll the interrupter once idle.
+	{
+		std::cout << std::endl;
+		class OptimisticWorker :
+			public Worker<
+				Ipv6FamilyInterface,
+				StreamTypeInterface,
+				TcpProtocolInterface,
+				NoLingerSocketOption,
+				OptimisticSocketOption> {
+			using Worker::Worker;
+
+			virtual void onWork() override {
+				Rain::Error::consumeThrowable([this]() {
+					std::string buffer(4, '\0');
+					while (this->recv(buffer, 1s) != 0) {
+						this->send(buffer);
+					}
+				})();
+			}
+		};
+		class OptimisticServer :
+			public Server<
+				OptimisticWorker,
+				Ipv6FamilyInterface,
+				StreamTypeInterface,
+				TcpProtocolInterface,
+				NoLingerSocketOption> {
+			using Server::Server;
+
+			virtual OptimisticWorker makeWorker(
+				NativeSocket nativeSocket,
+				SocketInterface *interrupter) override {
+				return {nativeSocket, interrupter};
+			}
+
+			public:
+			~OptimisticServer() { this->destruct(); }
+		};
+
+		auto &counters{
+			ConnectedSocketSpecInterface::optimisticCounters};
+		std::size_t recvHits{counters.recvHits},
+			recvMisses{counters.recvMisses};
+		std::unique_ptr<OptimisticServer> server(
+			new OptimisticServer(":0"));
+		MyClient client(Host{"", server->host().service}, {});
+		for (std::size_t idx{0}; idx < 4; idx++) {
+			client.send("ping");
+			std::string buffer(4, '\0');
+			client.recv(buffer);
+			releaseAssert(buffer == "ping");
+		}
+		// Each echo is counted once its recv returns, before it
+		// is sent.
+		recvHits = counters.recvHits - recvHits;
+		recvMisses = counters.recvMisses - recvMisses;
+		std::cout << "Optimistic recv hits: " << recvHits
+							<< ", misses: " << recvMisses << std::endl;
+		releaseAssert(recvHits + recvMisses >= 4);
+
+		// The idle Worker is interrupted by Server destruction.
+		auto timeBegin = std::chrono::steady_clock::now();
+		server.reset();
+		releaseAssert(
+			std::chrono::steady_clock::now() - timeBegin < 100ms);
+	}
+
+#ifndef RAIN_PLATFORM_WINDOWS
+	// Sharded Servers accept on multiple listening Sockets
+	// bound to the same address.
+	{
+		std::cout << std::endl;
+		class MyServer :
+			public Server<
+				MyWorker,
+				Ipv6FamilyInterface,
+				StreamTypeInterface,
+				TcpProtocolInterface,
+				NoLingerSocketOption,
+				ReusePortSocketOption> {
+			using Server::Server;
+
+			std::size_t workersDestructed{0};
+
+			virtual MyWorker makeWorker(
+				NativeSocket nativeSocket,
+				SocketInterface *interrupter) override {
+				return {
+					nativeSocket,
+					interrupter,
+					this->workersDestructed};
+			}
+
+			public:
+			~MyServer() { this->destruct(); }
+		};
+
+		MyServer server(
+			ServeOptions{.shards = 4, .shardThreadPools = true},
+			":0");
+		std::vector<std::unique_ptr<MyClient>> clients;
+		for (std::size_t idx{0}; idx < 8; idx++) {
+			clients.emplace_back(
+				new MyClient(Host{"", server.host().service}, {}));
+			clients.back()->send("ping");
+			std::string buffer(4, '\0');
+			clients.back()->recv(buffer);
+			releaseAssert(buffer == "ping");
+		}
+		std::cout << "Server workers: " << server.workers()
+							<< ", threads: " << server.threads()
+							<< std::endl;
+		releaseAssert(server.workers() == 8);
+	}
+
+	// Sharding requires ReusePortSocketOption, which is
+	// checked before binding, so an address in use is not
+	// reported instead.
+	{
+		std::cout << std::endl;
+		MyServer other(":0");
+		try {
+			MyServer server(
+				ServeOptions{.shards = 2},
+				Host{"", other.host().service});
+			throw std::runtime_error(
+				"Should have thrown exception during server "
+				"constructor.\n");
+		} catch (Exception const &exception) {
+			std::cout << exception.what();
+			releaseAssert(
+				exception.getError() == Error::REUSE_PORT_REQUIRED);
+		}
+	}
+#endif
+
 	return 0;
 }
@@ -0,0 +1,117 @@
+// Tests Networking::Task.
+#include <rain.hpp>
+
+using Rain::Error::releaseAssert;
+using namespace Rain::Literal;
+using Rain::Networking::Task;
+
+Task<int> answer() { co_return 42; }
+
+Task<long long> sum(long long depth) {
+	if (depth == 0) {
+		co_return 0;
+	}
+	co_return depth + co_await sum(depth - 1);
+}
+
+Task<> fail() {
+	throw std::runtime_error("fail");
+	co_return;
+}
+
+Task<std::string> recover() {
+	try {
+		co_await fail();
+	} catch (std::runtime_error const &) {
+		co_return "recovered";
+	}
+	co_return "not thrown";
+}
+
+// Awaitable which resumes the awaiting coroutine on
+// another thread.
+class OnThread {
+	private:
+	std::thread &thread;
+
+	public:
+	OnThread(std::thread &thread) : thread(thread) {}
+
+	bool await_ready() const noexcept { return false; }
+	void await_suspend(std::coroutine_handle<> handle) {
+		this->thread = std::thread([handle]() {
+			std::this_thread::sleep_for(50ms);
+			handle.resume();
+		});
+	}
+	void await_resume() const noexcept {}
+};
+
+Task<std::thread::id> hop(std::thread &thread) {
+	co_await OnThread(thread);
+	co_return std::this_thread::get_id();
+}
+
+int main() {
+	// Tasks are lazy, and begun by get.
+	{
+		bool begun{false};
+		// Lambda coroutines must not capture, since the
+		// lambda is destroyed before the Task begins.
+		auto task{[](bool &begun) -> Task<> {
+			begun = true;
+			co_return;
+		}(begun)};
+		releaseAssert(static_cast<bool>(task));
+		releaseAssert(!begun);
+		std::move(task).get();
+		releaseAssert(begun);
+		releaseAssert(!Task<>());
+	}
+
+	// Results propagate through chains of awaits.
+	{
+		releaseAssert(answer().get() == 42);
+		releaseAssert(sum(10000).get() == 50005000);
+	}
+
+	// Exceptions propagate to awaiters, and to get.
+	{
+		releaseAssert(recover().get() == "recovered");
+		bool thrown{false};
+		try {
+			fail().get();
+		} catch (std::runtime_error const &) {
+			thrown = true;
+		}
+		releaseAssert(thrown);
+	}
+
+	// get blocks until a Task resumed on another thread
+	// completes.
+	{
+		std::thread thread;
+		auto id{hop(thread).get()};
+		releaseAssert(id == thread.get_id());
+		thread.join();
+	}
+
+	// Detached Tasks run on their own, and destroy
+	// themselves once they complete.
+	{
+		std::thread thread;
+		std::atomic_bool done{false};
+		[](std::thread &thread, std::atomic_bool &done)
+			-> Task<> {
+			co_await OnThread(thread);
+			done = true;
+		}(thread, done)
+			.detach();
+		releaseAssert(!done);
+		std::this_thread::sleep_for(100ms);
+		thread.join();
+		releaseAssert(done);
+	}
+
+	return 0;
+}
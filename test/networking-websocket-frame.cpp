@@ -0,0 +1,129 @@
+// Tests Networking::WebSocket::FrameHead and mask.
+#include <rain.hpp>
+
+using Rain::Error::releaseAssert;
+using namespace Rain::Literal;
+using namespace Rain::Networking::WebSocket;
+using namespace std::literals;
+
+int main() {
+	// Heads round trip, with each payload length encoding.
+	for (std::uint64_t payloadLen :
+			 {0_zu,
+				 125_zu,
+				 126_zu,
+				 65535_zu,
+				 65536_zu,
+				 1_zu << 40}) {
+		for (bool isMasked : {false, true}) {
+			FrameHead head{
+				false,
+				true,
+				Opcode::BINARY,
+				isMasked,
+				{'\x01', '\x02', '\x03', '\x04'},
+				payloadLen};
+			char buffer[FrameHead::MAX_LEN];
+			std::size_t const len{head.serialize(buffer)};
+			std::size_t const cLenBytes{
+				payloadLen < 126         ? 0_zu
+					: payloadLen < 65536 ? 2_zu
+															 : 8_zu};
+			releaseAssert(
+				len == 2 + cLenBytes + (isMasked ? 4 : 0));
+
+			// Incomplete heads parse to 0.
+			FrameHead parsed;
+			for (std::size_t idx{0}; idx < len; idx++) {
+				releaseAssert(parsed.parse({buffer, idx}) == 0);
+			}
+			releaseAssert(parsed.parse({buffer, len}) == len);
+			releaseAssert(!parsed.fin && parsed.rsv1);
+			releaseAssert(parsed.opcode == Opcode::BINARY);
+			releaseAssert(parsed.isMasked == isMasked);
+			releaseAssert(parsed.payloadLen == payloadLen);
+			releaseAssert(
+				!isMasked || parsed.maskingKey == head.maskingKey);
+		}
+	}
+
+	// The example frames of RFC 6455 5.7.
+	{
+		FrameHead head;
+		releaseAssert(head.parse("\x81\x05Hello"sv) == 2);
+		releaseAssert(head.fin && head.opcode == Opcode::TEXT);
+		releaseAssert(head.payloadLen == 5 && !head.isMasked);
+
+		std::string_view const masked{
+			"\x81\x85\x37\xfa\x21\x3d\x7f\x9f\x4d\x51\x58"sv};
+		releaseAssert(head.parse(masked) == 6);
+		char payload[5];
+		mask(payload, masked.data() + 6, 5, head.maskingKey);
+		releaseAssert(std::string_view(payload, 5) == "Hello");
+
+		releaseAssert(head.parse("\x89\x05Hello"sv) == 2);
+		releaseAssert(head.opcode == Opcode::PING);
+	}
+
+	// Malformed heads.
+	{
+		FrameHead head;
+		// RSV2, RSV3, reserved opcodes.
+		releaseAssert(
+			head.parse("\xa1\x00"sv) == FrameHead::MALFORMED);
+		releaseAssert(
+			head.parse("\x91\x00"sv) == FrameHead::MALFORMED);
+		releaseAssert(
+			head.parse("\x83\x00"sv) == FrameHead::MALFORMED);
+		releaseAssert(
+			head.parse("\x8b\x00"sv) == FrameHead::MALFORMED);
+		// Fragmented or long control frames.
+		releaseAssert(
+			head.parse("\x09\x00"sv) == FrameHead::MALFORMED);
+		releaseAssert(
+			head.parse("\x88\x7e\x00\x7e"sv) ==
+			FrameHead::MALFORMED);
+		// Payload lengths over 2^63.
+		releaseAssert(
+			head.parse(
+				"\x82\x7f\x80\x00\x00\x00\x00\x00\x00\x00"sv) ==
+			FrameHead::MALFORMED);
+	}
+
+	// mask matches bytewise masking at every offset and
+	// alignment, and may mask in place.
+	{
+		std::mt19937_64 generator(0);
+		std::string from(1_zu << 10, '\0');
+		for (char &byte : from) {
+			byte = static_cast<char>(generator());
+		}
+		std::array<char, 4> const key{
+			'\x12', '\x34', '\x56', '\x78'};
+		for (std::size_t begin{0}; begin < 8; begin++) {
+			for (std::size_t len :
+					 {0_zu, 1_zu, 7_zu, 16_zu, 33_zu, 1000_zu}) {
+				for (std::size_t offset{0}; offset < 4; offset++) {
+					std::string to(len, '\0'), expected(len, '\0');
+					for (std::size_t idx{0}; idx < len; idx++) {
+						expected[idx] = static_cast<char>(
+							from[begin + idx] ^ key[(offset + idx) % 4]);
+					}
+					mask(
+						to.data(), from.data() + begin, len, key, offset);
+					releaseAssert(to == expected);
+
+					std::string inPlace{from.substr(begin, len)};
+					mask(
+						inPlace.data(),
+						inPlace.data(),
+						len,
+						key,
+						offset);
+					releaseAssert(inPlace == expected);
+				}
+			}
+		}
+	}
+	return 0;
+}
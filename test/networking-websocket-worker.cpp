@@ -0,0 +1,214 @@
+// Tests Networking::WebSocket::Worker and Client.
+#include <rain.hpp>
+
+using Rain::Error::releaseAssert;
+using namespace Rain::Literal;
+using namespace Rain::Networking;
+using namespace std::literals;
+
+class MyWorker : public WebSocket::Worker<> {
+	using Worker::Worker;
+
+	ResponseAction reqEcho(Request &req, std::smatch const &) {
+		return this->upgrade(req, true);
+	}
+	ResponseAction reqPlain(
+		Request &req,
+		std::smatch const &) {
+		return this->upgrade(req);
+	}
+
+	virtual Filters const &filters() override {
+		static Filters const filters{
+			{".*",
+				"/echo",
+				{Http::Method::GET},
+				&MyWorker::reqEcho},
+			{".*",
+				"/plain",
+				{Http::Method::GET},
+				&MyWorker::reqPlain}};
+		return filters;
+	}
+
+	// Echoes messages, and reports whether they were
+	// compressed.
+	virtual void onMessage(
+		WebSocket::Message &message) override {
+		if (message.payload == "throw") {
+			throw std::runtime_error("throw");
+		} else if (message.payload == "deflate?") {
+			message.payload =
+				this->perMessageDeflate != nullptr ? "yes" : "no";
+		}
+		this->send(message);
+	}
+
+	// Silent connections are pinged, then closed, quickly.
+	virtual std::chrono::milliseconds onWorkIdleTimeout()
+		override {
+		return 1s;
+	}
+};
+
+class MyServer : public Http::Server<MyWorker> {
+	using Server::Server;
+
+	virtual MyWorker makeWorker(
+		NativeSocket nativeSocket,
+		SocketInterface *interrupter) override {
+		return {nativeSocket, interrupter};
+	}
+
+	public:
+	~MyServer() { this->destruct(); }
+};
+
+// Sends a raw handshake request, and returns the response.
+std::string rawHandshake(
+	MyServer const &server,
+	std::string const &request) {
+	Client<
+		Ipv4FamilyInterface,
+		StreamTypeInterface,
+		TcpProtocolInterface>
+		rawClient(Host{"localhost", server.host().service});
+	rawClient.send(request);
+	std::string response, buffer;
+	buffer.reserve(1_zu << 12);
+	while (rawClient.recv(buffer, 1s) > 0) {
+		response += buffer;
+	}
+	return response;
+}
+
+int main() {
+	MyServer server(":0");
+	Host const host{"localhost", server.host().service};
+
+	// Messages are echoed, with and without
+	// permessage-deflate, across fragments and interleaved
+	// pings.
+	for (bool toDeflate : {false, true}) {
+		WebSocket::Client<> client(host);
+		client.upgrade("localhost", "/echo", toDeflate);
+
+		client.send(WebSocket::Message{"deflate?"});
+		WebSocket::Message message;
+		releaseAssert(client.recv(message));
+		releaseAssert(
+			message.payload == (toDeflate ? "yes" : "no"));
+
+		client.send(WebSocket::Message{"hello"});
+		releaseAssert(client.recv(message));
+		releaseAssert(message.opcode == WebSocket::Opcode::TEXT);
+		releaseAssert(message.payload == "hello");
+
+		client.ping("ping");
+		std::string repetitive;
+		while (repetitive.size() < 1_zu << 20) {
+			repetitive += "the rain in spain " +
+				std::to_string(repetitive.size());
+		}
+		client.send(WebSocket::Message{repetitive});
+		releaseAssert(client.recv(message));
+		releaseAssert(message.payload == repetitive);
+
+		std::mt19937_64 generator(0);
+		std::string random(1_zu << 18, '\0');
+		for (char &byte : random) {
+			byte = static_cast<char>(generator());
+		}
+		client.send(
+			WebSocket::Message{random, WebSocket::Opcode::BINARY});
+		releaseAssert(client.recv(message));
+		releaseAssert(
+			message.opcode == WebSocket::Opcode::BINARY);
+		releaseAssert(message.payload == random);
+
+		// Closing is echoed.
+		client.close();
+		releaseAssert(!client.recv(message));
+	}
+
+	// permessage-deflate is only negotiated if the Worker
+	// offers it.
+	{
+		WebSocket::Client<> client(host);
+		client.upgrade("localhost", "/plain", true);
+		client.send(WebSocket::Message{"deflate?"});
+		WebSocket::Message message;
+		releaseAssert(client.recv(message));
+		releaseAssert(message.payload == "no");
+	}
+
+	// Invalid UTF-8, and throwing handlers, close the
+	// connection.
+	{
+		WebSocket::Client<> client(host);
+		client.upgrade("localhost", "/echo");
+		client.send(WebSocket::Message{"\xc0\xaf"});
+		WebSocket::Message message;
+		releaseAssert(!client.recv(message));
+	}
+	{
+		WebSocket::Client<> client(host);
+		client.upgrade("localhost", "/echo");
+		client.send(WebSocket::Message{"throw"});
+		WebSocket::Message message;
+		releaseAssert(!client.recv(message));
+	}
+
+	// Silent connections are pinged, then closed.
+	{
+		WebSocket::Client<> client(host);
+		client.upgrade("localhost", "/echo");
+		auto const timeBegin{std::chrono::steady_clock::now()};
+		std::this_thread::sleep_for(1500ms);
+		WebSocket::Message message;
+		releaseAssert(!client.recv(message));
+		releaseAssert(
+			std::chrono::steady_clock::now() - timeBegin < 5s);
+	}
+
+	// Malformed handshakes are refused.
+	{
+		std::string const response{rawHandshake(
+			server,
+			"GET /echo HTTP/1.1\r\nUpgrade: websocket\r\n"
+			"Connection: Upgrade\r\n"
+			"Sec-WebSocket-Version: 13\r\n\r\n")};
+		releaseAssert(response.starts_with("HTTP/1.1 400"));
+	}
+	{
+		std::string const response{rawHandshake(
+			server,
+			"GET /echo HTTP/1.1\r\nUpgrade: websocket\r\n"
+			"Connection: keep-alive, Upgrade\r\n"
+			"Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+			"Sec-WebSocket-Version: 8\r\n\r\n")};
+		releaseAssert(response.starts_with("HTTP/1.1 426"));
+		releaseAssert(
+			response.find("Sec-WebSocket-Version: 13\r\n") !=
+			std::string::npos);
+	}
+
+	// The example handshake of RFC 6455 1.3.
+	{
+		std::string const response{rawHandshake(
+			server,
+			"GET /echo HTTP/1.1\r\nUpgrade: websocket\r\n"
+			"Connection: keep-alive, Upgrade\r\n"
+			"Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+			"Sec-WebSocket-Version: 13\r\n\r\n")};
+		releaseAssert(response.starts_with("HTTP/1.1 101"));
+		releaseAssert(
+			response.find(
+				"Sec-WebSocket-Accept: "
+				"s3pPLMBiTxaQ9kYGzzhZRbK+xOo=\r\n") !=
+			std::string::npos);
+		releaseAssert(
+			response.find("Content-Length") == std::string::npos);
+	}
+	return 0;
+}
@@ -24,6 +24,9 @@ int main() {
 						<< Rain::String::trimWhitespace(whiteStr)
 						<< "\n";
 	releaseAssert(whiteStr == "Some string with whitespace");
+	releaseAssert(
+		Rain::String::trimWhitespace(
+			std::string_view(" \t view \r\n")) == "view");
 
 	char whiteCStr[]{
 		"   	\t	\nSome string with whitespace\t\t\n   	"};
@@ -88,5 +88,18 @@ int main() {
 		releaseAssert(timeElapsed < 20ms);
 	}
 
+	// asInt is never negative unless infinite, and rounds up
+	// partial milliseconds.
+	{
+		releaseAssert(Rain::Time::Timeout().asInt() == -1);
+		releaseAssert(Rain::Time::Timeout(0s).asInt() == 0);
+		releaseAssert(Rain::Time::Timeout(-1s).asInt() == 0);
+		releaseAssert(
+			Rain::Time::Timeout(std::chrono::microseconds(500))
+				.asInt() == 1);
+		int const ms{Rain::Time::Timeout(100ms).asInt()};
+		releaseAssert(ms > 90 && ms <= 100);
+	}
+
 	return 0;
 }
@@ -0,0 +1,177 @@
+// Tests Time::TimerWheel.
+#include <rain.hpp>
+
+using Rain::Error::releaseAssert;
+using namespace Rain::Literal;
+using Rain::Time::TimerWheel;
+
+// Event loop which advances a wheel until all of its
+// timers fire.
+void runUntilEmpty(TimerWheel &wheel) {
+	while (wheel.size() > 0) {
+		std::this_thread::sleep_until(
+			wheel.nextTimeout().asTimepoint());
+		wheel.advance();
+	}
+}
+
+int main() {
+	// Empty wheels never need to be advanced.
+	{
+		TimerWheel wheel;
+		releaseAssert(wheel.nextTimeout().isInfinite());
+		releaseAssert(wheel.advance() == 0);
+		releaseAssert(wheel.schedule({}, []() {}) == 0);
+		releaseAssert(wheel.size() == 0);
+	}
+
+	// Timers on every level fire in order, no earlier than
+	// their timeout. At 10us, timers beyond 640us are on the
+	// second level, and beyond 41ms on the third.
+	{
+		TimerWheel wheel(std::chrono::microseconds(10));
+		std::vector<std::chrono::milliseconds> const timeouts{
+			150ms, 2ms, 30ms, 0ms, 50ms, 1ms};
+		std::vector<std::pair<std::chrono::milliseconds, bool>>
+			fired;
+		auto const timeBegin{std::chrono::steady_clock::now()};
+		for (auto const &timeout : timeouts) {
+			wheel.schedule(
+				timeBegin + timeout, [&fired, timeBegin, timeout]() {
+					fired.emplace_back(
+						timeout,
+						std::chrono::steady_clock::now() - timeBegin >=
+							timeout);
+				});
+		}
+		releaseAssert(wheel.size() == timeouts.size());
+		runUntilEmpty(wheel);
+		auto const timeElapsed{
+			std::chrono::steady_clock::now() - timeBegin};
+		std::cout << "Fired " << fired.size() << " timers in "
+							<< timeElapsed << "." << std::endl;
+		releaseAssert(fired.size() == timeouts.size());
+		for (std::size_t idx{0}; idx < fired.size(); idx++) {
+			releaseAssert(fired[idx].second);
+			releaseAssert(
+				idx == 0 || fired[idx - 1].first < fired[idx].first);
+		}
+		releaseAssert(timeElapsed < 170ms);
+	}
+
+	// Timers beyond the last level wait in it until they are
+	// in range. At 10ns, the wheel spans 168ms.
+	{
+		TimerWheel wheel(std::chrono::nanoseconds(10));
+		auto const timeBegin{std::chrono::steady_clock::now()};
+		std::chrono::steady_clock::duration firedAt{};
+		wheel.schedule(timeBegin + 300ms, [&]() {
+			firedAt = std::chrono::steady_clock::now() - timeBegin;
+		});
+		runUntilEmpty(wheel);
+		std::cout << "Fired beyond the last level after "
+							<< firedAt << "." << std::endl;
+		releaseAssert(firedAt >= 300ms && firedAt < 320ms);
+	}
+
+	// Cancelled timers do not fire, and Ids are not reused.
+	{
+		TimerWheel wheel;
+		std::size_t cFired{0};
+		std::vector<TimerWheel::Id> ids;
+		for (std::size_t idx{0}; idx < 1000; idx++) {
+			ids.push_back(
+				wheel.schedule(20ms, [&cFired]() { cFired++; }));
+		}
+		for (std::size_t idx{1}; idx < ids.size(); idx += 2) {
+			releaseAssert(wheel.cancel(ids[idx]));
+			releaseAssert(!wheel.cancel(ids[idx]));
+		}
+		releaseAssert(wheel.size() == 500);
+		runUntilEmpty(wheel);
+		releaseAssert(cFired == 500);
+		releaseAssert(!wheel.cancel(ids[0]));
+
+		// Freed timers are reused under a new Id.
+		TimerWheel::Id const id{
+			wheel.schedule(20ms, [&cFired]() { cFired++; })};
+		releaseAssert(
+			std::find(ids.begin(), ids.end(), id) == ids.end());
+		releaseAssert(!wheel.cancel(ids[1]));
+		releaseAssert(wheel.size() == 1);
+	}
+
+	// Cancelling a running timer waits for its callback, but
+	// callbacks may cancel themselves.
+	{
+		TimerWheel wheel;
+		std::atomic_bool started{false}, finished{false};
+		TimerWheel::Id id{0};
+		id = wheel.schedule(0ms, [&]() {
+			started = true;
+			releaseAssert(!wheel.cancel(id));
+			std::this_thread::sleep_for(100ms);
+			finished = true;
+		});
+
+		// The loop starts once id is set.
+		std::thread loop([&wheel]() { runUntilEmpty(wheel); });
+		while (!started) {
+			std::this_thread::yield();
+		}
+		releaseAssert(!wheel.cancel(id));
+		releaseAssert(finished);
+		loop.join();
+	}
+
+	// A wheel shared across event loops fires each timer on
+	// exactly one of them.
+	{
+		TimerWheel wheel;
+		std::atomic_bool stopping{false};
+		std::vector<std::thread> loops;
+		for (std::size_t idx{0}; idx < 4; idx++) {
+			loops.emplace_back([&wheel, &stopping]() {
+				while (!stopping) {
+					std::this_thread::sleep_until(std::min(
+						wheel.nextTimeout().asTimepoint(),
+						std::chrono::steady_clock::now() + 1ms));
+					wheel.advance();
+				}
+			});
+		}
+
+		std::size_t const C_TIMERS{10000};
+		std::vector<std::atomic_size_t> cFired(C_TIMERS);
+		std::vector<TimerWheel::Id> ids;
+		std::size_t cCancelled{0};
+		std::mt19937 generator(0);
+		for (std::size_t idx{0}; idx < C_TIMERS; idx++) {
+			ids.push_back(wheel.schedule(
+				std::chrono::microseconds(generator() % 50000),
+				[&cFired, idx]() { cFired[idx]++; }));
+			if (generator() % 4 == 0) {
+				cCancelled +=
+					wheel.cancel(ids[generator() % ids.size()]);
+			}
+		}
+		while (wheel.size() > 0) {
+			std::this_thread::sleep_for(10ms);
+		}
+		stopping = true;
+		for (auto &loop : loops) {
+			loop.join();
+		}
+
+		std::size_t cTotal{0};
+		for (std::size_t idx{0}; idx < C_TIMERS; idx++) {
+			releaseAssert(cFired[idx] <= 1);
+			cTotal += cFired[idx];
+		}
+		std::cout << "Fired " << cTotal << " timers, cancelled "
+							<< cCancelled << "." << std::endl;
+		releaseAssert(cTotal + cCancelled == C_TIMERS);
+	}
+
+	return 0;
+}